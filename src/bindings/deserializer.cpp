@@ -569,6 +569,11 @@ std::vector<double> Deserializer::getDoubleList( const papuga_ValueVariant& val)
 	return getAtomicTypeList<double,ValueVariantWrap::todouble,Deserializer::getDouble>( val);
 }
 
+std::vector<NumericVariant> Deserializer::getNumericList( const papuga_ValueVariant& val)
+{
+	return getAtomicTypeList<NumericVariant,ValueVariantWrap::tonumeric,Deserializer::getNumeric>( val);
+}
+
 std::vector<float> Deserializer::getFloatList( const papuga_ValueVariant& val)
 {
 	return getAtomicTypeList<float,ValueVariantWrap::tofloat,Deserializer::getFloat>( val);
@@ -1105,6 +1110,202 @@ StatisticsMessage Deserializer::getStatisticsMessage( const papuga_ValueVariant&
 	}
 }
 
+std::vector<StatisticsMessage> Deserializer::getStatisticsMessageList( const papuga_ValueVariant& msglist)
+{
+	static const char* context = _TXT("statistics message list");
+	std::vector<StatisticsMessage> rt;
+
+	if (!papuga_ValueVariant_defined( &msglist))
+	{
+		return rt;
+	}
+	else if (msglist.valuetype != papuga_TypeSerialization)
+	{
+		rt.push_back( getStatisticsMessage( msglist));
+		return rt;
+	}
+	papuga_SerializationIter seriter;
+	papuga_init_SerializationIter( &seriter, msglist.value.serialization);
+	if (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
+	{
+		rt.push_back( getStatisticsMessage( seriter));
+	}
+	else
+	{
+		while (papuga_SerializationIter_tag( &seriter) == papuga_TagOpen)
+		{
+			papuga_SerializationIter_skip( &seriter);
+			rt.push_back( getStatisticsMessage( seriter));
+			Deserializer::consumeClose( seriter);
+		}
+	}
+	if (!papuga_SerializationIter_eof( &seriter)) throw strus::runtime_error( _TXT("unexpected tokens at end of %s"), context);
+	return rt;
+}
+
+static std::pair<std::string,std::string> getTermKey( papuga_SerializationIter& seriter)
+{
+	static const StructureNameMap namemap( "type,value,variable,len", ',');
+	static const char* context = _TXT("term");
+
+	if (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
+	{
+		unsigned char defined[2] = {0,0};
+		std::string type;
+		std::string value;
+		do
+		{
+			int idx = namemap.index( *papuga_SerializationIter_value( &seriter));
+			papuga_SerializationIter_skip( &seriter);
+			switch (idx)
+			{
+				case 0: if (defined[0]++) throw strus::runtime_error(_TXT("duplicate definition of '%s' in %s"), namemap.name(idx), context);
+					type = Deserializer::getString( seriter);
+					break;
+				case 1: if (defined[1]++) throw strus::runtime_error(_TXT("duplicate definition of '%s' in %s"), namemap.name(idx), context);
+					value = Deserializer::getString( seriter);
+					break;
+				case 2: (void)Deserializer::getString( seriter);
+					// ... variable assigned to the term is ignored
+					break;
+				case 3: (void)Deserializer::getUint( seriter);
+					// ... len that is part of analyzer output is ignored
+					break;
+				default: throw strus::runtime_error(_TXT("unknown tag name in %s, one of {%s} expected"), context, namemap.names());
+			}
+		}
+		while (papuga_SerializationIter_tag( &seriter) == papuga_TagName);
+		if (!defined[0] || !defined[1])
+		{
+			throw strus::runtime_error(_TXT("incomplete %s definition"), context);
+		}
+		return std::pair<std::string,std::string>( type, value);
+	}
+	else if (papuga_SerializationIter_tag( &seriter) == papuga_TagValue)
+	{
+		std::string type = Deserializer::getString( seriter);
+		std::string value = Deserializer::getString( seriter);
+		return std::pair<std::string,std::string>( type, value);
+	}
+	else
+	{
+		throw strus::runtime_error(_TXT("structure expected with named elements or tuple with positional arguments for %s"), context);
+	}
+}
+
+std::vector<std::pair<std::string,std::string> > Deserializer::getTermKeyList( const papuga_ValueVariant& terms)
+{
+	static const char* context = _TXT("term list");
+	std::vector<std::pair<std::string,std::string> > rt;
+
+	if (!papuga_ValueVariant_defined( &terms))
+	{
+		return rt;
+	}
+	else if (terms.valuetype != papuga_TypeSerialization)
+	{
+		throw strus::runtime_error(_TXT("expected structure for %s"), context);
+	}
+	papuga_SerializationIter seriter;
+	papuga_init_SerializationIter( &seriter, terms.value.serialization);
+	if (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
+	{
+		rt.push_back( getTermKey( seriter));
+	}
+	else
+	{
+		while (papuga_SerializationIter_tag( &seriter) == papuga_TagOpen)
+		{
+			papuga_SerializationIter_skip( &seriter);
+			rt.push_back( getTermKey( seriter));
+			Deserializer::consumeClose( seriter);
+		}
+	}
+	if (!papuga_SerializationIter_eof( &seriter)) throw strus::runtime_error( _TXT("unexpected tokens at end of %s"), context);
+	return rt;
+}
+
+static void getStatisticsWatermark( std::map<std::string,TimeStamp>& res, papuga_SerializationIter& seriter)
+{
+	static const StructureNameMap namemap( "source,timestamp", ',');
+	enum StructureNameId {I_source=0,I_timestamp=1};
+	static const char* context = _TXT("statistics watermark");
+
+	bool defined[ 2] = {false,false};
+	std::string source;
+	TimeStamp timestamp;
+
+	while (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
+	{
+		StructureNameId idx = (StructureNameId)namemap.index( *papuga_SerializationIter_value( &seriter));
+		if (idx >= 0 && defined[idx])
+		{
+			throw strus::runtime_error(_TXT("duplicate definition of %s in %s"), namemap.name(idx), context);
+		}
+		defined[idx] = true;
+
+		papuga_SerializationIter_skip( &seriter);
+		switch (idx)
+		{
+			case I_source:
+				source = Deserializer::getString( seriter);
+				break;
+			case I_timestamp:
+				if (papuga_SerializationIter_tag( &seriter) == papuga_TagOpen)
+				{
+					papuga_SerializationIter_skip( &seriter);
+					timestamp = Deserializer::getTimeStamp( seriter);
+					Deserializer::consumeClose( seriter);
+				}
+				else
+				{
+					throw strus::runtime_error(_TXT("structure expected for %s in %s"), "timestamp", context);
+				}
+				break;
+			default:
+				throw strus::runtime_error(_TXT("unknown definition in %s expected one of %s"), context, "{source,timestamp}");
+				break;
+		}
+	}
+	if (!defined[ I_source] || !defined[ I_timestamp])
+	{
+		throw strus::runtime_error(_TXT("incomplete definition of %s, %s expected"), context, "{source,timestamp}");
+	}
+	res[ source] = timestamp;
+}
+
+std::map<std::string,TimeStamp> Deserializer::getStatisticsWatermarks( const papuga_ValueVariant& watermarks)
+{
+	static const char* context = _TXT("statistics watermark list");
+	std::map<std::string,TimeStamp> rt;
+
+	if (!papuga_ValueVariant_defined( &watermarks))
+	{
+		return rt;
+	}
+	else if (watermarks.valuetype != papuga_TypeSerialization)
+	{
+		throw strus::runtime_error(_TXT("expected structure for %s"), context);
+	}
+	papuga_SerializationIter seriter;
+	papuga_init_SerializationIter( &seriter, watermarks.value.serialization);
+	if (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
+	{
+		getStatisticsWatermark( rt, seriter);
+	}
+	else
+	{
+		while (papuga_SerializationIter_tag( &seriter) == papuga_TagOpen)
+		{
+			papuga_SerializationIter_skip( &seriter);
+			getStatisticsWatermark( rt, seriter);
+			Deserializer::consumeClose( seriter);
+		}
+	}
+	if (!papuga_SerializationIter_eof( &seriter)) throw strus::runtime_error( _TXT("unexpected tokens at end of %s"), context);
+	return rt;
+}
+
 SummaryElement Deserializer::getSummaryElement( papuga_SerializationIter& seriter)
 {
 	static const StructureNameMap namemap( "name,value,weight,index", ',');
@@ -3695,6 +3896,32 @@ void Deserializer::buildMetaDataRestriction(
 	}
 }
 
+void Deserializer::buildMetaDataRestriction(
+		MetaDataZoneFilter* builder,
+		const papuga_ValueVariant& content,
+		ErrorBufferInterface* errorhnd)
+{
+	static const char* context = _TXT("metadata restriction");
+
+	if (!papuga_ValueVariant_defined( &content)) return;
+	if (content.valuetype != papuga_TypeSerialization)
+	{
+		throw strus::runtime_error(_TXT("serialized structure expected for %s"), context);
+	}
+	papuga_SerializationIter seriter, serstart;
+	papuga_init_SerializationIter( &serstart, content.value.serialization);
+	papuga_init_SerializationIter( &seriter, content.value.serialization);
+	try
+	{
+		buildMetaDataRestriction_<MetaDataZoneFilter>( builder, seriter);
+		if (!papuga_SerializationIter_eof( &seriter)) throw strus::runtime_error( _TXT("unexpected tokens at end of serialization of %s"), context);
+	}
+	catch (const std::runtime_error& err)
+	{
+		throw runtime_error_with_location( err.what(), errorhnd, seriter, serstart);
+	}
+}
+
 std::string Deserializer::getConfigString( papuga_SerializationIter& seriter)
 {
 	ConfigDef cfg( seriter);
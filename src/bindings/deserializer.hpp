@@ -33,12 +33,14 @@
 #include "strus/numericVariant.hpp"
 #include "strus/storage/index.hpp"
 #include "impl/value/metadataExpression.hpp"
+#include "impl/value/metaDataZoneMap.hpp"
 #include "expressionBuilder.hpp"
 #include "structDefs.hpp"
 #include "papuga/serialization.h"
 #include "papuga/valueVariant.h"
 #include <string>
 #include <utility>
+#include <map>
 
 namespace strus {
 namespace bindings {
@@ -92,6 +94,8 @@ struct Deserializer
 
 	static std::vector<double> getDoubleList( const papuga_ValueVariant& val);
 
+	static std::vector<NumericVariant> getNumericList( const papuga_ValueVariant& val);
+
 	static std::vector<float> getFloatList( const papuga_ValueVariant& val);
 
 	static std::vector<WeightedString> getWeightedStringList( const papuga_ValueVariant& val);
@@ -114,6 +118,12 @@ struct Deserializer
 	static StatisticsMessage getStatisticsMessage( papuga_SerializationIter& seriter);
 	static StatisticsMessage getStatisticsMessage( const papuga_ValueVariant& msg);
 
+	static std::vector<StatisticsMessage> getStatisticsMessageList( const papuga_ValueVariant& msglist);
+
+	static std::vector<std::pair<std::string,std::string> > getTermKeyList( const papuga_ValueVariant& terms);
+
+	static std::map<std::string,TimeStamp> getStatisticsWatermarks( const papuga_ValueVariant& watermarks);
+
 	static SummaryElement getSummaryElement( papuga_SerializationIter& seriter);
 	static std::vector<SummaryElement> getSummaryElementList( papuga_SerializationIter& seriter);
 	static std::vector<SummaryElement> getSummaryElementListValue( papuga_SerializationIter& seriter);
@@ -248,6 +258,11 @@ struct Deserializer
 			const papuga_ValueVariant& content,
 			ErrorBufferInterface* errorhnd);
 
+	static void buildMetaDataRestriction(
+			MetaDataZoneFilter* filter,
+			const papuga_ValueVariant& content,
+			ErrorBufferInterface* errorhnd);
+
 	static std::string getConfigString( papuga_SerializationIter& seriter);
 	static std::string getConfigString( const papuga_ValueVariant& content);
 };
@@ -9,6 +9,7 @@
 #include "impl/value/analyzerIntrospection.hpp"
 #include "impl/value/featureFuncDef.hpp"
 #include "impl/value/sentenceTermExpression.hpp"
+#include "impl/value/analyzerJobQueue.hpp"
 #include "strus/documentAnalyzerInstanceInterface.hpp"
 #include "strus/documentAnalyzerContextInterface.hpp"
 #include "strus/queryAnalyzerInstanceInterface.hpp"
@@ -358,10 +359,11 @@ Struct DocumentAnalyzerImpl::introspection( const ValueVariant& arg) const
 	return rt;
 }
 
-QueryAnalyzerImpl::QueryAnalyzerImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd, const TextProcessorInterface* textproc_)
+QueryAnalyzerImpl::QueryAnalyzerImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd, const ObjectRef& jobqueue, const TextProcessorInterface* textproc_)
 	:m_errorhnd_impl(errorhnd)
 	,m_trace_impl(trace)
 	,m_objbuilder_impl(objbuilder)
+	,m_jobqueue_impl(jobqueue)
 	,m_analyzer_impl()
 	,m_sentence_lexer_map_impl()
 	,m_neighbour_collector_map_impl()
@@ -431,8 +433,20 @@ TermExpression* QueryAnalyzerImpl::analyzeTermExpression_( const ValueVariant& e
 
 	QueryAnalyzerTermExpressionBuilder exprbuilder( termexpr.get());
 	Deserializer::buildExpression( exprbuilder, expression, errorhnd, true);
-	termexpr->analyze();
-
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( "%s", errorhnd->fetchError());
+	}
+	AnalyzerJobQueue* jobqueue = m_jobqueue_impl.getObject<AnalyzerJobQueue>();
+	if (jobqueue)
+	{
+		// ... the analysis runs in a background thread, the result is gathered when the expression is serialized
+		termexpr->analyzeDeferred( jobqueue);
+	}
+	else
+	{
+		termexpr->analyze();
+	}
 	if (errorhnd->hasError())
 	{
 		throw strus::runtime_error( "%s", errorhnd->fetchError());
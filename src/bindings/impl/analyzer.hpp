@@ -452,11 +452,12 @@ private:
 	friend class ContextImpl;
 	friend class InserterImpl;
 
-	QueryAnalyzerImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd, const TextProcessorInterface* textproc_);
+	QueryAnalyzerImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd, const ObjectRef& jobqueue, const TextProcessorInterface* textproc_);
 
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
+	mutable ObjectRef m_jobqueue_impl;
 	ObjectRef m_analyzer_impl;
 	ObjectRef m_sentence_lexer_map_impl;
 	ObjectRef m_neighbour_collector_map_impl;
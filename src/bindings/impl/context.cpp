@@ -14,6 +14,8 @@
 #include "impl/contentstats.hpp"
 #include "impl/statistics.hpp"
 #include "impl/value/contextIntrospection.hpp"
+#include "impl/value/analyzerJobQueue.hpp"
+#include "impl/value/workerThreadSlots.hpp"
 #include "papuga/valueVariant.hpp"
 #include "papuga/serialization.hpp"
 #include "papuga/errors.hpp"
@@ -73,6 +75,8 @@ ContextImpl::ContextImpl( const ValueVariant& descr)
 	,m_trace_impl()
 	,m_storage_objbuilder_impl()
 	,m_analyzer_objbuilder_impl()
+	,m_analyzer_jobqueue_impl()
+	,m_workerslots_impl()
 	,m_textproc(0)
 	,m_threads(0)
 	,m_mutex()
@@ -88,6 +92,9 @@ ContextImpl::ContextImpl( const ValueVariant& descr)
 	{
 		int maxNofThreads =
 				contextdef.threads/*configured number of threads*/
+				+contextdef.analyzerThreads/*background threads of query analysis*/
+				+contextdef.workerThreads/*background threads of parallel operations*/
+				+contextdef.workerThreads/*threads kept by the worker thread pool of parallel query evaluation*/
 				+1/*main program*/
 				+1/*delegate request thread*/;
 
@@ -104,6 +111,7 @@ ContextImpl::ContextImpl( const ValueVariant& descr)
 	}
 
 	m_threads = contextdef.threads;
+	m_workerslots_impl.resetOwnership( new WorkerThreadSlots( contextdef.workerThreads), "WorkerThreadSlots");
 	if (contextdef.rpc.empty())
 	{
 		ModuleLoaderInterface* moduleLoader = createModuleLoader_( errorhnd);
@@ -112,6 +120,10 @@ ContextImpl::ContextImpl( const ValueVariant& descr)
 		{
 			m_trace_impl.resetOwnership( new TraceProxy( moduleLoader, contextdef.trace, errorhnd), "TraceProxy");
 		}
+		if (contextdef.analyzerThreads)
+		{
+			m_analyzer_jobqueue_impl.resetOwnership( new AnalyzerJobQueue( contextdef.analyzerThreads), "AnalyzerJobQueue");
+		}
 	}
 	else
 	{
@@ -307,7 +319,7 @@ ContentStatisticsImpl* ContextImpl::createContentStatistics()
 StorageClientImpl* ContextImpl::createStorageClient( const ValueVariant& config_)
 {
 	if (!m_storage_objbuilder_impl.get()) initStorageObjBuilder();
-	return new StorageClientImpl( m_trace_impl, m_storage_objbuilder_impl, m_errorhnd_impl, Deserializer::getConfigString( config_));
+	return new StorageClientImpl( m_trace_impl, m_storage_objbuilder_impl, m_errorhnd_impl, m_workerslots_impl, Deserializer::getConfigString( config_));
 }
 
 VectorStorageClientImpl* ContextImpl::createVectorStorageClient( const ValueVariant& config_)
@@ -325,7 +337,7 @@ DocumentAnalyzerImpl* ContextImpl::createDocumentAnalyzer( const ValueVariant& d
 QueryAnalyzerImpl* ContextImpl::createQueryAnalyzer()
 {
 	if (!m_analyzer_objbuilder_impl.get()) initAnalyzerObjBuilder();
-	return new QueryAnalyzerImpl( m_trace_impl, m_analyzer_objbuilder_impl, m_errorhnd_impl, m_textproc);
+	return new QueryAnalyzerImpl( m_trace_impl, m_analyzer_objbuilder_impl, m_errorhnd_impl, m_analyzer_jobqueue_impl, m_textproc);
 }
 
 QueryEvalImpl* ContextImpl::createQueryEval()
@@ -461,6 +473,18 @@ StatisticsMapImpl* ContextImpl::createStatisticsMap( const ValueVariant& config_
 	return new StatisticsMapImpl( m_trace_impl, m_storage_objbuilder_impl, m_errorhnd_impl, config);
 }
 
+StatisticsCacheImpl* ContextImpl::createStatisticsCache( const ValueVariant& config_)
+{
+	std::string config = Deserializer::getConfigString( config_);
+	return new StatisticsCacheImpl( m_trace_impl, m_errorhnd_impl, config);
+}
+
+ShardSelectorImpl* ContextImpl::createShardSelector( const ValueVariant& config_)
+{
+	std::string config = Deserializer::getConfigString( config_);
+	return new ShardSelectorImpl( m_trace_impl, m_errorhnd_impl, config);
+}
+
 void ContextImpl::close()
 {
 	m_analyzer_objbuilder_impl.reset();
@@ -38,6 +38,10 @@ class InserterImpl;
 /// \brief Forward declaration
 class StatisticsMapImpl;
 /// \brief Forward declaration
+class StatisticsCacheImpl;
+/// \brief Forward declaration
+class ShardSelectorImpl;
+/// \brief Forward declaration
 class QueryResultMergerImpl;
 /// \brief Forward declaration
 class QueryBuilderImpl;
@@ -62,6 +66,10 @@ public:
 	/// \example [ rpc: "localhost:7181" ]
 	/// \example [ trace: "log=dump;file=stdout" ]
 	/// \example [ threads: 12 ]
+	/// \example [ threads: 12, analyzerthreads: 4 ]
+	/// \note 'analyzerthreads' is the number of background threads used to analyze the features of a query concurrently, 0 (default) for analyzing them in the calling thread
+	/// \example [ threads: 12, workerthreads: 8 ]
+	/// \note 'workerthreads' is the maximum number of background threads running at the same time for parallel operations like 'StorageClient::selectPartitioned' or the analyzer threads of 'Inserter::load', 0 (default) for running them in the calling thread ('Inserter::load' needs at least one)
 	explicit ContextImpl( const ValueVariant& config=ValueVariant());
 	/// \brief Destructor
 	~ContextImpl();
@@ -113,6 +121,8 @@ public:
 	///	block_size:"4M"
 	///	cache:"1G"
 	///	] )
+	/// \example createStorageClient( "path=/srv/searchengine/storage; groupcommit=20" )
+	/// \note The configuration parameter 'groupcommit' enables the merging of commits of transactions arriving within the specified time window in milliseconds into one physical commit
 	/// \param[in] config configuration (string or structure with named elements) of the storage client or undefined, if the default remote storage of the RPC server is chosen
 	/// \return storage client interface (class StorageClient) for accessing the storage
 	StorageClientImpl* createStorageClient( const ValueVariant& config=ValueVariant());
@@ -228,10 +238,36 @@ public:
 	///	proc: "std"
 	///	blocks: "100K"
 	///	] )
+	/// \example createStatisticsMap( "proc=std; shards=64" )
+	/// \example createStatisticsMap( "proc=std; shards=64; dict=compact" )
+	/// \example createStatisticsMap( "proc=std; shards=64; dict=compact; sketchwidth=16M; sketchdepth=4; exactdf=32" )
+	/// \example createStatisticsMap( "proc=std; shards=64; snapshot=/srv/strus/statserver.snapshot; snapshotperiod=600" )
+	/// \example createStatisticsMap( "proc=std; shards=64; epoch=30" )
 	/// \param[in] config configuration (string or structure with named elements) of the statistics map including the name of the statistics processor (config variable 'proc') or undefined if the defaults are taken as configuration.
+	/// \note With the config variable 'shards' defined, the map is partitioned by term hash into the number of shards specified and answers df lookups from immutable snapshots without waiting for the ingestion of statistics messages, the statistics processor is then only used for decoding the messages.
+	/// \note With the config variable 'dict' set to "compact", the terms of the shards are stored in front coded dictionaries per type with varint packed df values, recent changes are kept in a mutable overlay until they are merged.
+	/// \note With the config variable 'sketchwidth' defined, only terms with a df reaching the threshold 'exactdf' (default 32) are counted exactly, the df of the other terms is estimated with count-min sketches of 'sketchdepth' (default 4) rows with 'sketchwidth' counters in total per row, the estimate exceeds the real df by at most e/sketchwidth times the sum of all df estimated with a probability of 1-exp(-sketchdepth), stated in the introspection.
+	/// \note With the config variable 'snapshot' defined (only with 'shards'), the map is loaded from this snapshot file on creation and stored to it periodically (config variable 'snapshotperiod' in seconds) or with StatisticsMap::storeSnapshot.
+	/// \note The version stamp of the map (StatisticsMap::version) used by statistics caches to detect outdated entries is incremented at most once per epoch (config variable 'epoch' in seconds, default 10).
 	/// \return the statistics map
 	StatisticsMapImpl* createStatisticsMap( const ValueVariant& config=ValueVariant());
 
+	/// \brief Create a cache for global statistics retrieved from a statistics server
+	/// \example createStatisticsCache()
+	/// \example createStatisticsCache( "ttl=60; size=1000000" )
+	/// \example createStatisticsCache( [ ttl: 60 size: 1000000 ] )
+	/// \param[in] config configuration (string or structure with named elements) of the cache with the time to live of entries in seconds (config variable 'ttl') and the maximum number of terms cached (config variable 'size'), the least recently used terms are evicted if it is reached, or undefined if the defaults are taken as configuration.
+	/// \return the statistics cache
+	StatisticsCacheImpl* createStatisticsCache( const ValueVariant& config=ValueVariant());
+
+	/// \brief Create a selector of the storage shards possibly matching a query, used by a coordinator of a distributed query evaluation
+	/// \example createShardSelector()
+	/// \example createShardSelector( "select=search" )
+	/// \example createShardSelector( [ select: "search,selfeat" ] )
+	/// \param[in] config configuration (string or structure with named elements) of the selector with the comma separated list of feature sets used for document selection (config variable 'select') or undefined if all features are considered
+	/// \return the shard selector
+	ShardSelectorImpl* createShardSelector( const ValueVariant& config=ValueVariant());
+
 	/// \brief Force cleanup to circumvent object pooling mechanisms in an interpreter context
 	void close();
 
@@ -281,6 +317,8 @@ private:
 	ObjectRef m_trace_impl;
 	ObjectRef m_storage_objbuilder_impl;
 	ObjectRef m_analyzer_objbuilder_impl;
+	ObjectRef m_analyzer_jobqueue_impl;
+	ObjectRef m_workerslots_impl;
 	const TextProcessorInterface* m_textproc;
 	int m_threads;
 	strus::mutex m_mutex;
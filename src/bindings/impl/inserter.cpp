@@ -13,10 +13,16 @@
 #include "strus/analyzer/documentAttribute.hpp"
 #include "strus/lib/bindings_description.hpp"
 #include "strus/base/local_ptr.hpp"
+#include "strus/base/configParser.hpp"
+#include "strus/base/fileio.hpp"
+#include "impl/value/bulkAnalyzerQueue.hpp"
+#include "impl/value/workerThreadSlots.hpp"
 #include "serializer.hpp"
 #include "deserializer.hpp"
 #include "papuga/allocator.h"
 #include "papuga/serialization.h"
+#include <algorithm>
+#include <cstring>
 
 using namespace strus;
 using namespace strus::bindings;
@@ -89,66 +95,70 @@ InserterTransactionImpl* InserterImpl::createTransaction() const
 	return new InserterTransactionImpl( transaction.get(), &m_analyzer);
 }
 
-void InserterTransactionImpl::insertDocument( const std::string& docid, const std::string& content, const ValueVariant& documentClass)
+/// \brief Insert a document analyzed into a storage transaction
+/// \param[in] docid the identifier of the document or empty if the document id is taken from the attribute 'docid' of the document
+static void insertAnalyzedDocument( StorageTransactionImpl& transaction, const std::string& docid, const analyzer::Document& doc)
 {
-	const DocumentAnalyzerInstanceInterface* analyzer = m_analyzer.m_analyzer_impl.getObject<const DocumentAnalyzerInstanceInterface>();
-	ErrorBufferInterface* errorhnd = m_analyzer.m_errorhnd_impl.getObject<ErrorBufferInterface>();
-	analyzer::DocumentClass dclass = m_analyzer.getDocumentClass( content, documentClass);
-	strus::local_ptr<DocumentAnalyzerContextInterface> analyzerContext( analyzer->createContext( dclass));
-	if (!analyzerContext.get()) throw std::runtime_error( errorhnd->fetchError());
-	analyzerContext->putInput( content.c_str(), content.size(), true/*eof*/);
-	strus::local_ptr<analyzer::Document> doc( new analyzer::Document());
-	int documentCount = 0;
-	while (analyzerContext->analyzeNext( *doc))
+	papuga_Serialization docser;
+	papuga_Allocator allocator;
+	int allocator_mem[ 1024];
+	papuga_init_Allocator( &allocator, &allocator_mem, sizeof(allocator_mem));
+	papuga_init_Serialization( &docser, &allocator);
+
+	try
 	{
-		papuga_Serialization docser;
-		papuga_Allocator allocator;
-		int allocator_mem[ 1024];
-		papuga_init_Allocator( &allocator, &allocator_mem, sizeof(allocator_mem));
-		papuga_init_Serialization( &docser, &allocator);
-		
-		try
-		{
-			Serializer::serialize( &docser, *doc, false/*deep*/);
-			papuga_ValueVariant docval;
-			papuga_init_ValueVariant_serialization( &docval, &docser);
+		Serializer::serialize( &docser, doc, false/*deep*/);
+		papuga_ValueVariant docval;
+		papuga_init_ValueVariant_serialization( &docval, &docser);
 
-			std::string id;
-			if (docid.empty())
+		if (docid.empty())
+		{
+			std::vector<analyzer::DocumentAttribute>::const_iterator ai = doc.attributes().begin(), ae = doc.attributes().end();
+			for (; ai != ae; ++ai)
 			{
-				std::vector<analyzer::DocumentAttribute>::const_iterator ai = doc->attributes().begin(), ae = doc->attributes().end();
-				for (; ai != ae; ++ai)
+				if (ai->name() == strus::Constants::attribute_docid())
 				{
-					if (ai->name() == strus::Constants::attribute_docid())
-					{
-						id = ai->value();
-						break;
-					}
+					break;
 				}
-				if (ai == ae)
-				{
-					throw strus::runtime_error(_TXT("insert document without docid or empty docid defined"));
-				}
-				m_transaction.insertDocument( id, docval);
-				documentCount++;
 			}
-			else
+			if (ai == ae)
 			{
-				m_transaction.insertDocument( docid, docval);
-				documentCount++;
+				throw strus::runtime_error(_TXT("insert document without docid or empty docid defined"));
 			}
+			transaction.insertDocument( ai->value(), docval);
 		}
-		catch (const std::bad_alloc&)
+		else
 		{
-			papuga_destroy_Allocator( &allocator);
-			throw std::bad_alloc();
-		}
-		catch (const std::runtime_error& err)
-		{
-			papuga_destroy_Allocator( &allocator);
-			throw err;
+			transaction.insertDocument( docid, docval);
 		}
+	}
+	catch (const std::bad_alloc&)
+	{
 		papuga_destroy_Allocator( &allocator);
+		throw std::bad_alloc();
+	}
+	catch (const std::runtime_error& err)
+	{
+		papuga_destroy_Allocator( &allocator);
+		throw err;
+	}
+	papuga_destroy_Allocator( &allocator);
+}
+
+void InserterTransactionImpl::insertDocument( const std::string& docid, const std::string& content, const ValueVariant& documentClass)
+{
+	const DocumentAnalyzerInstanceInterface* analyzer = m_analyzer.m_analyzer_impl.getObject<const DocumentAnalyzerInstanceInterface>();
+	ErrorBufferInterface* errorhnd = m_analyzer.m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	analyzer::DocumentClass dclass = m_analyzer.getDocumentClass( content, documentClass);
+	strus::local_ptr<DocumentAnalyzerContextInterface> analyzerContext( analyzer->createContext( dclass));
+	if (!analyzerContext.get()) throw std::runtime_error( errorhnd->fetchError());
+	analyzerContext->putInput( content.c_str(), content.size(), true/*eof*/);
+	strus::local_ptr<analyzer::Document> doc( new analyzer::Document());
+	int documentCount = 0;
+	while (analyzerContext->analyzeNext( *doc))
+	{
+		insertAnalyzedDocument( m_transaction, docid, *doc);
+		documentCount++;
 		if (documentCount > 1 && !docid.empty())
 		{
 			throw strus::runtime_error(_TXT("specified docid for inserter to insert of a multipart document"));
@@ -160,3 +170,133 @@ void InserterTransactionImpl::insertDocument( const std::string& docid, const st
 	}
 }
 
+/// \brief Collect the files to load from a path, directories are searched recursively
+static void collectFiles( std::vector<std::string>& files, const std::string& path, const std::string& ext)
+{
+	if (!strus::isDir( path))
+	{
+		files.push_back( path);
+		return;
+	}
+	std::vector<std::string> names;
+	int ec = strus::readDirFiles( path, ext, names);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read files of directory '%s' to load: %s"), path.c_str(), ::strerror(ec));
+	std::sort( names.begin(), names.end());
+	std::vector<std::string>::const_iterator ni = names.begin(), ne = names.end();
+	for (; ni != ne; ++ni)
+	{
+		files.push_back( strus::joinFilePath( path, *ni));
+	}
+	names.clear();
+	ec = strus::readDirSubDirs( path, names);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read sub directories of directory '%s' to load: %s"), path.c_str(), ::strerror(ec));
+	std::sort( names.begin(), names.end());
+	ni = names.begin(), ne = names.end();
+	for (; ni != ne; ++ni)
+	{
+		collectFiles( files, strus::joinFilePath( path, *ni), ext);
+	}
+}
+
+Struct InserterImpl::load( const ValueVariant& paths, const ValueVariant& config_, const ValueVariant& documentClass)
+{
+	const DocumentAnalyzerInstanceInterface* analyzer = m_analyzer.m_analyzer_impl.getObject<const DocumentAnalyzerInstanceInterface>();
+	ErrorBufferInterface* errorhnd = m_analyzer.m_errorhnd_impl.getObject<ErrorBufferInterface>();
+
+	std::string configstr = papuga_ValueVariant_defined( &config_) ? Deserializer::getConfigString( config_) : std::string();
+	unsigned int nofThreads = BulkAnalyzerQueue::DefaultNofThreads;
+	unsigned int queueSize = BulkAnalyzerQueue::DefaultQueueSize;
+	unsigned int commitSize = 1000;
+	std::string ext;
+	(void)extractUIntFromConfigString( nofThreads, configstr, "threads", errorhnd);
+	(void)extractUIntFromConfigString( queueSize, configstr, "queue", errorhnd);
+	(void)extractUIntFromConfigString( commitSize, configstr, "commit", errorhnd);
+	(void)extractStringFromConfigString( ext, configstr, "ext", errorhnd);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to parse load configuration: %s"), errorhnd->fetchError());
+	}
+	if (!configstr.empty())
+	{
+		throw strus::runtime_error( _TXT("unknown configuration parameters for load: %s"), configstr.c_str());
+	}
+	if (!commitSize) throw strus::runtime_error( _TXT("number of documents per transaction of load must not be 0"));
+
+	std::vector<std::string> files;
+	std::vector<std::string> pathlist = Deserializer::getStringList( paths);
+	std::vector<std::string>::const_iterator pi = pathlist.begin(), pe = pathlist.end();
+	for (; pi != pe; ++pi)
+	{
+		collectFiles( files, *pi, ext);
+	}
+	analyzer::DocumentClass dclass;
+	if (papuga_ValueVariant_defined( &documentClass))
+	{
+		dclass = Deserializer::getDocumentClass( documentClass);
+	}
+
+	double starttime = BulkAnalyzerQueue::currentTime();
+	double committime = 0.0;
+	int nofDocuments = 0;
+	int nofCommits = 0;
+	unsigned int nofTransactionDocuments = 0;
+
+	// ... every analyzer thread uses the error buffer of the context and needs a worker thread slot reserved for it
+	WorkerThreadAllocation workers( m_storage.m_workerslots_impl, nofThreads ? nofThreads : (unsigned int)BulkAnalyzerQueue::DefaultNofThreads);
+	if (!workers.nofThreads())
+	{
+		throw strus::runtime_error( _TXT("no worker threads available for the analyzer threads of load (context configuration 'workerthreads')"));
+	}
+	BulkAnalyzerQueue queue( analyzer, m_analyzer.m_textproc, errorhnd, files, dclass, workers.nofThreads(), queueSize);
+	strus::local_ptr<StorageTransactionImpl> transaction;
+	analyzer::Document* doc;
+	while (0!=(doc = queue.fetch()))
+	{
+		strus::local_ptr<analyzer::Document> docref( doc);
+		if (!transaction.get()) transaction.reset( m_storage.createTransaction());
+		insertAnalyzedDocument( *transaction, std::string(), *doc);
+		++nofDocuments;
+		if (++nofTransactionDocuments >= commitSize)
+		{
+			double commitstart = BulkAnalyzerQueue::currentTime();
+			transaction->commit();
+			committime += BulkAnalyzerQueue::currentTime() - commitstart;
+			transaction.reset();
+			nofTransactionDocuments = 0;
+			++nofCommits;
+		}
+	}
+	if (transaction.get())
+	{
+		double commitstart = BulkAnalyzerQueue::currentTime();
+		transaction->commit();
+		committime += BulkAnalyzerQueue::currentTime() - commitstart;
+		++nofCommits;
+	}
+	double seconds = BulkAnalyzerQueue::currentTime() - starttime;
+	BulkAnalyzerQueue::Statistics stats = queue.statistics();
+
+	Struct rt;
+	bool sc = true;
+	Serializer::serializeWithName( &rt.serialization, "files", (papuga_Int)stats.nofFiles, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "documents", (papuga_Int)nofDocuments, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "commits", (papuga_Int)nofCommits, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "seconds", seconds, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "throughput", seconds > 0.0 ? (double)nofDocuments / seconds : 0.0, true/*deep*/);
+	sc &= papuga_Serialization_pushName_charp( &rt.serialization, "analyzer");
+	sc &= papuga_Serialization_pushOpen( &rt.serialization);
+	Serializer::serializeWithName( &rt.serialization, "threads", (papuga_Int)queue.nofThreads(), true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "stalls", (papuga_Int)stats.producerStalls, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "time", stats.producerStallTime, true/*deep*/);
+	sc &= papuga_Serialization_pushClose( &rt.serialization);
+	sc &= papuga_Serialization_pushName_charp( &rt.serialization, "inserter");
+	sc &= papuga_Serialization_pushOpen( &rt.serialization);
+	Serializer::serializeWithName( &rt.serialization, "stalls", (papuga_Int)stats.consumerStalls, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "time", stats.consumerStallTime, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "committime", committime, true/*deep*/);
+	sc &= papuga_Serialization_pushClose( &rt.serialization);
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
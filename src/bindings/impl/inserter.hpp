@@ -29,6 +29,21 @@ public:
 	/// \return the transaction object (class InserterTransaction) created
 	InserterTransactionImpl* createTransaction() const;
 
+	/// \brief Load the documents of a list of files or directories, analyzed by a set of background threads and inserted with transactions committed at a configurable size
+	/// \note Documents of transactions committed before an error occurred stay inserted
+	/// \note The number of analyzer threads is bounded by the worker threads of the context (configuration 'workerthreads') not in use, the load fails if there are none available
+	/// \param[in] paths a file or directory path or a list of them, directories are searched recursively
+	/// \example "/srv/data/docs"
+	/// \example [ "/srv/data/docs1" "/srv/data/docs2/doc1.xml" ]
+	/// \param[in] config configuration (string or structure with named elements) of the load, number of analyzer threads (threads), maximum number of documents analyzed and not inserted yet (queue), number of documents inserted per transaction (commit) and extension of the files searched in directories (ext)
+	/// \example "threads=8; queue=1024; commit=10000; ext=.xml"
+	/// \example [ threads: 8 commit: 10000 ]
+	/// \param[in] documentClass (optional) document class of all documents to load (autodetection per file if undefined)
+	/// \example [ mimetype:"application/xml" encoding:"UTF-8" ]
+	/// \return structure with the number of files (files) and documents (documents) loaded, the number of commits (commits), the elapsed time in seconds (seconds), the throughput in documents per second (throughput)
+	///	and the stall statistics of the analyzer threads waiting for the inserter (analyzer) and of the inserter waiting for the analyzer threads (inserter), both with the number of times (stalls) and the total time in seconds (time) waited
+	Struct load( const ValueVariant& paths, const ValueVariant& config=ValueVariant(), const ValueVariant& documentClass=ValueVariant());
+
 	/// \brief Introspect a structure starting from a root path
 	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
 	/// \return the structure to introspect starting from the path
@@ -39,7 +54,7 @@ private:
 	friend class ContextImpl;
 
 	InserterImpl( const StorageClientImpl* storage, const DocumentAnalyzerImpl* analyzer)
-		:m_storage( storage->m_trace_impl, storage->m_objbuilder_impl, storage->m_errorhnd_impl, storage->m_storage_impl)
+		:m_storage( storage->m_trace_impl, storage->m_objbuilder_impl, storage->m_errorhnd_impl, storage->m_workerslots_impl, storage->m_storage_impl, storage->m_zonemap_impl)
 		,m_analyzer( analyzer->m_trace_impl, analyzer->m_objbuilder_impl, analyzer->m_errorhnd_impl, analyzer->m_analyzer_impl, analyzer->m_textproc){}
 
 	StorageClientImpl m_storage;
@@ -95,7 +110,7 @@ private:
 	friend class InserterImpl;
 
 	InserterTransactionImpl( const StorageTransactionImpl* transaction, const DocumentAnalyzerImpl* analyzer)
-		:m_transaction( transaction->m_trace_impl, transaction->m_objbuilder_impl, transaction->m_errorhnd_impl, transaction->m_storage_impl, transaction->m_transaction_impl)
+		:m_transaction( transaction->m_trace_impl, transaction->m_objbuilder_impl, transaction->m_errorhnd_impl, transaction->m_workerslots_impl, transaction->m_storage_impl, transaction->m_transaction_impl, transaction->m_zonemap_impl)
 		,m_analyzer( analyzer->m_trace_impl, analyzer->m_objbuilder_impl, analyzer->m_errorhnd_impl, analyzer->m_analyzer_impl, analyzer->m_textproc){}
 	
 	StorageTransactionImpl m_transaction;
@@ -7,12 +7,16 @@
  */
 #include "impl/query.hpp"
 #include "impl/storage.hpp"
+#include "impl/statistics.hpp"
 #include "impl/value/structViewIntrospection.hpp"
+#include "impl/value/parallelQueryEval.hpp"
+#include "impl/value/workerThreadSlots.hpp"
 #include "papuga/serialization.h"
 #include "strus/queryEvalInterface.hpp"
 #include "strus/queryInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/storageClientInterface.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "private/internationalization.hpp"
 #include "valueVariantWrap.hpp"
@@ -20,6 +24,10 @@
 #include "deserializer.hpp"
 #include "serializer.hpp"
 #include "structDefs.hpp"
+#include <map>
+#include <set>
+#include <algorithm>
+#include <limits>
 
 using namespace strus;
 using namespace strus::bindings;
@@ -29,6 +37,7 @@ QueryEvalImpl::QueryEvalImpl( const ObjectRef& trace, const ObjectRef& objbuilde
 	,m_trace_impl(trace)
 	,m_objbuilder_impl(objbuilder)
 	,m_queryeval_impl()
+	,m_rankeval_impl()
 {
 	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
 	m_queryproc = objBuilder->getQueryProcessor();
@@ -38,7 +47,8 @@ QueryEvalImpl::QueryEvalImpl( const ObjectRef& trace, const ObjectRef& objbuilde
 		throw strus::runtime_error( "%s", ehnd->fetchError());
 	}
 	m_queryeval_impl.resetOwnership( objBuilder->createQueryEval(), "QueryEval");
-	if (!m_queryeval_impl.get())
+	m_rankeval_impl.resetOwnership( objBuilder->createQueryEval(), "QueryEval");
+	if (!m_queryeval_impl.get() || !m_rankeval_impl.get())
 	{
 		ErrorBufferInterface* ehnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 		throw strus::runtime_error( "%s", ehnd->fetchError());
@@ -51,25 +61,33 @@ void QueryEvalImpl::addTerm(
 		const std::string& value_)
 {
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 	queryeval->addTerm( set_, type_, value_);
+	rankeval->addTerm( set_, type_, value_);
 }
 
 void QueryEvalImpl::addSelectionFeature( const std::string& set_)
 {
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 	queryeval->addSelectionFeature( set_);
+	rankeval->addSelectionFeature( set_);
 }
 
 void QueryEvalImpl::addRestrictionFeature( const std::string& set_)
 {
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 	queryeval->addRestrictionFeature( set_);
+	rankeval->addRestrictionFeature( set_);
 }
 
 void QueryEvalImpl::addExclusionFeature( const std::string& set_)
 {
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 	queryeval->addExclusionFeature( set_);
+	rankeval->addExclusionFeature( set_);
 }
 
 void QueryEvalImpl::addSummarizer(
@@ -97,9 +115,12 @@ void QueryEvalImpl::addWeightingFunction(
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 
 	Deserializer::buildWeightingFunction(
 		queryeval, name, parameters, featuresets, m_queryproc, errorhnd);
+	Deserializer::buildWeightingFunction(
+		rankeval, name, parameters, featuresets, m_queryproc, errorhnd);
 }
 
 void QueryEvalImpl::defineWeightingFormula(
@@ -108,14 +129,23 @@ void QueryEvalImpl::defineWeightingFormula(
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 
 	Deserializer::buildWeightingFormula( queryeval, source, parameter, m_queryproc, errorhnd);
+	Deserializer::buildWeightingFormula( rankeval, source, parameter, m_queryproc, errorhnd);
 }
 
 void QueryEvalImpl::usePositionInformation( const std::string& featureset, bool yes)
 {
 	QueryEvalInterface* queryeval = m_queryeval_impl.getObject<QueryEvalInterface>();
+	QueryEvalInterface* rankeval = m_rankeval_impl.getObject<QueryEvalInterface>();
 	queryeval->usePositionInformation( featureset, yes);
+	rankeval->usePositionInformation( featureset, yes);
+}
+
+void QueryEvalImpl::defineShard( const std::string& id)
+{
+	m_shard = id;
 }
 
 QueryImpl* QueryEvalImpl::createQuery( StorageClientImpl* storage) const
@@ -127,7 +157,7 @@ QueryImpl* QueryEvalImpl::createQuery( StorageClientImpl* storage) const
 	query.resetOwnership( qe->createQuery( st), "Query");
 	if (!query.get()) throw strus::runtime_error( "%s", errorhnd->fetchError());
 
-	return new QueryImpl( m_trace_impl, m_objbuilder_impl, m_errorhnd_impl, storage->m_storage_impl, m_queryeval_impl, query, m_queryproc);
+	return new QueryImpl( m_trace_impl, m_objbuilder_impl, m_errorhnd_impl, storage->m_workerslots_impl, storage->m_storage_impl, m_queryeval_impl, m_rankeval_impl, query, m_queryproc, m_shard);
 }
 
 Struct QueryEvalImpl::introspection( const ValueVariant& arg) const
@@ -151,11 +181,16 @@ Struct QueryEvalImpl::introspection( const ValueVariant& arg) const
 	return rt;
 }
 
-void QueryImpl::addFeature( const std::string& set_, const ValueVariant& expr_, double weight_)
+QueryImpl::QueryImpl( const ObjectRef& trace_impl_, const ObjectRef& objbuilder_impl_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_impl_, const ObjectRef& queryeval_impl_, const ObjectRef& rankeval_impl_, const ObjectRef& query_impl_, const QueryProcessorInterface* queryproc_, const std::string& shard_)
+	:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_objbuilder_impl(objbuilder_impl_),m_workerslots_impl(workerslots_),m_storage_impl(storage_impl_),m_queryeval_impl(queryeval_impl_),m_rankeval_impl(rankeval_impl_),m_query_impl(query_impl_),m_queryproc(queryproc_),m_useMergeResult(false),m_minRank(0),m_maxNofRanks(QueryInterface::DefaultMaxNofRanks),m_shard(shard_),m_hasShardEvalSet(false),m_nofShardEvalDocs(0)
+	,m_nofPartitions(0),m_definitions_impl(),m_hasEvalSet(false),m_evalset()
 {
-	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
-	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
-	QueryExpressionBuilder exprbuilder( THIS, m_queryproc, errorhnd);
+	m_definitions_impl.resetOwnership( new QueryDefinitions(), "QueryDefinitions");
+}
+
+static void defineQueryFeature( QueryInterface* query, const QueryProcessorInterface* queryproc, ErrorBufferInterface* errorhnd, const std::string& set_, const ValueVariant& expr_, double weight_)
+{
+	QueryExpressionBuilder exprbuilder( query, queryproc, errorhnd);
 
 	Deserializer::buildExpression( exprbuilder, expr_, errorhnd, true);
 	if (errorhnd->hasError()) throw strus::runtime_error( "%s", errorhnd->fetchError());
@@ -163,15 +198,44 @@ void QueryImpl::addFeature( const std::string& set_, const ValueVariant& expr_,
 	if (nn == 0) throw strus::runtime_error( _TXT("feature defined without expression"));
 	for (; ii<nn; ++ii)
 	{
-		THIS->defineFeature( set_, weight_);
+		query->defineFeature( set_, weight_);
+	}
+}
+
+static void defineQueryAccess( QueryInterface* query, const ValueVariant& userlist_)
+{
+	std::vector<std::string> userlist = Deserializer::getStringList( userlist_);
+	std::vector<std::string>::const_iterator ui = userlist.begin(), ue = userlist.end();
+	for (; ui != ue; ++ui)
+	{
+		query->addAccess( *ui);
+	}
+}
+
+static void defineQueryWeightingVariables( QueryInterface* query, const ValueVariant& parameter)
+{
+	KeyValueList kvlist( parameter, "name,value");
+	KeyValueList::const_iterator ki = kvlist.begin(), ke = kvlist.end();
+	for (; ki != ke; ++ki)
+	{
+		query->setWeightingVariableValue( ki->first, ValueVariantWrap::todouble( *ki->second));
 	}
 }
 
+void QueryImpl::addFeature( const std::string& set_, const ValueVariant& expr_, double weight_)
+{
+	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	defineQueryFeature( THIS, m_queryproc, errorhnd, set_, expr_, weight_);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::Feature, expr_, set_, std::string(), weight_);
+}
+
 void QueryImpl::addMetaDataRestriction( const ValueVariant& expression)
 {
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	Deserializer::buildMetaDataRestriction( THIS, expression, errorhnd);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::MetaDataRestriction, expression);
 }
 
 void QueryImpl::defineTermStatistics( const std::string& type_, const std::string& value_, const ValueVariant& stats_)
@@ -179,6 +243,7 @@ void QueryImpl::defineTermStatistics( const std::string& type_, const std::strin
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
 	TermStatistics stats = Deserializer::getTermStatistics( stats_);
 	THIS->defineTermStatistics( type_, value_, stats);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::TermStatistics, stats_, type_, value_);
 }
 
 void QueryImpl::defineGlobalStatistics( const ValueVariant& stats_)
@@ -186,6 +251,7 @@ void QueryImpl::defineGlobalStatistics( const ValueVariant& stats_)
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
 	GlobalStatistics stats = Deserializer::getGlobalStatistics( stats_);
 	THIS->defineGlobalStatistics( stats);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::GlobalStatistics, stats_);
 }
 
 void QueryImpl::addDocumentEvaluationSet( const ValueVariant& docnolist_)
@@ -193,6 +259,27 @@ void QueryImpl::addDocumentEvaluationSet( const ValueVariant& docnolist_)
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
 	std::vector<Index> docnolist = Deserializer::getIndexList( docnolist_);
 	THIS->addDocumentEvaluationSet( docnolist);
+	m_hasEvalSet = true;
+	m_evalset.insert( m_evalset.end(), docnolist.begin(), docnolist.end());
+}
+
+void QueryImpl::addShardEvaluationSet( const std::string& shard_, const ValueVariant& docnolist_)
+{
+	m_hasShardEvalSet = true;
+	if (shard_ != m_shard) return;
+
+	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
+	std::vector<Index> docnolist = Deserializer::getIndexList( docnolist_);
+	if (docnolist.empty()) return;
+	THIS->addDocumentEvaluationSet( docnolist);
+	m_nofShardEvalDocs += docnolist.size();
+	m_hasEvalSet = true;
+	m_evalset.insert( m_evalset.end(), docnolist.begin(), docnolist.end());
+}
+
+const char* QueryImpl::shardId( bool yes) const
+{
+	return yes ? m_shard.c_str() : NULL;
 }
 
 void QueryImpl::setMaxNofRanks( int maxNofRanks_)
@@ -210,27 +297,117 @@ void QueryImpl::useMergeResult( bool yes)
 	m_useMergeResult = yes;
 }
 
+void QueryImpl::setNofPartitions( unsigned int nofPartitions_)
+{
+	if (nofPartitions_ > ParallelQueryEvaluation::MaxNofPartitions) throw strus::runtime_error(_TXT("number of query evaluation partitions %u exceeds the maximum of %u"), nofPartitions_, (unsigned int)ParallelQueryEvaluation::MaxNofPartitions);
+	m_nofPartitions = nofPartitions_;
+}
+
 void QueryImpl::addAccess( const ValueVariant& userlist_)
 {
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
-	std::vector<std::string> userlist = Deserializer::getStringList( userlist_);
-	std::vector<std::string>::const_iterator ui = userlist.begin(), ue = userlist.end();
-	for (; ui != ue; ++ui)
-	{
-		THIS->addAccess( *ui);
-	}
+	defineQueryAccess( THIS, userlist_);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::Access, userlist_);
 }
 
 void QueryImpl::setWeightingVariables(
 		const ValueVariant& parameter)
 {
 	QueryInterface* THIS = m_query_impl.getObject<QueryInterface>();
+	defineQueryWeightingVariables( THIS, parameter);
+	m_definitions_impl.getObject<QueryDefinitions>()->push( QueryDefinitions::WeightingVariables, parameter);
+}
 
-	KeyValueList kvlist( parameter, "name,value");
-	KeyValueList::const_iterator ki = kvlist.begin(), ke = kvlist.end();
-	for (; ki != ke; ++ki)
+void QueryImpl::buildQueryCopy( QueryInterface* query) const
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	const QueryDefinitions* definitions = m_definitions_impl.getObject<const QueryDefinitions>();
+	std::vector<QueryDefinitions::Definition>::const_iterator di = definitions->definitions().begin(), de = definitions->definitions().end();
+	for (; di != de; ++di)
+	{
+		switch (di->type)
+		{
+			case QueryDefinitions::Feature:
+				defineQueryFeature( query, m_queryproc, errorhnd, di->name, di->arg, di->weight);
+				break;
+			case QueryDefinitions::MetaDataRestriction:
+				Deserializer::buildMetaDataRestriction( query, di->arg, errorhnd);
+				break;
+			case QueryDefinitions::TermStatistics:
+				query->defineTermStatistics( di->name, di->value, Deserializer::getTermStatistics( di->arg));
+				break;
+			case QueryDefinitions::GlobalStatistics:
+				query->defineGlobalStatistics( Deserializer::getGlobalStatistics( di->arg));
+				break;
+			case QueryDefinitions::Access:
+				defineQueryAccess( query, di->arg);
+				break;
+			case QueryDefinitions::WeightingVariables:
+				defineQueryWeightingVariables( query, di->arg);
+				break;
+		}
+	}
+	if (errorhnd->hasError()) throw strus::runtime_error( "%s", errorhnd->fetchError());
+}
+
+namespace strus {
+namespace bindings {
+/// \brief Evaluation of a copy of a query on the documents of a partition
+class QueryImplPartitionEvaluator
+	:public QueryPartitionEvaluator
+{
+public:
+	explicit QueryImplPartitionEvaluator( const QueryImpl* query_)
+		:m_query(query_){}
+	virtual ~QueryImplPartitionEvaluator(){}
+
+	virtual strus::QueryResult evaluate( const std::vector<Index>& docnos, int maxNofRanks) const
+	{
+		return evaluateCopy( m_query->m_rankeval_impl.getObject<const QueryEvalInterface>(), docnos, maxNofRanks);
+	}
+
+	virtual strus::QueryResult evaluateSummaries( const std::vector<Index>& docnos, int maxNofRanks) const
+	{
+		return evaluateCopy( m_query->m_queryeval_impl.getObject<const QueryEvalInterface>(), docnos, maxNofRanks);
+	}
+
+private:
+	strus::QueryResult evaluateCopy( const QueryEvalInterface* qe, const std::vector<Index>& docnos, int maxNofRanks) const
+	{
+		ErrorBufferInterface* errorhnd = m_query->m_errorhnd_impl.getObject<ErrorBufferInterface>();
+		const StorageClientInterface* storage = m_query->m_storage_impl.getObject<const StorageClientInterface>();
+
+		strus::local_ptr<QueryInterface> query( qe->createQuery( storage));
+		if (!query.get()) throw strus::runtime_error( "%s", errorhnd->fetchError());
+		m_query->buildQueryCopy( query.get());
+		query->addDocumentEvaluationSet( docnos);
+
+		strus::QueryResult rt = query->evaluate( 0, maxNofRanks);
+		if (rt.ranks().empty() && errorhnd->hasError())
+		{
+			throw strus::runtime_error( "%s", errorhnd->fetchError());
+		}
+		return rt;
+	}
+
+private:
+	const QueryImpl* m_query;
+};
+}}//namespace
+
+QueryResult* QueryImpl::evaluatePartitioned( unsigned int nofPartitions) const
+{
+	QueryImplPartitionEvaluator evaluator( this);
+	WorkerThreadSlots* workerslots = m_workerslots_impl.getObject<WorkerThreadSlots>();
+	ParallelQueryEvaluation evaluation( &evaluator, workerslots->pool(), nofPartitions, m_useMergeResult ? 0 : m_minRank, m_useMergeResult ? (m_minRank + m_maxNofRanks) : m_maxNofRanks);
+	if (m_hasEvalSet)
 	{
-		THIS->setWeightingVariableValue( ki->first, ValueVariantWrap::todouble( *ki->second));
+		return new QueryResult( evaluation.evaluateSet( m_evalset));
+	}
+	else
+	{
+		const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+		return new QueryResult( evaluation.evaluateRange( storage->maxDocumentNumber()));
 	}
 }
 
@@ -238,6 +415,20 @@ QueryResult* QueryImpl::evaluate() const
 {
 	const QueryInterface* THIS = m_query_impl.getObject<const QueryInterface>();
 	Reference<QueryResult> result;
+	if (m_hasShardEvalSet && m_nofShardEvalDocs == 0)
+	{
+		// ... no document of this shard survived the merge of the ranking phase
+		return new QueryResult();
+	}
+	if (m_nofPartitions > 1 && !(m_hasEvalSet && m_evalset.empty()))
+	{
+		// ... every partition is evaluated by a worker thread of the context, the query is evaluated in the calling thread if not more than one is available
+		WorkerThreadAllocation workers( m_workerslots_impl, m_nofPartitions);
+		if (workers.nofThreads() > 1)
+		{
+			return evaluatePartitioned( workers.nofThreads());
+		}
+	}
 	if (m_useMergeResult)
 	{
 		result.reset( new QueryResult( THIS->evaluate( 0, m_minRank + m_maxNofRanks)));
@@ -257,6 +448,83 @@ QueryResult* QueryImpl::evaluate() const
 	return result.release();
 }
 
+QueryResultCursorImpl* QueryImpl::createResultCursor() const
+{
+	if (m_maxNofRanks <= 0) throw strus::runtime_error( _TXT("page size of query result cursor must be positive"));
+	// ... no document of this shard survived the merge of the ranking phase, if the evaluation set of the shard is empty
+	bool empty = (m_hasShardEvalSet && m_nofShardEvalDocs == 0);
+	return new QueryResultCursorImpl( m_trace_impl, m_errorhnd_impl, m_storage_impl, m_query_impl, m_minRank, m_maxNofRanks, empty);
+}
+
+/// \brief Get the size of a window multiplied by a factor, clamped to the number of ranks left before the rank index overflows
+static int scaledWindowSize( int windowSize, int factor, int evaluated)
+{
+	int maxWindowSize = std::numeric_limits<int>::max() - evaluated;
+	return (windowSize > maxWindowSize / factor) ? maxWindowSize : windowSize * factor;
+}
+
+QueryResultCursorImpl::QueryResultCursorImpl( const ObjectRef& trace_impl_, const ObjectRef& errorhnd_, const ObjectRef& storage_impl_, const ObjectRef& query_impl_, int minRank_, int pageSize_, bool empty_)
+	:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_storage_impl(storage_impl_),m_query_impl(query_impl_)
+	,m_pageSize(pageSize_),m_windowSize(0),m_evaluated(minRank_ > 0 ? minRank_ : 0),m_nextRank(m_evaluated)
+	,m_ranks(),m_rankidx(0),m_eof(empty_),m_evaluationPass(0),m_nofRanked(0),m_nofVisited(0),m_summary()
+{
+	m_windowSize = scaledWindowSize( pageSize_, InitialWindowPages, m_evaluated);
+}
+
+void QueryResultCursorImpl::evaluateWindow()
+{
+	if (m_windowSize <= 0)
+	{
+		// ... the rank index reached the maximum integer value
+		m_ranks.clear();
+		m_rankidx = 0;
+		m_eof = true;
+		return;
+	}
+	const QueryInterface* query = m_query_impl.getObject<const QueryInterface>();
+	strus::QueryResult result = query->evaluate( m_evaluated, m_windowSize);
+	if (result.ranks().empty())
+	{
+		ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+		if (errorhnd->hasError())
+		{
+			throw strus::runtime_error( "%s", errorhnd->fetchError());
+		}
+	}
+	m_ranks = result.ranks();
+	m_rankidx = 0;
+	m_evaluationPass = result.evaluationPass();
+	m_nofRanked = result.nofRanked();
+	m_nofVisited = result.nofVisited();
+	m_summary = result.summaryElements();
+	if ((int)m_ranks.size() < m_windowSize) m_eof = true;
+	m_evaluated += m_windowSize;
+	// ... every window ranks all documents from the first rank again, the window grows without limit to keep the number of evaluations logarithmic
+	m_windowSize = scaledWindowSize( m_windowSize, 2, m_evaluated);
+}
+
+QueryResult* QueryResultCursorImpl::nextPage()
+{
+	std::vector<ResultDocument> page;
+	while ((int)page.size() < m_pageSize)
+	{
+		if (m_rankidx >= m_ranks.size())
+		{
+			if (m_eof) break;
+			evaluateWindow();
+			if (m_rankidx >= m_ranks.size()) break;
+		}
+		page.push_back( m_ranks[ m_rankidx++]);
+	}
+	m_nextRank += page.size();
+	return new QueryResult( m_evaluationPass, m_nofRanked, m_nofVisited, page, m_summary);
+}
+
+int QueryResultCursorImpl::nextRank() const
+{
+	return m_nextRank;
+}
+
 Struct QueryImpl::introspection( const ValueVariant& arg) const
 {
 	Struct rt;
@@ -273,6 +541,10 @@ Struct QueryImpl::introspection( const ValueVariant& arg) const
 		( "minrank", m_minRank)
 		( "nofranks", m_maxNofRanks)
 		( "merge", m_useMergeResult);
+	if (!m_shard.empty())
+	{
+		view( "shard", m_shard);
+	}
 	strus::local_ptr<IntrospectionBase> ictx( new StructViewIntrospection( errorhnd, view));
 	ictx->getPathContent( rt.serialization, path, false/*substructure*/);
 	if (errorhnd->hasError())
@@ -297,6 +569,15 @@ void QueryResultMergerImpl::addQueryResult( const ValueVariant& res)
 {
 	std::vector<QueryResult> partvec( Deserializer::getQueryResultList( res));
 	m_ar.insert( m_ar.end(), partvec.begin(), partvec.end());
+	m_shards.resize( m_ar.size());
+}
+
+void QueryResultMergerImpl::addShardQueryResult( const std::string& shard, const ValueVariant& res)
+{
+	std::vector<QueryResult> partvec( Deserializer::getQueryResultList( res));
+	m_ar.insert( m_ar.end(), partvec.begin(), partvec.end());
+	m_shards.resize( m_ar.size(), shard);
+	m_shardset.insert( shard);
 }
 
 void QueryResultMergerImpl::useMergeResult( bool yes)
@@ -309,6 +590,86 @@ QueryResult* QueryResultMergerImpl::evaluate() const
 	return new QueryResult( QueryResult::merge( m_ar, m_minRank, m_maxNofRanks));
 }
 
+namespace {
+struct ShardRank
+{
+	double weight;
+	int shardidx;
+	Index docno;
+
+	ShardRank( double weight_, int shardidx_, Index docno_)
+		:weight(weight_),shardidx(shardidx_),docno(docno_){}
+	ShardRank( const ShardRank& o)
+		:weight(o.weight),shardidx(o.shardidx),docno(o.docno){}
+
+	// ... exact order (strict weak ordering), ties broken by the order of the results added and the document number
+	bool operator < (const ShardRank& o) const
+	{
+		if (weight != o.weight) return weight > o.weight;
+		if (shardidx != o.shardidx) return shardidx < o.shardidx;
+		return docno < o.docno;
+	}
+};
+}//anonymous namespace
+
+Struct QueryResultMergerImpl::getShardEvaluationSets() const
+{
+	Struct rt;
+	// [1] Select the ranks surviving the merge:
+	std::vector<ShardRank> ranks;
+	std::vector<QueryResult>::const_iterator ai = m_ar.begin(), ae = m_ar.end();
+	for (int aidx=0; ai != ae; ++ai,++aidx)
+	{
+		std::vector<ResultDocument>::const_iterator ri = ai->ranks().begin(), re = ai->ranks().end();
+		for (; ri != re; ++ri)
+		{
+			ranks.push_back( ShardRank( ri->weight(), aidx, ri->docno()));
+		}
+	}
+	std::size_t nofRanks = m_minRank + m_maxNofRanks;
+	if (nofRanks < ranks.size())
+	{
+		std::nth_element( ranks.begin(), ranks.begin() + nofRanks, ranks.end());
+		ranks.resize( nofRanks);
+	}
+	std::sort( ranks.begin(), ranks.end());
+	if ((std::size_t)m_minRank >= ranks.size()) ranks.clear();
+	else ranks.erase( ranks.begin(), ranks.begin() + m_minRank);
+
+	// [2] Group the document numbers by shard, every shard that returned a result gets an evaluation set, also if it is empty,
+	//	so that the query evaluation of a shard without documents surviving the merge evaluates nothing:
+	typedef std::map<std::string,std::vector<Index> > ShardDocnoMap;
+	ShardDocnoMap shardDocnoMap;
+	std::set<std::string>::const_iterator hi = m_shardset.begin(), he = m_shardset.end();
+	for (; hi != he; ++hi)
+	{
+		shardDocnoMap[ *hi];
+	}
+	if (shardDocnoMap.empty())
+	{
+		// ... no shard returned a result, an empty evaluation set of an anonymous shard marks the query evaluations to evaluate nothing
+		shardDocnoMap[ std::string()];
+	}
+	std::vector<ShardRank>::const_iterator ri = ranks.begin(), re = ranks.end();
+	for (; ri != re; ++ri)
+	{
+		shardDocnoMap[ m_shards[ ri->shardidx]].push_back( ri->docno);
+	}
+	bool sc = true;
+	ShardDocnoMap::iterator si = shardDocnoMap.begin(), se = shardDocnoMap.end();
+	for (; si != se; ++si)
+	{
+		std::sort( si->second.begin(), si->second.end());
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		Serializer::serializeWithName( &rt.serialization, "shard", si->first, true/*deep*/);
+		Serializer::serializeWithName( &rt.serialization, "docno", si->second, true/*deep*/);
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
 static StructView getView( const SummaryElement& res);
 static StructView getView( const ResultDocument& res);
 static StructView getView( const QueryResult& res);
@@ -415,6 +776,118 @@ Struct QueryBuilderImpl::getRestrictions()
 	return Struct( m_obj.getRestrictions());
 }
 
+void QueryBuilderImpl::probeCache( const StatisticsCacheImpl* cache)
+{
+	if (m_cacheProbed) return;
+	std::set<QueryExpression::TermKey> cachedTerms;
+	// ... the update counter is read before the lookups, entries defined concurrently are then accepted by 'getTermStatistics' too
+	m_cacheUpdateCount = cache->updateCount();
+	bool globalValid = cache->globalStatisticsValid();
+	std::set<QueryExpression::TermKey> terms = m_obj.getFeatureTerms();
+	std::set<QueryExpression::TermKey>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te; ++ti)
+	{
+		GlobalCounter df;
+		if (cache->getDf( df, ti->first, ti->second, true/*valid*/))
+		{
+			cachedTerms.insert( *ti);
+		}
+	}
+	m_cacheComplete = globalValid && cachedTerms.size() == terms.size();
+	m_cachedTerms.swap( cachedTerms);
+	m_cacheProbed = true;
+}
+
+Struct QueryBuilderImpl::getFeaturesUncached( const StatisticsCacheImpl* cache)
+{
+	Struct rt;
+	probeCache( cache);
+	m_obj.serializeFeaturesReferencingOther( &rt.serialization, m_cachedTerms, true);
+	rt.release();
+	return rt;
+}
+
+Struct QueryBuilderImpl::selectStatisticsServers( const StatisticsCacheImpl* cache, const ValueVariant& servers)
+{
+	Struct rt;
+	probeCache( cache);
+	if (!m_cacheComplete)
+	{
+		std::vector<std::string> serverlist = Deserializer::getStringList( servers);
+		std::vector<std::string>::const_iterator si = serverlist.begin(), se = serverlist.end();
+		for (; si != se; ++si)
+		{
+			Serializer::serialize( &rt.serialization, *si, true/*deep*/);
+		}
+	}
+	rt.release();
+	return rt;
+}
+
+Struct QueryBuilderImpl::getTermStatistics( const StatisticsCacheImpl* cache)
+{
+	Struct rt;
+	bool sc = true;
+	std::set<QueryExpression::TermKey> terms = m_obj.getFeatureTerms();
+	std::set<QueryExpression::TermKey>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te; ++ti)
+	{
+		GlobalCounter df;
+		bool found;
+		if (!m_cacheProbed)
+		{
+			found = cache->getDf( df, ti->first, ti->second, true/*valid*/);
+		}
+		else if (m_cachedTerms.find( *ti) != m_cachedTerms.end())
+		{
+			// ... the validity decided by 'getFeaturesUncached' is kept, the statistics of the term have not been requested from the server
+			found = cache->getDf( df, ti->first, ti->second, false/*valid*/);
+		}
+		else
+		{
+			// ... only statistics delivered by the server after 'getFeaturesUncached' are accepted for terms not valid then
+			found = cache->getDfUpdatedSince( df, ti->first, ti->second, m_cacheUpdateCount);
+		}
+		if (found)
+		{
+			sc &= papuga_Serialization_pushOpen( &rt.serialization);
+			Serializer::serializeWithName( &rt.serialization, "type", ti->first, true/*deep*/);
+			Serializer::serializeWithName( &rt.serialization, "value", ti->second, true/*deep*/);
+			Serializer::serializeWithName( &rt.serialization, "df", df, true/*deep*/);
+			sc &= papuga_Serialization_pushClose( &rt.serialization);
+		}
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
+Struct QueryBuilderImpl::selectServers( const ShardSelectorImpl* selector, const ValueVariant& servers)
+{
+	Struct rt;
+	std::vector<std::string> serverlist = Deserializer::getStringList( servers);
+	std::set<QueryExpression::TermKey> terms = selector->selectFeatureSets().empty()
+			? m_obj.getFeatureTerms()
+			: m_obj.getFeatureTerms( selector->selectFeatureSets());
+	std::set<QueryExpression::TermKey>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te && !ti->second.empty(); ++ti){}
+	bool selectAll = (terms.empty() || ti != te);
+	// ... select all shards if there are no terms to decide on or if there are terms without value that cannot be looked up in a summary
+
+	std::vector<std::string>::const_iterator si = serverlist.begin(), se = serverlist.end();
+	for (; si != se; ++si)
+	{
+		if (!selectAll)
+		{
+			for (ti = terms.begin(); ti != te && !selector->mayContain( *si, ti->first, ti->second); ++ti){}
+			if (ti == te) continue;
+		}
+		Serializer::serialize( &rt.serialization, *si, true/*deep*/);
+	}
+	rt.release();
+	return rt;
+}
+
 Struct QueryBuilderImpl::introspection( const ValueVariant& path) const
 {
 	Struct rt;
@@ -12,11 +12,13 @@
 #include "strus/queryInterface.hpp"
 #include "strus/numericVariant.hpp"
 #include "strus/storage/queryResult.hpp"
+#include "strus/storage/index.hpp"
 #include "strus/analyzer/queryTerm.hpp"
 #include "impl/value/objectref.hpp"
 #include "impl/value/struct.hpp"
 #include "impl/value/queryExpression.hpp"
 #include <vector>
+#include <set>
 #include <string>
 
 namespace strus {
@@ -27,7 +29,13 @@ typedef papuga_ValueVariant ValueVariant;
 ///\brief Forward declaration
 class QueryImpl;
 ///\brief Forward declaration
+class QueryResultCursorImpl;
+///\brief Forward declaration
 class StorageClientImpl;
+///\brief Forward declaration
+class StatisticsCacheImpl;
+///\brief Forward declaration
+class ShardSelectorImpl;
 
 /// \class QueryEvalImpl
 /// \brief Query evaluation program object representing an information retrieval scheme for documents in a storage.
@@ -121,6 +129,13 @@ public:
 	/// \note The motivation for this method is to use it in a preliminary evaluation step to get document candidates for query interpretation and expansion.
 	void usePositionInformation( const std::string& featureset, bool yes);
 
+	/// \brief Define the identifier of the shard (the storage) queries of this query evaluation are evaluated on
+	/// \note The shard identifier is used in distributed query evaluation to address the documents of a shard in a merged ranklist, see 'Query::addShardEvaluationSet'
+	/// \note Query evaluation objects evaluating queries on the same storage must have the same shard identifier
+	/// \param[in] id shard identifier
+	/// \example "shard01"
+	void defineShard( const std::string& id);
+
 	/// \brief Create a query to instantiate based on this query evaluation scheme
 	/// \param[in] storage storage to execute the query on
 	/// \return the query instance
@@ -141,7 +156,9 @@ private:
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
 	ObjectRef m_queryeval_impl;
+	ObjectRef m_rankeval_impl;			// query evaluation with the same definitions but without summarizers, for ranking the partitions of a parallel evaluation
 	const QueryProcessorInterface* m_queryproc;
+	std::string m_shard;
 };
 
 
@@ -210,6 +227,20 @@ public:
 	/// \example [1,23,2345,3565,4676,6456,8855,12203]
 	void addDocumentEvaluationSet( const ValueVariant& docnolist);
 
+	/// \brief Define a set of documents of a shard the query is evaluated on. The documents are only added to the evaluation set if the shard identifier matches the one defined with 'QueryEval::defineShard'. If none of the shard evaluation sets added matches, then the query evaluation returns an empty result.
+	/// \note This method is intented for the second phase of a distributed query evaluation, where summaries are only calculated for the documents in the merged ranklist of the first phase (see 'QueryResultMerger::getShardEvaluationSets')
+	/// \param[in] shard identifier of the shard the documents belong to
+	/// \example "shard01"
+	/// \param[in] docnolist list of documents of the shard to evaluate the query on (array of positive integers)
+	/// \example [1,23,2345,3565]
+	void addShardEvaluationSet( const std::string& shard, const ValueVariant& docnolist);
+
+	/// \brief Get the identifier of the shard this query is evaluated on, defined with 'QueryEval::defineShard'
+	/// \param[in] yes true if the shard identifier is requested, false else
+	/// \note The flag is intented for the mappings in the webrequest context, where the identifier is only returned in the result if requested
+	/// \return the shard identifier or an empty string if not defined, NULL if not requested
+	const char* shardId( bool yes=true) const;
+
 	/// \brief Set number of ranks to evaluate starting with the first rank (the maximum size of the result rank list)
 	/// \param[in] maxNofRanks maximum number of results to return by this query
 	/// \example 20
@@ -231,6 +262,18 @@ public:
 	/// \param[in] yes true if the result of this query is used as input of a merge of multiple query results, false else
 	void useMergeResult( bool yes=true);
 
+	/// \brief Set the number of partitions of the documents evaluated in parallel by 'evaluate', each by a thread of its own evaluating a copy of this query
+	/// \note The document number range, or the evaluation set if one is defined, is split into partitions of equal size ranked without summaries, and the ranklists of the partitions are merged with 'QueryResult::merge'.
+	///	The summaries are evaluated afterwards only for the documents of the merged result. The statistics for weighting are the same for all partitions, so the result is the same as of an evaluation without partitions
+	/// \note default is 0, the query is evaluated without partitions
+	/// \note Each partition is evaluated by a worker thread of the context (configuration 'workerthreads'), the number of partitions is reduced to the number of worker threads available.
+	///	The threads are kept in a pool of the context and reused by later evaluations.
+	///	If not more than one is available, the query is evaluated without partitions in the calling thread
+	/// \param[in] nofPartitions number of partitions evaluated in parallel, 0 or 1 for no partitioning
+	/// \example 4
+	/// \example 8
+	void setNofPartitions( unsigned int nofPartitions);
+
 	/// \brief Allow read access to documents having a specific ACL tag
 	/// \note If no ACL tags are specified, then all documents are potential candidates for the result
 	/// \param[in] rolelist Add ACL tag or list of ACL tags that selects documents to be candidates of the result
@@ -245,6 +288,14 @@ public:
 	/// \return the result (strus::QueryResult)
 	QueryResult* evaluate() const;
 
+	/// \brief Create a cursor for fetching the result of this query page by page, starting with the rank defined with 'setMinRank' and with pages of the size defined with 'setMaxNofRanks'
+	/// \note The query must not be changed anymore after the creation of a cursor, the flag set with 'useMergeResult' and the partitions set with 'setNofPartitions' are ignored by the cursor
+	/// \note Every window of ranks is evaluated by ranking the documents from the first rank on, the ranks before the window are ranked again and dropped.
+	///	The window doubles with every evaluation, so the number of evaluations grows only logarithmically with the number of pages fetched
+	/// \note The windows are evaluated separately on the current state of the storage. If documents are inserted, updated or deleted while fetching pages, ranks may be returned twice or skipped
+	/// \return the cursor (class QueryResultCursor) created
+	QueryResultCursorImpl* createResultCursor() const;
+
 	/// \brief Introspect a structure starting from a root path
 	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
 	/// \return the structure to introspect starting from the path
@@ -252,20 +303,82 @@ public:
 
 private:
 	friend class QueryEvalImpl;
-	QueryImpl( const ObjectRef& trace_impl_, const ObjectRef& objbuilder_impl_, const ObjectRef& errorhnd_, const ObjectRef& storage_impl_, const ObjectRef& queryeval_impl_, const ObjectRef& query_impl_, const QueryProcessorInterface* queryproc_)
-		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_objbuilder_impl(objbuilder_impl_),m_storage_impl(storage_impl_),m_queryeval_impl(queryeval_impl_),m_query_impl(query_impl_),m_queryproc(queryproc_),m_useMergeResult(false),m_minRank(0),m_maxNofRanks(QueryInterface::DefaultMaxNofRanks)
-	{}
+	friend class QueryImplPartitionEvaluator;
+	QueryImpl( const ObjectRef& trace_impl_, const ObjectRef& objbuilder_impl_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_impl_, const ObjectRef& queryeval_impl_, const ObjectRef& rankeval_impl_, const ObjectRef& query_impl_, const QueryProcessorInterface* queryproc_, const std::string& shard_);
+
+	/// \brief Apply the definitions recorded to a copy of this query
+	void buildQueryCopy( QueryInterface* query) const;
+	/// \brief Evaluate this query with the documents split into partitions evaluated in parallel
+	/// \param[in] nofPartitions number of partitions, each evaluated by a worker thread allocated by the caller
+	QueryResult* evaluatePartitioned( unsigned int nofPartitions) const;
 
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
+	ObjectRef m_workerslots_impl;			// worker thread slots of the context, for the threads evaluating partitions
 	ObjectRef m_storage_impl;
 	ObjectRef m_queryeval_impl;
+	ObjectRef m_rankeval_impl;			// query evaluation without summarizers, for ranking the partitions of a parallel evaluation
 	ObjectRef m_query_impl;
 	const QueryProcessorInterface* m_queryproc;
 	bool m_useMergeResult;
 	int m_minRank;
 	int m_maxNofRanks;
+	std::string m_shard;
+	bool m_hasShardEvalSet;
+	int m_nofShardEvalDocs;
+	unsigned int m_nofPartitions;
+	ObjectRef m_definitions_impl;			// definitions of this query recorded for building copies of it for the evaluation of partitions
+	bool m_hasEvalSet;				// true, if an evaluation set is defined
+	std::vector<Index> m_evalset;			// evaluation set defined, split into partitions instead of the document number range
+};
+
+
+/// \class QueryResultCursorImpl
+/// \brief Object for fetching the result of a query page by page without ranking the documents of all pages fetched before again for every page
+/// \note The cursor evaluates a window of ranks ahead and buffers the ranks not fetched yet. If the buffer is exhausted, the next window is evaluated with twice the size of the previous one,
+///	so that the number of query evaluations grows only logarithmically with the number of pages fetched, even though every evaluation ranks the documents from the first rank again.
+///	The window is not limited, it does not grow beyond the number of ranks fetched before plus the size of the first window
+/// \note The only way to construct a query result cursor instance is to call Query::createResultCursor()
+class QueryResultCursorImpl
+{
+public:
+	/// \brief Destructor
+	virtual ~QueryResultCursorImpl(){}
+
+	/// \brief Get the next page of the result
+	/// \return the result (strus::QueryResult) with an empty rank list if all ranks have been fetched
+	QueryResult* nextPage();
+
+	/// \brief Get the index of the first rank returned by the next call of 'nextPage'
+	/// \return the index of the rank, starting with 0
+	int nextRank() const;
+
+private:
+	enum {
+		InitialWindowPages=4		// size of the first window evaluated in pages
+	};
+	friend class QueryImpl;
+	QueryResultCursorImpl( const ObjectRef& trace_impl_, const ObjectRef& errorhnd_, const ObjectRef& storage_impl_, const ObjectRef& query_impl_, int minRank_, int pageSize_, bool empty_);
+
+	/// \brief Evaluate the next window of ranks into the buffer
+	void evaluateWindow();
+
+	mutable ObjectRef m_errorhnd_impl;
+	ObjectRef m_trace_impl;
+	ObjectRef m_storage_impl;
+	ObjectRef m_query_impl;
+	int m_pageSize;				// number of ranks returned with a page
+	int m_windowSize;			// number of ranks evaluated with the next window
+	int m_evaluated;			// index of the first rank of the next window
+	int m_nextRank;				// index of the next rank fetched
+	std::vector<ResultDocument> m_ranks;	// ranks of the last window evaluated
+	std::size_t m_rankidx;			// index of the next rank fetched in m_ranks
+	bool m_eof;				// true if the last window evaluated was the last one
+	int m_evaluationPass;			// evaluation pass of the last window evaluated
+	int m_nofRanked;			// number of documents ranked in the last window evaluated
+	int m_nofVisited;			// number of documents visited in the last window evaluated
+	std::vector<SummaryElement> m_summary;	// summary of the result of the last window evaluated
 };
 
 
@@ -297,6 +410,12 @@ public:
 	/// \param[in] res one query result or a list of query results to merge
 	void addQueryResult( const ValueVariant& res);
 
+	/// \brief Add a query result of a shard identified by name
+	/// \param[in] shard identifier of the shard the result was evaluated on (see 'QueryEval::defineShard')
+	/// \example "shard01"
+	/// \param[in] res one query result or a list of query results of the shard to merge
+	void addShardQueryResult( const std::string& shard, const ValueVariant& res);
+
 	/// \brief Flag that marks the result of this query to be used as input of a merge of multiple query results ('QueryResult::merge')
 	/// \note In this case minRank and maxNofRanks have to be set to 0 and minRank+maxNofRanks for merge to work correctly
 	/// \note This method is intented for the mappings in the webrequest context, because there we have no possibility for control structures and calculations
@@ -308,6 +427,13 @@ public:
 	/// \return the result (strus::QueryResult)
 	QueryResult* evaluate() const;
 
+	/// \brief Get the documents of the merged ranklist grouped by the shards they were added with 'addShardQueryResult'
+	/// \note This method is intented for a two phase distributed query evaluation, where the first phase returns only ranks without summaries and the summaries are calculated in a second phase only for the documents that survived the merge
+	/// \note Every shard a result was added for gets an evaluation set, also if none of its documents survived the merge. If no shard result was added, the list contains one empty evaluation set with an empty shard identifier.
+	///	The list is therefore never empty, so that the query evaluation servers receiving it evaluate nothing instead of all documents, if no document survived
+	/// \return the list of shard evaluation sets as structures with the shard identifier and the list of document numbers of the shard (see 'Query::addShardEvaluationSet')
+	Struct getShardEvaluationSets() const;
+
 	/// \brief Introspect a structure starting from a root path
 	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
 	/// \return the structure to introspect starting from the path
@@ -316,7 +442,7 @@ public:
 private:
 	friend class ContextImpl;
 	QueryResultMergerImpl( const ObjectRef& trace_impl_, const ObjectRef& errorhnd_)
-		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_useMergeResult(false),m_minRank(0),m_maxNofRanks(QueryInterface::DefaultMaxNofRanks),m_ar()
+		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_useMergeResult(false),m_minRank(0),m_maxNofRanks(QueryInterface::DefaultMaxNofRanks),m_ar(),m_shards(),m_shardset()
 	{}
 
 	mutable ObjectRef m_errorhnd_impl;
@@ -325,6 +451,8 @@ private:
 	int m_minRank;
 	int m_maxNofRanks;
 	std::vector<QueryResult> m_ar;
+	std::vector<std::string> m_shards;
+	std::set<std::string> m_shardset;
 };
 
 /// \class QueryBuilderImpl
@@ -390,6 +518,36 @@ public:
 	/// \return the list of restrictions
 	Struct getRestrictions();
 
+	/// \brief Get the list of features defined with 'addFeature' that reference at least one term without valid statistics in a cache
+	/// \note Used to query only the statistics of the terms from the statistics server, that are not in the cache
+	/// \note The cache is probed only once by the first call of this method or of 'selectStatisticsServers', later calls use the validity decided then
+	/// \param[in] cache cache of global statistics retrieved from the statistics server
+	/// \return the list of features
+	Struct getFeaturesUncached( const StatisticsCacheImpl* cache);
+
+	/// \brief Get the list of statistics servers to ask for the statistics of the query
+	/// \note Returns an empty list, if all terms referenced by features defined with 'addFeature' have valid entries in the cache and the global statistics of the cache are valid, the request to the statistics server is skipped then
+	/// \note The cache is probed only once by the first call of this method or of 'getFeaturesUncached', later calls use the validity decided then
+	/// \param[in] cache cache of global statistics retrieved from the statistics server
+	/// \param[in] servers address or list of addresses of the statistics servers
+	/// \example "example.com:7184/statserver/test"
+	/// \return the list of servers to ask
+	Struct selectStatisticsServers( const StatisticsCacheImpl* cache, const ValueVariant& servers);
+
+	/// \brief Get the term statistics of all terms referenced by features defined with 'addFeature' that are available in a cache
+	/// \note Returns the terms found valid in the cache by the preceding probe of 'getFeaturesUncached' or 'selectStatisticsServers' and the terms defined in the cache since then.
+	///	Without a preceding probe, only the entries valid now are returned
+	/// \param[in] cache cache of global statistics retrieved from the statistics server
+	/// \return the list of term statistics as structures with type, value and df
+	Struct getTermStatistics( const StatisticsCacheImpl* cache);
+
+	/// \brief Get the list of servers of shards that possibly contain documents matching the query, skipping shards that cannot contain any term of a selecting feature
+	/// \param[in] selector selector with the summaries of the terms contained in the shards
+	/// \param[in] servers list of addresses of the servers of the shards to select from
+	/// \example ["example.com:7184/qryeval/test" "example.com:7185/qryeval/test"]
+	/// \return the list of servers selected
+	Struct selectServers( const ShardSelectorImpl* selector, const ValueVariant& servers);
+
 	/// \brief Introspect a structure starting from a root path
 	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
 	/// \return the structure to introspect starting from the path
@@ -398,12 +556,19 @@ public:
 private:
 	friend class ContextImpl;
 	QueryBuilderImpl( const ObjectRef& trace_impl_, const ObjectRef& errorhnd_)
-		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_obj()
+		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_impl_),m_obj(),m_cachedTerms(),m_cacheProbed(false),m_cacheComplete(false),m_cacheUpdateCount(0)
 	{}
 
+	/// \brief Decide what terms have valid entries in a statistics cache, if not done yet
+	void probeCache( const StatisticsCacheImpl* cache);
+
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	QueryExpression m_obj;
+	std::set<QueryExpression::TermKey> m_cachedTerms;	// terms found valid in the statistics cache by 'probeCache'
+	bool m_cacheProbed;					// true if 'probeCache' has been called
+	bool m_cacheComplete;					// true if 'probeCache' found all terms and the global statistics valid in the cache
+	GlobalCounter m_cacheUpdateCount;			// update counter of the statistics cache when 'probeCache' was called
 };
 
 }}//namespace
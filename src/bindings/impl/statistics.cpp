@@ -7,35 +7,109 @@
  */
 #include "impl/statistics.hpp"
 #include "impl/value/statisticsIntrospection.hpp"
+#include "impl/value/structViewIntrospection.hpp"
 #include "deserializer.hpp"
+#include "impl/value/statisticsShardMap.hpp"
+#include "impl/value/varintEncoding.hpp"
 #include "strus/statisticsMapInterface.hpp"
 #include "strus/storageObjectBuilderInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
-#include "strus/statisticsMapInterface.hpp"
 #include "strus/statisticsProcessorInterface.hpp"
+#include "strus/statisticsViewerInterface.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/configParser.hpp"
+#include "strus/base/fileio.hpp"
 #include "private/internationalization.hpp"
+#include "serializer.hpp"
+#include "papuga/serialization.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 using namespace strus;
 using namespace strus::bindings;
 
+#define STATISTICS_SNAPSHOT_MAGIC "strus statistics map snapshot 1\n"
+
 StatisticsMapImpl::StatisticsMapImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd_, const std::string& config)
 	:m_errorhnd_impl(errorhnd_)
 	,m_trace_impl(trace)
 	,m_objbuilder_impl(objbuilder)
 	,m_statmap_impl()
+	,m_shardmap_impl()
+	,m_version(0)
+	,m_epoch_mutex()
+	,m_nofPendingChanges(0)
+	,m_epochTime(0)
+	,m_epochPeriod(10)
+	,m_watermarks()
+	,m_contributingSources()
+	,m_watermarks_mutex()
+	,m_snapshotPath()
+	,m_snapshotPeriod(0)
+	,m_snapshotTime(0)
+	,m_snapshot_mutex()
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 
 	std::string configstr = config;
 	std::string statsprocname;
+	std::string dictname;
+	unsigned int nofShards = 0;
+	unsigned int sketchWidth = 0;
+	unsigned int sketchDepth = 4;
+	unsigned int exactDfThreshold = 32;
 	(void)extractStringFromConfigString( statsprocname, configstr, "proc", errorhnd);
+	(void)extractUIntFromConfigString( nofShards, configstr, "shards", errorhnd);
+	(void)extractUIntFromConfigString( sketchWidth, configstr, "sketchwidth", errorhnd);
+	(void)extractUIntFromConfigString( sketchDepth, configstr, "sketchdepth", errorhnd);
+	(void)extractUIntFromConfigString( exactDfThreshold, configstr, "exactdf", errorhnd);
+	(void)extractStringFromConfigString( dictname, configstr, "dict", errorhnd);
+	(void)extractStringFromConfigString( m_snapshotPath, configstr, "snapshot", errorhnd);
+	(void)extractUIntFromConfigString( m_snapshotPeriod, configstr, "snapshotperiod", errorhnd);
+	(void)extractUIntFromConfigString( m_epochPeriod, configstr, "epoch", errorhnd);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to parse statistics map configuration: %s"), errorhnd->fetchError());
+	}
+	bool compact = false;
+	if (dictname == "compact")
+	{
+		compact = true;
+		if (!nofShards) nofShards = StatisticsShardMap::DefaultNofShards;
+	}
+	else if (!dictname.empty() && dictname != "map")
+	{
+		throw strus::runtime_error( _TXT("unknown term dictionary '%s' of statistics map, expected 'map' or 'compact'"), dictname.c_str());
+	}
+	if (sketchWidth && !nofShards)
+	{
+		nofShards = StatisticsShardMap::DefaultNofShards;
+	}
 
 	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
 	m_statsproc = objBuilder->getStatisticsProcessor( statsprocname);
 	if (!m_statsproc) throw strus::runtime_error( _TXT("unknown statistics processor '%s'"), statsprocname.c_str());
 
+	if (nofShards)
+	{
+		// ... map partitioned by term hash maintained by the bindings, the statistics processor is only used for decoding messages
+		if (!configstr.empty())
+		{
+			throw strus::runtime_error( _TXT("unknown configuration parameters for statistics map with shards: %s"), configstr.c_str());
+		}
+		m_shardmap_impl.resetOwnership( new StatisticsShardMap( nofShards, compact, sketchWidth, sketchDepth, exactDfThreshold), "statistics shard map");
+		if (!m_snapshotPath.empty() && strus::isFile( m_snapshotPath))
+		{
+			loadSnapshot();
+		}
+		m_snapshotTime = std::time(0);
+		return;
+	}
+	if (!m_snapshotPath.empty())
+	{
+		throw strus::runtime_error( _TXT("snapshots are only supported for a statistics map configured with shards"));
+	}
 	m_statmap_impl.resetOwnership( m_statsproc->createMap( configstr), "statistics map");
 	if (!m_statmap_impl.get())
 	{
@@ -45,39 +119,410 @@ StatisticsMapImpl::StatisticsMapImpl( const ObjectRef& trace, const ObjectRef& o
 
 void StatisticsMapImpl::addNofDocumentsInsertedChange( int increment)
 {
-	StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
-	THIS->addNofDocumentsInsertedChange( increment);
+	if (m_shardmap_impl.get())
+	{
+		StatisticsShardMap* THIS = m_shardmap_impl.getObject<StatisticsShardMap>();
+		THIS->update( std::vector<StatisticsShardMap::DfChange>(), increment);
+	}
+	else
+	{
+		StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
+		THIS->addNofDocumentsInsertedChange( increment);
+	}
+	changed();
 }
 
 void StatisticsMapImpl::addDfChange( const std::string& type, const std::string& term, int increment)
 {
-	StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
-	THIS->addDfChange( type.c_str(), term.c_str(), increment);
+	if (m_shardmap_impl.get())
+	{
+		StatisticsShardMap* THIS = m_shardmap_impl.getObject<StatisticsShardMap>();
+		std::vector<StatisticsShardMap::DfChange> changes;
+		changes.push_back( StatisticsShardMap::DfChange( type, term, increment));
+		THIS->update( changes, 0);
+	}
+	else
+	{
+		StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
+		THIS->addDfChange( type.c_str(), term.c_str(), increment);
+	}
+	changed();
+}
+
+static void decodeStatisticsMessage( std::vector<StatisticsShardMap::DfChange>& changes, int& nofDocumentsInsertedChange, const StatisticsProcessorInterface* statsproc, const StatisticsMessage& msg, ErrorBufferInterface* errorhnd)
+{
+	strus::local_ptr<StatisticsViewerInterface> viewer( statsproc->createViewer( msg.ptr(), msg.size()));
+	if (!viewer.get()) throw strus::runtime_error(_TXT( "error decoding statistics from blob: %s"), errorhnd->fetchError());
+
+	TermStatisticsChange rec;
+	while (viewer->nextDfChange( rec))
+	{
+		changes.push_back( StatisticsShardMap::DfChange( rec.type(), rec.value(), rec.increment()));
+	}
+	nofDocumentsInsertedChange = viewer->nofDocumentsInsertedChange();
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT( "failed to feed statistics message blob: %s"), errorhnd->fetchError());
+	}
+}
+
+void StatisticsMapImpl::feedStatisticsMessage( const StatisticsMessage& msg)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	if (m_shardmap_impl.get())
+	{
+		StatisticsShardMap* THIS = m_shardmap_impl.getObject<StatisticsShardMap>();
+		std::vector<StatisticsShardMap::DfChange> changes;
+		int nofDocumentsInsertedChange = 0;
+		decodeStatisticsMessage( changes, nofDocumentsInsertedChange, m_statsproc, msg, errorhnd);
+		// ... the message is decoded completely before applying it, the shards affected are updated without blocking readers
+		THIS->update( changes, nofDocumentsInsertedChange);
+	}
+	else
+	{
+		StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
+		if (!THIS->processStatisticsMessage( msg.ptr(), msg.size()))
+		{
+			throw strus::runtime_error(_TXT( "failed to feed statistics message blob: %s"), errorhnd->fetchError());
+		}
+	}
 }
 
 void StatisticsMapImpl::processStatisticsMessage( const ValueVariant& blob)
 {
-	StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
 	StatisticsMessage msg = Deserializer::getStatisticsMessage( blob);
-	if (!THIS->processStatisticsMessage( msg.ptr(), msg.size()))
+	feedStatisticsMessage( msg);
+	changed();
+	storeSnapshotIfDue();
+}
+
+namespace {
+/// \brief Statistics message decoded for a map with shards
+struct DecodedStatisticsMessage
+{
+	TimeStamp timestamp;
+	std::vector<StatisticsShardMap::DfChange> changes;
+	int nofDocumentsInsertedChange;
+
+	explicit DecodedStatisticsMessage( const TimeStamp& timestamp_)
+		:timestamp(timestamp_),changes(),nofDocumentsInsertedChange(0){}
+	DecodedStatisticsMessage( const DecodedStatisticsMessage& o)
+		:timestamp(o.timestamp),changes(o.changes),nofDocumentsInsertedChange(o.nofDocumentsInsertedChange){}
+
+	bool empty() const
 	{
-		ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
-		throw strus::runtime_error(_TXT( "failed to feed statistics message blob: %s"), errorhnd->fetchError());
+		return changes.empty() && !nofDocumentsInsertedChange;
+	}
+};
+}//anonymous namespace
+
+void StatisticsMapImpl::processStatisticsChanges( const std::string& source, const ValueVariant& messages, const ValueVariant& watermark_, const ValueVariant& snapshot_)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	// ... the storage passes either a snapshot with its watermark or the messages since the watermark of the source
+	bool withSnapshot = papuga_ValueVariant_defined( &watermark_);
+	std::vector<StatisticsMessage> msglist = Deserializer::getStatisticsMessageList( withSnapshot ? snapshot_ : messages);
+	TimeStamp watermark = withSnapshot ? Deserializer::getTimeStamp( watermark_) : TimeStamp();
+
+	// ... the messages are decoded before locking the watermarks, only their application to the map is serialized
+	StatisticsShardMap* shardmap = m_shardmap_impl.getObject<StatisticsShardMap>();
+	std::vector<DecodedStatisticsMessage> decodedlist;
+	if (shardmap)
+	{
+		decodedlist.reserve( msglist.size());
+		std::vector<StatisticsMessage>::const_iterator mi = msglist.begin(), me = msglist.end();
+		for (; mi != me; ++mi)
+		{
+			decodedlist.push_back( DecodedStatisticsMessage( mi->timestamp()));
+			decodeStatisticsMessage( decodedlist.back().changes, decodedlist.back().nofDocumentsInsertedChange, m_statsproc, *mi, errorhnd);
+		}
+	}
+	{
+		strus::scoped_lock lock( m_watermarks_mutex);
+		std::map<std::string,TimeStamp>::iterator wi = m_watermarks.find( source);
+		if (withSnapshot)
+		{
+			if (wi != m_watermarks.end() && !(wi->second < watermark))
+			{
+				msglist.clear(); //... snapshot already contained, e.g. delivered by two synchronizations running concurrently
+				decodedlist.clear();
+			}
+			else
+			{
+				if (wi != m_watermarks.end() && m_contributingSources.find( source) != m_contributingSources.end())
+				{
+					// ... the statistics contributed by the source before cannot be replaced by the snapshot
+					resetStatistics();
+				}
+				wi = m_watermarks.insert( std::pair<std::string,TimeStamp>( source, TimeStamp())).first;
+				wi->second = watermark;
+			}
+		}
+		else if (wi == m_watermarks.end())
+		{
+			msglist.clear(); //... statistics of a source are accepted first with a snapshot, the next synchronization delivers it
+			decodedlist.clear();
+		}
+		std::size_t mi = 0, me = msglist.size();
+		for (; mi != me; ++mi)
+		{
+			if (!withSnapshot)
+			{
+				if (!(wi->second < msglist[ mi].timestamp())) continue; //... message already processed
+				wi->second = msglist[ mi].timestamp();
+			}
+			if (shardmap)
+			{
+				if (decodedlist[ mi].empty()) continue;
+				shardmap->update( decodedlist[ mi].changes, decodedlist[ mi].nofDocumentsInsertedChange);
+			}
+			else
+			{
+				feedStatisticsMessage( msglist[ mi]);
+			}
+			m_contributingSources.insert( source);
+			changed();
+		}
+	}
+	storeSnapshotIfDue();
+}
+
+void StatisticsMapImpl::resetStatistics()
+{
+	if (!m_shardmap_impl.get())
+	{
+		throw strus::runtime_error( _TXT("the statistics of a source can only be replaced by a snapshot in a statistics map configured with shards"));
 	}
+	StatisticsShardMap* THIS = m_shardmap_impl.getObject<StatisticsShardMap>();
+	THIS->clear();
+	m_watermarks.clear();
+	m_contributingSources.clear();
+	changed();
+}
+
+void StatisticsMapImpl::storeSnapshot()
+{
+	if (!m_shardmap_impl.get() || m_snapshotPath.empty())
+	{
+		throw strus::runtime_error( _TXT("no snapshot file configured for statistics map"));
+	}
+	const StatisticsShardMap* THIS = m_shardmap_impl.getObject<const StatisticsShardMap>();
+	std::string content( STATISTICS_SNAPSHOT_MAGIC);
+	StatisticsShardMap::Image image;
+	{
+		// ... no changes with watermark are applied while taking the image of the map, for the watermarks being consistent with it
+		strus::scoped_lock lock( m_watermarks_mutex);
+		appendVarint( content, (unsigned long long)m_version.value());
+		appendVarint( content, m_watermarks.size());
+		std::map<std::string,TimeStamp>::const_iterator wi = m_watermarks.begin(), we = m_watermarks.end();
+		for (; wi != we; ++wi)
+		{
+			appendVarintString( content, wi->first);
+			appendVarint( content, (unsigned long long)wi->second.unixtime());
+			appendVarint( content, (unsigned long long)wi->second.counter());
+		}
+		image = THIS->image();
+	}
+	// ... the image is immutable, serializing it does not block the processing of changes
+	image.serialize( content);
+	strus::scoped_lock lock( m_snapshot_mutex);
+	std::string tmppath = m_snapshotPath + ".tmp";
+	int ec = strus::writeFile( tmppath, content);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write statistics map snapshot '%s': %s"), tmppath.c_str(), ::strerror(ec));
+	ec = strus::renameFile( tmppath, m_snapshotPath);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write statistics map snapshot '%s': %s"), m_snapshotPath.c_str(), ::strerror(ec));
+	m_snapshotTime = std::time(0);
+}
+
+void StatisticsMapImpl::storeSnapshotIfDue()
+{
+	if (m_snapshotPath.empty() || !m_snapshotPeriod) return;
+	{
+		strus::scoped_lock lock( m_snapshot_mutex);
+		std::time_t now = std::time(0);
+		if (now < m_snapshotTime + (std::time_t)m_snapshotPeriod) return;
+		m_snapshotTime = now; //... only one caller stores the snapshot
+	}
+	storeSnapshot();
+}
+
+void StatisticsMapImpl::loadSnapshot()
+{
+	StatisticsShardMap* THIS = m_shardmap_impl.getObject<StatisticsShardMap>();
+	std::string content;
+	int ec = strus::readFile( m_snapshotPath, content);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read statistics map snapshot '%s': %s"), m_snapshotPath.c_str(), ::strerror(ec));
+	std::size_t magiclen = std::strlen( STATISTICS_SNAPSHOT_MAGIC);
+	if (content.size() < magiclen || 0!=std::memcmp( content.c_str(), STATISTICS_SNAPSHOT_MAGIC, magiclen))
+	{
+		throw strus::runtime_error( _TXT("file '%s' is not a statistics map snapshot"), m_snapshotPath.c_str());
+	}
+	std::size_t pos = magiclen;
+	GlobalCounter version = (GlobalCounter)readVarint( content, pos);
+	std::size_t nofWatermarks = readVarint( content, pos);
+	std::size_t wi = 0;
+	for (; wi < nofWatermarks; ++wi)
+	{
+		std::string source = readVarintString( content, pos);
+		long unixtime = (long)readVarint( content, pos);
+		int counter = (int)readVarint( content, pos);
+		m_watermarks[ source] = TimeStamp( unixtime, counter);
+		m_contributingSources.insert( source);
+	}
+	THIS->deserialize( content, pos);
+	// ... the version continues after the one of the snapshot, for clients caching statistics to detect the change
+	m_version.increment( version + 1);
+}
+
+Struct StatisticsMapImpl::watermarks() const
+{
+	Struct rt;
+	bool sc = true;
+	strus::scoped_lock lock( m_watermarks_mutex);
+	std::map<std::string,TimeStamp>::const_iterator wi = m_watermarks.begin(), we = m_watermarks.end();
+	for (; wi != we; ++wi)
+	{
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		Serializer::serializeWithName( &rt.serialization, "source", wi->first, true/*deep*/);
+		Serializer::serializeWithName( &rt.serialization, "timestamp", wi->second, true/*deep*/);
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
 }
 
 GlobalCounter StatisticsMapImpl::nofDocuments()
 {
+	if (m_shardmap_impl.get())
+	{
+		const StatisticsShardMap* THIS = m_shardmap_impl.getObject<const StatisticsShardMap>();
+		return THIS->nofDocuments();
+	}
 	StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
 	return THIS->nofDocuments();
 }
 
 GlobalCounter StatisticsMapImpl::df( const std::string& termtype, const std::string& termvalue)
 {
+	if (m_shardmap_impl.get())
+	{
+		const StatisticsShardMap* THIS = m_shardmap_impl.getObject<const StatisticsShardMap>();
+		return THIS->df( termtype, termvalue);
+	}
 	StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
 	return THIS->df( termtype, termvalue);
 }
 
+void StatisticsMapImpl::getDfList( std::vector<GlobalCounter>& dfar, const std::vector<std::pair<std::string,std::string> >& termlist)
+{
+	if (m_shardmap_impl.get())
+	{
+		const StatisticsShardMap* THIS = m_shardmap_impl.getObject<const StatisticsShardMap>();
+		THIS->dfList( dfar, termlist);
+	}
+	else
+	{
+		// ... a statistics map without shards has only a lookup per term, the distinct terms are looked up once in ascending order
+		typedef std::pair<std::string,std::string> TermKey;
+		std::vector<std::pair<TermKey,std::size_t> > sorted;
+		sorted.reserve( termlist.size());
+		std::vector<TermKey>::const_iterator ti = termlist.begin(), te = termlist.end();
+		for (std::size_t tidx=0; ti != te; ++ti,++tidx)
+		{
+			sorted.push_back( std::pair<TermKey,std::size_t>( *ti, tidx));
+		}
+		std::sort( sorted.begin(), sorted.end());
+
+		StatisticsMapInterface* THIS = m_statmap_impl.getObject<StatisticsMapInterface>();
+		dfar.assign( termlist.size(), 0);
+		std::vector<std::pair<TermKey,std::size_t> >::const_iterator si = sorted.begin(), se = sorted.end();
+		while (si != se)
+		{
+			GlobalCounter dfval = THIS->df( si->first.first, si->first.second);
+			std::vector<std::pair<TermKey,std::size_t> >::const_iterator sn = si;
+			for (; sn != se && sn->first == si->first; ++sn)
+			{
+				dfar[ sn->second] = dfval;
+			}
+			si = sn;
+		}
+	}
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT( "failed to get document frequencies of term list: %s"), errorhnd->fetchError());
+	}
+}
+
+Struct StatisticsMapImpl::dfArray( const ValueVariant& terms)
+{
+	std::vector<std::pair<std::string,std::string> > termlist = Deserializer::getTermKeyList( terms);
+	std::vector<GlobalCounter> dfar;
+	getDfList( dfar, termlist);
+
+	Struct rt;
+	bool sc = true;
+	std::vector<GlobalCounter>::const_iterator di = dfar.begin(), de = dfar.end();
+	for (; di != de; ++di)
+	{
+		sc &= papuga_Serialization_pushValue_int( &rt.serialization, *di);
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
+Struct StatisticsMapImpl::dfList( const ValueVariant& terms)
+{
+	typedef std::pair<std::string,std::string> TermKey;
+	std::vector<TermKey> termlist = Deserializer::getTermKeyList( terms);
+	std::vector<GlobalCounter> dfar;
+	getDfList( dfar, termlist);
+
+	Struct rt;
+	bool sc = true;
+	std::set<TermKey> visited;
+	std::vector<TermKey>::const_iterator ti = termlist.begin(), te = termlist.end();
+	for (std::size_t tidx=0; ti != te; ++ti,++tidx)
+	{
+		if (!visited.insert( *ti).second) continue;
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		Serializer::serializeWithName( &rt.serialization, "type", ti->first, true/*deep*/);
+		Serializer::serializeWithName( &rt.serialization, "value", ti->second, true/*deep*/);
+		Serializer::serializeWithName( &rt.serialization, "df", dfar[ tidx], true/*deep*/);
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
+void StatisticsMapImpl::changed()
+{
+	strus::scoped_lock lock( m_epoch_mutex);
+	++m_nofPendingChanges;
+	advanceVersionIfDue();
+}
+
+void StatisticsMapImpl::advanceVersionIfDue() const
+{
+	if (!m_nofPendingChanges) return;
+	std::time_t now = std::time(0);
+	if (now < m_epochTime + (std::time_t)m_epochPeriod) return;
+	m_version.increment();
+	m_nofPendingChanges = 0;
+	m_epochTime = now;
+}
+
+GlobalCounter StatisticsMapImpl::version() const
+{
+	strus::scoped_lock lock( m_epoch_mutex);
+	// ... changes propagated after the last increment are reflected in the version as soon as the epoch has elapsed, even without further changes
+	advanceVersionIfDue();
+	return m_version.value();
+}
+
 Struct StatisticsMapImpl::introspection( const ValueVariant& arg) const
 {
 	Struct rt;
@@ -87,9 +532,205 @@ Struct StatisticsMapImpl::introspection( const ValueVariant& arg) const
 		path = Deserializer::getStringList( arg);
 	}
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
-	const StatisticsMapInterface* THIS = m_statmap_impl.getObject<const StatisticsMapInterface>();
+	IntrospectionBase* ictxptr;
+	if (m_shardmap_impl.get())
+	{
+		const StatisticsShardMap* THIS = m_shardmap_impl.getObject<const StatisticsShardMap>();
+		StructView shardlist;
+		std::size_t nofTerms = 0;
+		std::size_t memorySize = 0;
+		GlobalCounter sketchErrorBound = 0;
+		std::vector<StatisticsShardMap::ShardInfo> shardinfo = THIS->shardInfo();
+		std::vector<StatisticsShardMap::ShardInfo>::const_iterator si = shardinfo.begin(), se = shardinfo.end();
+		for (; si != se; ++si)
+		{
+			shardlist( StructView()
+				( "base", (int)si->baseSize)
+				( "delta", (int)si->deltaSize)
+				( "bytes", (GlobalCounter)si->memorySize));
+			nofTerms += si->baseSize + si->deltaSize;
+			memorySize += si->memorySize;
+			if (si->sketchErrorBound > sketchErrorBound) sketchErrorBound = si->sketchErrorBound;
+		}
+		StructView view;
+		view
+			( "dict", std::string( THIS->compact() ? "compact" : "map"))
+			( "nofdocs", THIS->nofDocuments())
+			( "version", m_version.value())
+			( "bytes", (GlobalCounter)memorySize)
+			( "bytesperterm", (GlobalCounter)(nofTerms ? (memorySize + nofTerms/2) / nofTerms : 0))
+			( "shard", shardlist);
+		if (THIS->sketchWidth())
+		{
+			// ... the df of terms not counted exactly exceeds the real df by at most the error bound with the confidence stated (1-exp(-depth))
+			view( "sketch", StructView()
+				( "width", (GlobalCounter)THIS->sketchWidth() * THIS->nofShards())
+				( "depth", (int)THIS->sketchDepth())
+				( "exactdf", THIS->exactDfThreshold())
+				( "errorbound", sketchErrorBound)
+				( "confidence", (int)((1.0 - std::exp( -(double)THIS->sketchDepth())) * 100)));
+		}
+		ictxptr = new StructViewIntrospection( errorhnd, view);
+	}
+	else
+	{
+		const StatisticsMapInterface* THIS = m_statmap_impl.getObject<const StatisticsMapInterface>();
+		ictxptr = new StatisticsMapIntrospection( errorhnd, THIS);
+	}
+	strus::local_ptr<IntrospectionBase> ictx( ictxptr);
+	ictx->getPathContent( rt.serialization, path, false/*substructure*/);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT( "failed to serialize introspection: %s"), errorhnd->fetchError());
+	}
+	rt.release();
+	return rt;
+}
+
+StatisticsCacheImpl::StatisticsCacheImpl( const ObjectRef& trace, const ObjectRef& errorhnd_, const std::string& config)
+	:m_errorhnd_impl(errorhnd_)
+	,m_trace_impl(trace)
+	,m_mutex()
+	,m_termMap()
+	,m_lru()
+	,m_nofdocs(0)
+	,m_version(0)
+	,m_timestamp(0)
+	,m_timeToLive(60)
+	,m_maxSize(1000000)
+	,m_updateCount(0)
+	,m_globalUpdateCount(0)
+	,m_versionUpdateCount(0)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	std::string configstr = config;
+	(void)extractUIntFromConfigString( m_timeToLive, configstr, "ttl", errorhnd);
+	(void)extractUIntFromConfigString( m_maxSize, configstr, "size", errorhnd);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to create statistics cache: %s"), errorhnd->fetchError());
+	}
+	if (!configstr.empty())
+	{
+		throw strus::runtime_error( _TXT("unknown configuration parameters for statistics cache: %s"), configstr.c_str());
+	}
+}
 
-	strus::local_ptr<IntrospectionBase> ictx( new StatisticsMapIntrospection( errorhnd, THIS));
+void StatisticsCacheImpl::defineTermStatistics( const std::string& type, const std::string& value, const GlobalCounter& df)
+{
+	strus::scoped_lock lock( m_mutex);
+	Key key( type, value);
+	std::time_t now = std::time(0);
+	TermMap::iterator ti = m_termMap.find( key);
+	if (ti != m_termMap.end())
+	{
+		m_lru.splice( m_lru.begin(), m_lru, ti->second.lru);
+		ti->second.df = df;
+		ti->second.timestamp = now;
+		ti->second.updateCount = ++m_updateCount;
+		return;
+	}
+	while (!m_lru.empty() && m_termMap.size() >= m_maxSize)
+	{
+		// ... evict the least recently used entry
+		m_termMap.erase( m_lru.back());
+		m_lru.pop_back();
+	}
+	m_lru.push_front( key);
+	m_termMap.insert( TermMap::value_type( key, Entry( df, now, ++m_updateCount, m_lru.begin())));
+}
+
+void StatisticsCacheImpl::defineGlobalStatistics( const GlobalCounter& nofdocs, const GlobalCounter& version)
+{
+	strus::scoped_lock lock( m_mutex);
+	if (version != m_version)
+	{
+		// ... entries defined before the term statistics of this response, that is up to the last definition of the global statistics, are outdated
+		m_version = version;
+		m_versionUpdateCount = m_globalUpdateCount;
+	}
+	m_globalUpdateCount = m_updateCount;
+	m_nofdocs = nofdocs;
+	m_timestamp = std::time(0);
+}
+
+Struct StatisticsCacheImpl::getGlobalStatistics() const
+{
+	Struct rt;
+	strus::scoped_lock lock( m_mutex);
+	Serializer::serializeWithName( &rt.serialization, "nofdocs", m_nofdocs, true/*deep*/);
+	rt.release();
+	return rt;
+}
+
+void StatisticsCacheImpl::clear()
+{
+	strus::scoped_lock lock( m_mutex);
+	m_termMap.clear();
+	m_lru.clear();
+	m_nofdocs = 0;
+	m_version = 0;
+	m_timestamp = 0;
+	m_versionUpdateCount = m_updateCount;
+	m_globalUpdateCount = m_updateCount;
+}
+
+bool StatisticsCacheImpl::getDf( GlobalCounter& df, const std::string& type, const std::string& value, bool valid) const
+{
+	strus::scoped_lock lock( m_mutex);
+	TermMap::const_iterator ti = m_termMap.find( Key( type, value));
+	if (ti == m_termMap.end()) return false;
+	if (valid)
+	{
+		if (!m_timestamp || ti->second.updateCount <= m_versionUpdateCount) return false;
+		if (ti->second.timestamp + (std::time_t)m_timeToLive < std::time(0)) return false;
+	}
+	m_lru.splice( m_lru.begin(), m_lru, ti->second.lru);
+	df = ti->second.df;
+	return true;
+}
+
+bool StatisticsCacheImpl::getDfUpdatedSince( GlobalCounter& df, const std::string& type, const std::string& value, const GlobalCounter& updateCount) const
+{
+	strus::scoped_lock lock( m_mutex);
+	TermMap::const_iterator ti = m_termMap.find( Key( type, value));
+	if (ti == m_termMap.end() || ti->second.updateCount <= updateCount) return false;
+	df = ti->second.df;
+	return true;
+}
+
+GlobalCounter StatisticsCacheImpl::updateCount() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_updateCount;
+}
+
+bool StatisticsCacheImpl::globalStatisticsValid() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_timestamp && m_timestamp + (std::time_t)m_timeToLive >= std::time(0);
+}
+
+Struct StatisticsCacheImpl::introspection( const ValueVariant& arg) const
+{
+	Struct rt;
+	std::vector<std::string> path;
+	if (papuga_ValueVariant_defined( &arg))
+	{
+		path = Deserializer::getStringList( arg);
+	}
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	StructView view;
+	{
+		strus::scoped_lock lock( m_mutex);
+		view
+			( "ttl", (int)m_timeToLive)
+			( "size", (int)m_maxSize)
+			( "nofterms", (int)m_termMap.size())
+			( "nofdocs", m_nofdocs)
+			( "version", m_version);
+	}
+	strus::local_ptr<IntrospectionBase> ictx( new StructViewIntrospection( errorhnd, view));
 	ictx->getPathContent( rt.serialization, path, false/*substructure*/);
 	if (errorhnd->hasError())
 	{
@@ -99,4 +740,114 @@ Struct StatisticsMapImpl::introspection( const ValueVariant& arg) const
 	return rt;
 }
 
+ShardSelectorImpl::ShardSelectorImpl( const ObjectRef& trace, const ObjectRef& errorhnd_, const std::string& config)
+	:m_errorhnd_impl(errorhnd_)
+	,m_trace_impl(trace)
+	,m_mutex()
+	,m_summaryMap()
+	,m_version(0)
+	,m_selectFeatureSets()
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	std::string configstr = config;
+	std::string selectstr;
+	if (extractStringFromConfigString( selectstr, configstr, "select", errorhnd))
+	{
+		char const* si = selectstr.c_str();
+		while (*si)
+		{
+			for (; *si && ((unsigned char)*si <= 32 || *si == ','); ++si){}
+			char const* start = si;
+			for (; *si && (unsigned char)*si > 32 && *si != ','; ++si){}
+			if (si > start) m_selectFeatureSets.insert( std::string( start, si-start));
+		}
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to create shard selector: %s"), errorhnd->fetchError());
+	}
+	if (!configstr.empty())
+	{
+		throw strus::runtime_error( _TXT("unknown configuration parameters for shard selector: %s"), configstr.c_str());
+	}
+}
+
+void ShardSelectorImpl::defineShardSummary( const std::string& server, const std::string& summary)
+{
+	TermSummary termSummary( summary);
+	strus::scoped_lock lock( m_mutex);
+	SummaryMap::iterator si = m_summaryMap.find( server);
+	if (si == m_summaryMap.end())
+	{
+		m_summaryMap.insert( SummaryMap::value_type( server, ShardSummary( termSummary, m_version)));
+	}
+	else
+	{
+		si->second.summary = termSummary;
+		si->second.version = m_version;
+	}
+}
+
+void ShardSelectorImpl::defineStatisticsVersion( const GlobalCounter& version)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_version = version;
+}
+
+void ShardSelectorImpl::removeShardSummary( const std::string& server)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_summaryMap.erase( server);
+}
+
+bool ShardSelectorImpl::mayContain( const std::string& server, const std::string& type, const std::string& value) const
+{
+	strus::scoped_lock lock( m_mutex);
+	SummaryMap::const_iterator si = m_summaryMap.find( server);
+	if (si == m_summaryMap.end() || si->second.version != m_version) return true;
+	return si->second.summary.mayContain( type, value);
+}
+
+Struct ShardSelectorImpl::introspection( const ValueVariant& arg) const
+{
+	Struct rt;
+	std::vector<std::string> path;
+	if (papuga_ValueVariant_defined( &arg))
+	{
+		path = Deserializer::getStringList( arg);
+	}
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	StructView view;
+	{
+		strus::scoped_lock lock( m_mutex);
+		StructView shardlist;
+		SummaryMap::const_iterator si = m_summaryMap.begin(), se = m_summaryMap.end();
+		for (; si != se; ++si)
+		{
+			shardlist( StructView()
+				( "server", si->first)
+				( "bits", (int)si->second.summary.nofBits())
+				( "hashes", (int)si->second.summary.nofHashes())
+				( "nofterms", (int)si->second.summary.nofTerms())
+				( "outdated", si->second.version != m_version ? "true" : "false"));
+		}
+		StructView selectlist;
+		std::set<std::string>::const_iterator fi = m_selectFeatureSets.begin(), fe = m_selectFeatureSets.end();
+		for (; fi != fe; ++fi)
+		{
+			selectlist( *fi);
+		}
+		view
+			( "select", selectlist)
+			( "shard", shardlist);
+	}
+	strus::local_ptr<IntrospectionBase> ictx( new StructViewIntrospection( errorhnd, view));
+	ictx->getPathContent( rt.serialization, path, false/*substructure*/);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error(_TXT( "failed to serialize introspection: %s"), errorhnd->fetchError());
+	}
+	rt.release();
+	return rt;
+}
 
@@ -9,9 +9,20 @@
 #define _STRUS_BINDING_IMPL_STATISTICS_HPP_INCLUDED
 #include "papuga/valueVariant.h"
 #include "strus/storage/index.hpp"
+#include "strus/timeStamp.hpp"
+#include "strus/storage/statisticsMessage.hpp"
 #include "impl/value/objectref.hpp"
 #include "impl/value/struct.hpp"
+#include "impl/value/termSummary.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
 #include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <set>
+#include <utility>
+#include <ctime>
 
 namespace strus {
 
@@ -45,6 +56,28 @@ public:
 	/// \param[in] blob buffer containing the message blob or a statistics message structure with timestamp
 	void processStatisticsMessage( const ValueVariant& blob);
 
+	/// \brief Propagate the changes in statistics of a storage not propagated yet (see StorageClient::getStatisticsChanges)
+	/// \param[in] source identifier of the storage the changes come from
+	/// \example "node1/test"
+	/// \param[in] messages list of statistics message structures with timestamp, messages with a timestamp not newer than the watermark of the source are ignored
+	/// \param[in] watermark timestamp of the latest change of the source contained in the snapshot passed, defined if and only if a snapshot is passed
+	/// \example [ unixtime: 1577836800 counter: 12 ]
+	/// \param[in] snapshot list of statistics message structures with the complete statistics of the source up to the watermark
+	/// \note The watermark of the source is moved to the timestamp of the last message processed respectively to the watermark passed, it is only moved forward
+	/// \note With a snapshot the messages are ignored. A snapshot not newer than the watermark of the source is ignored too. Messages of a source without watermark are ignored, the statistics of a source are accepted first with a snapshot
+	/// \note A snapshot of a source that has already contributed statistics (the storage could not deliver the changes since the watermark anymore) cannot be separated from the statistics of the other sources.
+	///	In this case all statistics and watermarks are dropped and the other sources are accepted again with their next snapshot. This is only possible for a map configured with shards
+	void processStatisticsChanges( const std::string& source, const ValueVariant& messages, const ValueVariant& watermark=ValueVariant(), const ValueVariant& snapshot=ValueVariant());
+
+	/// \brief Store a snapshot of the map with the watermarks of all sources to the file configured (config variable 'snapshot')
+	/// \note A statistics map configured with a snapshot file is loaded from it on creation, the sources have then only to propagate the changes since their watermark
+	/// \note Snapshots are stored automatically after processing statistics changes if the period configured in seconds (config variable 'snapshotperiod') has elapsed
+	void storeSnapshot();
+
+	/// \brief Get the watermarks of all sources, passed to the storages to get the statistics changes not propagated yet (see StorageClient::getStatisticsChanges)
+	/// \return list of structures with the source identifier (source) and the timestamp of its latest change propagated (timestamp)
+	Struct watermarks() const;
+
 	/// \brief Get the total number of documents stored in the map
 	/// \return the number of documents in the collection
 	GlobalCounter nofDocuments();
@@ -55,6 +88,29 @@ public:
 	/// \return the document frequency
 	GlobalCounter df( const std::string& type, const std::string& value);
 
+	/// \brief Get the df (document frequency) of a list of terms with one call
+	/// \note The terms are looked up in one pass over the shards of the map, each distinct term once
+	/// \param[in] terms list of terms as structures with type and value or as pairs [type,value]
+	/// \example [ [type: "word" value: "country"] [type: "word" value: "city"] [type: "word" value: "country"] ]
+	/// \example [ ["word" "country"] ["word" "city"] ["word" "country"] ]
+	/// \return flat list of the document frequencies indexed like the terms passed, duplicates included, 0 for unknown terms
+	/// \example [ 312367 9823 312367 ]
+	Struct dfArray( const ValueVariant& terms);
+
+	/// \brief Get the df (document frequency) of a list of terms with one call, as needed for defining the term statistics of a query
+	/// \note The terms are looked up like with 'dfArray'
+	/// \param[in] terms list of terms as structures with type and value or as pairs [type,value]
+	/// \example [ [type: "word" value: "country"] [type: "word" value: "city"] ]
+	/// \example [ ["word" "country"] ["word" "city"] ]
+	/// \return list of the distinct terms with their document frequency as structures [type: "word" value: "country" df: 312367] in the order of their first occurrence
+	Struct dfList( const ValueVariant& terms);
+
+	/// \brief Get the version stamp of the statistics, that is incremented at most once per epoch (config variable 'epoch' in seconds, default 10) if changes have been propagated to this map
+	/// \note The version stamp is used by clients caching statistics to detect if the values in their cache are outdated.
+	///	The epoch bounds the time the cached values may be outdated without invalidating the caches with every change during ingestion
+	/// \return the version stamp
+	GlobalCounter version() const;
+
 	/// \brief Introspect a structure starting from a root path
 	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
 	/// \return the structure to introspect starting from the path
@@ -65,11 +121,211 @@ private:
 	friend class ContextImpl;
 	StatisticsMapImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd, const std::string& statsprocname);
 
+	/// \brief Apply a statistics message to the map
+	void feedStatisticsMessage( const StatisticsMessage& msg);
+	/// \brief Store a snapshot if snapshots are configured and the snapshot period has elapsed
+	void storeSnapshotIfDue();
+	/// \brief Load the content of the map and the watermarks from the snapshot file configured
+	void loadSnapshot();
+	/// \brief Get the df of a list of terms, indexed like the terms passed
+	void getDfList( std::vector<GlobalCounter>& dfar, const std::vector<std::pair<std::string,std::string> >& termlist);
+	/// \brief Drop all statistics and watermarks, called with m_watermarks_mutex locked
+	void resetStatistics();
+	/// \brief Count a change propagated to the map for the version stamp
+	void changed();
+	/// \brief Increment the version stamp if there are changes not reflected in it and the epoch has elapsed, called with m_epoch_mutex locked
+	void advanceVersionIfDue() const;
+
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
-	ObjectRef m_statmap_impl;
+	ObjectRef m_statmap_impl;		// statistics map of the statistics processor, if not configured with shards
+	ObjectRef m_shardmap_impl;		// statistics map partitioned by term hash, if configured with shards
 	const StatisticsProcessorInterface* m_statsproc;
+	mutable strus::AtomicCounter<GlobalCounter> m_version;
+	mutable strus::mutex m_epoch_mutex;		// mutex for advancing the version stamp
+	mutable GlobalCounter m_nofPendingChanges;	// number of changes not reflected in the version stamp yet
+	mutable std::time_t m_epochTime;		// time the version stamp was incremented the last time
+	unsigned int m_epochPeriod;			// minimum period between two increments of the version stamp in seconds
+	std::map<std::string,TimeStamp> m_watermarks;
+	std::set<std::string> m_contributingSources;	// sources that have contributed statistics since the map has been empty
+	mutable strus::mutex m_watermarks_mutex;
+	std::string m_snapshotPath;		// path of the snapshot file, empty if not configured
+	unsigned int m_snapshotPeriod;		// minimum period between automatic snapshots in seconds, 0 if snapshots are only stored explicitly
+	std::time_t m_snapshotTime;		// time of the last snapshot stored
+	strus::mutex m_snapshot_mutex;		// mutex for writing the snapshot file
+};
+
+
+/// \class StatisticsCacheImpl
+/// \brief Cache for global statistics retrieved from a statistics server, used by a coordinator of a distributed query evaluation
+/// \note Entries are valid until their time to live expires or until the statistics server reports a different version stamp of its statistics.
+///	If the maximum size is reached, the least recently used entries are evicted, these are usually the expired ones
+/// \note The global statistics with the version stamp are valid until their time to live expires. While they are valid and all terms of a query have valid entries, the statistics server is not asked (see QueryBuilder::selectStatisticsServers)
+/// \remark The only way to construct a statistics cache object is to call Context::createStatisticsCache()
+class StatisticsCacheImpl
+{
+public:
+	/// \brief Destructor
+	virtual ~StatisticsCacheImpl(){}
+
+	/// \brief Define the df (document frequency) of a term retrieved from the statistics server
+	/// \param[in] type type of the term
+	/// \example "word"
+	/// \param[in] value value of the term
+	/// \example "country"
+	/// \param[in] df the document frequency
+	/// \example 312367
+	void defineTermStatistics( const std::string& type, const std::string& value, const GlobalCounter& df);
+
+	/// \brief Define the global statistics retrieved from the statistics server
+	/// \param[in] nofdocs the total number of documents in the collection
+	/// \example 112739087
+	/// \param[in] version version stamp of the statistics (see StatisticsMap::version), all cached entries with a different version stamp are invalidated
+	/// \example 3321
+	/// \note The term statistics of a statistics server response are defined before its global statistics. On a version change all entries defined before the term statistics of the response are invalidated
+	void defineGlobalStatistics( const GlobalCounter& nofdocs, const GlobalCounter& version=0);
+
+	/// \brief Get the cached global statistics
+	/// \return the global statistics as structure [nofdocs: 112739087]
+	Struct getGlobalStatistics() const;
+
+	/// \brief Remove all entries from the cache
+	void clear();
+
+	/// \brief Introspect a structure starting from a root path
+	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
+	/// \return the structure to introspect starting from the path
+	Struct introspection( const ValueVariant& path=ValueVariant()) const;
+
+private:
+	/// \brief Constructor used by Context
+	friend class ContextImpl;
+	friend class QueryBuilderImpl;
+	StatisticsCacheImpl( const ObjectRef& trace, const ObjectRef& errorhnd, const std::string& config);
+
+	/// \brief Get the df of a term, if it is in the cache
+	/// \param[out] df the document frequency of the term
+	/// \param[in] type type of the term
+	/// \param[in] value value of the term
+	/// \param[in] valid true if only entries are accepted that are not expired
+	bool getDf( GlobalCounter& df, const std::string& type, const std::string& value, bool valid) const;
+	/// \brief Get the df of a term, if it has been defined after the update counter had a specific value
+	/// \param[out] df the document frequency of the term
+	/// \param[in] type type of the term
+	/// \param[in] value value of the term
+	/// \param[in] updateCount value of the update counter (see 'updateCount()')
+	bool getDfUpdatedSince( GlobalCounter& df, const std::string& type, const std::string& value, const GlobalCounter& updateCount) const;
+	/// \brief Get the counter incremented with every term statistics defined
+	GlobalCounter updateCount() const;
+	/// \brief Evaluate if the global statistics are defined and their time to live has not expired
+	bool globalStatisticsValid() const;
+
+	typedef std::pair<std::string,std::string> Key;
+	typedef std::list<Key> LruList;
+
+	struct Entry
+	{
+		GlobalCounter df;
+		std::time_t timestamp;
+		GlobalCounter updateCount;
+		LruList::iterator lru;		// position of the key in the list of keys ordered by their last use
+
+		Entry()
+			:df(0),timestamp(0),updateCount(0),lru(){}
+		Entry( GlobalCounter df_, std::time_t timestamp_, GlobalCounter updateCount_, LruList::iterator lru_)
+			:df(df_),timestamp(timestamp_),updateCount(updateCount_),lru(lru_){}
+		Entry( const Entry& o)
+			:df(o.df),timestamp(o.timestamp),updateCount(o.updateCount),lru(o.lru){}
+	};
+	typedef std::map<Key,Entry> TermMap;
+
+	mutable ObjectRef m_errorhnd_impl;
+	ObjectRef m_trace_impl;
+	mutable strus::mutex m_mutex;
+	TermMap m_termMap;
+	mutable LruList m_lru;			// keys of the entries, the most recently used first
+	GlobalCounter m_nofdocs;
+	GlobalCounter m_version;
+	std::time_t m_timestamp;
+	unsigned int m_timeToLive;
+	unsigned int m_maxSize;
+	GlobalCounter m_updateCount;
+	GlobalCounter m_globalUpdateCount;	// value of the update counter when the global statistics were defined the last time
+	GlobalCounter m_versionUpdateCount;	// entries with an update counter value not bigger than this are outdated by a version change
+};
+
+
+/// \class ShardSelectorImpl
+/// \brief Selector of the storage shards of a distributed query evaluation, that possibly contain documents matching a query
+/// \note Uses compact summaries of the terms contained in a storage shard (see StorageClient::termSummary) to skip shards that cannot contain any selecting feature of a query
+/// \remark The only way to construct a shard selector object is to call Context::createShardSelector()
+class ShardSelectorImpl
+{
+public:
+	/// \brief Destructor
+	virtual ~ShardSelectorImpl(){}
+
+	/// \brief Define the summary of the terms contained in a shard
+	/// \param[in] server address of the server of the shard, as used in the server list of the coordinator
+	/// \example "example.com:7184/qryeval/test"
+	/// \param[in] summary summary of the terms as returned by StorageClient::termSummary
+	void defineShardSummary( const std::string& server, const std::string& summary);
+
+	/// \brief Define the version of the collection statistics, as retrieved from the statistics server
+	/// \param[in] version version stamp of the statistics (see StatisticsMap::version)
+	/// \example 3321
+	/// \note A version change means that documents have been inserted or deleted in some shard. The summaries defined before are outdated then and not used anymore, the shards are always selected until their summaries rebuilt after the change (see StorageClient::termSummary) are defined
+	void defineStatisticsVersion( const GlobalCounter& version=0);
+
+	/// \brief Remove the summary of a shard, the shard is always selected afterwards
+	/// \param[in] server address of the server of the shard
+	/// \example "example.com:7184/qryeval/test"
+	void removeShardSummary( const std::string& server);
+
+	/// \brief Introspect a structure starting from a root path
+	/// \param[in] path list of idenfifiers describing the access path to the element to introspect
+	/// \return the structure to introspect starting from the path
+	Struct introspection( const ValueVariant& path=ValueVariant()) const;
+
+private:
+	/// \brief Constructor used by Context
+	friend class ContextImpl;
+	friend class QueryBuilderImpl;
+	ShardSelectorImpl( const ObjectRef& trace, const ObjectRef& errorhnd, const std::string& config);
+
+	/// \brief Test if a shard possibly contains a term
+	/// \param[in] server address of the server of the shard
+	/// \param[in] type type of the term
+	/// \param[in] value value of the term
+	/// \return true if the shard has no summary defined, if its summary is outdated by a statistics version change or if the term is possibly contained in the shard
+	bool mayContain( const std::string& server, const std::string& type, const std::string& value) const;
+
+	/// \brief Get the names of the feature sets used for document selection
+	/// \return the set of names, empty if all features are considered
+	const std::set<std::string>& selectFeatureSets() const
+	{
+		return m_selectFeatureSets;
+	}
+
+	struct ShardSummary
+	{
+		TermSummary summary;
+		GlobalCounter version;		// statistics version defined when the summary was defined
+
+		ShardSummary( const TermSummary& summary_, const GlobalCounter& version_)
+			:summary(summary_),version(version_){}
+		ShardSummary( const ShardSummary& o)
+			:summary(o.summary),version(o.version){}
+	};
+	typedef std::map<std::string,ShardSummary> SummaryMap;
+
+	mutable ObjectRef m_errorhnd_impl;
+	ObjectRef m_trace_impl;
+	mutable strus::mutex m_mutex;
+	SummaryMap m_summaryMap;
+	GlobalCounter m_version;
+	std::set<std::string> m_selectFeatureSets;
 };
 
 }}//namespace
@@ -9,10 +9,18 @@
 #include "impl/value/postingIterator.hpp"
 #include "impl/value/valueIterator.hpp"
 #include "impl/value/selectIterator.hpp"
+#include "impl/value/parallelSelectIterator.hpp"
+#include "impl/value/metaDataZoneMap.hpp"
+#include "impl/value/metaDataColumnIterator.hpp"
 #include "impl/value/statisticsIterator.hpp"
 #include "impl/value/forwardTermsIterator.hpp"
 #include "impl/value/searchTermsIterator.hpp"
 #include "impl/value/storageIntrospection.hpp"
+#include "impl/value/termSummary.hpp"
+#include "impl/value/documentExport.hpp"
+#include "impl/value/groupCommit.hpp"
+#include "impl/value/asyncCommit.hpp"
+#include "impl/value/workerThreadSlots.hpp"
 #include "strus/lib/storage_objbuild.hpp"
 #include "strus/storageClientInterface.hpp"
 #include "strus/storageTransactionInterface.hpp"
@@ -28,6 +36,9 @@
 #include "strus/metaDataRestrictionInstanceInterface.hpp"
 #include "strus/valueIteratorInterface.hpp"
 #include "strus/forwardIteratorInterface.hpp"
+#include "strus/statisticsIteratorInterface.hpp"
+#include "strus/statisticsProcessorInterface.hpp"
+#include "strus/statisticsViewerInterface.hpp"
 #include "strus/base/configParser.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/string_format.hpp"
@@ -40,24 +51,44 @@
 #include "structDefs.hpp"
 #include "serializer.hpp"
 #include "callResultUtils.hpp"
+#include <algorithm>
 
 using namespace strus;
 using namespace strus::bindings;
 
-StorageClientImpl::StorageClientImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd_, const std::string& config_)
+StorageClientImpl::StorageClientImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const std::string& config_)
 	:m_errorhnd_impl(errorhnd_)
 	,m_trace_impl( trace)
 	,m_objbuilder_impl( objbuilder)
+	,m_workerslots_impl( workerslots_)
 	,m_storage_impl()
+	,m_zonemap_impl()
+	,m_groupcommit_impl()
+	,m_termsummary_impl()
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
 
-	m_storage_impl.resetOwnership( createStorageClient( objBuilder, errorhnd, config_), "StorageClient");
+	// ... the group commit window is a parameter of the bindings and not passed to the storage
+	std::string configstr = config_;
+	unsigned int groupcommit = 0;
+	(void)extractUIntFromConfigString( groupcommit, configstr, "groupcommit", errorhnd);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to parse group commit window in storage configuration: %s"), errorhnd->fetchError());
+	}
+	m_storage_impl.resetOwnership( createStorageClient( objBuilder, errorhnd, configstr), "StorageClient");
 	if (!m_storage_impl.get())
 	{
 		throw strus::runtime_error( "%s", errorhnd->fetchError());
 	}
+	m_zonemap_impl.resetOwnership( new MetaDataZoneMap(), "MetaDataZoneMap");
+	m_termsummary_impl.resetOwnership( new TermSummaryCache(), "TermSummaryCache");
+	if (groupcommit)
+	{
+		StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
+		m_groupcommit_impl.resetOwnership( new GroupCommitQueue( storage, errorhnd, groupcommit), "GroupCommitQueue");
+	}
 }
 
 StorageClientImpl::~StorageClientImpl()
@@ -96,6 +127,45 @@ Index StorageClientImpl::documentNumber( const std::string& docid_) const
 	return THIS->documentNumber( docid_);
 }
 
+Struct StorageClientImpl::documentNumbers( const ValueVariant& docids_) const
+{
+	const StorageClientInterface* THIS = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!THIS) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	std::vector<std::string> docids = Deserializer::getStringList( docids_);
+
+	// ... look up the identifiers in ascending order for locality of the key lookups
+	std::vector<std::pair<std::string,std::size_t> > sorted;
+	sorted.reserve( docids.size());
+	std::vector<std::string>::const_iterator di = docids.begin(), de = docids.end();
+	for (std::size_t didx=0; di != de; ++di,++didx)
+	{
+		sorted.push_back( std::pair<std::string,std::size_t>( *di, didx));
+	}
+	std::sort( sorted.begin(), sorted.end());
+
+	std::vector<Index> docnos( docids.size(), 0);
+	std::vector<std::pair<std::string,std::size_t> >::const_iterator si = sorted.begin(), se = sorted.end();
+	for (; si != se; ++si)
+	{
+		docnos[ si->second] = THIS->documentNumber( si->first);
+	}
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to get document numbers of document identifiers: %s"), errorhnd->fetchError());
+	}
+	Struct rt;
+	bool sc = true;
+	std::vector<Index>::const_iterator ni = docnos.begin(), ne = docnos.end();
+	for (; ni != ne; ++ni)
+	{
+		sc &= papuga_Serialization_pushValue_int( &rt.serialization, *ni);
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
 Iterator StorageClientImpl::documentForwardIndexTerms( const Index& docno, const std::string& termtype, const Index& pos) const
 {
 	Reference<ForwardTermsIterator> itr( new ForwardTermsIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, termtype, docno, pos));
@@ -105,6 +175,91 @@ Iterator StorageClientImpl::documentForwardIndexTerms( const Index& docno, const
 	return rt;
 }
 
+Struct StorageClientImpl::documentsForwardIndexTerms( const ValueVariant& docnos_, const ValueVariant& termtypes_) const
+{
+	const StorageClientInterface* THIS = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!THIS) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+
+	std::vector<Index> docnos = Deserializer::getIndexList( docnos_);
+	std::sort( docnos.begin(), docnos.end());
+	docnos.erase( std::unique( docnos.begin(), docnos.end()), docnos.end());
+	while (!docnos.empty() && docnos[0] <= 0) docnos.erase( docnos.begin());
+	std::vector<std::string> termtypes = Deserializer::getStringList( termtypes_);
+
+	Struct rt;
+	bool sc = true;
+	sc &= papuga_Serialization_pushName_charp( &rt.serialization, "docno");
+	sc &= papuga_Serialization_pushOpen( &rt.serialization);
+	std::vector<Index>::const_iterator di = docnos.begin(), de = docnos.end();
+	for (; di != de; ++di)
+	{
+		sc &= papuga_Serialization_pushValue_int( &rt.serialization, *di);
+	}
+	sc &= papuga_Serialization_pushClose( &rt.serialization);
+	sc &= papuga_Serialization_pushName_charp( &rt.serialization, "type");
+	sc &= papuga_Serialization_pushOpen( &rt.serialization);
+
+	std::vector<std::string>::const_iterator ti = termtypes.begin(), te = termtypes.end();
+	for (; ti != te; ++ti)
+	{
+		strus::local_ptr<ForwardIteratorInterface> fitr( THIS->createForwardIterator( *ti));
+		if (!fitr.get()) throw strus::runtime_error( _TXT("failed to create forward iterator for type '%s': %s"), ti->c_str(), errorhnd->fetchError());
+
+		std::vector<Index> offsets;
+		std::vector<Index> positions;
+		std::vector<std::string> values;
+		offsets.reserve( docnos.size()+1);
+		for (di = docnos.begin(); di != de; ++di)
+		{
+			offsets.push_back( positions.size());
+			fitr->skipDoc( *di);
+			Index pos = 0;
+			while (0!=(pos=fitr->skipPos( pos+1)))
+			{
+				positions.push_back( pos);
+				values.push_back( fitr->fetch());
+			}
+		}
+		offsets.push_back( positions.size());
+		if (errorhnd->hasError())
+		{
+			throw strus::runtime_error( _TXT("failed to fetch forward index terms of type '%s': %s"), ti->c_str(), errorhnd->fetchError());
+		}
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		Serializer::serializeWithName( &rt.serialization, "name", *ti, true/*deep*/);
+		sc &= papuga_Serialization_pushName_charp( &rt.serialization, "offset");
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		std::vector<Index>::const_iterator oi = offsets.begin(), oe = offsets.end();
+		for (; oi != oe; ++oi)
+		{
+			sc &= papuga_Serialization_pushValue_int( &rt.serialization, *oi);
+		}
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+		sc &= papuga_Serialization_pushName_charp( &rt.serialization, "value");
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		std::vector<std::string>::const_iterator vi = values.begin(), ve = values.end();
+		for (; vi != ve; ++vi)
+		{
+			Serializer::serialize( &rt.serialization, *vi, true/*deep*/);
+		}
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+		sc &= papuga_Serialization_pushName_charp( &rt.serialization, "pos");
+		sc &= papuga_Serialization_pushOpen( &rt.serialization);
+		std::vector<Index>::const_iterator pi = positions.begin(), pe = positions.end();
+		for (; pi != pe; ++pi)
+		{
+			sc &= papuga_Serialization_pushValue_int( &rt.serialization, *pi);
+		}
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+		sc &= papuga_Serialization_pushClose( &rt.serialization);
+	}
+	sc &= papuga_Serialization_pushClose( &rt.serialization);
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
 Iterator StorageClientImpl::documentSearchIndexTerms( const Index& docno, const std::string& termtype) const
 {
 	Reference<SearchTermsIterator> itr( new SearchTermsIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, termtype, docno));
@@ -114,24 +269,53 @@ Iterator StorageClientImpl::documentSearchIndexTerms( const Index& docno, const
 	return rt;
 }
 
-Iterator StorageClientImpl::postings( const ValueVariant& expression, const ValueVariant& restriction, const Index& start_docno)
+Iterator StorageClientImpl::postings( const ValueVariant& expression, const ValueVariant& restriction, const Index& start_docno, const std::string& output)
 {
-	Reference<PostingIterator> itr( new PostingIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, expression, restriction, start_docno));
+	Reference<PostingIterator> itr( new PostingIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, m_zonemap_impl, expression, restriction, start_docno, output));
 	Iterator rt( itr.get(), &PostingIterator::Deleter, &PostingIterator::GetNext);
 	itr.release();
 	rt.release();
 	return rt;
 }
 
-Iterator StorageClientImpl::select( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction, const Index& start_docno, const ValueVariant& accesslist)
+Iterator StorageClientImpl::select( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction, const Index& start_docno, const ValueVariant& accesslist, unsigned int batchsize)
 {
-	Reference<SelectIterator> itr( new SelectIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, what, expression, restriction, start_docno, accesslist));
+	Reference<SelectIterator> itr( new SelectIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, m_zonemap_impl, what, expression, restriction, start_docno, accesslist, batchsize));
 	Iterator rt( itr.get(), &SelectIterator::Deleter, &SelectIterator::GetNext);
 	itr.release();
 	rt.release();
 	return rt;
 }
 
+Iterator StorageClientImpl::selectPartitioned( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction, const Index& start_docno, const ValueVariant& accesslist, unsigned int batchsize, unsigned int partitions, bool ordered)
+{
+	const StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	ObjectRef workers;
+	workers.resetOwnership( new WorkerThreadAllocation( m_workerslots_impl, partitions ? partitions : (unsigned int)ParallelSelectIterator::DefaultNofPartitions), "WorkerThreadAllocation");
+	if (workers.getObject<WorkerThreadAllocation>()->nofThreads() <= 1)
+	{
+		// ... scan the range without background threads and without copying the rows, if there are no worker threads to scan partitions in parallel
+		return select( what, expression, restriction, start_docno, accesslist, batchsize);
+	}
+	Reference<ParallelSelectIterator> itr( new ParallelSelectIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, m_zonemap_impl, workers, what, expression, restriction, start_docno, accesslist, batchsize, ordered));
+	Iterator rt( itr.get(), &ParallelSelectIterator::Deleter, &ParallelSelectIterator::GetNext);
+	itr.release();
+	rt.release();
+	return rt;
+}
+
+Iterator StorageClientImpl::metadataColumns( const ValueVariant& columns, const Index& start_docno, const Index& end_docno, unsigned int chunksize, bool packed)
+{
+	const StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	Reference<MetaDataColumnIterator> itr( new MetaDataColumnIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, columns, start_docno, end_docno, chunksize, packed));
+	Iterator rt( itr.get(), &MetaDataColumnIterator::Deleter, &MetaDataColumnIterator::GetNext);
+	itr.release();
+	rt.release();
+	return rt;
+}
+
 Iterator StorageClientImpl::termTypes() const
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
@@ -184,6 +368,49 @@ std::string StorageClientImpl::docid( const Index& docno) const
 	return areader->getValue( eh);
 }
 
+Struct StorageClientImpl::documentIds( const ValueVariant& docnos_) const
+{
+	const StorageClientInterface* THIS = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!THIS) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	Reference<AttributeReaderInterface> areader( THIS->createAttributeReader());
+	if (!areader.get()) throw strus::runtime_error( "%s", errorhnd->fetchError());
+	Index eh = areader->elementHandle( Constants::attribute_docid());
+	if (!eh) throw strus::runtime_error( _TXT("attribute '%s' not defined"), Constants::attribute_docid());
+	std::vector<Index> docnos = Deserializer::getIndexList( docnos_);
+
+	// ... visit the documents in ascending order, so that the attribute reader only moves forward
+	std::vector<std::pair<Index,std::size_t> > sorted;
+	sorted.reserve( docnos.size());
+	std::vector<Index>::const_iterator di = docnos.begin(), de = docnos.end();
+	for (std::size_t didx=0; di != de; ++di,++didx)
+	{
+		sorted.push_back( std::pair<Index,std::size_t>( *di, didx));
+	}
+	std::sort( sorted.begin(), sorted.end());
+
+	std::vector<std::string> docids( docnos.size());
+	std::vector<std::pair<Index,std::size_t> >::const_iterator si = sorted.begin(), se = sorted.end();
+	for (; si != se; ++si)
+	{
+		if (si->first <= 0) continue;
+		areader->skipDoc( si->first);
+		docids[ si->second] = areader->getValue( eh);
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to get document identifiers of document numbers: %s"), errorhnd->fetchError());
+	}
+	Struct rt;
+	std::vector<std::string>::const_iterator ii = docids.begin(), ie = docids.end();
+	for (; ii != ie; ++ii)
+	{
+		Serializer::serialize( &rt.serialization, *ii, true/*deep*/);
+	}
+	rt.release();
+	return rt;
+}
+
 Iterator StorageClientImpl::usernames() const
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
@@ -234,10 +461,250 @@ Iterator StorageClientImpl::getChangeStatistics( const ValueVariant& timestamp)
 	return rt;
 }
 
+static TimeStamp getLatestStatisticsChangeTimeStamp( const StorageClientInterface* storage, ErrorBufferInterface* errorhnd)
+{
+	std::vector<TimeStamp> tms = storage->getChangeStatisticTimeStamps();
+	if (errorhnd->hasError()) throw strus::runtime_error( _TXT("failed to get statistics change timestamps: %s"), errorhnd->fetchError());
+	TimeStamp rt;
+	std::vector<TimeStamp>::const_iterator ti = tms.begin(), te = tms.end();
+	for (; ti != te; ++ti)
+	{
+		if (rt < *ti) rt = *ti;
+	}
+	return rt;
+}
+
+static std::vector<StatisticsMessage> getStatisticsMessages( StatisticsIteratorInterface* statitr, const TimeStamp* watermark, ErrorBufferInterface* errorhnd)
+{
+	std::vector<StatisticsMessage> rt;
+	StatisticsMessage msg = statitr->getNext();
+	for (; !msg.empty(); msg = statitr->getNext())
+	{
+		// ... changes up to the watermark have already been acknowledged
+		if (watermark && !(*watermark < msg.timestamp())) continue;
+		rt.push_back( msg);
+	}
+	if (errorhnd->hasError()) throw strus::runtime_error( _TXT("error fetching statistics message: %s"), errorhnd->fetchError());
+	return rt;
+}
+
+static bool serializeStatisticsMessages( papuga_Serialization* ser, const char* name, const std::vector<StatisticsMessage>& msglist)
+{
+	bool rt = true;
+	rt &= papuga_Serialization_pushName_charp( ser, name);
+	rt &= papuga_Serialization_pushOpen( ser);
+	std::vector<StatisticsMessage>::const_iterator mi = msglist.begin(), me = msglist.end();
+	for (; mi != me; ++mi)
+	{
+		rt &= papuga_Serialization_pushOpen_struct( ser, StructIdTemplate<StatisticsMessage>::structid());
+		Serializer::serialize( ser, *mi, true/*deep*/);
+		rt &= papuga_Serialization_pushClose( ser);
+	}
+	rt &= papuga_Serialization_pushClose( ser);
+	return rt;
+}
+
+// ... the change log reaches back to a watermark if the watermark is not older than the oldest change kept, older changes may have been removed
+static bool changeLogReachesWatermark( const StorageClientInterface* storage, const TimeStamp& watermark, ErrorBufferInterface* errorhnd)
+{
+	std::vector<TimeStamp> tms = storage->getChangeStatisticTimeStamps();
+	if (errorhnd->hasError()) throw strus::runtime_error( _TXT("failed to get statistics change timestamps: %s"), errorhnd->fetchError());
+	if (tms.empty()) return !(TimeStamp() < watermark);
+	TimeStamp oldest = tms[0];
+	std::vector<TimeStamp>::const_iterator ti = tms.begin(), te = tms.end();
+	for (; ti != te; ++ti)
+	{
+		if (*ti < oldest) oldest = *ti;
+	}
+	return !(watermark < oldest);
+}
+
+static bool serializeStatisticsSnapshot( papuga_Serialization* ser, const StorageClientInterface* storage, ErrorBufferInterface* errorhnd)
+{
+	enum {MaxNofSnapshotTries=8};
+	// ... the snapshot is only consistent with the watermark returned if no change has been committed while reading it, otherwise it is read again
+	unsigned int tries = 0;
+	for (; tries < MaxNofSnapshotTries; ++tries)
+	{
+		TimeStamp watermark = getLatestStatisticsChangeTimeStamp( storage, errorhnd);
+		strus::local_ptr<StatisticsIteratorInterface> statitr( storage->createAllStatisticsIterator());
+		if (!statitr.get()) throw strus::runtime_error( _TXT("failed to create statistics iterator: %s"), errorhnd->fetchError());
+		std::vector<StatisticsMessage> snapshot = getStatisticsMessages( statitr.get(), NULL/*no filter*/, errorhnd);
+
+		if (watermark < getLatestStatisticsChangeTimeStamp( storage, errorhnd)) continue;
+
+		bool rt = serializeStatisticsMessages( ser, "snapshot", snapshot);
+		Serializer::serializeWithName( ser, "watermark", watermark, true/*deep*/);
+		return rt;
+	}
+	throw strus::runtime_error( _TXT("failed to get a statistics snapshot consistent with a watermark, the storage changed %u times while reading it"), tries);
+}
+
+Struct StorageClientImpl::getStatisticsChanges( const std::string& source, const ValueVariant& watermarks) const
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+
+	Struct rt;
+	bool sc = true;
+	std::map<std::string,TimeStamp> wmap = Deserializer::getStatisticsWatermarks( watermarks);
+	std::map<std::string,TimeStamp>::const_iterator wi = wmap.find( source);
+
+	Serializer::serializeWithName( &rt.serialization, "source", source, true/*deep*/);
+	if (wi == wmap.end() || !changeLogReachesWatermark( storage, wi->second, errorhnd))
+	{
+		// ... without watermark or if the changes since the watermark are not complete anymore, the complete statistics are returned
+		sc &= serializeStatisticsSnapshot( &rt.serialization, storage, errorhnd);
+	}
+	else
+	{
+		strus::local_ptr<StatisticsIteratorInterface> statitr( storage->createChangeStatisticsIterator( wi->second));
+		if (!statitr.get()) throw strus::runtime_error( _TXT("failed to create statistics change iterator: %s"), errorhnd->fetchError());
+		sc &= serializeStatisticsMessages( &rt.serialization, "message", getStatisticsMessages( statitr.get(), &wi->second, errorhnd));
+	}
+	if (!sc) throw std::bad_alloc();
+	rt.release();
+	return rt;
+}
+
+std::string StorageClientImpl::termSummary( const ValueVariant& config_) const
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
+
+	std::string configstr = Deserializer::getConfigString( config_);
+	std::string statsprocname;
+	unsigned int nofBits = TermSummary::DefaultNofBits;
+	unsigned int nofHashes = TermSummary::DefaultNofHashes;
+	(void)extractStringFromConfigString( statsprocname, configstr, "proc", errorhnd);
+	(void)extractUIntFromConfigString( nofBits, configstr, "bits", errorhnd);
+	(void)extractUIntFromConfigString( nofHashes, configstr, "hashes", errorhnd);
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to parse term summary configuration: %s"), errorhnd->fetchError());
+	}
+	if (!configstr.empty())
+	{
+		throw strus::runtime_error( _TXT("unknown configuration parameters for term summary: %s"), configstr.c_str());
+	}
+	const StatisticsProcessorInterface* statsproc = objBuilder->getStatisticsProcessor( statsprocname);
+	if (!statsproc) throw strus::runtime_error( _TXT("unknown statistics processor '%s'"), statsprocname.c_str());
+
+	// ... the summary is rebuilt only if the statistics changed since it was built the last time,
+	//	the timestamp is taken before reading the statistics, so that a change while reading leads to a rebuild with the next call
+	TermSummaryCache* cache = m_termsummary_impl.getObject<TermSummaryCache>();
+	std::string summarykey = strus::string_format( "%s:%u:%u", statsprocname.c_str(), nofBits, nofHashes);
+	std::vector<TimeStamp> timestamps = storage->getChangeStatisticTimeStamps();
+	if (errorhnd->hasError()) throw strus::runtime_error( _TXT("failed to get statistics change timestamps: %s"), errorhnd->fetchError());
+	if (timestamps.empty()) cache = 0;
+	TimeStamp version;
+	std::vector<TimeStamp>::const_iterator ti = timestamps.begin(), te = timestamps.end();
+	for (; ti != te; ++ti)
+	{
+		if (version < *ti) version = *ti;
+	}
+	std::string cached;
+	if (cache && cache->get( cached, summarykey, version))
+	{
+		return cached;
+	}
+	TermSummary summary( nofBits, nofHashes);
+	strus::local_ptr<StatisticsIteratorInterface> statitr( storage->createAllStatisticsIterator());
+	if (!statitr.get()) throw strus::runtime_error( "%s", errorhnd->fetchError());
+	StatisticsMessage msg = statitr->getNext();
+	for (; !msg.empty(); msg = statitr->getNext())
+	{
+		strus::local_ptr<StatisticsViewerInterface> viewer( statsproc->createViewer( msg.ptr(), msg.size()));
+		if (!viewer.get()) throw strus::runtime_error(_TXT( "error decoding statistics from blob: %s"), errorhnd->fetchError());
+		TermStatisticsChange rec;
+		while (viewer->nextDfChange( rec))
+		{
+			if (rec.increment() > 0)
+			{
+				summary.insert( rec.type(), rec.value());
+			}
+		}
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to build term summary: %s"), errorhnd->fetchError());
+	}
+	std::string rt = summary.tostring();
+	if (cache) cache->set( summarykey, version, rt);
+	return rt;
+}
+
+Struct StorageClientImpl::exportDocuments( const std::string& path, const Index& start_docno, const Index& end_docno) const
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+
+	DocumentExportWriter writer( storage, errorhnd);
+	writer.run( path, start_docno, end_docno);
+
+	Struct rt;
+	Serializer::serializeWithName( &rt.serialization, "documents", (papuga_Int)writer.nofDocuments(), true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "bytes", (papuga_Int)writer.nofBytes(), true/*deep*/);
+	rt.release();
+	return rt;
+}
+
+Struct StorageClientImpl::importDocuments( const std::string& path, unsigned int transactionsize)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
+	if (!storage) throw strus::runtime_error( _TXT("calling storage client method after close"));
+
+	DocumentImportReader reader( storage, errorhnd, transactionsize);
+	try
+	{
+		reader.run( path);
+	}
+	catch (const std::runtime_error&)
+	{
+		// ... documents of transactions committed before the error may replace documents summarized in the zone map
+		MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<MetaDataZoneMap>();
+		if (zonemap) zonemap->invalidate();
+		throw;
+	}
+	MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<MetaDataZoneMap>();
+	if (zonemap) zonemap->invalidate();
+
+	Struct rt;
+	Serializer::serializeWithName( &rt.serialization, "documents", (papuga_Int)reader.nofDocuments(), true/*deep*/);
+	rt.release();
+	return rt;
+}
+
 StorageTransactionImpl* StorageClientImpl::createTransaction() const
 {
 	if (!m_storage_impl.get()) throw strus::runtime_error( _TXT("calling storage client method after close"));
-	return new StorageTransactionImpl( m_trace_impl, m_objbuilder_impl, m_errorhnd_impl, m_storage_impl);
+	return new StorageTransactionImpl( m_trace_impl, m_objbuilder_impl, m_errorhnd_impl, m_workerslots_impl, m_storage_impl, m_zonemap_impl, m_groupcommit_impl);
+}
+
+Struct StorageClientImpl::groupCommitStatistics() const
+{
+	if (!m_storage_impl.get()) throw strus::runtime_error( _TXT("calling storage client method after close"));
+	const GroupCommitQueue* groupcommit = m_groupcommit_impl.getObject<const GroupCommitQueue>();
+	GroupCommitQueue::Statistics statistics;
+	unsigned int window = 0;
+	if (groupcommit)
+	{
+		statistics = groupcommit->statistics();
+		window = groupcommit->window();
+	}
+	Struct rt;
+	Serializer::serializeWithName( &rt.serialization, "window", (papuga_Int)window, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "groups", (papuga_Int)statistics.nofGroups, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "members", (papuga_Int)statistics.nofMembers, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "commits", (papuga_Int)statistics.nofCommits, true/*deep*/);
+	Serializer::serializeWithName( &rt.serialization, "failures", (papuga_Int)statistics.nofFailures, true/*deep*/);
+	rt.release();
+	return rt;
 }
 
 void StorageClientImpl::close()
@@ -306,28 +773,71 @@ Struct StorageClientImpl::introspection( const ValueVariant& arg) const
 	return rt;
 }
 
-StorageTransactionImpl::StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& storage_)
+StorageTransactionImpl::StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_, const ObjectRef& zonemap_, const ObjectRef& groupcommit_)
 	:m_errorhnd_impl(errorhnd_)
 	,m_trace_impl(trace_)
 	,m_objbuilder_impl(objbuilder_)
+	,m_workerslots_impl(workerslots_)
 	,m_storage_impl(storage_)
 	,m_transaction_impl()
+	,m_zonemap_impl(zonemap_)
+	,m_zonemap_docnos()
+	,m_zonemap_reset(false)
+	,m_groupcommit_impl(groupcommit_)
+	,m_operations_impl()
+	,m_asynccommit_impl()
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
 	StorageTransactionInterface* transaction = storage->createTransaction();
 	if (!transaction) throw strus::runtime_error( "%s", errorhnd->fetchError());
 	m_transaction_impl.resetOwnership( transaction, "StorageTransaction");
+	if (m_groupcommit_impl.get())
+	{
+		m_operations_impl.resetOwnership( new GroupCommitOperations(), "GroupCommitOperations");
+	}
 }
 
-void StorageTransactionImpl::insertDocument( const std::string& docid, const ValueVariant& doc)
+void StorageTransactionImpl::zoneMapDocumentChanged( const std::string& docid)
 {
-	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
-	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
-	if (docid.empty()) throw strus::runtime_error( _TXT("empty document id passed to %s"), _TXT("storage transaction insert document"));
+	const MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<const MetaDataZoneMap>();
+	if (zonemap && !zonemap->empty())
+	{
+		// ... only documents replaced or deleted matter, new documents get document numbers in blocks not summarized yet
+		const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+		Index docno = storage->documentNumber( docid);
+		if (docno) m_zonemap_docnos.push_back( docno);
+	}
+}
 
+void StorageTransactionImpl::zoneMapCommitted()
+{
+	MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<MetaDataZoneMap>();
+	if (zonemap)
+	{
+		if (m_zonemap_reset)
+		{
+			zonemap->invalidate();
+		}
+		else
+		{
+			std::vector<Index>::const_iterator di = m_zonemap_docnos.begin(), de = m_zonemap_docnos.end();
+			for (; di != de; ++di)
+			{
+				zonemap->invalidateDocument( *di);
+			}
+		}
+	}
+	m_zonemap_docnos.clear();
+	m_zonemap_reset = false;
+}
+
+void StorageTransactionImpl::applyInsertDocument( StorageTransactionInterface* transaction, const std::string& docid, const ValueVariant& doc)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	Reference<StorageDocumentInterface> document( transaction->createDocument( docid));
 	if (!document.get()) throw strus::runtime_error( _TXT("failed to create document with id '%s' to insert: %s"), docid.c_str(), errorhnd->fetchError());
+	zoneMapDocumentChanged( docid);
 
 	Deserializer::buildInsertDocument( document.get(), doc, errorhnd);
 	document->done();
@@ -337,15 +847,15 @@ void StorageTransactionImpl::insertDocument( const std::string& docid, const Val
 	}
 }
 
-void StorageTransactionImpl::updateDocument( const std::string& docid, const ValueVariant& content, const ValueVariant& deletes)
+void StorageTransactionImpl::applyUpdateDocument( StorageTransactionInterface* transaction, const std::string& docid, const ValueVariant& content, const ValueVariant& deletes)
 {
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
-	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
 	StorageClientInterface* storage = m_storage_impl.getObject<StorageClientInterface>();
 	strus::Index docno = storage->documentNumber( docid);
 	if (!docno) throw strus::runtime_error( _TXT("failed to update document with undefined id '%s'"), docid.c_str());
 	Reference<StorageDocumentUpdateInterface> document( transaction->createDocumentUpdate( docno));
 	if (!document.get()) throw strus::runtime_error( _TXT("failed to create document with id '%s' to insert: %s"), docid.c_str(), errorhnd->fetchError());
+	if (m_zonemap_impl.get()) m_zonemap_docnos.push_back( docno);
 
 	Deserializer::buildUpdateDocument( document.get(), content, deletes, errorhnd);
 	document->done();
@@ -355,9 +865,9 @@ void StorageTransactionImpl::updateDocument( const std::string& docid, const Val
 	}
 }
 
-void StorageTransactionImpl::deleteDocument( const std::string& docId)
+void StorageTransactionImpl::applyDeleteDocument( StorageTransactionInterface* transaction, const std::string& docId)
 {
-	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
+	zoneMapDocumentChanged( docId);
 	transaction->deleteDocument( docId);
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	if (errorhnd->hasError())
@@ -366,9 +876,8 @@ void StorageTransactionImpl::deleteDocument( const std::string& docId)
 	}
 }
 
-void StorageTransactionImpl::deleteUserAccessRights( const std::string& username)
+void StorageTransactionImpl::applyDeleteUserAccessRights( StorageTransactionInterface* transaction, const std::string& username)
 {
-	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
 	transaction->deleteUserAccessRights( username);
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	if (errorhnd->hasError())
@@ -377,6 +886,90 @@ void StorageTransactionImpl::deleteUserAccessRights( const std::string& username
 	}
 }
 
+void StorageTransactionImpl::applyOperations( StorageTransactionInterface* transaction)
+{
+	const GroupCommitOperations* operations = m_operations_impl.getObject<const GroupCommitOperations>();
+	if (!operations) return;
+	// ... the operations may be applied more than once, if a group commit is rebuilt
+	m_zonemap_docnos.clear();
+	std::vector<GroupCommitOperations::Operation>::const_iterator oi = operations->operations().begin(), oe = operations->operations().end();
+	for (; oi != oe; ++oi)
+	{
+		switch (oi->type)
+		{
+			case GroupCommitOperations::InsertDocument:
+				applyInsertDocument( transaction, oi->id, oi->content);
+				break;
+			case GroupCommitOperations::UpdateDocument:
+				applyUpdateDocument( transaction, oi->id, oi->content, oi->deletes);
+				break;
+			case GroupCommitOperations::DeleteDocument:
+				applyDeleteDocument( transaction, oi->id);
+				break;
+			case GroupCommitOperations::DeleteUserAccessRights:
+				applyDeleteUserAccessRights( transaction, oi->id);
+				break;
+		}
+	}
+}
+
+void StorageTransactionImpl::insertDocument( const std::string& docid, const ValueVariant& doc)
+{
+	checkAsyncCommitNotRunning();
+	if (docid.empty()) throw strus::runtime_error( _TXT("empty document id passed to %s"), _TXT("storage transaction insert document"));
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations)
+	{
+		operations->push( GroupCommitOperations::InsertDocument, docid, &doc);
+	}
+	else
+	{
+		applyInsertDocument( m_transaction_impl.getObject<StorageTransactionInterface>(), docid, doc);
+	}
+}
+
+void StorageTransactionImpl::updateDocument( const std::string& docid, const ValueVariant& content, const ValueVariant& deletes)
+{
+	checkAsyncCommitNotRunning();
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations)
+	{
+		operations->push( GroupCommitOperations::UpdateDocument, docid, &content, &deletes);
+	}
+	else
+	{
+		applyUpdateDocument( m_transaction_impl.getObject<StorageTransactionInterface>(), docid, content, deletes);
+	}
+}
+
+void StorageTransactionImpl::deleteDocument( const std::string& docId)
+{
+	checkAsyncCommitNotRunning();
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations)
+	{
+		operations->push( GroupCommitOperations::DeleteDocument, docId);
+	}
+	else
+	{
+		applyDeleteDocument( m_transaction_impl.getObject<StorageTransactionInterface>(), docId);
+	}
+}
+
+void StorageTransactionImpl::deleteUserAccessRights( const std::string& username)
+{
+	checkAsyncCommitNotRunning();
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations)
+	{
+		operations->push( GroupCommitOperations::DeleteUserAccessRights, username);
+	}
+	else
+	{
+		applyDeleteUserAccessRights( m_transaction_impl.getObject<StorageTransactionInterface>(), username);
+	}
+}
+
 static void fillUpdateMetaDataTable( StorageMetaDataTableUpdateInterface* update, const std::vector<MetaDataTableCommand>& cmdlist, ErrorBufferInterface* errorhnd)
 {
 	std::vector<MetaDataTableCommand>::const_iterator ci = cmdlist.begin(), ce = cmdlist.end();
@@ -421,27 +1014,166 @@ static void fillUpdateMetaDataTable( StorageMetaDataTableUpdateInterface* update
 
 void StorageTransactionImpl::updateMetaDataTable( const ValueVariant& commandlist)
 {
+	checkAsyncCommitNotRunning();
 	std::vector<MetaDataTableCommand> cmdlist = MetaDataTableCommand::getList( commandlist);
 	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
 	strus::Reference<StorageMetaDataTableUpdateInterface> update( transaction->createMetaDataTableUpdate());
 	if (!update.get()) throw strus::runtime_error( _TXT("failed to create meta data table update structure"));
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	fillUpdateMetaDataTable( update.get(), cmdlist, errorhnd);
+	m_zonemap_reset = true;
+}
+
+/// \brief Compare meta data column entries by document number only, for a stable sort keeping the last value specified for a document last
+static bool compareMetaDataColumnEntry( const std::pair<Index,NumericVariant>& a, const std::pair<Index,NumericVariant>& b)
+{
+	return a.first < b.first;
+}
+
+void StorageTransactionImpl::updateMetaDataColumn( const std::string& name, const ValueVariant& docnos_, const ValueVariant& values_)
+{
+	checkAsyncCommitNotRunning();
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+
+	std::vector<Index> docnos = Deserializer::getIndexList( docnos_);
+	std::vector<NumericVariant> values = Deserializer::getNumericList( values_);
+	if (docnos.size() != values.size())
+	{
+		throw strus::runtime_error( _TXT("number of document numbers (%d) and values (%d) do not match in %s"), (int)docnos.size(), (int)values.size(), _TXT("meta data column update"));
+	}
+	{
+		strus::local_ptr<MetaDataReaderInterface> reader( storage->createMetaDataReader());
+		if (!reader.get()) throw strus::runtime_error( _TXT("failed to create meta data reader: %s"), errorhnd->fetchError());
+		if (reader->elementHandle( name) < 0) throw strus::runtime_error( _TXT("unknown meta data element '%s' in %s"), name.c_str(), _TXT("meta data column update"));
+	}
+	std::vector<std::pair<Index,NumericVariant> > entries;
+	entries.reserve( docnos.size());
+	Index maxdocno = storage->maxDocumentNumber();
+	std::vector<Index>::const_iterator di = docnos.begin(), de = docnos.end();
+	std::vector<NumericVariant>::const_iterator vi = values.begin();
+	for (; di != de; ++di,++vi)
+	{
+		if (*di <= 0) throw strus::runtime_error( _TXT("invalid document number %d in %s"), (int)*di, _TXT("meta data column update"));
+		if (*di > maxdocno) throw strus::runtime_error( _TXT("document number %d exceeds the maximum document number %d of the storage in %s"), (int)*di, (int)maxdocno, _TXT("meta data column update"));
+		entries.push_back( std::pair<Index,NumericVariant>( *di, *vi));
+	}
+	std::stable_sort( entries.begin(), entries.end(), compareMetaDataColumnEntry);
+
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations)
+	{
+		// ... apply the document operations recorded for a group commit first to keep the order of the updates
+		try
+		{
+			applyOperations( transaction);
+		}
+		catch (...)
+		{
+			operations->clear();
+			throw;
+		}
+		operations->clear();
+	}
+	// ... the transaction touches the blocks of many documents and is not merged into a group commit, the zone map is invalidated completely on commit
+	m_zonemap_reset = true;
+	std::vector<std::pair<Index,NumericVariant> >::const_iterator ei = entries.begin(), ee = entries.end();
+	for (; ei != ee; ++ei)
+	{
+		Reference<StorageDocumentUpdateInterface> document( transaction->createDocumentUpdate( ei->first));
+		if (!document.get()) throw strus::runtime_error( _TXT("failed to create update of document %d: %s"), (int)ei->first, errorhnd->fetchError());
+		document->setMetaData( name, ei->second);
+		document->done();
+		if (errorhnd->hasError()) break;
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to update meta data column '%s': %s"), name.c_str(), errorhnd->fetchError());
+	}
 }
 
 void StorageTransactionImpl::defineMetaDataTable( const ValueVariant& deflist)
 {
+	checkAsyncCommitNotRunning();
 	std::vector<MetaDataTableCommand> cmdlist = MetaDataTableCommand::getListFromNameTypePairs( deflist);
 	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
 	strus::Reference<StorageMetaDataTableUpdateInterface> update( transaction->createMetaDataTableUpdate());
 	if (!update.get()) throw strus::runtime_error( _TXT("failed to create meta data table update structure"));
 	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 	fillUpdateMetaDataTable( update.get(), cmdlist, errorhnd);
+	m_zonemap_reset = true;
 }
 
+namespace strus {
+namespace bindings {
+/// \brief Storage transaction as member of a group commit
+class StorageTransactionGroupMember
+	:public GroupCommitMember
+{
+public:
+	explicit StorageTransactionGroupMember( StorageTransactionImpl* transaction_)
+		:m_transaction(transaction_){}
+	virtual ~StorageTransactionGroupMember(){}
+
+	virtual void apply( StorageTransactionInterface* transaction)
+	{
+		m_transaction->applyOperations( transaction);
+	}
+	virtual void committed()
+	{
+		m_transaction->zoneMapCommitted();
+	}
+
+private:
+	StorageTransactionImpl* m_transaction;
+};
+}}//namespace
+
 void StorageTransactionImpl::commit()
 {
+	checkAsyncCommitNotRunning();
+	commitTransaction();
+}
+
+void StorageTransactionImpl::commitTransaction()
+{
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	GroupCommitQueue* groupcommit = m_groupcommit_impl.getObject<GroupCommitQueue>();
+	if (operations && groupcommit && !m_zonemap_reset)
+	{
+		StorageTransactionGroupMember member( this);
+		try
+		{
+			groupcommit->commit( &member);
+		}
+		catch (...)
+		{
+			operations->clear();
+			m_zonemap_docnos.clear();
+			throw;
+		}
+		operations->clear();
+		return;
+	}
 	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
+	if (operations)
+	{
+		// ... a transaction changing the meta data table is not merged with others, its recorded operations are applied and committed alone
+		try
+		{
+			applyOperations( transaction);
+		}
+		catch (...)
+		{
+			transaction->rollback();
+			operations->clear();
+			m_zonemap_docnos.clear();
+			m_zonemap_reset = false;
+			throw;
+		}
+		operations->clear();
+	}
 	strus::StorageCommitResult cmres = transaction->commit();
 	if (!cmres.success())
 	{
@@ -449,12 +1181,87 @@ void StorageTransactionImpl::commit()
 		ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
 		throw strus::runtime_error( _TXT("error in commit transaction: %s"), errorhnd->fetchError());
 	}
+	zoneMapCommitted();
 }
 
 void StorageTransactionImpl::rollback()
 {
+	checkAsyncCommitNotRunning();
 	StorageTransactionInterface* transaction = m_transaction_impl.getObject<StorageTransactionInterface>();
 	transaction->rollback();
+	GroupCommitOperations* operations = m_operations_impl.getObject<GroupCommitOperations>();
+	if (operations) operations->clear();
+	m_zonemap_docnos.clear();
+	m_zonemap_reset = false;
+}
+
+void StorageTransactionImpl::checkAsyncCommitNotRunning() const
+{
+	const AsyncCommit* asynccommit = m_asynccommit_impl.getObject<const AsyncCommit>();
+	if (asynccommit && asynccommit->state() == AsyncCommit::Running)
+	{
+		throw strus::runtime_error( _TXT("storage transaction method called while an asynchronous commit is running"));
+	}
+}
+
+namespace strus {
+namespace bindings {
+/// \brief Commit of a storage transaction run in the background
+class StorageTransactionAsyncCommitJob
+	:public AsyncCommitJob
+{
+public:
+	explicit StorageTransactionAsyncCommitJob( StorageTransactionImpl* transaction_)
+		:m_transaction(transaction_){}
+	virtual ~StorageTransactionAsyncCommitJob(){}
+
+	virtual void run()
+	{
+		m_transaction->commitTransaction();
+	}
+
+private:
+	StorageTransactionImpl* m_transaction;
+};
+}}//namespace
+
+void StorageTransactionImpl::commitAsync()
+{
+	if (!m_transaction_impl.get()) throw strus::runtime_error( _TXT("calling storage transaction method after failed commit"));
+	AsyncCommit* asynccommit = m_asynccommit_impl.getObject<AsyncCommit>();
+	if (!asynccommit)
+	{
+		asynccommit = new AsyncCommit();
+		m_asynccommit_impl.resetOwnership( asynccommit, "AsyncCommit");
+	}
+	asynccommit->start( new StorageTransactionAsyncCommitJob( this), m_workerslots_impl);
+}
+
+Struct StorageTransactionImpl::commitState() const
+{
+	const AsyncCommit* asynccommit = m_asynccommit_impl.getObject<const AsyncCommit>();
+	AsyncCommit::State state = asynccommit ? asynccommit->state() : AsyncCommit::Idle;
+	Struct rt;
+	Serializer::serializeWithName( &rt.serialization, "state", std::string( AsyncCommit::stateName( state)), true/*deep*/);
+	if (state == AsyncCommit::Failed)
+	{
+		Serializer::serializeWithName( &rt.serialization, "error", asynccommit->error(), true/*deep*/);
+	}
+	rt.release();
+	return rt;
+}
+
+void StorageTransactionImpl::waitCommit()
+{
+	AsyncCommit* asynccommit = m_asynccommit_impl.getObject<AsyncCommit>();
+	if (!asynccommit) return;
+	AsyncCommit::State state = asynccommit->wait();
+	std::string errmsg = asynccommit->error();
+	asynccommit->reset();
+	if (state == AsyncCommit::Failed)
+	{
+		throw strus::runtime_error( "%s", errmsg.c_str());
+	}
 }
 
 
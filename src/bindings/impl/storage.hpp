@@ -19,6 +19,10 @@
 #include <string>
 
 namespace strus {
+
+/// \brief Forward declaration
+class StorageTransactionInterface;
+
 namespace bindings {
 
 typedef papuga_ValueVariant ValueVariant;
@@ -69,6 +73,14 @@ public:
 	/// \example 0
 	Index documentNumber( const std::string& docid) const;
 
+	/// \brief Get the internal document numbers of a list of document identifiers with one call
+	/// \note The identifiers are looked up in ascending order
+	/// \param[in] docids list of document identifiers
+	/// \example [ "doc://2132093" "doc://2132094" ]
+	/// \return list of the internal document numbers in the order of the identifiers passed, 0 for identifiers of documents not inserted
+	/// \example [ 892374 0 ]
+	Struct documentNumbers( const ValueVariant& docids) const;
+
 	/// \brief Get an interator on the tuples (value,pos) of the forward index of a given type for a document
 	/// \param[in] docno internal local document number
 	/// \example 312332
@@ -79,6 +91,16 @@ public:
 	/// \return iterator on tuples (value,pos)
 	Iterator documentForwardIndexTerms( const Index& docno, const std::string& termtype, const Index& pos=0) const;
 
+	/// \brief Get the terms of the forward index of some types for a list of documents with one call
+	/// \note The documents are visited in ascending order with one forward index iterator per type
+	/// \param[in] docnos list of internal local document numbers
+	/// \example [ 312332 7 881 ]
+	/// \param[in] termtypes list of term types
+	/// \example [ "word" "orig" ]
+	/// \return structure with the list of distinct document numbers in ascending order (docno) and per type (type) the lists of values (value) and positions (pos) of all documents concatenated and the start index of the terms of each document in these lists (offset, one element more than documents, the last one being the total number of terms)
+	/// \example [ docno: [7 881] type: [ [name: "word" offset: [0 2 3] value: ["hello" "world" "bye"] pos: [1 2 1]] ] ]
+	Struct documentsForwardIndexTerms( const ValueVariant& docnos, const ValueVariant& termtypes) const;
+
 	/// \brief Get an interator on the tuples (value,tf,firstpos) of the search index of a given type for a document
 	/// \param[in] docno internal local document number
 	/// \example 123
@@ -98,8 +120,11 @@ public:
 	/// \param[in] start_docno starting document number
 	/// \example 973141
 	/// \example 873
+	/// \param[in] output what to return besides the document number: "positions" (default) for the list of positions, "docno" for nothing, "ff" for the feature frequency, "packed" for the positions as base64 encoded string of varint encoded deltas
+	/// \example "ff"
+	/// \example "packed"
 	/// \return iterator on a set of postings
-	Iterator postings( const ValueVariant& expression, const ValueVariant& restriction=ValueVariant(), const Index& start_docno=0);
+	Iterator postings( const ValueVariant& expression, const ValueVariant& restriction=ValueVariant(), const Index& start_docno=0, const std::string& output="");
 
 	/// \brief Get an iterator on records of selected elements for matching documents starting from a specified document number
 	/// \param[in] what list of items to select: names of document attributes or meta data or "position" for matching positions or "docno" for the document number
@@ -116,8 +141,48 @@ public:
 	/// \example 873
 	/// \param[in] accesslist list of access restrictions (one of them must match)
 	/// \example [ "public" "devel" ]
-	/// \return iterator on a set of postings
-	Iterator select( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction=ValueVariant(), const Index& start_docno=0, const ValueVariant& accesslist=ValueVariant());
+	/// \param[in] batchsize maximum number of rows returned with one iterator step or 0 for returning one row per step as structure with the names of the items selected
+	/// \example 1000
+	/// \return iterator on a set of postings, with a batch size specified on structures with the names of the items selected as list (header) and the rows of up to batchsize documents as lists of values (rows)
+	Iterator select( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction=ValueVariant(), const Index& start_docno=0, const ValueVariant& accesslist=ValueVariant(), unsigned int batchsize=0);
+
+	/// \brief Get an iterator on records of selected elements for matching documents, scanning partitions of the document number range in parallel
+	/// \param[in] what list of items to select: names of document attributes or meta data or "position" for matching positions or "docno" for the document number
+	/// \example  [ "docno" "title" "position" ]
+	/// \param[in] expression query term expression
+	/// \example  [ "within" 5 ["word" "world"]  ["word" "money"]]
+	/// \example  [ "word" "hello" ]
+	/// \param[in] restriction meta data restrictions
+	/// \example  [ [["=" "country" 12] ["=" "country" 17]]  ["<" "year" "2007"] ]
+	/// \example  ["<" "year" "2002"]
+	/// \param[in] start_docno starting document number
+	/// \example 873
+	/// \param[in] accesslist list of access restrictions (one of them must match)
+	/// \example [ "public" "devel" ]
+	/// \param[in] batchsize maximum number of rows returned with one iterator step or 0 for returning one row per step as structure with the names of the items selected
+	/// \example 1000
+	/// \param[in] partitions number of partitions of the document number range, each scanned by a thread of its own, 0 for the default (4), 1 for scanning without background threads
+	/// \example 16
+	/// \param[in] ordered true if the rows are returned in ascending order of document numbers, false if they are returned in the order they are fetched
+	/// \example false
+	/// \return iterator on a set of postings, returning the same as 'select' with the same arguments (in different order if not ordered)
+	/// \note The number of partitions is limited by the number of worker threads configured for the context ('workerthreads') not in use by other operations, with less than 2 the range is scanned by the calling thread like with 'select'
+	Iterator selectPartitioned( const ValueVariant& what, const ValueVariant& expression, const ValueVariant& restriction=ValueVariant(), const Index& start_docno=0, const ValueVariant& accesslist=ValueVariant(), unsigned int batchsize=0, unsigned int partitions=0, bool ordered=true);
+
+	/// \brief Get an iterator on the values of meta data elements for a range of document numbers, returned column by column in chunks of documents
+	/// \param[in] columns list of names of the meta data elements to export or undefined for all
+	/// \example  [ "date" "doclen" ]
+	/// \param[in] start_docno first document number of the range or 0 for starting with the first document
+	/// \example 1
+	/// \param[in] end_docno document number following the last one of the range or 0 for ending with the last document inserted
+	/// \example 100001
+	/// \param[in] chunksize number of documents returned with one iterator step or 0 for the default (1024)
+	/// \example 4096
+	/// \param[in] packed true if the values of a column are returned as base64 encoded array of 8 byte little endian values (int64 or IEEE float64 depending on the column type) instead of a list
+	/// \example true
+	/// \return iterator on structures with the first document number (start) and the number of documents (count) of the chunk and a list of columns with name, type ("int64" or "float64") and the values of the chunk (values or packed)
+	/// \note Documents deleted or not existing in the range get the value 0
+	Iterator metadataColumns( const ValueVariant& columns=ValueVariant(), const Index& start_docno=0, const Index& end_docno=0, unsigned int chunksize=0, bool packed=false);
 
 	/// \brief Get an iterator on the term types inserted
 	/// \return iterator on the term types
@@ -139,6 +204,13 @@ public:
 	/// \return the document identifier
 	std::string docid( const Index& docno) const;
 
+	/// \brief Get the document identifiers of a list of local document numbers with one call
+	/// \note The document numbers are looked up in ascending order
+	/// \param[in] docnos list of local document numbers
+	/// \example [ 79213 1 ]
+	/// \return list of the document identifiers in the order of the document numbers passed, empty for document numbers without identifier
+	Struct documentIds( const ValueVariant& docnos) const;
+
 	/// \brief Get an iterator on the user names (roles) used in document access restrictions
 	/// \return iterator on the user names (roles)
 	Iterator usernames() const;
@@ -164,6 +236,45 @@ public:
 	/// \return iterator on the encoded blobs of the statistic changes of the storage
 	Iterator getChangeStatistics( const ValueVariant& timestamp);
 
+	/// \brief Get the changes in statistics of the storage that have not been acknowledged yet by a statistics server, used for feeding a statistics server incrementally
+	/// \param[in] source identifier of this storage as source of statistics for the statistics server
+	/// \example "node1/test"
+	/// \param[in] watermarks list of the timestamps of the last changes acknowledged by the statistics server, one per source (see StatisticsMap::watermarks)
+	/// \example [ [ source: "node1/test" timestamp: [ unixtime: 1577836800 counter: 12 ] ] ]
+	/// \return structure with the source identifier (source) and the messages with changes newer than the watermark of the source (message), or if no watermark has been defined for the source yet, the complete statistics (snapshot) with the timestamp of the latest change contained in it (watermark)
+	/// \note The snapshot is read again if the storage changed while reading it, so that the watermark returned with it is exact
+	/// \note The complete statistics are also returned if the changes kept by the storage do not reach back to the watermark of the source anymore
+	Struct getStatisticsChanges( const std::string& source, const ValueVariant& watermarks) const;
+
+	/// \brief Get a compact summary (bloom filter) of all terms contained in this storage
+	/// \note The summary is published to a coordinator of a distributed query evaluation, that uses it to skip shards that cannot contain any selecting feature of a query (see ShardSelector)
+	/// \param[in] config configuration (string or structure with named elements) of the summary, size of the filter in bits (bits), number of hash functions (hashes) and the statistics processor (proc) used to decode the storage statistics
+	/// \example "bits=1048576; hashes=4"
+	/// \example [ bits: 4194304 hashes: 3 ]
+	/// \return the summary as base64 encoded blob
+	/// \note The summary is kept and returned again until the statistics of the storage change, it is rebuilt with the first call after a change. Without statistics change timestamps (no statistics processor configured) it is rebuilt with every call
+	std::string termSummary( const ValueVariant& config=ValueVariant()) const;
+
+	/// \brief Write the documents of a range of document numbers with all their content (attributes, meta data, access rights, search and forward index terms) to a file, for reindexing or migrating a collection
+	/// \note The file has a compact binary format with a checksum per document, readable with importDocuments
+	/// \param[in] path path of the file to write
+	/// \example "/srv/searchengine/export/storage.bin"
+	/// \param[in] start_docno first document number of the range or 0 for starting with the first document
+	/// \example 1
+	/// \param[in] end_docno document number following the last one of the range or 0 for ending with the last document inserted
+	/// \example 100001
+	/// \return structure with the number of documents (documents) and bytes (bytes) written
+	Struct exportDocuments( const std::string& path, const Index& start_docno=0, const Index& end_docno=0) const;
+
+	/// \brief Insert the documents of a file written with exportDocuments into this storage
+	/// \note The meta data elements of the documents exported have to be defined in this storage
+	/// \param[in] path path of the file to read
+	/// \example "/srv/searchengine/export/storage.bin"
+	/// \param[in] transactionsize number of documents inserted with one transaction or 0 for the default (1000)
+	/// \example 10000
+	/// \return structure with the number of documents inserted (documents)
+	Struct importDocuments( const std::string& path, unsigned int transactionsize=0);
+
 	/// \brief Create a transaction
 	/// \return the transaction object (class StorageTransaction) created
 	StorageTransactionImpl* createTransaction() const;
@@ -192,22 +303,31 @@ public:
 	/// \return the structure to introspect starting from the path
 	Struct introspection( const ValueVariant& path) const;
 
+	/// \brief Get the counters of the group commits of the transactions created by this storage client
+	/// \note Group commit is enabled with the configuration parameter 'groupcommit' specifying the time window in milliseconds the commits of concurrent transactions are collected to be merged into one physical commit
+	/// \return structure with the time window in milliseconds (window), the number of groups (groups), members committed (members), physical commits (commits) and members failed (failures), the window is 0 and all counters are 0 if group commit is not enabled
+	Struct groupCommitStatistics() const;
+
 private:
 	/// \brief Constructor used by Context
 	friend class ContextImpl;
-	StorageClientImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd_, const std::string& config);
+	StorageClientImpl( const ObjectRef& trace, const ObjectRef& objbuilder, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const std::string& config);
 
 	/// \brief Constructor used by Inserter
 	friend class InserterImpl;
-	StorageClientImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& storage_)
-		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_){}
+	StorageClientImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_, const ObjectRef& zonemap_)
+		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_workerslots_impl(workerslots_),m_storage_impl(storage_),m_zonemap_impl(zonemap_),m_groupcommit_impl(),m_termsummary_impl(){}
 
 	friend class QueryImpl;
 	friend class QueryEvalImpl;
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
+	ObjectRef m_workerslots_impl;
 	ObjectRef m_storage_impl;
+	ObjectRef m_zonemap_impl;
+	ObjectRef m_groupcommit_impl;
+	ObjectRef m_termsummary_impl;			// term summary built last with the statistics change timestamp it was built for
 };
 
 
@@ -249,33 +369,90 @@ public:
 	/// \example [["add" "doclen" "UINT16"], ["add" "class" "INT8"]]
 	void updateMetaDataTable( const ValueVariant& commandlist);
 
+	/// \brief Update the values of one meta data element for a list of documents addressed by document number, without passing a document description for each document
+	/// \note The values are written in ascending order of document numbers with one document update per entry setting only this element, and physically updated with the call of 'commit()'. If a document number appears more than once, the last value in the list wins. The meta data zone map is invalidated completely on commit
+	/// \note The call is rejected without recording any update if the element is unknown or a document number is out of range
+	/// \note If group commit is enabled, a transaction with a meta data column update is not merged with others
+	/// \param[in] name name of the meta data element to update
+	/// \example "popularity"
+	/// \param[in] docnos list of document numbers of the documents to update, not exceeding the maximum document number of the storage
+	/// \example [1, 2, 3, 7]
+	/// \param[in] values list of values, one for each document number in the same order
+	/// \example [0.5, 0.71, 0.1, 0.92]
+	void updateMetaDataColumn( const std::string& name, const ValueVariant& docnos, const ValueVariant& values);
+
 	/// \brief Define a list of new meta data table entries (same as updateMetaDataTable with implicit 'add' as operation in the arguments)
 	/// \param[in] deflist list of name/type pairs defining the meta data entries to create in the metadata table.
 	/// \example [["doclen" "UINT16"], ["class" "INT8"]]
 	void defineMetaDataTable( const ValueVariant& deflist);
 
 	/// \brief Commit all insert or delete or user access right change statements of this transaction.
+	/// \note If group commit is enabled for the storage client, the document operations are recorded and the commit is merged with the commits of other transactions arriving within the time window. Errors in the document operations are reported by the commit then.
 	/// \remark throws an error on failure
 	void commit();
 
 	/// \brief Rollback all insert or delete or user access right change statements of this transaction.
 	void rollback();
 
+	/// \brief Start the commit of all insert or delete or user access right change statements of this transaction in a background thread and return immediately
+	/// \note The state of the commit is polled with 'commitState()' or waited for with 'waitCommit()'. Other methods of the transaction called while the commit is running throw an error
+	/// \note The background thread is a worker thread of the context (configuration 'workerthreads'), if none is available the commit is done in the calling thread before returning
+	void commitAsync();
+
+	/// \brief Get the state of the last commit started with 'commitAsync()' without blocking
+	/// \return structure with the state (state) one of "idle","running","done","failed" and the error message (error) if the commit failed
+	/// \example [ state: "running" ]
+	/// \example [ state: "failed" error: "error in commit transaction: out of disk space" ]
+	Struct commitState() const;
+
+	/// \brief Wait for the commit started with 'commitAsync()' to finish
+	/// \remark throws the error of the commit if it failed
+	void waitCommit();
+
 private:
 	friend class StorageClientImpl;
-	StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& storage_);
+	StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_, const ObjectRef& zonemap_, const ObjectRef& groupcommit_);
 
 	friend class InserterTransactionImpl;
-	StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& storage_, const ObjectRef& transaction_)
-		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_transaction_impl(transaction_){}
+	StorageTransactionImpl( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& errorhnd_, const ObjectRef& workerslots_, const ObjectRef& storage_, const ObjectRef& transaction_, const ObjectRef& zonemap_)
+		:m_errorhnd_impl(errorhnd_),m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_workerslots_impl(workerslots_),m_storage_impl(storage_),m_transaction_impl(transaction_),m_zonemap_impl(zonemap_),m_zonemap_docnos(),m_zonemap_reset(false),m_groupcommit_impl(),m_operations_impl(),m_asynccommit_impl(){}
+
+	/// \brief Remember a document changed for invalidating its block in the meta data zone map on commit
+	void zoneMapDocumentChanged( const std::string& docid);
+	/// \brief Invalidate the blocks of the documents changed or the whole meta data zone map after a successful commit
+	void zoneMapCommitted();
+
+	/// \brief Apply the operations on documents to a transaction
+	void applyInsertDocument( StorageTransactionInterface* transaction, const std::string& docid, const ValueVariant& doc);
+	void applyUpdateDocument( StorageTransactionInterface* transaction, const std::string& docid, const ValueVariant& content, const ValueVariant& deletes);
+	void applyDeleteDocument( StorageTransactionInterface* transaction, const std::string& docid);
+	void applyDeleteUserAccessRights( StorageTransactionInterface* transaction, const std::string& username);
+	/// \brief Apply the operations recorded for a group commit to a transaction
+	void applyOperations( StorageTransactionInterface* transaction);
+
+	friend class StorageTransactionGroupMember;
+
+	/// \brief Commit the transaction, called by 'commit()' or by the background thread of 'commitAsync()'
+	void commitTransaction();
+	/// \brief Throw an error if a commit started with 'commitAsync()' is running
+	void checkAsyncCommitNotRunning() const;
+
+	friend class StorageTransactionAsyncCommitJob;
 
 	friend class QueryImpl;
 	friend class QueryEvalImpl;
 	mutable ObjectRef m_errorhnd_impl;
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
+	ObjectRef m_workerslots_impl;			// worker thread slots of the context, for the background thread of 'commitAsync()'
 	ObjectRef m_storage_impl;
 	ObjectRef m_transaction_impl;
+	ObjectRef m_zonemap_impl;
+	std::vector<Index> m_zonemap_docnos;		// documents changed, their blocks are invalidated in the zone map on commit
+	bool m_zonemap_reset;				// true if the meta data table has been changed and the zone map is invalidated completely on commit
+	ObjectRef m_groupcommit_impl;			// group commit queue of the storage client, if group commit is enabled
+	ObjectRef m_operations_impl;			// operations on documents recorded for a group commit
+	ObjectRef m_asynccommit_impl;			// commit running in the background started with 'commitAsync()', destroyed first
 };
 
 }}//namespace
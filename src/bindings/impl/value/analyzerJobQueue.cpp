@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Queue of query term expressions analyzed by a fixed set of background threads
+#include "impl/value/analyzerJobQueue.hpp"
+#include "impl/value/termExpression.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+AnalyzerJobQueue::AnalyzerJobQueue( int nofThreads_)
+	:m_mutex(),m_cond(),m_queue(),m_threads(),m_terminate(false)
+{
+	if (nofThreads_ <= 0) throw strus::runtime_error(_TXT("number of analyzer threads must be positive"));
+	try
+	{
+		int ti = 0;
+		for (; ti < nofThreads_; ++ti)
+		{
+			m_threads.push_back( new strus::thread( &AnalyzerJobQueue::run, this));
+		}
+	}
+	catch (...)
+	{
+		{
+			strus::unique_lock lock( m_mutex);
+			m_terminate = true;
+		}
+		m_cond.notify_all();
+		std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+		for (; ti != te; ++ti)
+		{
+			(*ti)->join();
+			delete *ti;
+		}
+		throw;
+	}
+}
+
+AnalyzerJobQueue::~AnalyzerJobQueue()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+	}
+	m_cond.notify_all();
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+}
+
+void AnalyzerJobQueue::push( TermExpression* job)
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_terminate) throw strus::runtime_error(_TXT("analyzer job queue has been stopped"));
+		m_queue.push_back( job);
+	}
+	m_cond.notify_one();
+}
+
+void AnalyzerJobQueue::run()
+{
+	for (;;)
+	{
+		TermExpression* job = 0;
+		{
+			strus::unique_lock lock( m_mutex);
+			while (m_queue.empty() && !m_terminate)
+			{
+				m_cond.wait( lock);
+			}
+			if (m_queue.empty()) break;
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+		job->runAnalyze();
+	}
+}
+
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_ANALYZER_JOB_QUEUE_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_ANALYZER_JOB_QUEUE_HPP_INCLUDED
+/// \brief Queue of query term expressions analyzed by a fixed set of background threads
+#include "strus/base/thread.hpp"
+#include <deque>
+#include <vector>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Forward declaration
+class TermExpression;
+
+/// \brief Queue of query term expressions analyzed by a fixed set of background threads
+/// \note Lets the features of a query be analyzed concurrently, the results are gathered when the term expressions are serialized
+class AnalyzerJobQueue
+{
+public:
+	/// \brief Constructor
+	/// \param[in] nofThreads_ number of background threads started
+	explicit AnalyzerJobQueue( int nofThreads_);
+	/// \brief Destructor, processes all jobs left in the queue and joins the background threads
+	virtual ~AnalyzerJobQueue();
+
+	/// \brief Push a term expression to analyze
+	/// \param[in] job term expression to analyze, must not be deleted before its analysis has completed
+	void push( TermExpression* job);
+
+	/// \brief Get the number of background threads
+	int nofThreads() const
+	{
+		return m_threads.size();
+	}
+
+private:
+	void run();
+
+private:
+	AnalyzerJobQueue( const AnalyzerJobQueue&){}		//... non copyable
+	void operator=( const AnalyzerJobQueue&){}		//... non copyable
+
+private:
+	strus::mutex m_mutex;				//< mutex for the queue monitor
+	strus::condition_variable m_cond;		//< signal for jobs available or termination
+	std::deque<TermExpression*> m_queue;		//< jobs waiting to be processed
+	std::vector<strus::thread*> m_threads;		//< background threads
+	bool m_terminate;				//< true, if the background threads should stop after the queue has been processed
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Commit of a transaction running in a background thread, with its state polled or waited for by the caller
+#include "impl/value/asyncCommit.hpp"
+#include "impl/value/workerThreadSlots.hpp"
+#include "strus/lib/error.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+AsyncCommit::AsyncCommit()
+	:m_mutex(),m_cond(),m_thread(0),m_worker(0),m_job(0),m_state(Idle),m_errmsg()
+{}
+
+AsyncCommit::~AsyncCommit()
+{
+	reset();
+}
+
+void AsyncCommit::start( AsyncCommitJob* job, const ObjectRef& workerslots)
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_state == Running)
+		{
+			delete job;
+			throw strus::runtime_error(_TXT("asynchronous commit started while another one is running"));
+		}
+	}
+	reset();
+	m_job = job;
+	m_state = Running;
+	try
+	{
+		m_worker = new WorkerThreadAllocation( workerslots, 1);
+		if (m_worker->nofThreads())
+		{
+			m_thread = new strus::thread( &AsyncCommit::run, this);
+		}
+		else
+		{
+			// ... no worker thread available, the background thread would not have a slot in the error buffer
+			run();
+		}
+	}
+	catch (...)
+	{
+		m_state = Idle;
+		m_job = 0;
+		delete job;
+		if (m_worker)
+		{
+			delete m_worker;
+			m_worker = 0;
+		}
+		throw;
+	}
+}
+
+AsyncCommit::State AsyncCommit::state() const
+{
+	strus::unique_lock lock( m_mutex);
+	return m_state;
+}
+
+AsyncCommit::State AsyncCommit::wait()
+{
+	strus::unique_lock lock( m_mutex);
+	while (m_state == Running)
+	{
+		m_cond.wait( lock);
+	}
+	return m_state;
+}
+
+std::string AsyncCommit::error() const
+{
+	strus::unique_lock lock( m_mutex);
+	return m_errmsg;
+}
+
+void AsyncCommit::reset()
+{
+	if (m_thread)
+	{
+		m_thread->join();
+		delete m_thread;
+		m_thread = 0;
+	}
+	if (m_worker)
+	{
+		delete m_worker;
+		m_worker = 0;
+	}
+	if (m_job)
+	{
+		delete m_job;
+		m_job = 0;
+	}
+	m_state = Idle;
+	m_errmsg.clear();
+}
+
+void AsyncCommit::run()
+{
+	std::string errmsg;
+	try
+	{
+		m_job->run();
+	}
+	catch (const std::bad_alloc&)
+	{
+		errmsg = _TXT("memory allocation error in asynchronous commit");
+	}
+	catch (const std::runtime_error& err)
+	{
+		errmsg = err.what();
+	}
+	{
+		strus::unique_lock lock( m_mutex);
+		if (errmsg.empty())
+		{
+			m_state = Done;
+		}
+		else
+		{
+			m_state = Failed;
+			m_errmsg = errmsg;
+		}
+	}
+	m_cond.notify_all();
+}
+
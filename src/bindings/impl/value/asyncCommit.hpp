@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_ASYNC_COMMIT_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_ASYNC_COMMIT_HPP_INCLUDED
+/// \brief Commit of a transaction running in a background thread, with its state polled or waited for by the caller
+#include "impl/value/objectref.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Forward declaration
+class WorkerThreadAllocation;
+
+/// \brief Commit job run by an asynchronous commit
+class AsyncCommitJob
+{
+public:
+	virtual ~AsyncCommitJob(){}
+
+	/// \brief Do the commit
+	/// \remark throws an error on failure
+	virtual void run()=0;
+};
+
+/// \brief Commit of a transaction running in a background thread
+/// \note Only one commit is running at a time, the thread is joined and its worker thread slot released when the result of the commit is fetched or on destruction
+class AsyncCommit
+{
+public:
+	enum State {Idle,Running,Done,Failed};
+
+	/// \brief Get the name of a state
+	static const char* stateName( State state)
+	{
+		static const char* ar[] = {"idle","running","done","failed",0};
+		return ar[ state];
+	}
+
+	AsyncCommit();
+	/// \brief Destructor, waits for the commit running to finish
+	~AsyncCommit();
+
+	/// \brief Start a commit in a background thread
+	/// \param[in] job the commit to run (with ownership)
+	/// \param[in] workerslots worker thread slots of the context, the commit is run in the calling thread if no slot is available
+	/// \remark throws an error if a commit is already running
+	void start( AsyncCommitJob* job, const ObjectRef& workerslots);
+
+	/// \brief Get the state of the last commit started without blocking
+	State state() const;
+
+	/// \brief Wait for the commit started to finish
+	/// \return the state of the commit finished
+	State wait();
+
+	/// \brief Get the error of the last commit failed
+	std::string error() const;
+
+	/// \brief Join the background thread of the commit finished and reset the state to idle
+	/// \remark waits for the commit to finish, if it is still running
+	void reset();
+
+private:
+	/// \brief Run the commit, called by the background thread
+	void run();
+
+private:
+	AsyncCommit( const AsyncCommit&){}		//... non copyable
+	void operator=( const AsyncCommit&){}		//... non copyable
+
+private:
+	mutable strus::mutex m_mutex;			//< mutex for the state
+	strus::condition_variable m_cond;		//< signal for the commit finished
+	strus::thread* m_thread;			//< background thread of the commit started
+	WorkerThreadAllocation* m_worker;		//< worker thread slot allocated for the background thread
+	AsyncCommitJob* m_job;				//< commit job started
+	State m_state;					//< state of the last commit started
+	std::string m_errmsg;				//< error of the last commit failed
+};
+
+}}//namespace
+#endif
+
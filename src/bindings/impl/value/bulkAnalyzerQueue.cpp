@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Bounded queue of documents analyzed from a list of files by a fixed set of background threads
+#include "impl/value/bulkAnalyzerQueue.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/lib/error.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <sys/time.h>
+
+using namespace strus;
+using namespace strus::bindings;
+
+BulkAnalyzerQueue::BulkAnalyzerQueue(
+		const DocumentAnalyzerInstanceInterface* analyzer_,
+		const TextProcessorInterface* textproc_,
+		ErrorBufferInterface* errorhnd_,
+		const std::vector<std::string>& files_,
+		const analyzer::DocumentClass& dclass_,
+		unsigned int nofThreads_,
+		unsigned int queueSize_)
+	:m_analyzer(analyzer_),m_textproc(textproc_),m_errorhnd(errorhnd_)
+	,m_files(files_),m_dclass(dclass_),m_queueSize(queueSize_?queueSize_:(unsigned int)DefaultQueueSize)
+	,m_mutex(),m_notEmpty(),m_notFull(),m_queue(),m_threads(),m_fileidx(0),m_nofRunning(0),m_terminate(false),m_errmsg(),m_statistics()
+{
+	if (!nofThreads_) nofThreads_ = DefaultNofThreads;
+	try
+	{
+		unsigned int ti = 0;
+		for (; ti < nofThreads_; ++ti)
+		{
+			{
+				strus::unique_lock lock( m_mutex);
+				++m_nofRunning;
+			}
+			try
+			{
+				m_threads.push_back( new strus::thread( &BulkAnalyzerQueue::run, this));
+			}
+			catch (...)
+			{
+				strus::unique_lock lock( m_mutex);
+				--m_nofRunning;
+				throw;
+			}
+		}
+	}
+	catch (...)
+	{
+		clear();
+		throw;
+	}
+}
+
+BulkAnalyzerQueue::~BulkAnalyzerQueue()
+{
+	clear();
+}
+
+void BulkAnalyzerQueue::clear()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+	}
+	m_notFull.notify_all();
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+	m_threads.clear();
+	std::deque<analyzer::Document*>::iterator qi = m_queue.begin(), qe = m_queue.end();
+	for (; qi != qe; ++qi)
+	{
+		delete *qi;
+	}
+	m_queue.clear();
+}
+
+double BulkAnalyzerQueue::currentTime()
+{
+	struct timeval tv;
+	::gettimeofday( &tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+BulkAnalyzerQueue::Statistics BulkAnalyzerQueue::statistics() const
+{
+	strus::unique_lock lock( m_mutex);
+	return m_statistics;
+}
+
+analyzer::Document* BulkAnalyzerQueue::fetch()
+{
+	analyzer::Document* rt = 0;
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_queue.empty() && m_nofRunning && m_errmsg.empty())
+		{
+			double starttime = currentTime();
+			++m_statistics.consumerStalls;
+			while (m_queue.empty() && m_nofRunning && m_errmsg.empty())
+			{
+				m_notEmpty.wait( lock);
+			}
+			m_statistics.consumerStallTime += currentTime() - starttime;
+		}
+		if (!m_errmsg.empty())
+		{
+			throw strus::runtime_error( "%s", m_errmsg.c_str());
+		}
+		if (m_queue.empty()) return 0;
+		rt = m_queue.front();
+		m_queue.pop_front();
+	}
+	m_notFull.notify_one();
+	return rt;
+}
+
+bool BulkAnalyzerQueue::push( analyzer::Document* doc)
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_queue.size() >= m_queueSize && !m_terminate)
+		{
+			double starttime = currentTime();
+			++m_statistics.producerStalls;
+			while (m_queue.size() >= m_queueSize && !m_terminate)
+			{
+				m_notFull.wait( lock);
+			}
+			m_statistics.producerStallTime += currentTime() - starttime;
+		}
+		if (m_terminate)
+		{
+			delete doc;
+			return false;
+		}
+		m_queue.push_back( doc);
+		++m_statistics.nofDocuments;
+	}
+	m_notEmpty.notify_one();
+	return true;
+}
+
+bool BulkAnalyzerQueue::analyzeFile( const std::string& filename)
+{
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read file '%s' to load: %s"), filename.c_str(), ::strerror(ec));
+
+	analyzer::DocumentClass dclass = m_dclass;
+	if (!dclass.defined())
+	{
+		enum {MaxHdrSize = 8092};
+		std::size_t hdrsize = content.size() > MaxHdrSize ? MaxHdrSize : content.size();
+		if (!m_textproc->detectDocumentClass( dclass, content.c_str(), hdrsize, MaxHdrSize < content.size()))
+		{
+			if (m_errorhnd->hasError())
+			{
+				throw strus::runtime_error( _TXT("failed to detect document class of file '%s': %s"), filename.c_str(), m_errorhnd->fetchError());
+			}
+			throw strus::runtime_error( _TXT("could not detect document class of file '%s'"), filename.c_str());
+		}
+	}
+	strus::local_ptr<DocumentAnalyzerContextInterface> analyzerContext( m_analyzer->createContext( dclass));
+	if (!analyzerContext.get()) throw strus::runtime_error( _TXT("failed to create analyzer context for file '%s': %s"), filename.c_str(), m_errorhnd->fetchError());
+	analyzerContext->putInput( content.c_str(), content.size(), true/*eof*/);
+
+	strus::local_ptr<analyzer::Document> doc( new analyzer::Document());
+	while (analyzerContext->analyzeNext( *doc))
+	{
+		if (!push( doc.release())) return false;
+		doc.reset( new analyzer::Document());
+	}
+	if (m_errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to analyze file '%s': %s"), filename.c_str(), m_errorhnd->fetchError());
+	}
+	return true;
+}
+
+void BulkAnalyzerQueue::run()
+{
+	try
+	{
+		for (;;)
+		{
+			std::string filename;
+			{
+				strus::unique_lock lock( m_mutex);
+				if (m_terminate || m_fileidx >= m_files.size()) break;
+				filename = m_files[ m_fileidx++];
+			}
+			if (!analyzeFile( filename)) break;
+			{
+				strus::unique_lock lock( m_mutex);
+				++m_statistics.nofFiles;
+			}
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_errmsg.empty()) m_errmsg = _TXT("memory allocation error in bulk load analyzer thread");
+		m_terminate = true;
+	}
+	catch (const std::runtime_error& err)
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_errmsg.empty()) m_errmsg = err.what();
+		m_terminate = true;
+	}
+	{
+		strus::unique_lock lock( m_mutex);
+		--m_nofRunning;
+	}
+	m_notEmpty.notify_all();
+	m_notFull.notify_all();
+}
+
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_BULK_ANALYZER_QUEUE_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_BULK_ANALYZER_QUEUE_HPP_INCLUDED
+/// \brief Bounded queue of documents analyzed from a list of files by a fixed set of background threads
+#include "strus/base/thread.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class DocumentAnalyzerInstanceInterface;
+/// \brief Forward declaration
+class TextProcessorInterface;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+namespace bindings {
+
+/// \brief Bounded queue of documents analyzed from a list of files by a fixed set of background threads
+/// \note The background threads take the files one by one and block if the queue is full, the documents are consumed by the thread calling 'fetch'
+class BulkAnalyzerQueue
+{
+public:
+	enum {
+		DefaultNofThreads=4,		//< number of background threads if not specified
+		DefaultQueueSize=256		//< maximum number of documents analyzed and not consumed yet if not specified
+	};
+
+	/// \brief Counters of the queue for reporting throughput and stalls
+	struct Statistics
+	{
+		int nofFiles;			//< number of files analyzed completely
+		int nofDocuments;		//< number of documents analyzed
+		int producerStalls;		//< number of times a background thread waited for the queue not being full
+		double producerStallTime;	//< total time in seconds background threads waited for the queue not being full
+		int consumerStalls;		//< number of times the consumer waited for a document
+		double consumerStallTime;	//< total time in seconds the consumer waited for a document
+
+		Statistics()
+			:nofFiles(0),nofDocuments(0),producerStalls(0),producerStallTime(0.0),consumerStalls(0),consumerStallTime(0.0){}
+		Statistics( const Statistics& o)
+			:nofFiles(o.nofFiles),nofDocuments(o.nofDocuments),producerStalls(o.producerStalls),producerStallTime(o.producerStallTime),consumerStalls(o.consumerStalls),consumerStallTime(o.consumerStallTime){}
+	};
+
+	/// \brief Constructor, starts the background threads
+	/// \param[in] analyzer_ document analyzer used by all threads
+	/// \param[in] textproc_ text processor used for detecting the document class if not specified
+	/// \param[in] errorhnd_ error buffer interface
+	/// \param[in] files_ list of files to analyze
+	/// \param[in] dclass_ document class of all files or undefined for detecting the class of each file
+	/// \param[in] nofThreads_ number of background threads started, each of them needs a slot in the error buffer reserved (see WorkerThreadSlots)
+	/// \param[in] queueSize_ maximum number of documents analyzed and not consumed yet
+	BulkAnalyzerQueue(
+			const DocumentAnalyzerInstanceInterface* analyzer_,
+			const TextProcessorInterface* textproc_,
+			ErrorBufferInterface* errorhnd_,
+			const std::vector<std::string>& files_,
+			const analyzer::DocumentClass& dclass_,
+			unsigned int nofThreads_,
+			unsigned int queueSize_);
+	/// \brief Destructor, stops the background threads and deletes the documents not consumed
+	virtual ~BulkAnalyzerQueue();
+
+	/// \brief Get the next document analyzed, blocks until one is available
+	/// \return the document (ownership passed to the caller) or NULL if all files have been analyzed
+	/// \remark throws the first error reported by a background thread
+	analyzer::Document* fetch();
+
+	/// \brief Get the number of background threads
+	unsigned int nofThreads() const
+	{
+		return m_threads.size();
+	}
+
+	/// \brief Get a snapshot of the counters
+	Statistics statistics() const;
+
+	/// \brief Get the current time in seconds with microsecond resolution, for measuring durations
+	static double currentTime();
+
+private:
+	/// \brief Analyze files, run by a background thread
+	void run();
+	/// \brief Analyze one file and push its documents into the queue
+	/// \return false if the queue has been stopped
+	bool analyzeFile( const std::string& filename);
+	/// \brief Push a document into the queue, blocks while the queue is full
+	/// \return false if the queue has been stopped, the document is deleted then
+	bool push( analyzer::Document* doc);
+	/// \brief Stop the background threads and delete the documents not consumed
+	void clear();
+
+private:
+	BulkAnalyzerQueue( const BulkAnalyzerQueue&){}		//... non copyable
+	void operator=( const BulkAnalyzerQueue&){}		//... non copyable
+
+private:
+	const DocumentAnalyzerInstanceInterface* m_analyzer;
+	const TextProcessorInterface* m_textproc;
+	ErrorBufferInterface* m_errorhnd;
+	std::vector<std::string> m_files;		//< files to analyze
+	analyzer::DocumentClass m_dclass;		//< document class of all files or undefined
+	unsigned int m_queueSize;
+	mutable strus::mutex m_mutex;			//< mutex for the queue monitor
+	strus::condition_variable m_notEmpty;		//< signal for documents available or all threads finished
+	strus::condition_variable m_notFull;		//< signal for space in the queue or termination
+	std::deque<analyzer::Document*> m_queue;	//< documents analyzed and not consumed yet
+	std::vector<strus::thread*> m_threads;		//< background threads
+	std::size_t m_fileidx;				//< index of the next file to analyze
+	unsigned int m_nofRunning;			//< number of background threads not finished yet
+	bool m_terminate;				//< true, if the background threads should stop
+	std::string m_errmsg;				//< first error reported by a background thread
+	Statistics m_statistics;
+};
+
+}}//namespace
+#endif
+
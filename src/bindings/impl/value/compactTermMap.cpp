@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Immutable map of terms to their df with front coded term values and varint packed df values
+#include "impl/value/compactTermMap.hpp"
+#include "impl/value/varintEncoding.hpp"
+#include "private/internationalization.hpp"
+#include "strus/lib/error.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+/// \brief Estimated allocation overhead of a node of a std::map
+#define MAP_NODE_OVERHEAD 48
+
+static std::size_t commonPrefixLength( const std::string& a, const std::string& b)
+{
+	std::size_t rt = 0;
+	for (; rt < a.size() && rt < b.size() && a[rt] == b[rt]; ++rt){}
+	return rt;
+}
+
+void CompactTermMap::append( const std::string& type, const std::string& value, GlobalCounter df)
+{
+	if (!m_typemap.empty() && type < m_typemap.rbegin()->first)
+	{
+		throw strus::runtime_error(_TXT("terms of a compact term map not appended in ascending order"));
+	}
+	TypeDict& dict = m_typemap[ type];
+	if (dict.nofTerms && !(dict.last < value))
+	{
+		throw strus::runtime_error(_TXT("terms of a compact term map not appended in ascending order"));
+	}
+	std::size_t prefixlen = 0;
+	if (dict.nofTerms % BlockSize == 0)
+	{
+		dict.blockofs.push_back( dict.data.size());
+	}
+	else
+	{
+		prefixlen = commonPrefixLength( dict.last, value);
+	}
+	appendVarint( dict.data, prefixlen);
+	appendVarint( dict.data, value.size() - prefixlen);
+	dict.data.append( value.c_str() + prefixlen, value.size() - prefixlen);
+	appendVarint( dict.data, (unsigned long long)(df > 0 ? df : 0));
+	dict.last = value;
+	++dict.nofTerms;
+	++m_nofTerms;
+}
+
+std::size_t CompactTermMap::decodeEntry( const std::string& data, std::size_t pos, std::string& value, GlobalCounter& df)
+{
+	std::size_t prefixlen = readVarint( data, pos);
+	std::size_t suffixlen = readVarint( data, pos);
+	if (prefixlen > value.size() || pos + suffixlen > data.size())
+	{
+		throw strus::runtime_error(_TXT("corrupt compact term map: %s"), _TXT("entry out of range"));
+	}
+	value.resize( prefixlen);
+	value.append( data.c_str() + pos, suffixlen);
+	pos += suffixlen;
+	df = (GlobalCounter)readVarint( data, pos);
+	return pos;
+}
+
+GlobalCounter CompactTermMap::df( const std::string& type, const std::string& value) const
+{
+	GlobalCounter rt = 0;
+	return find( type, value, rt) ? rt : 0;
+}
+
+bool CompactTermMap::find( const std::string& type, const std::string& value, GlobalCounter& df_) const
+{
+	TypeMap::const_iterator ti = m_typemap.find( type);
+	if (ti == m_typemap.end()) return false;
+	const TypeDict& dict = ti->second;
+
+	// ... binary search for the last block with a first value not bigger than the value searched
+	std::size_t lo = 0, hi = dict.blockofs.size();
+	std::string blockvalue;
+	GlobalCounter blockdf = 0;
+	while (hi - lo > 1)
+	{
+		std::size_t mid = (lo + hi) / 2;
+		blockvalue.clear();
+		decodeEntry( dict.data, dict.blockofs[ mid], blockvalue, blockdf);
+		if (value < blockvalue)
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid;
+		}
+	}
+	if (lo >= dict.blockofs.size()) return false;
+
+	// ... linear scan of the block
+	std::size_t pos = dict.blockofs[ lo];
+	std::size_t end = lo+1 < dict.blockofs.size() ? dict.blockofs[ lo+1] : dict.data.size();
+	std::string entryvalue;
+	GlobalCounter entrydf = 0;
+	while (pos < end)
+	{
+		pos = decodeEntry( dict.data, pos, entryvalue, entrydf);
+		if (entryvalue == value)
+		{
+			df_ = entrydf;
+			return true;
+		}
+		if (value < entryvalue) break;
+	}
+	return false;
+}
+
+std::size_t CompactTermMap::memorySize() const
+{
+	std::size_t rt = sizeof(*this);
+	TypeMap::const_iterator ti = m_typemap.begin(), te = m_typemap.end();
+	for (; ti != te; ++ti)
+	{
+		rt += MAP_NODE_OVERHEAD + sizeof(TypeMap::value_type);
+		rt += ti->first.capacity() + ti->second.data.capacity() + ti->second.last.capacity();
+		rt += ti->second.blockofs.capacity() * sizeof(unsigned int);
+	}
+	return rt;
+}
+
+CompactTermMap::Iterator::Iterator( const CompactTermMap& map_)
+	:m_map(&map_),m_ti(map_.m_typemap.begin()),m_pos(0),m_value(),m_df(0)
+{}
+
+bool CompactTermMap::Iterator::next()
+{
+	while (m_ti != m_map->m_typemap.end() && m_pos >= m_ti->second.data.size())
+	{
+		++m_ti;
+		m_pos = 0;
+		m_value.clear();
+	}
+	if (m_ti == m_map->m_typemap.end()) return false;
+	m_pos = decodeEntry( m_ti->second.data, m_pos, m_value, m_df);
+	return true;
+}
+
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_COMPACT_TERM_MAP_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_COMPACT_TERM_MAP_HPP_INCLUDED
+/// \brief Immutable map of terms to their df with front coded term values and varint packed df values
+#include "strus/storage/index.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Immutable map of terms to their df with front coded term values and varint packed df values
+/// \note The map is built by appending the terms in ascending order of type and value
+class CompactTermMap
+{
+private:
+	/// \brief Term values of one type, packed in blocks of BlockSize entries with the first value of each block stored completely
+	struct TypeDict
+	{
+		std::string data;			//< entries as [varint prefix length][varint suffix length][suffix][varint df]
+		std::vector<unsigned int> blockofs;	//< start offsets of the blocks in data
+		std::string last;			//< last value appended, for computing the common prefix of the next
+		std::size_t nofTerms;
+
+		TypeDict()
+			:data(),blockofs(),last(),nofTerms(0){}
+		TypeDict( const TypeDict& o)
+			:data(o.data),blockofs(o.blockofs),last(o.last),nofTerms(o.nofTerms){}
+	};
+	typedef std::map<std::string,TypeDict> TypeMap;
+
+public:
+	enum {BlockSize=16};
+
+	/// \brief Constructor of an empty map
+	CompactTermMap()
+		:m_typemap(),m_nofTerms(0){}
+	CompactTermMap( const CompactTermMap& o)
+		:m_typemap(o.m_typemap),m_nofTerms(o.m_nofTerms){}
+
+	/// \brief Append a term, terms have to be appended in strictly ascending order of type and value
+	/// \param[in] type type of the term
+	/// \param[in] value value of the term
+	/// \param[in] df document frequency of the term
+	void append( const std::string& type, const std::string& value, GlobalCounter df);
+
+	/// \brief Get the df of a term
+	/// \return the df or 0 if the term is not in the map
+	GlobalCounter df( const std::string& type, const std::string& value) const;
+
+	/// \brief Find a term
+	/// \param[out] df_ the df of the term found, also if it is 0
+	/// \return true if the term is in the map
+	bool find( const std::string& type, const std::string& value, GlobalCounter& df_) const;
+
+	/// \brief Get the number of terms in the map
+	std::size_t size() const
+	{
+		return m_nofTerms;
+	}
+
+	/// \brief Get the number of bytes allocated by the map
+	std::size_t memorySize() const;
+
+	/// \brief Iterator on the terms of the map in ascending order
+	class Iterator
+	{
+	public:
+		explicit Iterator( const CompactTermMap& map_);
+
+		/// \brief Skip to the next term
+		/// \return false if there is no term left
+		bool next();
+
+		const std::string& type() const		{return m_ti->first;}
+		const std::string& value() const	{return m_value;}
+		GlobalCounter df() const		{return m_df;}
+
+	private:
+		const CompactTermMap* m_map;
+		TypeMap::const_iterator m_ti;
+		std::size_t m_pos;
+		std::string m_value;
+		GlobalCounter m_df;
+	};
+
+private:
+	friend class Iterator;
+	/// \brief Decode the entry at a position of a type dictionary
+	/// \param[in,out] value previous value decoded in the same block, replaced by the value decoded
+	/// \param[out] df the df decoded
+	/// \return the position of the next entry
+	static std::size_t decodeEntry( const std::string& data, std::size_t pos, std::string& value, GlobalCounter& df);
+
+private:
+	TypeMap m_typemap;
+	std::size_t m_nofTerms;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Count-min sketch for estimating the df of terms not counted exactly
+#include "impl/value/countMinSketch.hpp"
+#include "impl/value/varintEncoding.hpp"
+#include "private/internationalization.hpp"
+#include "strus/lib/error.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+CountMinSketch::CountMinSketch( unsigned int width_, unsigned int depth_)
+	:m_width(width_),m_depth(depth_),m_total(0),m_ar(0)
+{
+	if (!m_width || !m_depth) throw strus::runtime_error(_TXT("width and depth of a count-min sketch must not be 0"));
+	m_ar = new Counter[ (std::size_t)m_width * m_depth];
+}
+
+CountMinSketch::~CountMinSketch()
+{
+	delete [] m_ar;
+}
+
+void CountMinSketch::getHash( unsigned int& h1, unsigned int& h2, const std::string& type, const std::string& value) const
+{
+	// ... FNV-1a 64 bit hash of type and value separated by a 0 byte, split into two 32 bit hashes for double hashing
+	unsigned long long hh = 14695981039346656037ULL;
+	std::string::const_iterator si = type.begin(), se = type.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 1099511628211ULL;
+	}
+	hh *= 1099511628211ULL;
+	si = value.begin(), se = value.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 1099511628211ULL;
+	}
+	h1 = (unsigned int)(hh & 0xffffFFFFULL);
+	h2 = (unsigned int)(hh >> 32) | 1;
+}
+
+void CountMinSketch::add( const std::string& type, const std::string& value, int increment)
+{
+	unsigned int h1,h2;
+	getHash( h1, h2, type, value);
+	unsigned int ri = 0;
+	for (; ri < m_depth; ++ri)
+	{
+		// ... the writers are serialized, only the readers run concurrently
+		Counter& cnt = m_ar[ (std::size_t)ri * m_width + (h1 + ri * h2) % m_width];
+		int cntval = cnt.value();
+		cnt.set( cntval + increment > 0 ? cntval + increment : 0);
+	}
+	GlobalCounter total = m_total.value();
+	m_total.set( total + increment > 0 ? total + increment : 0);
+}
+
+void CountMinSketch::clear()
+{
+	std::size_t ai = 0, ae = (std::size_t)m_width * m_depth;
+	for (; ai != ae; ++ai)
+	{
+		m_ar[ ai].set( 0);
+	}
+	m_total.set( 0);
+}
+
+GlobalCounter CountMinSketch::estimate( const std::string& type, const std::string& value) const
+{
+	unsigned int h1,h2;
+	getHash( h1, h2, type, value);
+	int rt = m_ar[ h1 % m_width].value();
+	unsigned int ri = 1;
+	for (; ri < m_depth; ++ri)
+	{
+		int cnt = m_ar[ (std::size_t)ri * m_width + (h1 + ri * h2) % m_width].value();
+		if (cnt < rt) rt = cnt;
+	}
+	return rt;
+}
+
+GlobalCounter CountMinSketch::errorBound() const
+{
+	// ... e/width * total
+	return (GlobalCounter)(((double)m_total.value() * 2.718281828) / m_width + 0.5);
+}
+
+void CountMinSketch::serialize( std::string& dest) const
+{
+	appendVarint( dest, m_width);
+	appendVarint( dest, m_depth);
+	appendVarint( dest, (unsigned long long)m_total.value());
+	std::size_t ai = 0, ae = (std::size_t)m_width * m_depth;
+	for (; ai != ae; ++ai)
+	{
+		appendVarint( dest, (unsigned long long)m_ar[ ai].value());
+	}
+}
+
+void CountMinSketch::deserialize( const std::string& src, std::size_t& pos)
+{
+	unsigned int width = readVarint( src, pos);
+	unsigned int depth = readVarint( src, pos);
+	if (width != m_width || depth != m_depth)
+	{
+		throw strus::runtime_error(_TXT("dimensions of serialized count-min sketch (%u x %u) differ from the configured (%u x %u)"), width, depth, m_width, m_depth);
+	}
+	m_total.set( (GlobalCounter)readVarint( src, pos));
+	std::size_t ai = 0, ae = (std::size_t)m_width * m_depth;
+	for (; ai != ae; ++ai)
+	{
+		m_ar[ ai].set( (int)readVarint( src, pos));
+	}
+}
+
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_COUNT_MIN_SKETCH_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_COUNT_MIN_SKETCH_HPP_INCLUDED
+/// \brief Count-min sketch for estimating the df of terms not counted exactly
+#include "strus/storage/index.hpp"
+#include "strus/base/atomic.hpp"
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Count-min sketch for estimating the df of terms not counted exactly
+/// \note The estimate of a term is never smaller than its df and exceeds it by at most e/width times the total of all df counted
+///	with a probability of 1-exp(-depth), as long as no df gets negative
+/// \note The counters are atomic, the sketch can be read while it is updated, but the writers have to be serialized
+class CountMinSketch
+{
+public:
+	/// \brief Constructor
+	/// \param[in] width_ number of counters per row
+	/// \param[in] depth_ number of rows (hash functions)
+	CountMinSketch( unsigned int width_, unsigned int depth_);
+	/// \brief Destructor
+	~CountMinSketch();
+
+	/// \brief Add a change of the df of a term
+	void add( const std::string& type, const std::string& value, int increment);
+	/// \brief Get the estimated df of a term
+	GlobalCounter estimate( const std::string& type, const std::string& value) const;
+
+	unsigned int width() const		{return m_width;}
+	unsigned int depth() const		{return m_depth;}
+	/// \brief Get the total of all df counted
+	GlobalCounter total() const		{return m_total.value();}
+	/// \brief Get the bound of the estimation error holding with a probability of 1-exp(-depth)
+	GlobalCounter errorBound() const;
+	/// \brief Get the number of bytes allocated by the counters
+	std::size_t memorySize() const		{return (std::size_t)m_width * m_depth * sizeof(Counter);}
+
+	/// \brief Reset all counters to 0
+	void clear();
+
+	/// \brief Append the sketch to a buffer
+	void serialize( std::string& dest) const;
+	/// \brief Load the counters of a serialized sketch with the same dimensions
+	/// \param[in] src buffer with the serialization
+	/// \param[in,out] pos start position of the serialization, moved to its end
+	void deserialize( const std::string& src, std::size_t& pos);
+
+private:
+	CountMinSketch( const CountMinSketch&){}		//... non copyable
+	void operator=( const CountMinSketch&){}		//... non copyable
+
+	void getHash( unsigned int& h1, unsigned int& h2, const std::string& type, const std::string& value) const;
+
+private:
+	typedef strus::AtomicCounter<int> Counter;
+
+	unsigned int m_width;
+	unsigned int m_depth;
+	strus::AtomicCounter<GlobalCounter> m_total;
+	Counter* m_ar;					//< matrix of m_depth rows with m_width counters
+};
+
+}}//namespace
+#endif
+
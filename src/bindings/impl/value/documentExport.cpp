@@ -0,0 +1,668 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Streaming export and import of the documents of a storage in a compact binary format with checksums
+#include "impl/value/documentExport.hpp"
+#include "impl/value/varintEncoding.hpp"
+#include "private/internationalization.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/constants.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/storageTransactionInterface.hpp"
+#include "strus/storageDocumentInterface.hpp"
+#include "strus/attributeReaderInterface.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "strus/aclReaderInterface.hpp"
+#include "strus/forwardIteratorInterface.hpp"
+#include "strus/documentTermIteratorInterface.hpp"
+#include "strus/postingIteratorInterface.hpp"
+#include "strus/valueIteratorInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/reference.hpp"
+#include <set>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+
+using namespace strus;
+using namespace strus::bindings;
+
+#define DOCUMENT_EXPORT_MAGIC "strus document export 1\n"
+
+enum MetaDataTag {MetaDataNull=0,MetaDataInt=1,MetaDataUInt=2,MetaDataFloat=3};
+
+namespace {
+/// \brief Table of the CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) of all byte values
+struct Crc32Table
+{
+	unsigned int ar[ 256];
+
+	Crc32Table()
+	{
+		unsigned int ti = 0;
+		for (; ti < 256; ++ti)
+		{
+			unsigned int cc = ti;
+			int bi = 0;
+			for (; bi < 8; ++bi) cc = (cc & 1) ? (0xEDB88320U ^ (cc >> 1)) : (cc >> 1);
+			ar[ ti] = cc;
+		}
+	}
+};
+}//anonymous namespace
+
+static unsigned int crc32( const std::string& data)
+{
+	// ... initialization of function local statics is thread safe
+	static const Crc32Table table;
+	unsigned int rt = 0xFFFFFFFFU;
+	std::string::const_iterator di = data.begin(), de = data.end();
+	for (; di != de; ++di)
+	{
+		rt = table.ar[ (rt ^ (unsigned char)*di) & 0xff] ^ (rt >> 8);
+	}
+	return rt ^ 0xFFFFFFFFU;
+}
+
+static void appendUInt64( std::string& dest, uint64_t val)
+{
+	// ... 8 bytes little endian
+	char ar[ 8];
+	for (int bi=0; bi<8; ++bi,val>>=8) ar[ bi] = (char)(unsigned char)(val & 0xff);
+	dest.append( ar, 8);
+}
+
+static uint64_t readUInt64( const std::string& src, std::size_t& pos)
+{
+	if (pos + 8 > src.size()) throw strus::runtime_error(_TXT("corrupt document export record: %s"), _TXT("unexpected end of data"));
+	uint64_t rt = 0;
+	for (int bi=7; bi>=0; --bi) rt = (rt << 8) | (unsigned char)src[ pos+bi];
+	pos += 8;
+	return rt;
+}
+
+static void appendNumeric( std::string& dest, const NumericVariant& val)
+{
+	switch (val.type)
+	{
+		case NumericVariant::Null:
+			dest.push_back( (char)MetaDataNull);
+			break;
+		case NumericVariant::Int:
+			// ... zigzag encoding for small negative values in few bytes
+			dest.push_back( (char)MetaDataInt);
+			appendVarint( dest, ((uint64_t)val.variant.Int << 1) ^ (uint64_t)(val.variant.Int >> 63));
+			break;
+		case NumericVariant::UInt:
+			dest.push_back( (char)MetaDataUInt);
+			appendVarint( dest, val.variant.UInt);
+			break;
+		case NumericVariant::Float:
+		{
+			uint64_t uval;
+			std::memcpy( &uval, &val.variant.Float, 8);
+			dest.push_back( (char)MetaDataFloat);
+			appendUInt64( dest, uval);
+			break;
+		}
+	}
+}
+
+static NumericVariant readNumeric( const std::string& src, std::size_t& pos)
+{
+	if (pos >= src.size()) throw strus::runtime_error(_TXT("corrupt document export record: %s"), _TXT("unexpected end of data"));
+	switch ((MetaDataTag)(unsigned char)src[ pos++])
+	{
+		case MetaDataNull:
+			return NumericVariant();
+		case MetaDataInt:
+		{
+			uint64_t uval = readVarint( src, pos);
+			return NumericVariant( (NumericVariant::IntType)((uval >> 1) ^ (~(uval & 1) + 1)));
+		}
+		case MetaDataUInt:
+			return NumericVariant( (NumericVariant::UIntType)readVarint( src, pos));
+		case MetaDataFloat:
+		{
+			uint64_t uval = readUInt64( src, pos);
+			double fval;
+			std::memcpy( &fval, &uval, 8);
+			return NumericVariant( fval);
+		}
+	}
+	throw strus::runtime_error(_TXT("corrupt document export record: %s"), _TXT("unknown meta data value type"));
+}
+
+static void appendPositions( std::string& dest, const std::vector<Index>& pos)
+{
+	// ... positions as differences to their predecessor
+	appendVarint( dest, pos.size());
+	Index prev = 0;
+	std::vector<Index>::const_iterator pi = pos.begin(), pe = pos.end();
+	for (; pi != pe; prev = *pi, ++pi)
+	{
+		appendVarint( dest, *pi - prev);
+	}
+}
+
+static std::vector<Index> readPositions( const std::string& src, std::size_t& pos)
+{
+	std::vector<Index> rt;
+	std::size_t size = readVarint( src, pos);
+	if (size > src.size() - pos) throw strus::runtime_error(_TXT("corrupt document export record: %s"), _TXT("position list out of range"));
+	rt.reserve( size);
+	Index prev = 0;
+	std::size_t pi = 0;
+	for (; pi < size; ++pi)
+	{
+		prev += (Index)readVarint( src, pos);
+		rt.push_back( prev);
+	}
+	return rt;
+}
+
+void ExportDocument::serialize( std::string& dest) const
+{
+	appendVarintString( dest, docid);
+
+	appendVarint( dest, attributes.size());
+	std::vector<std::pair<std::string,std::string> >::const_iterator ai = attributes.begin(), ae = attributes.end();
+	for (; ai != ae; ++ai)
+	{
+		appendVarintString( dest, ai->first);
+		appendVarintString( dest, ai->second);
+	}
+	appendVarint( dest, metadata.size());
+	std::vector<std::pair<std::string,NumericVariant> >::const_iterator mi = metadata.begin(), me = metadata.end();
+	for (; mi != me; ++mi)
+	{
+		appendVarintString( dest, mi->first);
+		appendNumeric( dest, mi->second);
+	}
+	appendVarint( dest, users.size());
+	std::vector<std::string>::const_iterator ui = users.begin(), ue = users.end();
+	for (; ui != ue; ++ui)
+	{
+		appendVarintString( dest, *ui);
+	}
+	appendVarint( dest, searchIndex.size());
+	std::vector<SearchTermList>::const_iterator si = searchIndex.begin(), se = searchIndex.end();
+	for (; si != se; ++si)
+	{
+		appendVarintString( dest, si->type);
+		appendVarint( dest, si->terms.size());
+		std::vector<SearchTerm>::const_iterator ti = si->terms.begin(), te = si->terms.end();
+		for (; ti != te; ++ti)
+		{
+			appendVarintString( dest, ti->value);
+			appendPositions( dest, ti->pos);
+		}
+	}
+	appendVarint( dest, forwardIndex.size());
+	std::vector<ForwardTermList>::const_iterator fi = forwardIndex.begin(), fe = forwardIndex.end();
+	for (; fi != fe; ++fi)
+	{
+		appendVarintString( dest, fi->type);
+		appendVarint( dest, fi->terms.size());
+		Index prev = 0;
+		std::vector<std::pair<Index,std::string> >::const_iterator ti = fi->terms.begin(), te = fi->terms.end();
+		for (; ti != te; prev = ti->first, ++ti)
+		{
+			appendVarint( dest, ti->first - prev);
+			appendVarintString( dest, ti->second);
+		}
+	}
+}
+
+void ExportDocument::deserialize( const std::string& src)
+{
+	std::size_t pos = 0;
+	docid = readVarintString( src, pos);
+
+	std::size_t ii,size;
+	attributes.clear();
+	size = readVarint( src, pos);
+	for (ii=0; ii<size; ++ii)
+	{
+		std::string name = readVarintString( src, pos);
+		attributes.push_back( std::pair<std::string,std::string>( name, readVarintString( src, pos)));
+	}
+	metadata.clear();
+	size = readVarint( src, pos);
+	for (ii=0; ii<size; ++ii)
+	{
+		std::string name = readVarintString( src, pos);
+		metadata.push_back( std::pair<std::string,NumericVariant>( name, readNumeric( src, pos)));
+	}
+	users.clear();
+	size = readVarint( src, pos);
+	for (ii=0; ii<size; ++ii)
+	{
+		users.push_back( readVarintString( src, pos));
+	}
+	searchIndex.clear();
+	size = readVarint( src, pos);
+	for (ii=0; ii<size; ++ii)
+	{
+		searchIndex.push_back( SearchTermList( readVarintString( src, pos)));
+		std::size_t ti = 0, te = readVarint( src, pos);
+		for (; ti < te; ++ti)
+		{
+			searchIndex.back().terms.push_back( SearchTerm( readVarintString( src, pos)));
+			searchIndex.back().terms.back().pos = readPositions( src, pos);
+		}
+	}
+	forwardIndex.clear();
+	size = readVarint( src, pos);
+	for (ii=0; ii<size; ++ii)
+	{
+		forwardIndex.push_back( ForwardTermList( readVarintString( src, pos)));
+		Index prev = 0;
+		std::size_t ti = 0, te = readVarint( src, pos);
+		for (; ti < te; ++ti)
+		{
+			prev += (Index)readVarint( src, pos);
+			forwardIndex.back().terms.push_back( std::pair<Index,std::string>( prev, readVarintString( src, pos)));
+		}
+	}
+	if (pos != src.size()) throw strus::runtime_error(_TXT("corrupt document export record: %s"), _TXT("unexpected data at end of record"));
+}
+
+/// \brief Closes a file when leaving the scope
+class FileScope
+{
+public:
+	explicit FileScope( std::FILE* file_) :m_file(file_){}
+	~FileScope()
+	{
+		if (m_file) std::fclose( m_file);
+	}
+	/// \brief Close the file explicitely, for checking for errors of the final flush
+	/// \return 0 on success, errno else
+	int close()
+	{
+		int rt = std::fclose( m_file) ? errno : 0;
+		m_file = 0;
+		return rt;
+	}
+private:
+	std::FILE* m_file;
+};
+
+DocumentExportWriter::DocumentExportWriter( const StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int chunksize_)
+	:m_storage(storage_),m_errorhnd(errorhnd_),m_chunksize(chunksize_?chunksize_:(unsigned int)DefaultChunkSize),m_nofDocuments(0),m_nofBytes(0)
+{}
+
+void DocumentExportWriter::writeRecord( std::FILE* file, const std::string& path, const std::string& payload)
+{
+	if (payload.size() > (std::size_t)DocumentImportReader::MaxRecordSize) throw strus::runtime_error( _TXT("failed to write document export file '%s': %s"), path.c_str(), _TXT("document record exceeds maximum size"));
+	std::string hdr;
+	appendVarint( hdr, payload.size());
+	if (payload.size())
+	{
+		unsigned int crc = crc32( payload);
+		std::string trailer;
+		for (int bi=0; bi<4; ++bi,crc>>=8) trailer.push_back( (char)(unsigned char)(crc & 0xff));
+		if (hdr.size() != std::fwrite( hdr.c_str(), 1, hdr.size(), file)
+		||  payload.size() != std::fwrite( payload.c_str(), 1, payload.size(), file)
+		||  trailer.size() != std::fwrite( trailer.c_str(), 1, trailer.size(), file))
+		{
+			int ec = errno;
+			throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write document export file '%s': %s"), path.c_str(), ::strerror(ec));
+		}
+		m_nofBytes += hdr.size() + payload.size() + trailer.size();
+	}
+	else
+	{
+		if (hdr.size() != std::fwrite( hdr.c_str(), 1, hdr.size(), file))
+		{
+			int ec = errno;
+			throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write document export file '%s': %s"), path.c_str(), ::strerror(ec));
+		}
+		m_nofBytes += hdr.size();
+	}
+}
+
+void DocumentExportWriter::fetchChunk( std::vector<ExportDocument>& docs, const Index& start_docno, const Index& end_docno)
+{
+	strus::Reference<AttributeReaderInterface> attributereader( m_storage->createAttributeReader());
+	if (!attributereader.get()) throw strus::runtime_error( _TXT("failed to create attribute reader for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+	strus::Reference<MetaDataReaderInterface> metadatareader( m_storage->createMetaDataReader());
+	if (!metadatareader.get()) throw strus::runtime_error( _TXT("failed to create meta data reader for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+	strus::Reference<AclReaderInterface> aclreader( m_storage->createAclReader());
+	if (!aclreader.get() && m_errorhnd->hasError())
+	{
+		// ... a storage without access control has no ACL reader
+		(void)m_errorhnd->fetchError();
+	}
+	Index docid_handle = attributereader->elementHandle( Constants::attribute_docid());
+	std::vector<std::string> attributeNames = attributereader->getNames();
+	std::vector<std::string> metadataNames = metadatareader->getNames();
+
+	strus::Reference<ValueIteratorInterface> typeitr( m_storage->createTermTypeIterator());
+	if (!typeitr.get()) throw strus::runtime_error( _TXT("failed to create term type iterator for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+	std::vector<std::string> types = typeitr->fetchValues( std::numeric_limits<short>::max());
+
+	// ... attributes, meta data and access rights, document by document
+	Index docno = start_docno;
+	for (; docno < end_docno; ++docno)
+	{
+		attributereader->skipDoc( docno);
+		std::string docid = attributereader->getValue( docid_handle);
+		if (docid.empty()) continue; //... deleted or not existing document
+
+		docs.push_back( ExportDocument( docno, docid));
+		ExportDocument& doc = docs.back();
+		std::vector<std::string>::const_iterator ni = attributeNames.begin(), ne = attributeNames.end();
+		for (; ni != ne; ++ni)
+		{
+			if (*ni == Constants::attribute_docid()) continue; //... set with the creation of the document
+			std::string value = attributereader->getValue( attributereader->elementHandle( *ni));
+			if (!value.empty()) doc.attributes.push_back( std::pair<std::string,std::string>( *ni, value));
+		}
+		metadatareader->skipDoc( docno);
+		ni = metadataNames.begin(), ne = metadataNames.end();
+		for (; ni != ne; ++ni)
+		{
+			NumericVariant value = metadatareader->getValue( metadatareader->elementHandle( *ni));
+			if (value.defined()) doc.metadata.push_back( std::pair<std::string,NumericVariant>( *ni, value));
+		}
+		if (aclreader.get())
+		{
+			aclreader->skipDoc( docno);
+			doc.users = aclreader->getReadAccessList();
+		}
+	}
+	if (docs.empty()) return;
+
+	std::vector<std::string>::const_iterator ti = types.begin(), te = types.end();
+	for (; ti != te; ++ti)
+	{
+		// ... search index: distinct terms of the chunk, then the positions of each term with one posting iterator per chunk
+		strus::Reference<DocumentTermIteratorInterface> termitr( m_storage->createDocumentTermIterator( *ti));
+		if (!termitr.get()) throw strus::runtime_error( _TXT("failed to create document term iterator for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+		std::set<std::string> chunkterms;
+		std::vector<ExportDocument>::iterator di = docs.begin(), de = docs.end();
+		for (; di != de; ++di)
+		{
+			if (termitr->skipDoc( di->docno) != di->docno) continue;
+			DocumentTermIteratorInterface::Term term;
+			while (termitr->nextTerm( term))
+			{
+				chunkterms.insert( termitr->termValue( term.termno));
+			}
+		}
+		if (!chunkterms.empty())
+		{
+			di = docs.begin();
+			for (; di != de; ++di)
+			{
+				di->searchIndex.push_back( ExportDocument::SearchTermList( *ti));
+			}
+			std::set<std::string>::const_iterator ci = chunkterms.begin(), ce = chunkterms.end();
+			for (; ci != ce; ++ci)
+			{
+				strus::Reference<PostingIteratorInterface> postings( m_storage->createTermPostingIterator( *ti, *ci, 1, TermStatistics()));
+				if (!postings.get()) throw strus::runtime_error( _TXT("failed to create posting iterator for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+				di = docs.begin();
+				Index dn = postings->skipDoc( di->docno);
+				while (dn && dn < end_docno)
+				{
+					for (; di != de && di->docno < dn; ++di){}
+					if (di == de) break;
+					if (di->docno == dn)
+					{
+						ExportDocument::SearchTerm term( *ci);
+						Index pos = 0;
+						while (0!=(pos=postings->skipPos( pos+1)))
+						{
+							term.pos.push_back( pos);
+						}
+						di->searchIndex.back().terms.push_back( term);
+					}
+					dn = postings->skipDoc( dn+1);
+				}
+			}
+			di = docs.begin();
+			for (; di != de; ++di)
+			{
+				if (di->searchIndex.back().terms.empty()) di->searchIndex.pop_back();
+			}
+		}
+		// ... forward index
+		if (m_storage->isForwardIndexTerm( *ti))
+		{
+			strus::Reference<ForwardIteratorInterface> fwditr( m_storage->createForwardIterator( *ti));
+			if (!fwditr.get()) throw strus::runtime_error( _TXT("failed to create forward iterator for %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+			di = docs.begin();
+			for (; di != de; ++di)
+			{
+				fwditr->skipDoc( di->docno);
+				ExportDocument::ForwardTermList terms( *ti);
+				Index pos = 0;
+				while (0!=(pos=fwditr->skipPos( pos+1)))
+				{
+					terms.terms.push_back( std::pair<Index,std::string>( pos, fwditr->fetch()));
+				}
+				if (!terms.terms.empty()) di->forwardIndex.push_back( terms);
+			}
+		}
+	}
+	if (m_errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("error in %s: %s"), _TXT("document export"), m_errorhnd->fetchError());
+	}
+}
+
+void DocumentExportWriter::run( const std::string& path, const Index& start_docno, const Index& end_docno)
+{
+	Index maxdocno = m_storage->maxDocumentNumber();
+	Index docno = start_docno ? start_docno : 1;
+	Index enddocno = (end_docno && end_docno <= maxdocno) ? end_docno : (maxdocno + 1);
+
+	std::FILE* file = std::fopen( path.c_str(), "wb");
+	if (!file)
+	{
+		int ec = errno;
+		throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to open document export file '%s' for writing: %s"), path.c_str(), ::strerror(ec));
+	}
+	FileScope filescope( file);
+	std::size_t magiclen = std::strlen( DOCUMENT_EXPORT_MAGIC);
+	if (magiclen != std::fwrite( DOCUMENT_EXPORT_MAGIC, 1, magiclen, file))
+	{
+		int ec = errno;
+		throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write document export file '%s': %s"), path.c_str(), ::strerror(ec));
+	}
+	m_nofBytes += magiclen;
+
+	std::vector<ExportDocument> docs;
+	std::string payload;
+	while (docno < enddocno)
+	{
+		Index chunkend = docno + m_chunksize;
+		if (chunkend > enddocno) chunkend = enddocno;
+		docs.clear();
+		fetchChunk( docs, docno, chunkend);
+
+		std::vector<ExportDocument>::const_iterator di = docs.begin(), de = docs.end();
+		for (; di != de; ++di)
+		{
+			payload.clear();
+			di->serialize( payload);
+			writeRecord( file, path, payload);
+			++m_nofDocuments;
+		}
+		docno = chunkend;
+	}
+	writeRecord( file, path, std::string());
+	int ec = filescope.close();
+	if (ec) throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to write document export file '%s': %s"), path.c_str(), ::strerror(ec));
+}
+
+DocumentImportReader::DocumentImportReader( StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int transactionsize_)
+	:m_storage(storage_),m_errorhnd(errorhnd_),m_transactionsize(transactionsize_?transactionsize_:(unsigned int)DefaultTransactionSize),m_nofDocuments(0)
+{}
+
+/// \brief Read the size of a record
+/// \return false if the end of the file is reached before the first byte
+static bool readRecordSize( std::FILE* file, const std::string& path, std::size_t& size)
+{
+	unsigned long long rt = 0;
+	unsigned int shift = 0;
+	for (;;)
+	{
+		int ch = std::fgetc( file);
+		if (ch == EOF)
+		{
+			if (std::ferror( file))
+			{
+				int ec = errno;
+				throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read document export file '%s': %s"), path.c_str(), ::strerror(ec));
+			}
+			if (shift == 0) return false;
+			throw strus::runtime_error( _TXT("document export file '%s' is truncated"), path.c_str());
+		}
+		if (shift > 63) throw strus::runtime_error( _TXT("corrupt document export file '%s': %s"), path.c_str(), _TXT("invalid record size"));
+		rt |= (unsigned long long)(ch & 0x7f) << shift;
+		if (!(ch & 0x80)) break;
+		shift += 7;
+	}
+	if (rt > (unsigned long long)DocumentImportReader::MaxRecordSize) throw strus::runtime_error( _TXT("corrupt document export file '%s': %s"), path.c_str(), _TXT("record size exceeds maximum"));
+	size = rt;
+	return true;
+}
+
+static void readBlock( std::FILE* file, const std::string& path, std::string& buf, std::size_t size)
+{
+	buf.resize( size);
+	if (size && size != std::fread( const_cast<char*>( buf.c_str()), 1, size, file))
+	{
+		if (std::ferror( file))
+		{
+			int ec = errno;
+			throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to read document export file '%s': %s"), path.c_str(), ::strerror(ec));
+		}
+		throw strus::runtime_error( _TXT("document export file '%s' is truncated"), path.c_str());
+	}
+}
+
+static void insertDocument( StorageTransactionInterface* transaction, const ExportDocument& doc, ErrorBufferInterface* errorhnd)
+{
+	strus::Reference<StorageDocumentInterface> document( transaction->createDocument( doc.docid));
+	if (!document.get()) throw strus::runtime_error( _TXT("failed to create document '%s' to import: %s"), doc.docid.c_str(), errorhnd->fetchError());
+
+	std::vector<std::pair<std::string,std::string> >::const_iterator ai = doc.attributes.begin(), ae = doc.attributes.end();
+	for (; ai != ae; ++ai)
+	{
+		document->setAttribute( ai->first, ai->second);
+	}
+	std::vector<std::pair<std::string,NumericVariant> >::const_iterator mi = doc.metadata.begin(), me = doc.metadata.end();
+	for (; mi != me; ++mi)
+	{
+		document->setMetaData( mi->first, mi->second);
+	}
+	std::vector<std::string>::const_iterator ui = doc.users.begin(), ue = doc.users.end();
+	for (; ui != ue; ++ui)
+	{
+		document->setUserAccessRight( *ui);
+	}
+	std::vector<ExportDocument::SearchTermList>::const_iterator si = doc.searchIndex.begin(), se = doc.searchIndex.end();
+	for (; si != se; ++si)
+	{
+		std::vector<ExportDocument::SearchTerm>::const_iterator ti = si->terms.begin(), te = si->terms.end();
+		for (; ti != te; ++ti)
+		{
+			std::vector<Index>::const_iterator pi = ti->pos.begin(), pe = ti->pos.end();
+			for (; pi != pe; ++pi)
+			{
+				document->addSearchIndexTerm( si->type, ti->value, *pi);
+			}
+		}
+	}
+	std::vector<ExportDocument::ForwardTermList>::const_iterator fi = doc.forwardIndex.begin(), fe = doc.forwardIndex.end();
+	for (; fi != fe; ++fi)
+	{
+		std::vector<std::pair<Index,std::string> >::const_iterator ti = fi->terms.begin(), te = fi->terms.end();
+		for (; ti != te; ++ti)
+		{
+			document->addForwardIndexTerm( fi->type, ti->second, ti->first);
+		}
+	}
+	document->done();
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to import document '%s': %s"), doc.docid.c_str(), errorhnd->fetchError());
+	}
+}
+
+static void commitTransaction( StorageTransactionInterface* transaction, ErrorBufferInterface* errorhnd)
+{
+	StorageCommitResult cmres = transaction->commit();
+	if (!cmres.success())
+	{
+		throw strus::runtime_error( _TXT("error in commit of %s: %s"), _TXT("document import"), errorhnd->fetchError());
+	}
+}
+
+void DocumentImportReader::run( const std::string& path)
+{
+	std::FILE* file = std::fopen( path.c_str(), "rb");
+	if (!file)
+	{
+		int ec = errno;
+		throw strus::runtime_error_ec( (ErrorCode)ec, _TXT("failed to open document export file '%s' for reading: %s"), path.c_str(), ::strerror(ec));
+	}
+	FileScope filescope( file);
+	std::string buf;
+	std::size_t magiclen = std::strlen( DOCUMENT_EXPORT_MAGIC);
+	readBlock( file, path, buf, magiclen);
+	if (0!=std::memcmp( buf.c_str(), DOCUMENT_EXPORT_MAGIC, magiclen))
+	{
+		throw strus::runtime_error( _TXT("file '%s' is not a document export file"), path.c_str());
+	}
+	strus::Reference<StorageTransactionInterface> transaction;
+	unsigned int nofTransactionDocuments = 0;
+	ExportDocument doc;
+	std::string trailer;
+	std::size_t size;
+	for (;;)
+	{
+		if (!readRecordSize( file, path, size))
+		{
+			throw strus::runtime_error( _TXT("document export file '%s' is truncated"), path.c_str());
+		}
+		if (size == 0) break; //... end of export marker
+		readBlock( file, path, buf, size);
+		readBlock( file, path, trailer, 4);
+		unsigned int crc = 0;
+		for (int bi=3; bi>=0; --bi) crc = (crc << 8) | (unsigned char)trailer[ bi];
+		if (crc != crc32( buf))
+		{
+			throw strus::runtime_error( _TXT("corrupt document export file '%s': checksum mismatch in record %d"), path.c_str(), (int)m_nofDocuments+1);
+		}
+		doc.deserialize( buf);
+
+		if (!transaction.get())
+		{
+			transaction.reset( m_storage->createTransaction());
+			if (!transaction.get()) throw strus::runtime_error( _TXT("failed to create transaction for %s: %s"), _TXT("document import"), m_errorhnd->fetchError());
+		}
+		insertDocument( transaction.get(), doc, m_errorhnd);
+		++m_nofDocuments;
+		if (++nofTransactionDocuments >= m_transactionsize)
+		{
+			commitTransaction( transaction.get(), m_errorhnd);
+			transaction.reset();
+			nofTransactionDocuments = 0;
+		}
+	}
+	if (transaction.get())
+	{
+		commitTransaction( transaction.get(), m_errorhnd);
+	}
+}
+
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_DOCUMENT_EXPORT_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_DOCUMENT_EXPORT_HPP_INCLUDED
+/// \brief Streaming export and import of the documents of a storage in a compact binary format with checksums
+#include "strus/storage/index.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/base/stdint.h"
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+
+namespace strus {
+
+/// \brief Forward declaration
+class StorageClientInterface;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+namespace bindings {
+
+/// \brief Document as exported, with all its content needed to insert it again into a storage
+struct ExportDocument
+{
+	/// \brief Search index term with all its positions in the document
+	struct SearchTerm
+	{
+		std::string value;
+		std::vector<Index> pos;
+
+		explicit SearchTerm( const std::string& value_)
+			:value(value_),pos(){}
+		SearchTerm( const SearchTerm& o)
+			:value(o.value),pos(o.pos){}
+	};
+	/// \brief Terms of one type of the search index
+	struct SearchTermList
+	{
+		std::string type;
+		std::vector<SearchTerm> terms;
+
+		explicit SearchTermList( const std::string& type_)
+			:type(type_),terms(){}
+		SearchTermList( const SearchTermList& o)
+			:type(o.type),terms(o.terms){}
+	};
+	/// \brief Terms of one type of the forward index as pairs of position and value
+	struct ForwardTermList
+	{
+		std::string type;
+		std::vector<std::pair<Index,std::string> > terms;
+
+		explicit ForwardTermList( const std::string& type_)
+			:type(type_),terms(){}
+		ForwardTermList( const ForwardTermList& o)
+			:type(o.type),terms(o.terms){}
+	};
+
+	Index docno;
+	std::string docid;
+	std::vector<std::pair<std::string,std::string> > attributes;
+	std::vector<std::pair<std::string,NumericVariant> > metadata;
+	std::vector<std::string> users;
+	std::vector<SearchTermList> searchIndex;
+	std::vector<ForwardTermList> forwardIndex;
+
+	ExportDocument()
+		:docno(0),docid(),attributes(),metadata(),users(),searchIndex(),forwardIndex(){}
+	ExportDocument( const Index& docno_, const std::string& docid_)
+		:docno(docno_),docid(docid_),attributes(),metadata(),users(),searchIndex(),forwardIndex(){}
+	ExportDocument( const ExportDocument& o)
+		:docno(o.docno),docid(o.docid),attributes(o.attributes),metadata(o.metadata),users(o.users),searchIndex(o.searchIndex),forwardIndex(o.forwardIndex){}
+
+	/// \brief Append the document as record payload to a buffer
+	void serialize( std::string& dest) const;
+	/// \brief Load the document from a record payload
+	void deserialize( const std::string& src);
+};
+
+/// \brief Writer of the documents of a storage to a file
+/// \note The file starts with a magic header followed by one record per document, each record as [varint payload size][payload][CRC32 of payload, 4 bytes little endian]
+///	and a record of size 0 marking the end, so that truncated files are detected on import
+/// \note The documents are read in chunks of document numbers. The search index terms of a chunk are collected with one document term iterator per type
+///	and then the positions of each distinct term are read with one posting iterator per term and chunk instead of one per term and document
+class DocumentExportWriter
+{
+public:
+	enum {DefaultChunkSize=256};
+
+	/// \brief Constructor
+	/// \param[in] storage_ storage to export the documents from
+	/// \param[in] errorhnd_ error buffer interface
+	/// \param[in] chunksize_ number of document numbers processed with one pass over the search index terms
+	DocumentExportWriter( const StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int chunksize_=DefaultChunkSize);
+
+	/// \brief Export a range of documents
+	/// \param[in] path path of the file to write
+	/// \param[in] start_docno first document number of the range or 0 for starting with the first document
+	/// \param[in] end_docno document number following the last one of the range or 0 for ending with the last document inserted
+	void run( const std::string& path, const Index& start_docno, const Index& end_docno);
+
+	/// \brief Get the number of documents written
+	Index nofDocuments() const		{return m_nofDocuments;}
+	/// \brief Get the number of bytes written
+	int64_t nofBytes() const		{return m_nofBytes;}
+
+private:
+	void fetchChunk( std::vector<ExportDocument>& docs, const Index& start_docno, const Index& end_docno);
+	void writeRecord( std::FILE* file, const std::string& path, const std::string& payload);
+
+private:
+	const StorageClientInterface* m_storage;
+	ErrorBufferInterface* m_errorhnd;
+	unsigned int m_chunksize;
+	Index m_nofDocuments;
+	int64_t m_nofBytes;
+};
+
+/// \brief Reader of documents exported with DocumentExportWriter, inserting them into a storage
+/// \note The meta data elements of the documents have to be defined in the destination storage
+class DocumentImportReader
+{
+public:
+	enum {
+		DefaultTransactionSize=1000,
+		MaxRecordSize=(1<<30)		//< maximum size of a record accepted, larger sizes are treated as corrupt data
+	};
+
+	/// \brief Constructor
+	/// \param[in] storage_ storage to insert the documents into
+	/// \param[in] errorhnd_ error buffer interface
+	/// \param[in] transactionsize_ number of documents inserted with one transaction
+	DocumentImportReader( StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int transactionsize_=DefaultTransactionSize);
+
+	/// \brief Import all documents of a file
+	/// \param[in] path path of the file to read
+	void run( const std::string& path);
+
+	/// \brief Get the number of documents inserted
+	Index nofDocuments() const		{return m_nofDocuments;}
+
+private:
+	StorageClientInterface* m_storage;
+	ErrorBufferInterface* m_errorhnd;
+	unsigned int m_transactionsize;
+	Index m_nofDocuments;
+};
+
+}}//namespace
+#endif
+
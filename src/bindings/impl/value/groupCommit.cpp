@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Merging of the commits of concurrent storage transactions arriving within a short time window into one physical commit
+#include "impl/value/groupCommit.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/storageTransactionInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/sleep.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/lib/error.hpp"
+#include "papuga/allocator.h"
+#include "papuga/errors.h"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+GroupCommitOperations::GroupCommitOperations()
+	:m_operations()
+{
+	papuga_init_Allocator( &m_allocator, 0, 0);
+}
+
+GroupCommitOperations::~GroupCommitOperations()
+{
+	papuga_destroy_Allocator( &m_allocator);
+}
+
+void GroupCommitOperations::push( Type type, const std::string& id, const papuga_ValueVariant* content, const papuga_ValueVariant* deletes)
+{
+	Operation op( type, id);
+	papuga_ErrorCode errcode = papuga_Ok;
+	if (content && papuga_ValueVariant_defined( content)
+		&& !papuga_Allocator_deepcopy_value( &m_allocator, &op.content, const_cast<papuga_ValueVariant*>(content)/*unchanged*/, false/*no host objects expected*/, &errcode))
+	{
+		throw strus::runtime_error(_TXT("failed to record operation for group commit: %s"), papuga_ErrorCode_tostring( errcode));
+	}
+	if (deletes && papuga_ValueVariant_defined( deletes)
+		&& !papuga_Allocator_deepcopy_value( &m_allocator, &op.deletes, const_cast<papuga_ValueVariant*>(deletes)/*unchanged*/, false/*no host objects expected*/, &errcode))
+	{
+		throw strus::runtime_error(_TXT("failed to record operation for group commit: %s"), papuga_ErrorCode_tostring( errcode));
+	}
+	m_operations.push_back( op);
+}
+
+void GroupCommitOperations::clear()
+{
+	m_operations.clear();
+	papuga_destroy_Allocator( &m_allocator);
+	papuga_init_Allocator( &m_allocator, 0, 0);
+}
+
+GroupCommitQueue::GroupCommitQueue( StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int window_)
+	:m_storage(storage_),m_errorhnd(errorhnd_),m_window(window_),m_mutex(),m_cond(),m_pending(),m_leaderActive(false),m_statistics()
+{
+	if (m_window > MaxWindow) throw strus::runtime_error(_TXT("group commit window of %u milliseconds exceeds the maximum of %u"), m_window, (unsigned int)MaxWindow);
+}
+
+GroupCommitQueue::Statistics GroupCommitQueue::statistics() const
+{
+	strus::unique_lock lock( m_mutex);
+	return m_statistics;
+}
+
+void GroupCommitQueue::commit( GroupCommitMember* member)
+{
+	Ticket ticket( member);
+	bool leader = false;
+	{
+		strus::unique_lock lock( m_mutex);
+		m_pending.push_back( &ticket);
+		if (!m_leaderActive)
+		{
+			m_leaderActive = true;
+			leader = true;
+		}
+	}
+	if (leader)
+	{
+		// ... the first caller waits for others to join and commits the group, the callers arriving later start the next group
+		if (m_window) strus::usleep( m_window * 1000);
+		std::vector<Ticket*> group;
+		{
+			strus::unique_lock lock( m_mutex);
+			group.swap( m_pending);
+			m_leaderActive = false;
+		}
+		GroupScope groupScope( this, group);
+		try
+		{
+			processGroup( group);
+		}
+		catch (const std::bad_alloc&)
+		{
+			setUnprocessedError( group, _TXT("memory allocation error in group commit"));
+		}
+		catch (const std::runtime_error& err)
+		{
+			setUnprocessedError( group, err.what());
+		}
+		catch (...)
+		{
+			setUnprocessedError( group, _TXT("uncaught exception in group commit"));
+		}
+	}
+	else
+	{
+		strus::unique_lock lock( m_mutex);
+		while (!ticket.done)
+		{
+			m_cond.wait( lock);
+		}
+	}
+	if (!ticket.errmsg.empty())
+	{
+		throw strus::runtime_error( "%s", ticket.errmsg.c_str());
+	}
+}
+
+GroupCommitQueue::GroupScope::~GroupScope()
+{
+	{
+		strus::unique_lock lock( m_queue->m_mutex);
+		std::vector<Ticket*>::const_iterator gi = m_group.begin(), ge = m_group.end();
+		for (; gi != ge; ++gi)
+		{
+			(*gi)->done = true;
+		}
+		++m_queue->m_statistics.nofGroups;
+	}
+	m_queue->m_cond.notify_all();
+}
+
+void GroupCommitQueue::setUnprocessedError( const std::vector<Ticket*>& group, const char* errmsg)
+{
+	int nofFailures = 0;
+	std::vector<Ticket*>::const_iterator gi = group.begin(), ge = group.end();
+	for (; gi != ge; ++gi)
+	{
+		if (!(*gi)->processed)
+		{
+			(*gi)->processed = true;
+			(*gi)->errmsg = errmsg;
+			++nofFailures;
+		}
+	}
+	strus::unique_lock lock( m_mutex);
+	m_statistics.nofFailures += nofFailures;
+}
+
+void GroupCommitQueue::processGroup( const std::vector<Ticket*>& group)
+{
+	std::vector<Ticket*> members = group;
+	while (!members.empty())
+	{
+		strus::Reference<StorageTransactionInterface> transaction( m_storage->createTransaction());
+		if (!transaction.get())
+		{
+			std::string errmsg = strus::string_format( _TXT("failed to create transaction for group commit: %s"), m_errorhnd->fetchError());
+			std::vector<Ticket*>::iterator mi = members.begin(), me = members.end();
+			for (; mi != me; ++mi)
+			{
+				(*mi)->processed = true;
+				(*mi)->errmsg = errmsg;
+			}
+			strus::unique_lock lock( m_mutex);
+			m_statistics.nofFailures += members.size();
+			return;
+		}
+		// ... apply the operations of all members, members failing are excluded and the group is rebuilt without them
+		std::vector<Ticket*> valid;
+		std::vector<Ticket*>::iterator mi = members.begin(), me = members.end();
+		for (; mi != me; ++mi)
+		{
+			try
+			{
+				(*mi)->member->apply( transaction.get());
+				valid.push_back( *mi);
+			}
+			catch (const std::runtime_error& err)
+			{
+				(*mi)->processed = true;
+				(*mi)->errmsg = err.what();
+				strus::unique_lock lock( m_mutex);
+				++m_statistics.nofFailures;
+			}
+		}
+		if (valid.size() < members.size())
+		{
+			transaction->rollback();
+			members.swap( valid);
+			continue;
+		}
+		StorageCommitResult cmres = transaction->commit();
+		{
+			strus::unique_lock lock( m_mutex);
+			++m_statistics.nofCommits;
+		}
+		if (cmres.success())
+		{
+			mi = members.begin(), me = members.end();
+			for (; mi != me; ++mi)
+			{
+				(*mi)->processed = true;
+				(*mi)->member->committed();
+			}
+			strus::unique_lock lock( m_mutex);
+			m_statistics.nofMembers += members.size();
+			return;
+		}
+		std::string errmsg = strus::string_format( _TXT("error in commit transaction: %s"), m_errorhnd->fetchError());
+		if (members.size() == 1)
+		{
+			members[0]->processed = true;
+			members[0]->errmsg = errmsg;
+			strus::unique_lock lock( m_mutex);
+			++m_statistics.nofFailures;
+			return;
+		}
+		// ... commit the members one by one, so that only the callers with a transaction failing get an error
+		mi = members.begin(), me = members.end();
+		for (; mi != me; ++mi)
+		{
+			processGroup( std::vector<Ticket*>( 1, *mi));
+		}
+		return;
+	}
+}
+
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_GROUP_COMMIT_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_GROUP_COMMIT_HPP_INCLUDED
+/// \brief Merging of the commits of concurrent storage transactions arriving within a short time window into one physical commit
+#include "papuga/typedefs.h"
+#include "papuga/valueVariant.h"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Forward declaration
+class StorageClientInterface;
+/// \brief Forward declaration
+class StorageTransactionInterface;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+namespace bindings {
+
+/// \brief Operations on documents recorded by a storage transaction for a group commit, with deep copies of their arguments
+class GroupCommitOperations
+{
+public:
+	enum Type {InsertDocument,UpdateDocument,DeleteDocument,DeleteUserAccessRights};
+
+	struct Operation
+	{
+		Type type;			//< type of the operation
+		std::string id;			//< document id or user name
+		papuga_ValueVariant content;	//< document content to insert or update
+		papuga_ValueVariant deletes;	//< document contents to delete in an update
+
+		Operation( Type type_, const std::string& id_)
+			:type(type_),id(id_)
+		{
+			papuga_init_ValueVariant( &content);
+			papuga_init_ValueVariant( &deletes);
+		}
+		Operation( const Operation& o)
+			:type(o.type),id(o.id),content(o.content),deletes(o.deletes){}
+	};
+
+	GroupCommitOperations();
+	~GroupCommitOperations();
+
+	/// \brief Record an operation
+	/// \param[in] type type of the operation
+	/// \param[in] id document id or user name
+	/// \param[in] content document content to insert or update (copied) or NULL
+	/// \param[in] deletes document contents to delete in an update (copied) or NULL
+	void push( Type type, const std::string& id, const papuga_ValueVariant* content=0, const papuga_ValueVariant* deletes=0);
+
+	/// \brief Get the operations recorded in the order of their recording
+	const std::vector<Operation>& operations() const
+	{
+		return m_operations;
+	}
+
+	/// \brief Forget all operations recorded
+	void clear();
+
+private:
+	GroupCommitOperations( const GroupCommitOperations&){}		//... non copyable
+	void operator=( const GroupCommitOperations&){}			//... non copyable
+
+private:
+	std::vector<Operation> m_operations;
+	papuga_Allocator m_allocator;			//< allocator for the copies of the arguments
+};
+
+/// \brief Member of a group commit, a transaction with its operations to apply
+class GroupCommitMember
+{
+public:
+	virtual ~GroupCommitMember(){}
+
+	/// \brief Apply the operations of the member to the transaction of a group commit
+	/// \remark throws an error if an operation cannot be applied
+	virtual void apply( StorageTransactionInterface* transaction)=0;
+
+	/// \brief Notify the member that its operations have been committed
+	virtual void committed()=0;
+};
+
+/// \brief Coordinator merging the commits of concurrent storage transactions arriving within a short time window into one physical commit
+/// \note The first caller of a group waits for the window and commits the operations of all members arrived, the other callers wait for the result.
+///	If the operations of a member cannot be applied, the group is rebuilt without it. If the physical commit fails, the members are committed one by one,
+///	so that each caller gets the result of its own transaction
+class GroupCommitQueue
+{
+public:
+	enum {MaxWindow=10000};
+
+	/// \brief Constructor
+	/// \param[in] storage_ storage the transactions are committed to
+	/// \param[in] errorhnd_ error buffer interface
+	/// \param[in] window_ time in milliseconds the first caller of a group waits for other commits to join
+	GroupCommitQueue( StorageClientInterface* storage_, ErrorBufferInterface* errorhnd_, unsigned int window_);
+
+	/// \brief Commit the operations of a member, together with the members of other callers arriving within the time window
+	/// \param[in] member the member to commit
+	/// \remark throws the error of the member if its operations could not be committed
+	void commit( GroupCommitMember* member);
+
+	/// \brief Get the time in milliseconds the first caller of a group waits for other commits to join
+	unsigned int window() const
+	{
+		return m_window;
+	}
+
+	/// \brief Counters of the group commits for introspection
+	struct Statistics
+	{
+		int nofGroups;		//< number of groups committed
+		int nofMembers;		//< number of members committed
+		int nofCommits;		//< number of physical commits
+		int nofFailures;	//< number of members failed
+
+		Statistics()
+			:nofGroups(0),nofMembers(0),nofCommits(0),nofFailures(0){}
+		Statistics( const Statistics& o)
+			:nofGroups(o.nofGroups),nofMembers(o.nofMembers),nofCommits(o.nofCommits),nofFailures(o.nofFailures){}
+	};
+	/// \brief Get a snapshot of the counters
+	Statistics statistics() const;
+
+private:
+	struct Ticket
+	{
+		GroupCommitMember* member;	//< member to commit
+		bool processed;			//< true if the member has been committed or its error has been set, only accessed by the thread processing the group
+		bool done;			//< true if the commit of the member has been processed and the caller may return
+		std::string errmsg;		//< error of the member, empty on success
+
+		explicit Ticket( GroupCommitMember* member_)
+			:member(member_),processed(false),done(false),errmsg(){}
+	};
+
+	/// \brief Marks the tickets of a group as done and wakes up their callers when leaving the scope, also when leaving it with an exception
+	class GroupScope
+	{
+	public:
+		GroupScope( GroupCommitQueue* queue_, const std::vector<Ticket*>& group_)
+			:m_queue(queue_),m_group(group_){}
+		~GroupScope();
+
+	private:
+		GroupCommitQueue* m_queue;
+		const std::vector<Ticket*>& m_group;
+	};
+	friend class GroupScope;
+
+	/// \brief Commit the members of a group, sets the error of the members failed
+	void processGroup( const std::vector<Ticket*>& group);
+	/// \brief Set the error of the members of a group not processed yet, called if the processing of a group has been interrupted by an exception
+	void setUnprocessedError( const std::vector<Ticket*>& group, const char* errmsg);
+
+private:
+	GroupCommitQueue( const GroupCommitQueue&){}		//... non copyable
+	void operator=( const GroupCommitQueue&){}		//... non copyable
+
+private:
+	StorageClientInterface* m_storage;
+	ErrorBufferInterface* m_errorhnd;
+	unsigned int m_window;
+	mutable strus::mutex m_mutex;			//< mutex for the queue monitor
+	strus::condition_variable m_cond;		//< signal for groups processed
+	std::vector<Ticket*> m_pending;			//< members waiting for the next group
+	bool m_leaderActive;				//< true if the first caller of the next group is waiting for the window to close
+	Statistics m_statistics;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "impl/value/metaDataColumnIterator.hpp"
+#include "deserializer.hpp"
+#include "papuga/valueVariant.h"
+#include "papuga/callResult.h"
+#include "papuga/serialization.h"
+#include "papuga/allocator.h"
+#include "strus/lib/error.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/base/base64.hpp"
+#include "private/internationalization.hpp"
+#include <cstring>
+#include <stdint.h>
+
+#define ITERATOR_NAME "meta data column iterator"
+
+using namespace strus;
+using namespace strus::bindings;
+
+MetaDataColumnIterator::MetaDataColumnIterator(
+		const ObjectRef& trace_,
+		const ObjectRef& objbuilder_,
+		const ObjectRef& storage_,
+		const ObjectRef& errorhnd_,
+		const ValueVariant& columns,
+		const Index& start_docno_,
+		const Index& end_docno_,
+		unsigned int chunksize_,
+		bool packed_)
+	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_)
+	,m_metadata(),m_columns(),m_docno(start_docno_?start_docno_:1),m_end_docno(end_docno_),m_chunksize(chunksize_?chunksize_:(unsigned int)DefaultChunkSize),m_packed(packed_)
+{
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+
+	m_metadata.reset( storage->createMetaDataReader());
+	if (!m_metadata.get()) throw strus::runtime_error( _TXT("failed to create metadata reader for %s: %s"), ITERATOR_NAME, errorhnd->fetchError());
+
+	Index maxdocno = storage->maxDocumentNumber();
+	if (!m_end_docno || m_end_docno > maxdocno + 1) m_end_docno = maxdocno + 1;
+
+	std::vector<std::string> namelist;
+	if (papuga_ValueVariant_defined( &columns))
+	{
+		namelist = Deserializer::getStringList( columns);
+	}
+	else
+	{
+		namelist = m_metadata->getNames();
+	}
+	std::vector<std::string>::const_iterator ni = namelist.begin(), ne = namelist.end();
+	for (; ni != ne; ++ni)
+	{
+		Index eh = m_metadata->elementHandle( *ni);
+		if (eh < 0) throw strus::runtime_error(_TXT("unknown meta data element '%s' in %s"), ni->c_str(), ITERATOR_NAME);
+		const char* type = m_metadata->getType( eh);
+		bool isFloat = type && 0==std::strncmp( type, "Float", 5);
+		m_columns.push_back( Column( *ni, eh, isFloat));
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to instantiate %s: %s"), ITERATOR_NAME, errorhnd->fetchError());
+	}
+}
+
+static int64_t numericToInt( const NumericVariant& val)
+{
+	switch (val.type)
+	{
+		case NumericVariant::Null: return 0;
+		case NumericVariant::Int: return val.variant.Int;
+		case NumericVariant::UInt: return val.variant.UInt;
+		case NumericVariant::Float: return (int64_t)val.variant.Float;
+	}
+	return 0;
+}
+
+static double numericToFloat( const NumericVariant& val)
+{
+	switch (val.type)
+	{
+		case NumericVariant::Null: return 0.0;
+		case NumericVariant::Int: return val.variant.Int;
+		case NumericVariant::UInt: return val.variant.UInt;
+		case NumericVariant::Float: return val.variant.Float;
+	}
+	return 0.0;
+}
+
+static bool pushPackedValues( papuga_Serialization* ser, papuga_Allocator* allocator, const std::string& buf)
+{
+	std::size_t allocsize = strus::base64EncodeLength( buf.size());
+	char* valstr = (char*)papuga_Allocator_alloc( allocator, allocsize+1, 1);
+	if (!valstr) throw std::bad_alloc();
+	strus::ErrorCode ec = (strus::ErrorCode)0;
+	std::size_t len = strus::encodeBase64( valstr, allocsize, buf.c_str(), buf.size(), ec);
+	if (!len && ec) throw strus::runtime_error(_TXT("error encoding packed values of %s: %s"), ITERATOR_NAME, errorCodeToString( ec));
+	valstr[ len] = 0;
+	return papuga_Serialization_pushValue_string( ser, valstr, len);
+}
+
+static void appendPackedInt( std::string& buf, int64_t val)
+{
+	// ... 8 bytes little endian
+	uint64_t uval = (uint64_t)val;
+	char ar[ 8];
+	for (int bi=0; bi<8; ++bi,uval>>=8) ar[ bi] = (char)(unsigned char)(uval & 0xff);
+	buf.append( ar, 8);
+}
+
+static void appendPackedFloat( std::string& buf, double val)
+{
+	// ... IEEE 754 double in 8 bytes little endian
+	uint64_t uval;
+	std::memcpy( &uval, &val, 8);
+	appendPackedInt( buf, (int64_t)uval);
+}
+
+bool MetaDataColumnIterator::buildChunk( papuga_CallResult* result)
+{
+	Index chunkend = m_docno + m_chunksize;
+	if (chunkend > m_end_docno) chunkend = m_end_docno;
+
+	// ... read the values document by document, collected column by column
+	std::vector<std::vector<NumericVariant> > values( m_columns.size());
+	Index docno = m_docno;
+	for (; docno < chunkend; ++docno)
+	{
+		m_metadata->skipDoc( docno);
+		std::vector<Column>::const_iterator ci = m_columns.begin(), ce = m_columns.end();
+		for (int cidx=0; ci != ce; ++ci,++cidx)
+		{
+			values[ cidx].push_back( m_metadata->getValue( ci->handle));
+		}
+	}
+	if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+	papuga_Serialization* ser = result->valuear[0].value.serialization;
+
+	bool sc = true;
+	sc &= papuga_Serialization_pushName_charp( ser, "start");
+	sc &= papuga_Serialization_pushValue_int( ser, m_docno);
+	sc &= papuga_Serialization_pushName_charp( ser, "count");
+	sc &= papuga_Serialization_pushValue_int( ser, chunkend - m_docno);
+	sc &= papuga_Serialization_pushName_charp( ser, "column");
+	sc &= papuga_Serialization_pushOpen( ser);
+	std::vector<Column>::const_iterator ci = m_columns.begin(), ce = m_columns.end();
+	for (int cidx=0; ci != ce; ++ci,++cidx)
+	{
+		sc &= papuga_Serialization_pushOpen( ser);
+		sc &= papuga_Serialization_pushName_charp( ser, "name");
+		sc &= papuga_Serialization_pushValue_string( ser, ci->name.c_str(), ci->name.size());
+		sc &= papuga_Serialization_pushName_charp( ser, "type");
+		sc &= papuga_Serialization_pushValue_charp( ser, ci->isFloat ? "float64" : "int64");
+
+		std::vector<NumericVariant>::const_iterator vi = values[ cidx].begin(), ve = values[ cidx].end();
+		if (m_packed)
+		{
+			std::string buf;
+			buf.reserve( values[ cidx].size() * 8);
+			for (; vi != ve; ++vi)
+			{
+				if (ci->isFloat)
+				{
+					appendPackedFloat( buf, numericToFloat( *vi));
+				}
+				else
+				{
+					appendPackedInt( buf, numericToInt( *vi));
+				}
+			}
+			sc &= papuga_Serialization_pushName_charp( ser, "packed");
+			sc &= pushPackedValues( ser, result->allocator, buf);
+		}
+		else
+		{
+			sc &= papuga_Serialization_pushName_charp( ser, "values");
+			sc &= papuga_Serialization_pushOpen( ser);
+			for (; vi != ve; ++vi)
+			{
+				if (ci->isFloat)
+				{
+					sc &= papuga_Serialization_pushValue_double( ser, numericToFloat( *vi));
+				}
+				else
+				{
+					sc &= papuga_Serialization_pushValue_int( ser, numericToInt( *vi));
+				}
+			}
+			sc &= papuga_Serialization_pushClose( ser);
+		}
+		sc &= papuga_Serialization_pushClose( ser);
+	}
+	sc &= papuga_Serialization_pushClose( ser);
+	if (!sc) throw std::bad_alloc();
+	m_docno = chunkend;
+	return true;
+}
+
+bool MetaDataColumnIterator::getNext( papuga_CallResult* result)
+{
+	try
+	{
+		if (m_docno >= m_end_docno) return false;
+		bool rt = buildChunk( result);
+		ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+		if (errorhnd->hasError())
+		{
+			papuga_CallResult_reportError( result, _TXT("error in %s get next: %s"), ITERATOR_NAME, errorhnd->fetchError());
+			rt = false;
+		}
+		return rt;
+	}
+	catch (const std::bad_alloc& err)
+	{
+		papuga_CallResult_reportError( result, _TXT("memory allocation error in %s get next"), ITERATOR_NAME);
+		return false;
+	}
+	catch (const std::runtime_error& err)
+	{
+		papuga_CallResult_reportError( result, _TXT("error in %s get next: %s"), ITERATOR_NAME, err.what());
+		return false;
+	}
+}
+
+bool MetaDataColumnIterator::GetNext( void* self, papuga_CallResult* result)
+{
+	return ((MetaDataColumnIterator*)self)->getNext( result);
+}
+
+void MetaDataColumnIterator::Deleter( void* obj)
+{
+	delete (MetaDataColumnIterator*)obj;
+}
+
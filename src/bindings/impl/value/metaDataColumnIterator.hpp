@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_STORAGE_METADATA_COLUMN_ITERATOR_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_STORAGE_METADATA_COLUMN_ITERATOR_HPP_INCLUDED
+#include "papuga/typedefs.h"
+#include "strus/storage/index.hpp"
+#include "strus/reference.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "impl/value/objectref.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+typedef papuga_ValueVariant ValueVariant;
+
+/// \brief Iterator on the values of meta data columns over a range of document numbers, returning one chunk of values per column and step
+class MetaDataColumnIterator
+{
+public:
+	enum {DefaultChunkSize=1024};
+
+	MetaDataColumnIterator(
+		const ObjectRef& trace_,
+		const ObjectRef& objbuilder_,
+		const ObjectRef& storage_,
+		const ObjectRef& errorhnd_,
+		const ValueVariant& columns,
+		const Index& start_docno_,
+		const Index& end_docno_,
+		unsigned int chunksize_,
+		bool packed_);
+	virtual ~MetaDataColumnIterator(){}
+
+	bool getNext( papuga_CallResult* result);
+
+	static bool GetNext( void* self, papuga_CallResult* result);
+	static void Deleter( void* obj);
+
+private:
+	struct Column
+	{
+		std::string name;
+		Index handle;
+		bool isFloat;
+
+		Column( const std::string& name_, const Index& handle_, bool isFloat_)
+			:name(name_),handle(handle_),isFloat(isFloat_){}
+		Column( const Column& o)
+			:name(o.name),handle(o.handle),isFloat(o.isFloat){}
+	};
+
+	bool buildChunk( papuga_CallResult* result);
+
+private:
+	ObjectRef m_trace_impl;
+	ObjectRef m_objbuilder_impl;
+	ObjectRef m_storage_impl;
+	ObjectRef m_errorhnd_impl;
+	Reference<MetaDataReaderInterface> m_metadata;
+	std::vector<Column> m_columns;
+	Index m_docno;
+	Index m_end_docno;
+	unsigned int m_chunksize;
+	bool m_packed;
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Summary of the minimum and maximum value of meta data elements per block of document numbers, used for skipping blocks that cannot match a meta data restriction
+#include "impl/value/metaDataZoneMap.hpp"
+#include "private/internationalization.hpp"
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+
+using namespace strus;
+using namespace strus::bindings;
+
+static bool getNumericValue( double& result, const NumericVariant& val)
+{
+	switch (val.type)
+	{
+		case NumericVariant::Null: return false;
+		case NumericVariant::Int: result = (double)val.variant.Int; return true;
+		case NumericVariant::UInt: result = (double)val.variant.UInt; return true;
+		case NumericVariant::Float: result = val.variant.Float; return true;
+	}
+	return false;
+}
+
+void MetaDataZoneFilter::addCondition(
+		const MetaDataRestrictionInterface::CompareOperator& opr,
+		const std::string& name,
+		const NumericVariant& operand,
+		bool newGroup)
+{
+	double value = 0.0;
+	bool defined = getNumericValue( value, operand);
+	if (newGroup || m_groups.empty())
+	{
+		m_groups.push_back( Group());
+	}
+	m_groups.back().push_back( Condition( opr, name, value, defined));
+}
+
+bool MetaDataZoneMap::Domain::get( Domain& result, const char* type)
+{
+	if (!type) return false;
+	// ... floating point types: relative rounding error of the mantissa and smallest positive (subnormal) value
+	if (0==std::strcmp( type, "Float16")) {result = Domain( -65504.0, 65504.0, 1.0/(1<<11), 1.0/(1<<24)); return true;}
+	if (0==std::strcmp( type, "Float32")) {result = Domain( -FLT_MAX, FLT_MAX, 1.0/(1<<24), FLT_MIN * FLT_EPSILON); return true;}
+	if (0==std::strcmp( type, "Int8")) {result = Domain( -128.0, 127.0, 0.0, 0.0); return true;}
+	if (0==std::strcmp( type, "UInt8")) {result = Domain( 0.0, 255.0, 0.0, 0.0); return true;}
+	if (0==std::strcmp( type, "Int16")) {result = Domain( -32768.0, 32767.0, 0.0, 0.0); return true;}
+	if (0==std::strcmp( type, "UInt16")) {result = Domain( 0.0, 65535.0, 0.0, 0.0); return true;}
+	if (0==std::strcmp( type, "Int32")) {result = Domain( -2147483648.0, 2147483647.0, 0.0, 0.0); return true;}
+	if (0==std::strcmp( type, "UInt32")) {result = Domain( 0.0, 4294967295.0, 0.0, 0.0); return true;}
+	return false;
+}
+
+bool MetaDataZoneMap::Domain::convert( double& lo, double& hi, double value) const
+{
+	if (value < minval || value > maxval) return false;
+	if (epsilon > 0.0)
+	{
+		double err = std::fabs( value) * epsilon + tiny;
+		lo = value - err;
+		hi = value + err;
+	}
+	else
+	{
+		// ... truncated or rounded to an integer
+		lo = std::floor( value);
+		hi = std::ceil( value);
+	}
+	return true;
+}
+
+bool MetaDataZoneMap::Zone::mayMatch( const MetaDataZoneFilter::Condition& cond, const Domain& domain) const
+{
+	if (state != Bounded || !cond.defined) return true;
+	// ... compare with all values the operand may be converted to, the block is only skipped if none of them can match
+	double lo, hi;
+	if (!domain.convert( lo, hi, cond.value)) return true;
+	switch (cond.cmpop)
+	{
+		case MetaDataRestrictionInterface::CompareLess: return minval < hi;
+		case MetaDataRestrictionInterface::CompareLessEqual: return minval <= hi;
+		case MetaDataRestrictionInterface::CompareEqual: return minval <= hi && lo <= maxval;
+		case MetaDataRestrictionInterface::CompareNotEqual: return !(lo == hi && minval == lo && maxval == lo);
+		case MetaDataRestrictionInterface::CompareGreater: return maxval > lo;
+		case MetaDataRestrictionInterface::CompareGreaterEqual: return maxval >= lo;
+	}
+	return true;
+}
+
+bool MetaDataZoneMap::zoneMayMatch( const MetaDataZoneFilter::Condition& cond, const Index& blockidx) const
+{
+	ColumnMap::const_iterator ci = m_columns.find( cond.name);
+	if (ci == m_columns.end() || blockidx >= (Index)ci->second.zones.size()) return true;
+	return ci->second.zones[ blockidx].mayMatch( cond, ci->second.domain);
+}
+
+bool MetaDataZoneMap::hasZone( const std::string& name, const Index& blockidx) const
+{
+	strus::scoped_lock lock( m_mutex);
+	ColumnMap::const_iterator ci = m_columns.find( name);
+	return (ci != m_columns.end() && blockidx < (Index)ci->second.zones.size() && ci->second.zones[ blockidx].state != Zone::Unknown);
+}
+
+void MetaDataZoneMap::buildZone( const std::string& name, const Index& blockidx, MetaDataReaderInterface* reader, const Index& maxdocno)
+{
+	unsigned int generation;
+	{
+		strus::scoped_lock lock( m_mutex);
+		generation = m_generation;
+	}
+	// ... build the summary of the block without holding the lock
+	Index docno = blockStart( blockidx);
+	Index blockend = docno + BlockSize;
+	if (blockend > maxdocno + 1)
+	{
+		// ... incomplete block, documents may still be added
+		return;
+	}
+	Zone zone;
+	Domain domain;
+	Index eh = reader->elementHandle( name);
+	if (eh < 0 || !Domain::get( domain, reader->getType( eh)))
+	{
+		zone.state = Zone::Unbounded;
+	}
+	else
+	{
+		zone.state = Zone::Bounded;
+		for (; docno < blockend; ++docno)
+		{
+			double value;
+			reader->skipDoc( docno);
+			if (!getNumericValue( value, reader->getValue( eh)))
+			{
+				zone.state = Zone::Unbounded;
+				break;
+			}
+			if (docno == blockStart( blockidx) || value < zone.minval) zone.minval = value;
+			if (docno == blockStart( blockidx) || value > zone.maxval) zone.maxval = value;
+		}
+	}
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (generation == m_generation)
+		{
+			Column& column = m_columns[ name];
+			column.domain = domain;
+			if ((Index)column.zones.size() <= blockidx) column.zones.resize( blockidx+1);
+			column.zones[ blockidx] = zone;
+		}
+	}
+}
+
+bool MetaDataZoneMap::blockMayMatch( const MetaDataZoneFilter& filter, const Index& blockidx) const
+{
+	strus::scoped_lock lock( m_mutex);
+	std::vector<MetaDataZoneFilter::Group>::const_iterator gi = filter.groups().begin(), ge = filter.groups().end();
+	for (; gi != ge; ++gi)
+	{
+		bool groupMayMatch = false;
+		MetaDataZoneFilter::Group::const_iterator ci = gi->begin(), ce = gi->end();
+		for (; !groupMayMatch && ci != ce; ++ci)
+		{
+			groupMayMatch = zoneMayMatch( *ci, blockidx);
+		}
+		if (!groupMayMatch) return false;
+	}
+	return true;
+}
+
+void MetaDataZoneMap::summarizeBlock( const MetaDataZoneFilter& filter, const Index& blockidx, MetaDataReaderInterface* reader, const Index& maxdocno)
+{
+	std::vector<MetaDataZoneFilter::Group>::const_iterator gi = filter.groups().begin(), ge = filter.groups().end();
+	for (; gi != ge; ++gi)
+	{
+		MetaDataZoneFilter::Group::const_iterator ci = gi->begin(), ce = gi->end();
+		for (; ci != ce; ++ci)
+		{
+			if (!hasZone( ci->name, blockidx))
+			{
+				buildZone( ci->name, blockidx, reader, maxdocno);
+			}
+		}
+	}
+}
+
+void MetaDataZoneMap::invalidateDocument( const Index& docno)
+{
+	strus::scoped_lock lock( m_mutex);
+	Index blockidx = blockIndex( docno);
+	ColumnMap::iterator ci = m_columns.begin(), ce = m_columns.end();
+	for (; ci != ce; ++ci)
+	{
+		if (blockidx < (Index)ci->second.zones.size())
+		{
+			ci->second.zones[ blockidx] = Zone();
+		}
+	}
+	++m_generation;
+}
+
+void MetaDataZoneMap::invalidate()
+{
+	strus::scoped_lock lock( m_mutex);
+	m_columns.clear();
+	++m_generation;
+}
+
+bool MetaDataZoneMap::empty() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_columns.empty();
+}
+
+Index MetaDataZoneCursor::skipDoc( const Index& docno)
+{
+	Index blockidx = MetaDataZoneMap::blockIndex( docno);
+	if (blockidx == m_blockidx)
+	{
+		if (docno != m_docno)
+		{
+			m_docno = docno;
+			if (++m_nofVisits == DenseScanVisits)
+			{
+				m_zonemap->summarizeBlock( m_filter, blockidx, m_reader.get(), m_maxdocno);
+			}
+		}
+		return docno;
+	}
+	Index rt = docno;
+	while (rt <= m_maxdocno)
+	{
+		if (m_zonemap->blockMayMatch( m_filter, blockidx))
+		{
+			m_blockidx = blockidx;
+			m_docno = rt;
+			m_nofVisits = 1;
+			return rt;
+		}
+		rt = MetaDataZoneMap::blockStart( ++blockidx);
+	}
+	return rt;
+}
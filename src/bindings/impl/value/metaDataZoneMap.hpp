@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_METADATA_ZONE_MAP_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_METADATA_ZONE_MAP_HPP_INCLUDED
+/// \brief Summary of the minimum and maximum value of meta data elements per block of document numbers, used for skipping blocks that cannot match a meta data restriction
+#include "strus/storage/index.hpp"
+#include "strus/reference.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/metaDataRestrictionInterface.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+#include <map>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Meta data restriction in conjunctive normal form (groups of conditions joined with OR, the groups joined with AND), as used for evaluating it on blocks of documents
+/// \note Built with Deserializer::buildMetaDataRestriction from the same structure as the meta data restriction of the storage
+class MetaDataZoneFilter
+{
+public:
+	struct Condition
+	{
+		MetaDataRestrictionInterface::CompareOperator cmpop;
+		std::string name;
+		double value;
+		bool defined;		//< false if the operand is NULL
+
+		Condition( const MetaDataRestrictionInterface::CompareOperator& cmpop_, const std::string& name_, double value_, bool defined_)
+			:cmpop(cmpop_),name(name_),value(value_),defined(defined_){}
+		Condition( const Condition& o)
+			:cmpop(o.cmpop),name(o.name),value(o.value),defined(o.defined){}
+	};
+	typedef std::vector<Condition> Group;
+
+	MetaDataZoneFilter()
+		:m_groups(){}
+	MetaDataZoneFilter( const MetaDataZoneFilter& o)
+		:m_groups(o.m_groups){}
+
+	/// \brief Add a condition, same as MetaDataRestrictionInterface::addCondition
+	void addCondition(
+			const MetaDataRestrictionInterface::CompareOperator& opr,
+			const std::string& name,
+			const NumericVariant& operand,
+			bool newGroup);
+
+	const std::vector<Group>& groups() const
+	{
+		return m_groups;
+	}
+	bool empty() const
+	{
+		return m_groups.empty();
+	}
+
+private:
+	std::vector<Group> m_groups;
+};
+
+
+/// \brief Summary of the minimum and maximum value of meta data elements per block of document numbers
+/// \note The summary of a block is built when a block is scanned densely (see MetaDataZoneCursor), blocks without summary are never skipped
+/// \note Blocks are invalidated by the transactions of the storage client on commit, blocks not complete yet (containing the highest document number) are never stored
+class MetaDataZoneMap
+{
+public:
+	enum {BlockSize=1024};
+
+	MetaDataZoneMap()
+		:m_mutex(),m_columns(),m_generation(0){}
+	virtual ~MetaDataZoneMap(){}
+
+	/// \brief Get the index of the block of a document number
+	static Index blockIndex( const Index& docno)
+	{
+		return (docno - 1) / BlockSize;
+	}
+	/// \brief Get the first document number of a block
+	static Index blockStart( const Index& blockidx)
+	{
+		return blockidx * BlockSize + 1;
+	}
+
+	/// \brief Test if a block may contain documents matching a restriction
+	/// \param[in] filter restriction to test
+	/// \param[in] blockidx index of the block
+	/// \return false if no document of the block can match, true if a document may match or if there is no summary of the block
+	bool blockMayMatch( const MetaDataZoneFilter& filter, const Index& blockidx) const;
+
+	/// \brief Build the summaries of a block for the elements of a restriction that are not available yet
+	/// \param[in] filter restriction referring to the elements to summarize
+	/// \param[in] blockidx index of the block
+	/// \param[in] reader meta data reader used to read the values of the block
+	/// \param[in] maxdocno highest document number in the storage
+	void summarizeBlock( const MetaDataZoneFilter& filter, const Index& blockidx, MetaDataReaderInterface* reader, const Index& maxdocno);
+
+	/// \brief Invalidate the summary of the block containing a document, called when the meta data of the document has changed
+	void invalidateDocument( const Index& docno);
+	/// \brief Invalidate all summaries, called when the meta data table has changed
+	void invalidate();
+
+	/// \brief Test if there are summaries of blocks stored, changes do not have to be tracked if not
+	bool empty() const;
+
+private:
+	/// \brief Values representable by the type of an element, the operand of a condition is converted to it by the meta data restriction before comparing
+	struct Domain
+	{
+		double minval;		//< smallest value representable
+		double maxval;		//< largest value representable
+		double epsilon;		//< relative rounding error of a floating point type, 0.0 for integer types
+		double tiny;		//< absolute rounding error of a floating point type close to 0.0
+
+		Domain()
+			:minval(0.0),maxval(0.0),epsilon(0.0),tiny(0.0){}
+		Domain( double minval_, double maxval_, double epsilon_, double tiny_)
+			:minval(minval_),maxval(maxval_),epsilon(epsilon_),tiny(tiny_){}
+		Domain( const Domain& o)
+			:minval(o.minval),maxval(o.maxval),epsilon(o.epsilon),tiny(o.tiny){}
+
+		/// \brief Get the domain of a meta data element type
+		/// \return false if the type is not known
+		static bool get( Domain& result, const char* type);
+
+		/// \brief Get the interval of values an operand may be converted to
+		/// \return false if the operand is not representable and the result of the conversion is undefined
+		bool convert( double& lo, double& hi, double value) const;
+	};
+
+	/// \brief Minimum and maximum value of an element in a block
+	struct Zone
+	{
+		enum State {Unknown,Bounded,Unbounded};
+		double minval;
+		double maxval;
+		State state;
+
+		Zone()
+			:minval(0.0),maxval(0.0),state(Unknown){}
+		Zone( const Zone& o)
+			:minval(o.minval),maxval(o.maxval),state(o.state){}
+
+		bool mayMatch( const MetaDataZoneFilter::Condition& cond, const Domain& domain) const;
+	};
+	typedef std::vector<Zone> ZoneArray;
+
+	/// \brief Summaries of the blocks of an element
+	struct Column
+	{
+		Domain domain;
+		ZoneArray zones;
+
+		Column()
+			:domain(),zones(){}
+		Column( const Column& o)
+			:domain(o.domain),zones(o.zones){}
+	};
+	typedef std::map<std::string,Column> ColumnMap;
+
+	bool zoneMayMatch( const MetaDataZoneFilter::Condition& cond, const Index& blockidx) const;
+	bool hasZone( const std::string& name, const Index& blockidx) const;
+	void buildZone( const std::string& name, const Index& blockidx, MetaDataReaderInterface* reader, const Index& maxdocno);
+
+private:
+	MetaDataZoneMap( const MetaDataZoneMap&){}	//... non copyable
+	void operator=( const MetaDataZoneMap&){}	//... non copyable
+
+private:
+	mutable strus::mutex m_mutex;	//< mutex guarding the summaries
+	ColumnMap m_columns;		//< summaries of the blocks per element
+	unsigned int m_generation;	//< counter of invalidations, for not storing a summary built from data changed in the meantime
+};
+
+
+/// \brief Cursor of a scan skipping the blocks of documents that cannot match a restriction
+/// \note The summary of a block is built when the scan visits a number of documents in the block, so that reading the values of the whole block is paid only by scans that read a substantial part of it anyway
+class MetaDataZoneCursor
+{
+public:
+	enum {DenseScanVisits=MetaDataZoneMap::BlockSize/8};	//< number of documents of a block visited by a scan that trigger the build of the summary of the block
+
+	/// \brief Constructor
+	/// \param[in] zonemap_ zone map of the storage
+	/// \param[in] filter_ restriction of the scan
+	/// \param[in] reader_ meta data reader for building summaries of blocks (ownership passed)
+	/// \param[in] maxdocno_ highest document number in the storage
+	MetaDataZoneCursor( MetaDataZoneMap* zonemap_, const MetaDataZoneFilter& filter_, MetaDataReaderInterface* reader_, const Index& maxdocno_)
+		:m_zonemap(zonemap_),m_filter(filter_),m_reader(reader_),m_maxdocno(maxdocno_),m_blockidx(-1),m_docno(0),m_nofVisits(0){}
+
+	/// \brief Get the smallest document number greater than or equal to a document number that is in a block that may contain matches
+	/// \note Blocks beyond the highest document number of the storage passed to the constructor are never skipped
+	/// \return the document number
+	Index skipDoc( const Index& docno);
+
+private:
+	MetaDataZoneCursor( const MetaDataZoneCursor&){}	//... non copyable
+	void operator=( const MetaDataZoneCursor&){}		//... non copyable
+
+private:
+	MetaDataZoneMap* m_zonemap;
+	MetaDataZoneFilter m_filter;
+	Reference<MetaDataReaderInterface> m_reader;
+	Index m_maxdocno;
+	Index m_blockidx;		//< index of the last block visited that may contain matches
+	Index m_docno;			//< last document number visited
+	int m_nofVisits;		//< number of documents visited in the last block
+};
+
+}}//namespace
+#endif
+
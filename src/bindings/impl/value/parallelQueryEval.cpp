@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Evaluation of a query with the documents split into partitions evaluated in parallel and the results merged
+#include "impl/value/parallelQueryEval.hpp"
+#include "strus/lib/error.hpp"
+#include "papuga/allocator.h"
+#include "papuga/errors.h"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace strus;
+using namespace strus::bindings;
+
+QueryDefinitions::QueryDefinitions()
+	:m_definitions()
+{
+	papuga_init_Allocator( &m_allocator, 0, 0);
+}
+
+QueryDefinitions::~QueryDefinitions()
+{
+	papuga_destroy_Allocator( &m_allocator);
+}
+
+void QueryDefinitions::push( Type type, const papuga_ValueVariant& arg, const std::string& name, const std::string& value, double weight)
+{
+	Definition def( type, name, value, weight);
+	papuga_ErrorCode errcode = papuga_Ok;
+	if (papuga_ValueVariant_defined( &arg)
+		&& !papuga_Allocator_deepcopy_value( &m_allocator, &def.arg, const_cast<papuga_ValueVariant*>(&arg)/*unchanged*/, false/*no host objects expected*/, &errcode))
+	{
+		throw strus::runtime_error(_TXT("failed to record query definition: %s"), papuga_ErrorCode_tostring( errcode));
+	}
+	m_definitions.push_back( def);
+}
+
+ParallelQueryEvaluation::ParallelQueryEvaluation( const QueryPartitionEvaluator* evaluator_, WorkerThreadPool* pool_, unsigned int nofPartitions_, int minRank_, int maxNofRanks_)
+	:m_evaluator(evaluator_),m_pool(pool_),m_nofPartitions(nofPartitions_),m_minRank(minRank_ > 0 ? minRank_ : 0),m_maxNofRanks(maxNofRanks_ > 0 ? maxNofRanks_ : 0)
+	,m_mutex(),m_cond(),m_nofRunning(0),m_partitions(),m_docnos(),m_terminate(false)
+{
+	if (m_nofPartitions > MaxNofPartitions) throw strus::runtime_error(_TXT("number of query evaluation partitions %u exceeds the maximum of %u"), m_nofPartitions, (unsigned int)MaxNofPartitions);
+	if (m_nofPartitions == 0) m_nofPartitions = 1;
+}
+
+ParallelQueryEvaluation::~ParallelQueryEvaluation()
+{
+	clear();
+}
+
+void ParallelQueryEvaluation::wait()
+{
+	strus::unique_lock lock( m_mutex);
+	while (m_nofRunning > 0)
+	{
+		m_cond.wait( lock);
+	}
+}
+
+void ParallelQueryEvaluation::clear()
+{
+	wait();
+	std::vector<Partition*>::iterator ai = m_partitions.begin(), ae = m_partitions.end();
+	for (; ai != ae; ++ai)
+	{
+		delete *ai;
+	}
+	m_partitions.clear();
+}
+
+void ParallelQueryEvaluation::createPartitions( const Index& start, const Index& end)
+{
+	// ... split the range into partitions of equal size
+	Index range = end > start ? (end - start) : 0;
+	unsigned int nofPartitions = m_nofPartitions;
+	if ((Index)nofPartitions > range) nofPartitions = range ? range : 1;
+	Index partsize = (range + nofPartitions - 1) / nofPartitions;
+
+	unsigned int pi = 0;
+	for (; pi < nofPartitions; ++pi)
+	{
+		Index part_start = start + pi * partsize;
+		Index part_end = part_start + partsize;
+		if (part_end > end) part_end = end;
+		if (part_start >= part_end) break;
+		m_partitions.push_back( new Partition( this, part_start, part_end));
+	}
+}
+
+QueryResult ParallelQueryEvaluation::evaluateRange( const Index& maxdocno)
+{
+	clear();
+	m_docnos.clear();
+	createPartitions( 1, maxdocno + 1);
+	return evaluatePartitions();
+}
+
+QueryResult ParallelQueryEvaluation::evaluateSet( const std::vector<Index>& docnos)
+{
+	clear();
+	m_docnos = docnos;
+	std::sort( m_docnos.begin(), m_docnos.end());
+	m_docnos.erase( std::unique( m_docnos.begin(), m_docnos.end()), m_docnos.end());
+	createPartitions( 0, m_docnos.size());
+	return evaluatePartitions();
+}
+
+QueryResult ParallelQueryEvaluation::evaluatePartitions()
+{
+	m_terminate = false;
+	try
+	{
+		std::vector<Partition*>::iterator ai = m_partitions.begin(), ae = m_partitions.end();
+		for (; ai != ae; ++ai)
+		{
+			{
+				strus::unique_lock lock( m_mutex);
+				++m_nofRunning;
+			}
+			try
+			{
+				m_pool->push( *ai);
+			}
+			catch (...)
+			{
+				strus::unique_lock lock( m_mutex);
+				--m_nofRunning;
+				throw;
+			}
+		}
+	}
+	catch (...)
+	{
+		{
+			strus::unique_lock lock( m_mutex);
+			m_terminate = true;
+		}
+		clear();
+		throw;
+	}
+	wait();
+	std::vector<QueryResult> results;
+	std::vector<Partition*>::iterator ai = m_partitions.begin(), ae = m_partitions.end();
+	for (; ai != ae; ++ai)
+	{
+		if (!(*ai)->errmsg.empty())
+		{
+			std::string errmsg = (*ai)->errmsg;
+			clear();
+			throw strus::runtime_error( "%s", errmsg.c_str());
+		}
+		results.push_back( (*ai)->result);
+	}
+	clear();
+	return evaluateSummaries( QueryResult::merge( results, m_minRank, m_maxNofRanks));
+}
+
+QueryResult ParallelQueryEvaluation::evaluateSummaries( const QueryResult& ranks)
+{
+	if (ranks.ranks().empty()) return ranks;
+	std::vector<Index> docnos;
+	docnos.reserve( ranks.ranks().size());
+	std::vector<ResultDocument>::const_iterator ri = ranks.ranks().begin(), re = ranks.ranks().end();
+	for (; ri != re; ++ri)
+	{
+		docnos.push_back( ri->docno());
+	}
+	std::sort( docnos.begin(), docnos.end());
+	// ... the statistics of the documents visited and ranked are the ones of the partitions, not the ones of the evaluation of the summaries
+	QueryResult summaries = m_evaluator->evaluateSummaries( docnos, docnos.size());
+	return QueryResult( ranks.evaluationPass(), ranks.nofRanked(), ranks.nofVisited(), summaries.ranks(), summaries.summaryElements());
+}
+
+void ParallelQueryEvaluation::run( Partition* part)
+{
+	try
+	{
+		std::vector<Index> chunk;
+		Index ci = part->start;
+		while (ci < part->end)
+		{
+			{
+				strus::unique_lock lock( m_mutex);
+				if (m_terminate) break;
+			}
+			Index ce = (part->end - ci > (Index)ChunkSize) ? (ci + (Index)ChunkSize) : part->end;
+			chunk.clear();
+			if (m_docnos.empty())
+			{
+				for (; ci < ce; ++ci) chunk.push_back( ci);
+			}
+			else
+			{
+				chunk.insert( chunk.end(), m_docnos.begin() + ci, m_docnos.begin() + ce);
+				ci = ce;
+			}
+			// ... every chunk is ranked up to the last rank of the result, so that the merge of the chunks does not lose any rank
+			std::vector<QueryResult> results;
+			results.push_back( part->result);
+			results.push_back( m_evaluator->evaluate( chunk, m_minRank + m_maxNofRanks));
+			part->result = QueryResult::merge( results, 0, m_minRank + m_maxNofRanks);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		part->errmsg = _TXT("memory allocation error in parallel query evaluation");
+	}
+	catch (const std::runtime_error& err)
+	{
+		part->errmsg = err.what();
+	}
+	{
+		strus::unique_lock lock( m_mutex);
+		if (!part->errmsg.empty())
+		{
+			m_terminate = true;
+		}
+		--m_nofRunning;
+		m_cond.notify_all();
+		//... notify while holding the lock, the waiting thread may delete this object as soon as it gets the lock
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_PARALLEL_QUERY_EVAL_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_PARALLEL_QUERY_EVAL_HPP_INCLUDED
+/// \brief Evaluation of a query with the documents split into partitions evaluated in parallel and the results merged
+#include "papuga/typedefs.h"
+#include "papuga/valueVariant.h"
+#include "strus/storage/index.hpp"
+#include "strus/storage/queryResult.hpp"
+#include "impl/value/workerThreadSlots.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Definitions of a query recorded with deep copies of their arguments, for building copies of the query
+class QueryDefinitions
+{
+public:
+	enum Type {Feature,MetaDataRestriction,TermStatistics,GlobalStatistics,Access,WeightingVariables};
+
+	struct Definition
+	{
+		Type type;			//< type of the definition
+		std::string name;		//< feature set name or term type
+		std::string value;		//< term value
+		papuga_ValueVariant arg;	//< expression, statistics or list argument of the definition
+		double weight;			//< feature weight
+
+		Definition( Type type_, const std::string& name_, const std::string& value_, double weight_)
+			:type(type_),name(name_),value(value_),weight(weight_)
+		{
+			papuga_init_ValueVariant( &arg);
+		}
+		Definition( const Definition& o)
+			:type(o.type),name(o.name),value(o.value),arg(o.arg),weight(o.weight){}
+	};
+
+	QueryDefinitions();
+	~QueryDefinitions();
+
+	/// \brief Record a definition
+	/// \param[in] type type of the definition
+	/// \param[in] arg argument of the definition (copied)
+	/// \param[in] name feature set name or term type
+	/// \param[in] value term value
+	/// \param[in] weight feature weight
+	void push( Type type, const papuga_ValueVariant& arg, const std::string& name=std::string(), const std::string& value=std::string(), double weight=0.0);
+
+	/// \brief Get the definitions recorded in the order of their recording
+	const std::vector<Definition>& definitions() const
+	{
+		return m_definitions;
+	}
+
+private:
+	QueryDefinitions( const QueryDefinitions&){}		//... non copyable
+	void operator=( const QueryDefinitions&){}		//... non copyable
+
+private:
+	std::vector<Definition> m_definitions;
+	papuga_Allocator m_allocator;			//< allocator for the copies of the arguments
+};
+
+/// \brief Evaluation of a copy of a query restricted to a set of documents, called from the threads of a parallel query evaluation
+class QueryPartitionEvaluator
+{
+public:
+	virtual ~QueryPartitionEvaluator(){}
+
+	/// \brief Rank the documents of a set with a copy of the query without summarizers
+	/// \param[in] docnos ascending list of documents to evaluate the query on
+	/// \param[in] maxNofRanks maximum number of ranks to return starting with the best one
+	/// \return the result without summaries
+	/// \remark throws an error on failure
+	/// \note Must be callable from several threads at the same time
+	virtual QueryResult evaluate( const std::vector<Index>& docnos, int maxNofRanks) const=0;
+
+	/// \brief Evaluate a copy of the query with its summarizers on the documents of the merged result
+	/// \param[in] docnos ascending list of documents to evaluate the query on
+	/// \param[in] maxNofRanks maximum number of ranks to return starting with the best one
+	/// \return the result with summaries
+	/// \remark throws an error on failure
+	virtual QueryResult evaluateSummaries( const std::vector<Index>& docnos, int maxNofRanks) const=0;
+};
+
+/// \brief Evaluation of a query with the document number range or the evaluation set of the query split into partitions evaluated in parallel
+/// \note Each partition is evaluated by a thread of the worker thread pool of the context in chunks of documents passed as evaluation set to a copy of the query without summarizers.
+///	The ranklists of the chunks and partitions are merged with 'QueryResult::merge', the summaries are evaluated only for the documents of the merged result.
+///	The statistics used for weighting do not depend on the evaluation set, so the weights of the documents are the same as in a sequential evaluation of the query
+class ParallelQueryEvaluation
+{
+public:
+	enum {
+		MaxNofPartitions=64,		//< maximum number of partitions
+		ChunkSize=(1<<20)		//< maximum number of documents in the evaluation set of one query evaluation of a partition
+	};
+
+	/// \brief Constructor
+	/// \param[in] evaluator_ evaluator of the copies of the query
+	/// \param[in] pool_ pool of the background threads evaluating the partitions
+	/// \param[in] nofPartitions_ number of partitions to evaluate in parallel, each by a background thread the caller has reserved a worker thread slot for (see WorkerThreadSlots)
+	/// \param[in] minRank_ index, starting with 0, of the first rank of the result returned
+	/// \param[in] maxNofRanks_ maximum number of ranks of the result returned
+	ParallelQueryEvaluation( const QueryPartitionEvaluator* evaluator_, WorkerThreadPool* pool_, unsigned int nofPartitions_, int minRank_, int maxNofRanks_);
+	/// \brief Destructor, waits for the partitions evaluated to finish
+	~ParallelQueryEvaluation();
+
+	/// \brief Evaluate the query on all documents
+	/// \param[in] maxdocno maximum document number of the storage
+	/// \return the merged result
+	QueryResult evaluateRange( const Index& maxdocno);
+
+	/// \brief Evaluate the query on an evaluation set
+	/// \param[in] docnos the evaluation set (unordered, with duplicates allowed)
+	/// \return the merged result
+	QueryResult evaluateSet( const std::vector<Index>& docnos);
+
+private:
+	struct Partition
+		:public WorkerThreadJob
+	{
+		ParallelQueryEvaluation* evaluation;	//< evaluation the partition belongs to
+		Index start;				//< first document number or index of the first element of the evaluation set of the partition
+		Index end;				//< end (not included) of the partition
+		QueryResult result;			//< merged result of the chunks of the partition evaluated
+		std::string errmsg;			//< error reported by the background thread
+
+		Partition( ParallelQueryEvaluation* evaluation_, const Index& start_, const Index& end_)
+			:evaluation(evaluation_),start(start_),end(end_),result(),errmsg(){}
+		virtual ~Partition(){}
+
+		virtual void run()
+		{
+			evaluation->run( this);
+		}
+	};
+
+	/// \brief Create the partitions of a range of documents or elements of the evaluation set
+	void createPartitions( const Index& start, const Index& end);
+	/// \brief Push the partitions to the worker thread pool, wait for them to finish and merge their results
+	QueryResult evaluatePartitions();
+	/// \brief Evaluate the summaries of the documents of a merged result
+	QueryResult evaluateSummaries( const QueryResult& ranks);
+	/// \brief Evaluate a partition, run by a background thread
+	void run( Partition* part);
+	/// \brief Wait for the partitions pushed to finish
+	void wait();
+	/// \brief Wait for the partitions pushed to finish and free all resources
+	void clear();
+
+private:
+	ParallelQueryEvaluation( const ParallelQueryEvaluation&){}	//... non copyable
+	void operator=( const ParallelQueryEvaluation&){}		//... non copyable
+
+private:
+	const QueryPartitionEvaluator* m_evaluator;
+	WorkerThreadPool* m_pool;
+	unsigned int m_nofPartitions;
+	int m_minRank;
+	int m_maxNofRanks;
+	strus::mutex m_mutex;				//< mutex for the termination flag and the counter of partitions running
+	strus::condition_variable m_cond;		//< signal for a partition finished
+	unsigned int m_nofRunning;			//< number of partitions pushed to the worker thread pool and not finished yet
+	std::vector<Partition*> m_partitions;
+	std::vector<Index> m_docnos;			//< sorted evaluation set split into partitions, empty if the document number range is split
+	bool m_terminate;				//< true, if a partition failed and the background threads should stop
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Iterator on the rows of a select scanning partitions of the document number range in parallel
+#include "impl/value/parallelSelectIterator.hpp"
+#include "impl/value/selectIterator.hpp"
+#include "impl/value/workerThreadSlots.hpp"
+#include "papuga/valueVariant.h"
+#include "papuga/callResult.h"
+#include "papuga/serialization.h"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+#define ITERATOR_NAME "parallel select iterator"
+
+using namespace strus;
+using namespace strus::bindings;
+
+ParallelSelectIterator::ParallelSelectIterator(
+		const ObjectRef& trace_,
+		const ObjectRef& objbuilder_,
+		const ObjectRef& storage_,
+		const ObjectRef& errorhnd_,
+		const ObjectRef& zonemap_,
+		const ObjectRef& workers_,
+		const papuga_ValueVariant& what,
+		const papuga_ValueVariant& expression,
+		const papuga_ValueVariant& restriction,
+		const Index& start_docno_,
+		const papuga_ValueVariant& accesslist,
+		unsigned int batchsize_,
+		bool ordered_)
+	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_),m_zonemap_impl(zonemap_),m_workers_impl(workers_)
+	,m_mutex(),m_cond_produced(),m_cond_consumed(),m_partitions(),m_curPartition(0),m_curChunk(0),m_curRow(0)
+	,m_batchsize(batchsize_),m_chunksize(batchsize_ ? batchsize_ : (unsigned int)DefaultChunkSize),m_ordered(ordered_),m_terminate(false)
+{
+	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
+	unsigned int nofPartitions = m_workers_impl.getObject<WorkerThreadAllocation>()->nofThreads();
+	if (!nofPartitions) throw strus::runtime_error(_TXT("no worker threads allocated for %s"), ITERATOR_NAME);
+
+	// ... split the document number range into partitions of equal size
+	Index start_docno = start_docno_ ? start_docno_ : 1;
+	Index end_docno = storage->maxDocumentNumber() + 1;
+	Index range = end_docno > start_docno ? (end_docno - start_docno) : 0;
+	if ((Index)nofPartitions > range) nofPartitions = range ? range : 1;
+	Index partsize = (range + nofPartitions - 1) / nofPartitions;
+
+	try
+	{
+		unsigned int pi = 0;
+		for (; pi < nofPartitions; ++pi)
+		{
+			Index part_start = start_docno + pi * partsize;
+			Index part_end = part_start + partsize;
+			if (part_end > end_docno) part_end = end_docno;
+
+			m_partitions.push_back( new Partition());
+			m_partitions.back()->iter = new SelectIterator( m_trace_impl, m_objbuilder_impl, m_storage_impl, m_errorhnd_impl, m_zonemap_impl, what, expression, restriction, part_start, accesslist, m_chunksize, part_end);
+		}
+		std::vector<Partition*>::iterator ai = m_partitions.begin(), ae = m_partitions.end();
+		for (; ai != ae; ++ai)
+		{
+			(*ai)->thread = new strus::thread( &ParallelSelectIterator::run, this, *ai);
+		}
+	}
+	catch (...)
+	{
+		clear();
+		throw;
+	}
+}
+
+ParallelSelectIterator::~ParallelSelectIterator()
+{
+	clear();
+}
+
+void ParallelSelectIterator::clear()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+	}
+	m_cond_consumed.notify_all();
+	std::vector<Partition*>::iterator ai = m_partitions.begin(), ae = m_partitions.end();
+	for (; ai != ae; ++ai)
+	{
+		if ((*ai)->thread)
+		{
+			(*ai)->thread->join();
+			delete (*ai)->thread;
+		}
+		delete (*ai)->iter;
+		std::deque<SelectRowBuffer*>::iterator ci = (*ai)->chunks.begin(), ce = (*ai)->chunks.end();
+		for (; ci != ce; ++ci)
+		{
+			delete *ci;
+		}
+		delete *ai;
+	}
+	m_partitions.clear();
+	if (m_curChunk)
+	{
+		delete m_curChunk;
+		m_curChunk = 0;
+	}
+}
+
+void ParallelSelectIterator::run( Partition* part)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	std::string errmsg;
+	try
+	{
+		bool more = true;
+		while (more)
+		{
+			strus::local_ptr<SelectRowBuffer> chunk( new SelectRowBuffer());
+			unsigned int nofRows = part->iter->fetchRows( *chunk, m_chunksize, m_batchsize == 0/*withNames*/);
+			if (errorhnd->hasError())
+			{
+				errmsg = errorhnd->fetchError();
+				break;
+			}
+			more = (nofRows == m_chunksize);
+			if (nofRows)
+			{
+				strus::unique_lock lock( m_mutex);
+				while (part->chunks.size() >= MaxQueuedChunks && !m_terminate)
+				{
+					m_cond_consumed.wait( lock);
+				}
+				if (m_terminate) break;
+				part->chunks.push_back( chunk.get());
+				chunk.release();
+			}
+			m_cond_produced.notify_all();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		errmsg = _TXT("out of memory");
+	}
+	catch (const std::runtime_error& err)
+	{
+		errmsg = err.what();
+	}
+	catch (...)
+	{
+		errmsg = _TXT("uncaught exception");
+	}
+	{
+		strus::unique_lock lock( m_mutex);
+		part->errmsg = errmsg;
+		part->done = true;
+	}
+	m_cond_produced.notify_all();
+}
+
+SelectRowBuffer* ParallelSelectIterator::fetchChunk()
+{
+	strus::unique_lock lock( m_mutex);
+	for (;;)
+	{
+		if (m_ordered)
+		{
+			// ... take the chunks of the partitions one after the other, the rows are returned in ascending order of document numbers
+			while (m_curPartition < m_partitions.size())
+			{
+				Partition* part = m_partitions[ m_curPartition];
+				if (!part->chunks.empty())
+				{
+					SelectRowBuffer* rt = part->chunks.front();
+					part->chunks.pop_front();
+					m_cond_consumed.notify_all();
+					return rt;
+				}
+				if (!part->done) break;
+				if (!part->errmsg.empty()) throw strus::runtime_error( "%s", part->errmsg.c_str());
+				++m_curPartition;
+			}
+			if (m_curPartition == m_partitions.size()) return NULL;
+		}
+		else
+		{
+			// ... take the next chunk available, visiting the partitions round robin
+			bool alldone = true;
+			std::size_t pi = 0;
+			for (; pi < m_partitions.size(); ++pi)
+			{
+				std::size_t pidx = (m_curPartition + pi) % m_partitions.size();
+				Partition* part = m_partitions[ pidx];
+				if (!part->chunks.empty())
+				{
+					SelectRowBuffer* rt = part->chunks.front();
+					part->chunks.pop_front();
+					m_curPartition = pidx + 1;
+					m_cond_consumed.notify_all();
+					return rt;
+				}
+				if (!part->done)
+				{
+					alldone = false;
+				}
+				else if (!part->errmsg.empty())
+				{
+					throw strus::runtime_error( "%s", part->errmsg.c_str());
+				}
+			}
+			if (alldone) return NULL;
+		}
+		m_cond_produced.wait( lock);
+	}
+}
+
+bool ParallelSelectIterator::getNext( papuga_CallResult* result)
+{
+	try
+	{
+		if (m_batchsize)
+		{
+			strus::local_ptr<SelectRowBuffer> chunk( fetchChunk());
+			if (!chunk.get()) return false;
+
+			if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+			papuga_Serialization* serialization = result->valuear[0].value.serialization;
+
+			bool ser = true;
+			ser &= papuga_Serialization_pushName_charp( serialization, "header");
+			ser &= m_partitions[0]->iter->serializeHeader( serialization);
+			ser &= papuga_Serialization_pushName_charp( serialization, "rows");
+			ser &= papuga_Serialization_pushOpen( serialization);
+			std::size_t ri = 0, re = chunk->nofRows();
+			for (; ri != re; ++ri)
+			{
+				ser &= papuga_Serialization_pushOpen( serialization);
+				ser &= chunk->serializeRow( ri, serialization, result->allocator);
+				ser &= papuga_Serialization_pushClose( serialization);
+			}
+			ser &= papuga_Serialization_pushClose( serialization);
+			if (!ser) throw std::bad_alloc();
+			return true;
+		}
+		else
+		{
+			while (!m_curChunk || m_curRow >= m_curChunk->nofRows())
+			{
+				if (m_curChunk)
+				{
+					delete m_curChunk;
+					m_curChunk = 0;
+				}
+				m_curChunk = fetchChunk();
+				m_curRow = 0;
+				if (!m_curChunk) return false;
+			}
+			if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+			papuga_Serialization* serialization = result->valuear[0].value.serialization;
+			if (!m_curChunk->serializeRow( m_curRow++, serialization, result->allocator)) throw std::bad_alloc();
+			return true;
+		}
+	}
+	catch (const std::bad_alloc& err)
+	{
+		papuga_CallResult_reportError( result, _TXT("memory allocation error in %s get next"), ITERATOR_NAME);
+		return false;
+	}
+	catch (const std::runtime_error& err)
+	{
+		papuga_CallResult_reportError( result, _TXT("error in %s get next: %s"), ITERATOR_NAME, err.what());
+		return false;
+	}
+}
+
+bool ParallelSelectIterator::GetNext( void* self, papuga_CallResult* result)
+{
+	return ((ParallelSelectIterator*)self)->getNext( result);
+}
+
+void ParallelSelectIterator::Deleter( void* obj)
+{
+	delete (ParallelSelectIterator*)obj;
+}
+
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_PARALLEL_SELECT_ITERATOR_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_PARALLEL_SELECT_ITERATOR_HPP_INCLUDED
+/// \brief Iterator on the rows of a select scanning partitions of the document number range in parallel
+#include "papuga/typedefs.h"
+#include "strus/storage/index.hpp"
+#include "strus/base/thread.hpp"
+#include "impl/value/objectref.hpp"
+#include "impl/value/selectRowBuffer.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Forward declaration
+class SelectIterator;
+
+/// \brief Iterator on the rows of a select scanning partitions of the document number range in parallel
+/// \note Each partition is scanned by a select iterator of its own running in a background thread, the rows are passed in chunks to the iterating thread
+/// \note The number of partitions is the number of worker thread slots allocated for the iterator
+class ParallelSelectIterator
+{
+public:
+	enum {
+		DefaultNofPartitions=4,		//< number of partitions if not specified
+		DefaultChunkSize=128,		//< number of rows passed at once from a background thread if no batch size is specified
+		MaxQueuedChunks=4		//< maximum number of chunks waiting per partition before its background thread blocks
+	};
+
+	ParallelSelectIterator(
+		const ObjectRef& trace_,
+		const ObjectRef& objbuilder_,
+		const ObjectRef& storage_,
+		const ObjectRef& errorhnd_,
+		const ObjectRef& zonemap_,
+		const ObjectRef& workers_,
+		const papuga_ValueVariant& what,
+		const papuga_ValueVariant& expression,
+		const papuga_ValueVariant& restriction,
+		const Index& start_docno_,
+		const papuga_ValueVariant& accesslist,
+		unsigned int batchsize_,
+		bool ordered_);
+	virtual ~ParallelSelectIterator();
+
+	bool getNext( papuga_CallResult* result);
+
+	static bool GetNext( void* self, papuga_CallResult* result);
+	static void Deleter( void* obj);
+
+private:
+	struct Partition
+	{
+		SelectIterator* iter;			//< select iterator on the document number range of the partition
+		strus::thread* thread;			//< background thread scanning the partition
+		std::deque<SelectRowBuffer*> chunks;	//< chunks of rows fetched and not consumed yet
+		bool done;				//< true if the background thread has finished
+		std::string errmsg;			//< error reported by the background thread
+
+		Partition()
+			:iter(0),thread(0),chunks(),done(false),errmsg(){}
+	};
+
+	/// \brief Scan a partition, run by a background thread
+	void run( Partition* part);
+	/// \brief Get the next chunk of rows, blocks until one is available
+	/// \return the chunk (ownership passed to the caller) or NULL if all partitions have been scanned
+	SelectRowBuffer* fetchChunk();
+	/// \brief Stop the background threads and free all resources
+	void clear();
+
+private:
+	ParallelSelectIterator( const ParallelSelectIterator&){}	//... non copyable
+	void operator=( const ParallelSelectIterator&){}		//... non copyable
+
+private:
+	ObjectRef m_trace_impl;
+	ObjectRef m_objbuilder_impl;
+	ObjectRef m_storage_impl;
+	ObjectRef m_errorhnd_impl;
+	ObjectRef m_zonemap_impl;
+	ObjectRef m_workers_impl;			//< worker thread slots allocated, one for each partition
+	strus::mutex m_mutex;				//< mutex for the chunk queues of the partitions
+	strus::condition_variable m_cond_produced;	//< signal for a chunk available or a partition finished
+	strus::condition_variable m_cond_consumed;	//< signal for a chunk consumed or termination
+	std::vector<Partition*> m_partitions;
+	std::size_t m_curPartition;			//< partition to take the next chunk from
+	SelectRowBuffer* m_curChunk;			//< chunk with rows not returned yet (without batch size)
+	std::size_t m_curRow;				//< next row to return of the current chunk
+	unsigned int m_batchsize;
+	unsigned int m_chunksize;
+	bool m_ordered;
+	bool m_terminate;				//< true, if the background threads should stop
+};
+
+}}//namespace
+#endif
+
@@ -11,6 +11,12 @@
 #include "strus/storageObjectBuilderInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/queryProcessorInterface.hpp"
+#include "strus/storageClientInterface.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "strus/base/string_conv.hpp"
+#include "strus/base/base64.hpp"
+#include "strus/lib/error.hpp"
+#include "impl/value/varintEncoding.hpp"
 #include "expressionBuilder.hpp"
 #include "deserializer.hpp"
 #include "serializer.hpp"
@@ -21,8 +27,8 @@
 using namespace strus;
 using namespace strus::bindings;
 
-PostingIterator::PostingIterator( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& storage_, const ObjectRef& errorhnd_, const papuga_ValueVariant& expression, const papuga_ValueVariant& restriction, const Index& start_docno_)
-	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_),m_postings(),m_restriction(),m_docno(start_docno_?start_docno_:1)
+PostingIterator::PostingIterator( const ObjectRef& trace_, const ObjectRef& objbuilder_, const ObjectRef& storage_, const ObjectRef& errorhnd_, const ObjectRef& zonemap_, const papuga_ValueVariant& expression, const papuga_ValueVariant& restriction, const Index& start_docno_, const std::string& output_)
+	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_),m_zonemap_impl(zonemap_),m_postings(),m_restriction(),m_zonecursor(),m_docno(start_docno_?start_docno_:1),m_output(getOutputMode(output_))
 {
 	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
 	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
@@ -43,27 +49,85 @@ PostingIterator::PostingIterator( const ObjectRef& trace_, const ObjectRef& objb
 		Deserializer::buildMetaDataRestriction( builder.get(), restriction, errorhnd);
 		m_restriction.reset( builder->createInstance());
 		if (!m_restriction.get()) throw strus::runtime_error(_TXT("failed to create metadata restriction for %s instance"), ITERATOR_NAME);
+
+		MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<MetaDataZoneMap>();
+		if (zonemap)
+		{
+			MetaDataZoneFilter filter;
+			Deserializer::buildMetaDataRestriction( &filter, restriction, errorhnd);
+			MetaDataReaderInterface* zonereader = storage->createMetaDataReader();
+			if (!zonereader) throw strus::runtime_error( _TXT("failed to create metadata reader for %s"), ITERATOR_NAME);
+			m_zonecursor.reset( new MetaDataZoneCursor( zonemap, filter, zonereader, storage->maxDocumentNumber()));
+		}
 	}
 }
 
+PostingIterator::OutputMode PostingIterator::getOutputMode( const std::string& name)
+{
+	if (name.empty() || strus::caseInsensitiveEquals( name, "positions")) return OutputPositions;
+	if (strus::caseInsensitiveEquals( name, "docno")) return OutputDocno;
+	if (strus::caseInsensitiveEquals( name, "ff")) return OutputFf;
+	if (strus::caseInsensitiveEquals( name, "packed")) return OutputPacked;
+	throw strus::runtime_error(_TXT("unknown output mode '%s' of %s, expected one of %s"), name.c_str(), ITERATOR_NAME, "'positions','docno','ff','packed'");
+}
+
+bool PostingIterator::pushPackedPositions( papuga_CallResult* result)
+{
+	std::string buf;
+	Index prevpos = 0;
+	for (Index pos = 0; 0!=(pos=m_postings->skipPos(pos)); ++pos)
+	{
+		appendVarint( buf, pos - prevpos);
+		prevpos = pos;
+	}
+	std::string packed( strus::base64EncodeLength( buf.size()), '\0');
+	ErrorCode errcode = (ErrorCode)0;
+	packed.resize( strus::encodeBase64( const_cast<char*>( packed.c_str()), packed.size(), buf.c_str(), buf.size(), errcode));
+	if (errcode) throw strus::runtime_error(_TXT("error encoding positions of %s: %s"), ITERATOR_NAME, errorCodeToString( errcode));
+	return papuga_add_CallResult_string_copy( result, packed.c_str(), packed.size());
+}
+
 bool PostingIterator::getNext( papuga_CallResult* result)
 {
 	try
 	{
 		if (!m_docno) return false;
-		for (; 0!=(m_docno = m_postings->skipDoc( m_docno)); ++m_docno)
+		for (;;)
 		{
+			if (m_zonecursor.get())
+			{
+				// ... skip the blocks of documents that cannot match the restriction
+				m_docno = m_zonecursor->skipDoc( m_docno);
+			}
+			if (0==(m_docno = m_postings->skipDoc( m_docno))) break;
+			if (m_zonecursor.get() && m_zonecursor->skipDoc( m_docno) != m_docno) continue;
 			if (!m_restriction.get() || m_restriction->match( m_docno)) break;
+			++m_docno;
 		}
 		if (m_docno)
 		{
 			bool ser = true;
 			if (!papuga_add_CallResult_int( result, m_docno++)) throw std::bad_alloc();
-			if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
-			papuga_Serialization* serialization = result->valuear[ result->nofvalues-1].value.serialization;
-			for (Index pos = 0; 0!=(pos=m_postings->skipPos(pos)); ++pos)
+			switch (m_output)
 			{
-				ser &= papuga_Serialization_pushValue_int( serialization, pos);
+				case OutputDocno:
+					break;
+				case OutputFf:
+					if (!papuga_add_CallResult_int( result, m_postings->frequency())) throw std::bad_alloc();
+					break;
+				case OutputPacked:
+					ser = pushPackedPositions( result);
+					break;
+				case OutputPositions:
+				{
+					if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+					papuga_Serialization* serialization = result->valuear[ result->nofvalues-1].value.serialization;
+					for (Index pos = 0; 0!=(pos=m_postings->skipPos(pos)); ++pos)
+					{
+						ser &= papuga_Serialization_pushValue_int( serialization, pos);
+					}
+					break;
+				}
 			}
 			if (!ser)
 			{
@@ -13,6 +13,7 @@
 #include "strus/postingIteratorInterface.hpp"
 #include "strus/metaDataRestrictionInstanceInterface.hpp"
 #include "impl/value/objectref.hpp"
+#include "impl/value/metaDataZoneMap.hpp"
 #include <vector>
 #include <string>
 
@@ -27,9 +28,11 @@ public:
 		const ObjectRef& objbuilder_,
 		const ObjectRef& storage_,
 		const ObjectRef& errorhnd_,
+		const ObjectRef& zonemap_,
 		const papuga_ValueVariant& expression,
 		const papuga_ValueVariant& restriction,
-		const Index& start_docno_);
+		const Index& start_docno_,
+		const std::string& output_=std::string());
 	virtual ~PostingIterator(){}
 
 	bool getNext( papuga_CallResult* result);
@@ -37,14 +40,28 @@ public:
 	static bool GetNext( void* self, papuga_CallResult* result);
 	static void Deleter( void* obj);
 
+private:
+	/// \brief What is returned for a posting besides the document number
+	enum OutputMode {
+		OutputPositions,	//< list of positions
+		OutputDocno,		//< nothing
+		OutputFf,		//< feature frequency
+		OutputPacked		//< positions as base64 encoded string of varint encoded deltas
+	};
+	static OutputMode getOutputMode( const std::string& name);
+	bool pushPackedPositions( papuga_CallResult* result);
+
 private:
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
 	ObjectRef m_storage_impl;
 	ObjectRef m_errorhnd_impl;
+	ObjectRef m_zonemap_impl;
 	Reference<PostingIteratorInterface> m_postings;
 	Reference<MetaDataRestrictionInstanceInterface> m_restriction;
+	Reference<MetaDataZoneCursor> m_zonecursor;
 	Index m_docno;
+	OutputMode m_output;
 };
 
 }}//namespace
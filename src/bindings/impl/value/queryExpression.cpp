@@ -281,6 +281,74 @@ void QueryExpression::serializeFeatures( papuga_Serialization* ser, bool mapType
 	}
 }
 
+void QueryExpression::collectTerms( std::set<TermKey>& res, const Node& nd) const
+{
+	switch (nd.type)
+	{
+		case Node::TermType:
+		{
+			const Term& term = m_termar[ nd.idx];
+			res.insert( TermKey( term.type, term.value));
+			break;
+		}
+		case Node::ExpressionType:
+		{
+			const Expression& expr = m_exprar[ nd.idx];
+			int ai=0, ae=expr.argc;
+			int ni = expr.nodeidx;
+			for (; ai != ae; ++ai)
+			{
+				const Node& chldnd = m_nodear[ ni];
+				collectTerms( res, chldnd);
+				ni = chldnd.next;
+			}
+			if (ni != -1) throw std::runtime_error(_TXT("internal: corrupt query expression"));
+			break;
+		}
+	}
+}
+
+std::set<QueryExpression::TermKey> QueryExpression::getFeatureTerms() const
+{
+	std::set<TermKey> rt;
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (; fi != fe; ++fi)
+	{
+		collectTerms( rt, m_nodear[ fi->nodeidx]);
+	}
+	return rt;
+}
+
+std::set<QueryExpression::TermKey> QueryExpression::getFeatureTerms( const std::set<std::string>& featureSets) const
+{
+	std::set<TermKey> rt;
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (; fi != fe; ++fi)
+	{
+		if (featureSets.find( fi->set) != featureSets.end())
+		{
+			collectTerms( rt, m_nodear[ fi->nodeidx]);
+		}
+	}
+	return rt;
+}
+
+void QueryExpression::serializeFeaturesReferencingOther( papuga_Serialization* ser, const std::set<TermKey>& terms, bool mapTypes) const
+{
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (; fi != fe; ++fi)
+	{
+		std::set<TermKey> featterms;
+		collectTerms( featterms, m_nodear[ fi->nodeidx]);
+		std::set<TermKey>::const_iterator ti = featterms.begin(), te = featterms.end();
+		for (; ti != te && terms.find( *ti) != terms.end(); ++ti){}
+		if (ti != te)
+		{
+			serializeFeature( ser, *fi, mapTypes);
+		}
+	}
+}
+
 void QueryExpression::serializeCollectedTerms( papuga_Serialization* ser) const
 {
 	bool rt = true;
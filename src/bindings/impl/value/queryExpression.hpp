@@ -17,6 +17,8 @@
 #include "papuga/typedefs.h"
 #include <vector>
 #include <string>
+#include <set>
+#include <utility>
 
 namespace strus {
 namespace bindings {
@@ -37,6 +39,13 @@ public:
 	void addCollectSummary( const std::vector<SummaryElement>& summary);
 
 	void serializeFeatures( papuga_Serialization* ser, bool mapTypes) const;
+
+	typedef std::pair<std::string,std::string> TermKey;
+	std::set<TermKey> getFeatureTerms() const;
+	/// \brief Get the terms of the features of a selected list of feature sets
+	std::set<TermKey> getFeatureTerms( const std::set<std::string>& featureSets) const;
+	/// \brief Serialize only the features referencing at least one term that is not in a set of terms
+	void serializeFeaturesReferencingOther( papuga_Serialization* ser, const std::set<TermKey>& terms, bool mapTypes) const;
 	void serializeCollectedTerms( papuga_Serialization* ser) const;
 
 	const papuga_Serialization* getRestrictions() const		{return &m_restrictionSerialization;}
@@ -108,6 +117,7 @@ private:
 	void fillWeightedQueryTerms( std::vector<WeightedSentenceTerm>& weightedQueryTerms, const Node& nd, double ww) const;
 	void serializeFeature( papuga_Serialization* serialization, const Feature& feature, bool mapTypes) const;
 	void serializeNode( papuga_Serialization* serialization, const Node& nd, bool mapTypes) const;
+	void collectTerms( std::set<TermKey>& res, const Node& nd) const;
 
 	typedef std::map<std::string,double> CollectedSummaryMap;
 	typedef std::map<std::string,CollectedSummaryMap> NameCollectedSummaryMapMap;
@@ -15,11 +15,13 @@
 #include "strus/metaDataReaderInterface.hpp"
 #include "strus/attributeReaderInterface.hpp"
 #include "strus/aclReaderInterface.hpp"
+#include "strus/valueIteratorInterface.hpp"
 #include "strus/constants.hpp"
 #include "strus/base/string_conv.hpp"
 #include "expressionBuilder.hpp"
 #include "deserializer.hpp"
 #include "serializer.hpp"
+#include <algorithm>
 
 #define ITERATOR_NAME "select iterator"
 
@@ -31,12 +33,15 @@ SelectIterator::SelectIterator(
 		const ObjectRef& objbuilder_,
 		const ObjectRef& storage_,
 		const ObjectRef& errorhnd_,
+		const ObjectRef& zonemap_,
 		const papuga_ValueVariant& what,
 		const papuga_ValueVariant& expression,
 		const papuga_ValueVariant& restriction,
 		const Index& start_docno_,
-		const papuga_ValueVariant& accesslist)
-	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_),m_attributes(),m_metadata(),m_acls(),m_postings(),m_restriction(),m_forwarditer(),m_docno(start_docno_?start_docno_:1),m_maxdocno(0),m_items()
+		const papuga_ValueVariant& accesslist,
+		unsigned int batchsize_,
+		const Index& end_docno_)
+	:m_trace_impl(trace_),m_objbuilder_impl(objbuilder_),m_storage_impl(storage_),m_errorhnd_impl(errorhnd_),m_zonemap_impl(zonemap_),m_attributes(),m_metadata(),m_acls(),m_postings(),m_restriction(),m_zonecursor(),m_forwarditer(),m_searchiter(),m_accessiter(),m_docnolist(),m_docnoidx(0),m_docno(start_docno_?start_docno_:1),m_maxdocno(0),m_items(),m_batchsize(batchsize_),m_row()
 {
 	const StorageObjectBuilderInterface* objBuilder = m_objbuilder_impl.getObject<const StorageObjectBuilderInterface>();
 	const StorageClientInterface* storage = m_storage_impl.getObject<const StorageClientInterface>();
@@ -53,6 +58,10 @@ SelectIterator::SelectIterator(
 	if (!metadatareader) throw strus::runtime_error( _TXT("failed to create metadata reader for %s"), ITERATOR_NAME);
 
 	m_maxdocno = storage->maxDocumentNumber();
+	if (end_docno_ && end_docno_ <= m_maxdocno)
+	{
+		m_maxdocno = end_docno_ - 1;
+	}
 
 	if (papuga_ValueVariant_defined( &accesslist))
 	{
@@ -84,6 +93,19 @@ SelectIterator::SelectIterator(
 			m_restriction.reset( builder->createInstance());
 			if (!m_restriction.get()) throw strus::runtime_error(_TXT("failed to create metadata restriction for %s instance"), ITERATOR_NAME);
 		}
+		MetaDataZoneMap* zonemap = m_zonemap_impl.getObject<MetaDataZoneMap>();
+		if (zonemap)
+		{
+			MetaDataZoneFilter filter;
+			Deserializer::buildMetaDataRestriction( &filter, restriction, errorhnd);
+			MetaDataReaderInterface* zonereader = storage->createMetaDataReader();
+			if (!zonereader) throw strus::runtime_error( _TXT("failed to create metadata reader for %s"), ITERATOR_NAME);
+			m_zonecursor.reset( new MetaDataZoneCursor( zonemap, filter, zonereader, storage->maxDocumentNumber()));
+		}
+	}
+	if (!m_postings.get() && m_accessiter.empty())
+	{
+		collectDocumentNumbers( storage);
 	}
 	std::vector<std::string> elemlist = Deserializer::getStringList( what);
 	std::vector<std::string>::const_iterator ei = elemlist.begin(), ee = elemlist.end();
@@ -143,10 +165,33 @@ SelectIterator::SelectIterator(
 	}
 }
 
-bool SelectIterator::checkAccess( const Index& docno)
+void SelectIterator::collectDocumentNumbers( const StorageClientInterface* storage)
+{
+	ErrorBufferInterface* errorhnd = m_errorhnd_impl.getObject<ErrorBufferInterface>();
+	Reference<ValueIteratorInterface> docidItr( storage->createDocIdIterator());
+	if (!docidItr.get()) throw strus::runtime_error( _TXT("failed to create document identifier iterator for %s: %s"), ITERATOR_NAME, errorhnd->fetchError());
+	for (;;)
+	{
+		std::vector<std::string> docids = docidItr->fetchValues( FetchDocIdChunkSize);
+		if (docids.empty()) break;
+		std::vector<std::string>::const_iterator di = docids.begin(), de = docids.end();
+		for (; di != de; ++di)
+		{
+			Index dn = storage->documentNumber( *di);
+			if (dn >= m_docno && dn <= m_maxdocno) m_docnolist.push_back( dn);
+		}
+	}
+	if (errorhnd->hasError())
+	{
+		throw strus::runtime_error( _TXT("failed to collect the document numbers for %s: %s"), ITERATOR_NAME, errorhnd->fetchError());
+	}
+	std::sort( m_docnolist.begin(), m_docnolist.end());
+}
+
+Index SelectIterator::nextAccessible( const Index& docno)
 {
 	// [NOTE] This function assumes to be called with document numbers (docno) in ascending order !!!
-	if (m_accessiter.empty()) return docno;
+	Index rt = 0;
 	std::vector<AccessRestriction>::iterator
 		ai = m_accessiter.begin(), ae = m_accessiter.end();
 	for (; ai != ae; ++ai)
@@ -155,34 +200,36 @@ bool SelectIterator::checkAccess( const Index& docno)
 		if (ai->docno < docno)
 		{
 			ai->docno = ai->acciter->skipDoc( docno);
+			if (ai->docno == 0) continue;
 		}
-		if (ai->docno == docno) return true;
+		if (!rt || ai->docno < rt) rt = ai->docno;
 	}
-	return false;
+	return rt;
 }
 
-bool SelectIterator::buildRow( papuga_CallResult* result)
+void SelectIterator::fetchRow( SelectRowBuffer& row, bool withNames)
 {
 	AttributeReaderInterface* attributereader = 0;
 	MetaDataReaderInterface* metadatareader = 0;
 
-	bool ser = true;
-	if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
-	papuga_Serialization* serialization = result->valuear[0].value.serialization;
+	row.startRow();
 	if (m_items.empty())
 	{
-		ser &= papuga_Serialization_pushValue_int( serialization, m_docno);
+		row.pushInt( m_docno);
 	}
 	else
 	{
 		std::vector<ItemDef>::const_iterator ei = m_items.begin(), ee = m_items.end();
 		for (; ei != ee; ++ei)
 		{
-			ser &= papuga_Serialization_pushName_string( serialization, ei->name().c_str(), ei->name().size());
+			if (withNames)
+			{
+				row.pushName( ei->name());
+			}
 			switch (ei->type())
 			{
 				case ItemDef::None:
-					ser &= papuga_Serialization_pushValue_void( serialization);
+					row.pushVoid();
 					break;
 
 				case ItemDef::MetaData:
@@ -193,11 +240,11 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 					}
 					if (ei->handle() >= 0)
 					{
-						Serializer::serialize( serialization, metadatareader->getValue( ei->handle()), true/*deep*/);
+						row.pushNumeric( metadatareader->getValue( ei->handle()));
 					}
 					else
 					{
-						ser &= papuga_Serialization_pushValue_void( serialization);
+						row.pushVoid();
 					}
 					break;
 
@@ -209,15 +256,11 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 							attributereader = (AttributeReaderInterface*)m_attributes.get();
 							attributereader->skipDoc( m_docno);
 						}
-						std::string attrvalstr = attributereader->getValue( ei->handle());
-						const char* attrvalptr = papuga_Allocator_copy_string( result->allocator, attrvalstr.c_str(), attrvalstr.size());
-						if (!attrvalptr) throw std::bad_alloc();
-
-						ser &= papuga_Serialization_pushValue_string( serialization, attrvalptr, attrvalstr.size());
+						row.pushString( attributereader->getValue( ei->handle()));
 					}
 					else
 					{
-						ser &= papuga_Serialization_pushValue_void( serialization);
+						row.pushVoid();
 					}
 					break;
 
@@ -226,15 +269,13 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 					AclReaderInterface* aclreader = (AclReaderInterface*)m_acls.get();
 					aclreader->skipDoc( m_docno);
 					std::vector<std::string> usernames = aclreader->getReadAccessList();
-					ser &= papuga_Serialization_pushOpen( serialization);
+					row.pushOpen();
 					std::vector<std::string>::const_iterator ui = usernames.begin(), ue = usernames.end();
 					for (; ui != ue; ++ui)
 					{
-						const char* usernamestr = papuga_Allocator_copy_string( result->allocator, ui->c_str(), ui->size());
-						if (!usernamestr) throw std::bad_alloc();
-						ser &= papuga_Serialization_pushValue_string( serialization, usernamestr, ui->size());
+						row.pushString( *ui);
 					}
-					ser &= papuga_Serialization_pushClose( serialization);
+					row.pushClose();
 					break;
 				}
 
@@ -243,15 +284,12 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 					ForwardIteratorInterface* fitr = m_forwarditer[ ei->handle()].get();
 					fitr->skipDoc( m_docno);
 					Index pos = 0;
-					ser &= papuga_Serialization_pushOpen( serialization);
+					row.pushOpen();
 					while (0!=(pos=fitr->skipPos( pos+1)))
 					{
-						std::string value = fitr->fetch();
-						const char* valuestr = papuga_Allocator_copy_string( result->allocator, value.c_str(), value.size());
-						if (!valuestr) throw std::bad_alloc();
-						ser &= papuga_Serialization_pushValue_string( serialization, valuestr, value.size());
+						row.pushString( fitr->fetch());
 					}
-					ser &= papuga_Serialization_pushClose( serialization);
+					row.pushClose();
 					break;
 				}
 
@@ -260,19 +298,17 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 					DocumentTermIteratorInterface* titr = m_searchiter[ ei->handle()].get();
 					if (titr->skipDoc( m_docno) == m_docno)
 					{
-						ser &= papuga_Serialization_pushOpen( serialization);
+						row.pushOpen();
 						DocumentTermIteratorInterface::Term term;
 						while (titr->nextTerm( term))
 						{
-							std::string value = titr->termValue( term.termno);
-							const char* valuestr = papuga_Allocator_copy_string( result->allocator, value.c_str(), value.size());
-							ser &= papuga_Serialization_pushValue_string( serialization, valuestr, value.size());
+							row.pushString( titr->termValue( term.termno));
 						}
-						ser &= papuga_Serialization_pushClose( serialization);
+						row.pushClose();
 					}
 					else
 					{
-						ser &= papuga_Serialization_pushValue_void( serialization);
+						row.pushVoid();
 					}
 					break;
 				}
@@ -280,56 +316,177 @@ bool SelectIterator::buildRow( papuga_CallResult* result)
 				case ItemDef::Position:
 					if (m_postings.get())
 					{
-						ser &= papuga_Serialization_pushOpen( serialization);
+						row.pushOpen();
 						for (Index pos = 0; 0!=(pos=m_postings->skipPos(pos)); ++pos)
 						{
-							ser &= papuga_Serialization_pushValue_int( serialization, pos);
+							row.pushInt( pos);
 						}
-						ser &= papuga_Serialization_pushClose( serialization);
+						row.pushClose();
 					}
 					else
 					{
-						ser &= papuga_Serialization_pushValue_void( serialization);
+						row.pushVoid();
 					}
 					break;
 
 				case ItemDef::Docno:
-					ser &= papuga_Serialization_pushValue_int( serialization, m_docno);
+					row.pushInt( m_docno);
 					break;
 			}
 		}
 	}
-	if (!ser)
+}
+
+bool SelectIterator::serializeRow( papuga_Serialization* serialization, papuga_Allocator* allocator, bool withNames)
+{
+	m_row.clear();
+	fetchRow( m_row, withNames);
+	return m_row.serializeRow( 0, serialization, allocator);
+}
+
+unsigned int SelectIterator::fetchRows( SelectRowBuffer& rows, unsigned int maxrows, bool withNames)
+{
+	unsigned int rowcnt = 0;
+	for (; rowcnt < maxrows && nextDoc(); ++rowcnt,++m_docno)
 	{
-		papuga_CallResult_reportError( result, _TXT("memory allocation error in %s get next"), ITERATOR_NAME);
-		return false;
+		fetchRow( rows, withNames);
 	}
-	return true;
+	return rowcnt;
 }
 
-bool SelectIterator::getNext( papuga_CallResult* result)
+bool SelectIterator::serializeHeader( papuga_Serialization* serialization) const
 {
-	try
+	bool ser = true;
+	ser &= papuga_Serialization_pushOpen( serialization);
+	if (m_items.empty())
+	{
+		ser &= papuga_Serialization_pushValue_charp( serialization, strus::Constants::identifier_docno());
+	}
+	else
 	{
-		if (m_postings.get())
+		std::vector<ItemDef>::const_iterator ei = m_items.begin(), ee = m_items.end();
+		for (; ei != ee; ++ei)
 		{
-			if (!m_docno) return false;
-			for (; 0!=(m_docno = m_postings->skipDoc( m_docno)); ++m_docno)
-			{
-				if (checkAccess( m_docno) && (!m_restriction.get() || m_restriction->match( m_docno))) break;
-			}
+			ser &= papuga_Serialization_pushValue_string( serialization, ei->name().c_str(), ei->name().size());
 		}
-		else
+	}
+	ser &= papuga_Serialization_pushClose( serialization);
+	return ser;
+}
+
+bool SelectIterator::nextDoc()
+{
+	if (!m_docno) return false;
+	if (m_postings.get())
+	{
+		for (;;)
 		{
-			if (!m_docno) return false;
-			for (;m_docno <= m_maxdocno; ++m_docno)
+			if (m_zonecursor.get())
+			{
+				// ... skip the blocks of documents that cannot match the restriction
+				m_docno = m_zonecursor->skipDoc( m_docno);
+			}
+			if (0==(m_docno = m_postings->skipDoc( m_docno))) break;
+			if (m_docno > m_maxdocno)
 			{
-				if (checkAccess( m_docno)) break;
+				m_docno = 0;
+				break;
 			}
-			if (m_docno > m_maxdocno) return false;
+			if (m_zonecursor.get() && m_zonecursor->skipDoc( m_docno) != m_docno) continue;
+			if (!m_accessiter.empty())
+			{
+				// ... leapfrog between the postings and the union of the access restrictions
+				Index accessible = nextAccessible( m_docno);
+				if (!accessible)
+				{
+					m_docno = 0;
+					break;
+				}
+				if (accessible != m_docno)
+				{
+					m_docno = accessible;
+					continue;
+				}
+			}
+			if (!m_restriction.get() || m_restriction->match( m_docno)) break;
+			++m_docno;
+		}
+		return m_docno != 0;
+	}
+	else if (!m_accessiter.empty())
+	{
+		// ... the union of the access restrictions drives the scan
+		Index accessible = nextAccessible( m_docno);
+		if (!accessible || accessible > m_maxdocno)
+		{
+			m_docno = 0;
+			return false;
 		}
+		m_docno = accessible;
+		return true;
+	}
+	else
+	{
+		// ... the documents inserted drive the scan, document numbers of documents deleted or never assigned are skipped
+		while (m_docnoidx < m_docnolist.size() && m_docnolist[ m_docnoidx] < m_docno) ++m_docnoidx;
+		if (m_docnoidx == m_docnolist.size())
+		{
+			m_docno = 0;
+			return false;
+		}
+		m_docno = m_docnolist[ m_docnoidx];
+		return true;
+	}
+}
+
+bool SelectIterator::buildRow( papuga_CallResult* result)
+{
+	if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+	papuga_Serialization* serialization = result->valuear[0].value.serialization;
+	if (!serializeRow( serialization, result->allocator, true/*withNames*/))
+	{
+		papuga_CallResult_reportError( result, _TXT("memory allocation error in %s get next"), ITERATOR_NAME);
+		return false;
+	}
+	return true;
+}
+
+bool SelectIterator::buildBatch( papuga_CallResult* result)
+{
+	if (!papuga_add_CallResult_serialization( result)) throw std::bad_alloc();
+	papuga_Serialization* serialization = result->valuear[0].value.serialization;
+
+	bool ser = true;
+	ser &= papuga_Serialization_pushName_charp( serialization, "header");
+	ser &= serializeHeader( serialization);
+	ser &= papuga_Serialization_pushName_charp( serialization, "rows");
+	ser &= papuga_Serialization_pushOpen( serialization);
+	unsigned int rowcnt = 0;
+	for (; rowcnt < m_batchsize && nextDoc(); ++rowcnt,++m_docno)
+	{
+		ser &= papuga_Serialization_pushOpen( serialization);
+		ser &= serializeRow( serialization, result->allocator, false/*withNames*/);
+		ser &= papuga_Serialization_pushClose( serialization);
+	}
+	ser &= papuga_Serialization_pushClose( serialization);
+	if (!ser)
+	{
+		papuga_CallResult_reportError( result, _TXT("memory allocation error in %s get next"), ITERATOR_NAME);
+		return false;
+	}
+	return rowcnt > 0;
+}
+
+bool SelectIterator::getNext( papuga_CallResult* result)
+{
+	try
+	{
 		bool rt = false;
-		if (m_docno)
+		if (m_batchsize)
+		{
+			rt = buildBatch( result);
+		}
+		else if (nextDoc())
 		{
 			rt = buildRow( result);
 			++m_docno;
@@ -20,6 +20,8 @@
 #include "strus/attributeReaderInterface.hpp"
 #include "strus/aclReaderInterface.hpp"
 #include "impl/value/objectref.hpp"
+#include "impl/value/selectRowBuffer.hpp"
+#include "impl/value/metaDataZoneMap.hpp"
 #include "private/internationalization.hpp"
 #include <vector>
 #include <string>
@@ -35,20 +37,44 @@ public:
 		const ObjectRef& objbuilder_,
 		const ObjectRef& storage_,
 		const ObjectRef& errorhnd_,
+		const ObjectRef& zonemap_,
 		const papuga_ValueVariant& what,
 		const papuga_ValueVariant& expression,
 		const papuga_ValueVariant& restriction,
 		const Index& start_docno_,
-		const papuga_ValueVariant& accesslist);
+		const papuga_ValueVariant& accesslist,
+		unsigned int batchsize_=0,
+		const Index& end_docno_=0);
 	virtual ~SelectIterator(){}
 
 	bool getNext( papuga_CallResult* result);
 
+	/// \brief Fetch the rows of the next documents matching into a buffer
+	/// \param[in,out] rows where to append the rows to
+	/// \param[in] maxrows maximum number of rows to fetch
+	/// \param[in] withNames true if the values are preceded by the names of the elements, false for a plain list of values
+	/// \return the number of rows fetched, less than maxrows if there is no document left
+	unsigned int fetchRows( SelectRowBuffer& rows, unsigned int maxrows, bool withNames);
+	/// \brief Serialize the names of the elements selected as list
+	bool serializeHeader( papuga_Serialization* serialization) const;
+
 	static bool GetNext( void* self, papuga_CallResult* result);
 	static void Deleter( void* obj);
 
 private:
+	/// \brief Move to the next document matching, starting with the current one
+	/// \return false if there is no document left
+	bool nextDoc();
+	/// \brief Append the selected elements of the current document as one row to a buffer
+	/// \param[in] withNames true if the values are preceded by the names of the elements, false for a plain list of values
+	void fetchRow( SelectRowBuffer& row, bool withNames);
+	/// \brief Serialize the selected elements of the current document as one row
+	/// \param[in] withNames true if the values are preceded by the names of the elements, false for a plain list of values
+	bool serializeRow( papuga_Serialization* serialization, papuga_Allocator* allocator, bool withNames);
+	/// \brief Build a result with the row of the current document
 	bool buildRow( papuga_CallResult* result);
+	/// \brief Build a result with the rows of the next documents (up to the batch size) as list of values with the names of the elements as header
+	bool buildBatch( papuga_CallResult* result);
 
 private:
 	class ItemDef
@@ -95,24 +121,35 @@ private:
 			:docno(o.docno),acciter(o.acciter){}
 	};
 private:
-	bool checkAccess( const Index& docno);
+	enum {FetchDocIdChunkSize=1024};
+
+	/// \brief Get the smallest document number greater than or equal to docno accessible with one of the access restrictions or 0 if there is none
+	Index nextAccessible( const Index& docno);
+	/// \brief Collect the document numbers of the documents inserted in the range of the iterator
+	void collectDocumentNumbers( const StorageClientInterface* storage);
 
 private:
 	ObjectRef m_trace_impl;
 	ObjectRef m_objbuilder_impl;
 	ObjectRef m_storage_impl;
 	ObjectRef m_errorhnd_impl;
+	ObjectRef m_zonemap_impl;
 	Reference<AttributeReaderInterface> m_attributes;
 	Reference<MetaDataReaderInterface> m_metadata;
 	Reference<AclReaderInterface> m_acls;
 	Reference<PostingIteratorInterface> m_postings;
 	Reference<MetaDataRestrictionInstanceInterface> m_restriction;
+	Reference<MetaDataZoneCursor> m_zonecursor;
 	std::vector<Reference<ForwardIteratorInterface> > m_forwarditer;
 	std::vector<Reference<DocumentTermIteratorInterface> > m_searchiter;
 	std::vector<AccessRestriction> m_accessiter;
+	std::vector<Index> m_docnolist;		// ascending document numbers of the documents inserted in the range, driving the scan without postings and access restrictions
+	std::size_t m_docnoidx;			// index of the next candidate in m_docnolist
 	Index m_docno;
 	Index m_maxdocno;
 	std::vector<ItemDef> m_items;
+	unsigned int m_batchsize;
+	SelectRowBuffer m_row;
 };
 
 }}//namespace
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Buffer for rows of a select, independent of a papuga allocator, so that they can be fetched in one thread and serialized in another
+#include "impl/value/selectRowBuffer.hpp"
+#include "papuga/serialization.h"
+#include "papuga/allocator.h"
+#include <new>
+
+using namespace strus;
+using namespace strus::bindings;
+
+void SelectRowBuffer::pushNumeric( const NumericVariant& val)
+{
+	switch (val.type)
+	{
+		case NumericVariant::Null:
+			pushVoid();
+			return;
+		case NumericVariant::Int:
+		{
+			Token tk( Token::Int);
+			tk.value.Int = val.variant.Int;
+			m_tokens.push_back( tk);
+			return;
+		}
+		case NumericVariant::UInt:
+		{
+			Token tk( Token::Int);
+			tk.value.Int = val.variant.UInt;
+			m_tokens.push_back( tk);
+			return;
+		}
+		case NumericVariant::Float:
+		{
+			Token tk( Token::Double);
+			tk.value.Double = val.variant.Float;
+			m_tokens.push_back( tk);
+			return;
+		}
+	}
+	pushVoid();
+}
+
+bool SelectRowBuffer::serializeRow( std::size_t rowidx, papuga_Serialization* serialization, papuga_Allocator* allocator) const
+{
+	std::size_t ti = m_rows[ rowidx];
+	std::size_t te = rowidx+1 < m_rows.size() ? m_rows[ rowidx+1] : m_tokens.size();
+	bool ser = true;
+	for (; ti < te; ++ti)
+	{
+		const Token& tk = m_tokens[ ti];
+		switch (tk.type)
+		{
+			case Token::Open:
+				ser &= papuga_Serialization_pushOpen( serialization);
+				break;
+			case Token::Close:
+				ser &= papuga_Serialization_pushClose( serialization);
+				break;
+			case Token::Void:
+				ser &= papuga_Serialization_pushValue_void( serialization);
+				break;
+			case Token::Int:
+				ser &= papuga_Serialization_pushValue_int( serialization, tk.value.Int);
+				break;
+			case Token::Double:
+				ser &= papuga_Serialization_pushValue_double( serialization, tk.value.Double);
+				break;
+			case Token::Name:
+			case Token::String:
+			{
+				const char* str = papuga_Allocator_copy_string( allocator, m_strings.c_str() + tk.value.String.ofs, tk.value.String.len);
+				if (!str) throw std::bad_alloc();
+				if (tk.type == Token::Name)
+				{
+					ser &= papuga_Serialization_pushName_string( serialization, str, tk.value.String.len);
+				}
+				else
+				{
+					ser &= papuga_Serialization_pushValue_string( serialization, str, tk.value.String.len);
+				}
+				break;
+			}
+		}
+	}
+	return ser;
+}
+
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_SELECT_ROW_BUFFER_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_SELECT_ROW_BUFFER_HPP_INCLUDED
+/// \brief Buffer for rows of a select, independent of a papuga allocator, so that they can be fetched in one thread and serialized in another
+#include "papuga/typedefs.h"
+#include "strus/storage/index.hpp"
+#include "strus/numericVariant.hpp"
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Buffer for rows of a select, independent of a papuga allocator, so that they can be fetched in one thread and serialized in another
+class SelectRowBuffer
+{
+public:
+	SelectRowBuffer()
+		:m_tokens(),m_strings(),m_rows(){}
+	SelectRowBuffer( const SelectRowBuffer& o)
+		:m_tokens(o.m_tokens),m_strings(o.m_strings),m_rows(o.m_rows){}
+
+	/// \brief Start a new row
+	void startRow()
+	{
+		m_rows.push_back( m_tokens.size());
+	}
+	void pushOpen()
+	{
+		m_tokens.push_back( Token( Token::Open));
+	}
+	void pushClose()
+	{
+		m_tokens.push_back( Token( Token::Close));
+	}
+	void pushVoid()
+	{
+		m_tokens.push_back( Token( Token::Void));
+	}
+	void pushName( const std::string& name)
+	{
+		pushString( Token::Name, name);
+	}
+	void pushString( const std::string& value)
+	{
+		pushString( Token::String, value);
+	}
+	void pushInt( const Index& value)
+	{
+		Token tk( Token::Int);
+		tk.value.Int = value;
+		m_tokens.push_back( tk);
+	}
+	void pushNumeric( const NumericVariant& value);
+
+	/// \brief Get the number of rows in the buffer
+	std::size_t nofRows() const
+	{
+		return m_rows.size();
+	}
+
+	/// \brief Append a row of the buffer to a serialization
+	/// \param[in] rowidx index of the row (0..nofRows-1)
+	/// \param[in,out] serialization where to append the row to
+	/// \param[in] allocator allocator for copying the strings of the row
+	/// \return false on memory allocation error
+	bool serializeRow( std::size_t rowidx, papuga_Serialization* serialization, papuga_Allocator* allocator) const;
+
+	/// \brief Remove all rows from the buffer
+	void clear()
+	{
+		m_tokens.clear();
+		m_strings.clear();
+		m_rows.clear();
+	}
+
+private:
+	struct Token
+	{
+		enum Type {Open,Close,Name,Void,Int,Double,String};
+		Type type;
+		union
+		{
+			int64_t Int;
+			double Double;
+			struct
+			{
+				std::size_t ofs;
+				std::size_t len;
+			} String;
+		} value;
+
+		explicit Token( Type type_)
+			:type(type_)
+		{
+			value.Int = 0;
+		}
+		Token( const Token& o)
+			:type(o.type),value(o.value){}
+	};
+
+	void pushString( Token::Type type, const std::string& value)
+	{
+		Token tk( type);
+		tk.value.String.ofs = m_strings.size();
+		tk.value.String.len = value.size();
+		m_strings.append( value);
+		m_tokens.push_back( tk);
+	}
+
+private:
+	std::vector<Token> m_tokens;		//< tokens of all rows
+	std::string m_strings;			//< contents of the strings referenced by the tokens
+	std::vector<std::size_t> m_rows;	//< index of the first token of each row
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,551 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Map of global statistics partitioned by term hash, serving reads from immutable snapshots
+#include "impl/value/statisticsShardMap.hpp"
+#include "impl/value/varintEncoding.hpp"
+#include "private/internationalization.hpp"
+#include "strus/lib/error.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace strus;
+using namespace strus::bindings;
+
+/// \brief Minimum size of the delta maps of a shard before they are merged into the base map
+#define MIN_MERGE_DELTA_SIZE 1024
+/// \brief Maximum size of the delta maps of a shard relative to the base map (as divisor) before they are merged
+#define MERGE_DELTA_FRACTION 8
+/// \brief Estimated allocation overhead of a node of a std::map
+#define MAP_NODE_OVERHEAD 48
+
+StatisticsShardMap::StatisticsShardMap( unsigned int nofShards_, bool compact_, unsigned int sketchWidth_, unsigned int sketchDepth_, GlobalCounter exactDfThreshold_)
+	:m_shards(),m_nofDocuments(0),m_compact(compact_),m_sketchWidth(0),m_sketchDepth(sketchDepth_),m_exactDfThreshold(exactDfThreshold_)
+{
+	if (!nofShards_) throw strus::runtime_error(_TXT("number of shards of a statistics map must not be 0"));
+	if (sketchWidth_)
+	{
+		if (!sketchDepth_ || exactDfThreshold_ <= 0) throw strus::runtime_error(_TXT("depth of sketch and df threshold for exact counting of a statistics map must not be 0"));
+		// ... every shard has its own sketch with the configured width divided by the number of shards
+		m_sketchWidth = (sketchWidth_ + nofShards_ - 1) / nofShards_;
+	}
+	m_shards.reserve( nofShards_);
+	try
+	{
+		unsigned int si = 0;
+		for (; si < nofShards_; ++si)
+		{
+			m_shards.push_back( new Shard( m_compact, m_sketchWidth ? new CountMinSketch( m_sketchWidth, m_sketchDepth) : 0, m_exactDfThreshold));
+		}
+	}
+	catch (...)
+	{
+		std::vector<Shard*>::iterator si = m_shards.begin(), se = m_shards.end();
+		for (; si != se; ++si) delete *si;
+		throw;
+	}
+}
+
+StatisticsShardMap::~StatisticsShardMap()
+{
+	std::vector<Shard*>::iterator si = m_shards.begin(), se = m_shards.end();
+	for (; si != se; ++si) delete *si;
+}
+
+unsigned int StatisticsShardMap::shardIndex( const std::string& type, const std::string& value) const
+{
+	// ... FNV-1a hash of type and value separated by a 0 byte
+	unsigned int hh = 2166136261U;
+	std::string::const_iterator si = type.begin(), se = type.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 16777619U;
+	}
+	hh *= 16777619U;
+	si = value.begin(), se = value.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 16777619U;
+	}
+	return hh % m_shards.size();
+}
+
+const GlobalCounter* StatisticsShardMap::Snapshot::deltaDf( const Key& key) const
+{
+	DeltaList::const_reverse_iterator di = deltas.rbegin(), de = deltas.rend();
+	for (; di != de; ++di)
+	{
+		TermMap::const_iterator ti = (*di)->find( key);
+		if (ti != (*di)->end()) return &ti->second;
+	}
+	return 0;
+}
+
+bool StatisticsShardMap::Snapshot::find( const Key& key, GlobalCounter& df_) const
+{
+	const GlobalCounter* dfref = deltaDf( key);
+	if (dfref)
+	{
+		df_ = *dfref;
+		return true;
+	}
+	if (cbase.get()) return cbase->find( key.first, key.second, df_);
+	TermMap::const_iterator ti = base->find( key);
+	if (ti == base->end()) return false;
+	df_ = ti->second;
+	return true;
+}
+
+void StatisticsShardMap::Snapshot::mergeDeltas( TermMap& dest) const
+{
+	DeltaList::const_iterator di = deltas.begin(), de = deltas.end();
+	for (; di != de; ++di)
+	{
+		if (dest.empty())
+		{
+			dest = **di;
+			continue;
+		}
+		TermMap::const_iterator ti = (*di)->begin(), te = (*di)->end();
+		for (; ti != te; ++ti)
+		{
+			dest[ ti->first] = ti->second;
+		}
+	}
+}
+
+std::size_t StatisticsShardMap::Snapshot::deltaSize() const
+{
+	std::size_t rt = 0;
+	DeltaList::const_iterator di = deltas.begin(), de = deltas.end();
+	for (; di != de; ++di)
+	{
+		rt += (*di)->size();
+	}
+	return rt;
+}
+
+static std::size_t termMapMemorySize( const std::map<std::pair<std::string,std::string>,GlobalCounter>& map)
+{
+	std::size_t rt = 0;
+	std::map<std::pair<std::string,std::string>,GlobalCounter>::const_iterator mi = map.begin(), me = map.end();
+	for (; mi != me; ++mi)
+	{
+		rt += MAP_NODE_OVERHEAD + sizeof(*mi) + mi->first.first.capacity() + mi->first.second.capacity();
+	}
+	return rt;
+}
+
+std::size_t StatisticsShardMap::Snapshot::memorySize() const
+{
+	std::size_t rt = cbase.get() ? cbase->memorySize() : termMapMemorySize( *base);
+	DeltaList::const_iterator di = deltas.begin(), de = deltas.end();
+	for (; di != de; ++di)
+	{
+		rt += termMapMemorySize( **di);
+	}
+	return rt;
+}
+
+StatisticsShardMap::Snapshot StatisticsShardMap::Shard::get() const
+{
+	strus::scoped_lock lock( publishMutex);
+	return snapshot;
+}
+
+StatisticsShardMap::Shard::~Shard()
+{
+	if (sketch) delete sketch;
+}
+
+void StatisticsShardMap::Shard::update( const std::vector<const DfChange*>& changes)
+{
+	strus::scoped_lock wlock( writeMutex);
+	// ... the snapshot is only replaced by writers, so it can be read without holding the publish lock here
+	const Snapshot& cur = snapshot;
+
+	// ... the changes of this update form a new delta map of their own, the delta maps of the current snapshot are shared
+	strus::shared_ptr<TermMap> delta( new TermMap());
+	std::vector<const DfChange*>::const_iterator ci = changes.begin(), ce = changes.end();
+	for (; ci != ce; ++ci)
+	{
+		Key key( (*ci)->type, (*ci)->value);
+		TermMap::iterator di = delta->find( key);
+		GlobalCounter exactdf = 0;
+		bool exact = true;
+		if (di == delta->end())
+		{
+			exact = cur.find( key, exactdf);
+		}
+		else
+		{
+			exactdf = di->second;
+		}
+		GlobalCounter dfval;
+		if (sketch && !exact)
+		{
+			// ... terms not counted exactly are counted in the sketch until their estimated df reaches the threshold
+			sketch->add( key.first, key.second, (*ci)->increment);
+			if ((*ci)->increment <= 0) continue;
+			dfval = sketch->estimate( key.first, key.second);
+			if (dfval < exactDfThreshold) continue;
+		}
+		else
+		{
+			dfval = exactdf + (*ci)->increment;
+		}
+		// ... terms with a df of 0 are kept in the delta to shadow their entry in the base map until the next merge,
+		//	with a sketch they are kept also in the base, for not falling back to the estimate of the sketch
+		if (di == delta->end())
+		{
+			delta->insert( TermMap::value_type( key, dfval > 0 ? dfval : 0));
+		}
+		else
+		{
+			di->second = dfval > 0 ? dfval : 0;
+		}
+	}
+	DeltaList deltas( cur.deltas);
+	deltas.push_back( delta);
+	while (deltas.size() >= 2 && deltas[ deltas.size()-2]->size() <= 2 * deltas.back()->size())
+	{
+		// ... join the newest delta map with its predecessor if it is not at least twice as big
+		strus::shared_ptr<TermMap> joined( new TermMap( *deltas[ deltas.size()-2]));
+		TermMap::const_iterator di = deltas.back()->begin(), de = deltas.back()->end();
+		for (; di != de; ++di)
+		{
+			(*joined)[ di->first] = di->second;
+		}
+		deltas.pop_back();
+		deltas.back() = joined;
+	}
+	Snapshot next( cur.base, cur.cbase, deltas);
+	std::size_t deltaSize = next.deltaSize();
+	TermMap merged;
+	if (deltaSize <= MIN_MERGE_DELTA_SIZE || deltaSize <= cur.baseSize() / MERGE_DELTA_FRACTION)
+	{
+		// ... no merge yet
+	}
+	else if (cur.cbase.get())
+	{
+		// ... build the next compact base by merging the terms of the current one with the delta
+		next.mergeDeltas( merged);
+		strus::shared_ptr<CompactTermMap> cbase( new CompactTermMap());
+		CompactTermMap::Iterator itr( *cur.cbase);
+		bool more = itr.next();
+		TermMap::const_iterator di = merged.begin(), de = merged.end();
+		while (more || di != de)
+		{
+			if (di == de || (more && Key( itr.type(), itr.value()) < di->first))
+			{
+				cbase->append( itr.type(), itr.value(), itr.df());
+				more = itr.next();
+			}
+			else
+			{
+				if (more && itr.type() == di->first.first && itr.value() == di->first.second)
+				{
+					more = itr.next(); //... replaced by the value in the delta
+				}
+				if (di->second || sketch)
+				{
+					cbase->append( di->first.first, di->first.second, di->second);
+				}
+				++di;
+			}
+		}
+		next = Snapshot( TermMapRef(), cbase, DeltaList());
+	}
+	else
+	{
+		next.mergeDeltas( merged);
+		strus::shared_ptr<TermMap> base( new TermMap( *cur.base));
+		TermMap::const_iterator di = merged.begin(), de = merged.end();
+		for (; di != de; ++di)
+		{
+			if (di->second || sketch)
+			{
+				(*base)[ di->first] = di->second;
+			}
+			else
+			{
+				base->erase( di->first);
+			}
+		}
+		next = Snapshot( base, CompactTermMapRef(), DeltaList());
+	}
+	strus::scoped_lock plock( publishMutex);
+	snapshot = next;
+}
+
+void StatisticsShardMap::update( const std::vector<DfChange>& changes, int nofDocumentsInsertedChange)
+{
+	// ... group the changes by shard, for building the next version of each shard affected once
+	std::vector<std::vector<const DfChange*> > shardchanges( m_shards.size());
+	std::vector<DfChange>::const_iterator ci = changes.begin(), ce = changes.end();
+	for (; ci != ce; ++ci)
+	{
+		shardchanges[ shardIndex( ci->type, ci->value)].push_back( &*ci);
+	}
+	std::vector<std::vector<const DfChange*> >::const_iterator si = shardchanges.begin(), se = shardchanges.end();
+	for (int sidx=0; si != se; ++si,++sidx)
+	{
+		if (!si->empty())
+		{
+			m_shards[ sidx]->update( *si);
+		}
+	}
+	if (nofDocumentsInsertedChange)
+	{
+		m_nofDocuments.increment( nofDocumentsInsertedChange);
+	}
+}
+
+void StatisticsShardMap::clear()
+{
+	std::vector<Shard*>::iterator si = m_shards.begin(), se = m_shards.end();
+	for (; si != se; ++si)
+	{
+		Shard* shard = *si;
+		strus::scoped_lock wlock( shard->writeMutex);
+		if (shard->sketch) shard->sketch->clear();
+		Snapshot next( m_compact);
+		strus::scoped_lock plock( shard->publishMutex);
+		shard->snapshot = next;
+	}
+	m_nofDocuments.increment( -m_nofDocuments.value());
+}
+
+GlobalCounter StatisticsShardMap::df( const std::string& type, const std::string& value) const
+{
+	const Shard* shard = m_shards[ shardIndex( type, value)];
+	Snapshot snapshot = shard->get();
+	GlobalCounter rt = 0;
+	if (!snapshot.find( Key( type, value), rt) && shard->sketch)
+	{
+		rt = shard->sketch->estimate( type, value);
+	}
+	return rt;
+}
+
+namespace {
+// ... position of a term in a list sorted by shard and term
+struct ShardTermPosition
+{
+	unsigned int shardidx;
+	const std::pair<std::string,std::string>* term;
+	std::size_t termidx;
+
+	ShardTermPosition( unsigned int shardidx_, const std::pair<std::string,std::string>* term_, std::size_t termidx_)
+		:shardidx(shardidx_),term(term_),termidx(termidx_){}
+	ShardTermPosition( const ShardTermPosition& o)
+		:shardidx(o.shardidx),term(o.term),termidx(o.termidx){}
+
+	bool operator < (const ShardTermPosition& o) const
+	{
+		if (shardidx != o.shardidx) return shardidx < o.shardidx;
+		if (*term != *o.term) return *term < *o.term;
+		return termidx < o.termidx;
+	}
+};
+}//anonymous namespace
+
+void StatisticsShardMap::dfList( std::vector<GlobalCounter>& dest, const std::vector<std::pair<std::string,std::string> >& terms) const
+{
+	dest.assign( terms.size(), 0);
+	std::vector<ShardTermPosition> positions;
+	positions.reserve( terms.size());
+	std::vector<std::pair<std::string,std::string> >::const_iterator ti = terms.begin(), te = terms.end();
+	for (std::size_t tidx=0; ti != te; ++ti,++tidx)
+	{
+		positions.push_back( ShardTermPosition( shardIndex( ti->first, ti->second), &*ti, tidx));
+	}
+	std::sort( positions.begin(), positions.end());
+
+	std::vector<ShardTermPosition>::const_iterator pi = positions.begin(), pe = positions.end();
+	while (pi != pe)
+	{
+		// ... one snapshot for all terms of a shard
+		const Shard* shard = m_shards[ pi->shardidx];
+		Snapshot snapshot = shard->get();
+		unsigned int shardidx = pi->shardidx;
+		while (pi != pe && pi->shardidx == shardidx)
+		{
+			GlobalCounter dfval = 0;
+			if (!snapshot.find( *pi->term, dfval) && shard->sketch)
+			{
+				dfval = shard->sketch->estimate( pi->term->first, pi->term->second);
+			}
+			// ... duplicates of a term are adjacent and get the df looked up for the first one
+			const std::pair<std::string,std::string>* term = pi->term;
+			for (; pi != pe && pi->shardidx == shardidx && *pi->term == *term; ++pi)
+			{
+				dest[ pi->termidx] = dfval;
+			}
+		}
+	}
+}
+
+std::vector<StatisticsShardMap::ShardInfo> StatisticsShardMap::shardInfo() const
+{
+	std::vector<ShardInfo> rt;
+	std::vector<Shard*>::const_iterator si = m_shards.begin(), se = m_shards.end();
+	for (; si != se; ++si)
+	{
+		Snapshot snapshot = (*si)->get();
+		ShardInfo info;
+		info.baseSize = snapshot.baseSize();
+		info.deltaSize = snapshot.deltaSize();
+		info.memorySize = snapshot.memorySize();
+		if ((*si)->sketch)
+		{
+			info.memorySize += (*si)->sketch->memorySize();
+			info.sketchErrorBound = (*si)->sketch->errorBound();
+		}
+		rt.push_back( info);
+	}
+	return rt;
+}
+
+static void appendSerializedTerm( std::string& dest, const std::string& type, const std::string& value, GlobalCounter df)
+{
+	dest.push_back( 1);
+	appendVarintString( dest, type);
+	appendVarintString( dest, value);
+	appendVarint( dest, (unsigned long long)df);
+}
+
+StatisticsShardMap::Image StatisticsShardMap::image() const
+{
+	Image rt;
+	rt.m_nofDocuments = nofDocuments();
+	rt.m_keepZeroDf = m_sketchWidth != 0;
+	rt.m_shards.reserve( m_shards.size());
+	std::vector<Shard*>::const_iterator si = m_shards.begin(), se = m_shards.end();
+	for (; si != se; ++si)
+	{
+		rt.m_shards.push_back( (*si)->get());
+	}
+	if (m_sketchWidth)
+	{
+		rt.m_sketches.push_back( 1);
+		appendVarint( rt.m_sketches, m_shards.size());
+		for (si = m_shards.begin(); si != se; ++si)
+		{
+			strus::scoped_lock wlock( (*si)->writeMutex);
+			(*si)->sketch->serialize( rt.m_sketches);
+		}
+	}
+	else
+	{
+		rt.m_sketches.push_back( 0);
+	}
+	return rt;
+}
+
+void StatisticsShardMap::Image::serialize( std::string& dest) const
+{
+	appendVarint( dest, (unsigned long long)(m_nofDocuments > 0 ? m_nofDocuments : 0));
+	std::vector<Snapshot>::const_iterator si = m_shards.begin(), se = m_shards.end();
+	for (; si != se; ++si)
+	{
+		const Snapshot& snapshot = *si;
+		TermMap delta;
+		snapshot.mergeDeltas( delta);
+		// ... terms of the base not overwritten by the delta first, then the terms of the delta
+		if (snapshot.cbase.get())
+		{
+			CompactTermMap::Iterator itr( *snapshot.cbase);
+			while (itr.next())
+			{
+				if (delta.find( Key( itr.type(), itr.value())) != delta.end()) continue;
+				appendSerializedTerm( dest, itr.type(), itr.value(), itr.df());
+			}
+		}
+		else
+		{
+			TermMap::const_iterator bi = snapshot.base->begin(), be = snapshot.base->end();
+			for (; bi != be; ++bi)
+			{
+				if (delta.find( bi->first) != delta.end()) continue;
+				appendSerializedTerm( dest, bi->first.first, bi->first.second, bi->second);
+			}
+		}
+		TermMap::const_iterator di = delta.begin(), de = delta.end();
+		for (; di != de; ++di)
+		{
+			if (di->second || m_keepZeroDf) appendSerializedTerm( dest, di->first.first, di->first.second, di->second);
+		}
+	}
+	dest.push_back( 0);
+	dest.append( m_sketches);
+}
+
+void StatisticsShardMap::serialize( std::string& dest) const
+{
+	image().serialize( dest);
+}
+
+void StatisticsShardMap::deserialize( const std::string& src, std::size_t& pos)
+{
+	GlobalCounter nofdocs = (GlobalCounter)readVarint( src, pos);
+	std::vector<TermMap> shardterms( m_shards.size());
+	for (;;)
+	{
+		if (pos >= src.size()) throw strus::runtime_error(_TXT("corrupt statistics map serialization: %s"), _TXT("unexpected end of data"));
+		if (src[ pos++] == 0) break;
+		std::string type = readVarintString( src, pos);
+		std::string value = readVarintString( src, pos);
+		GlobalCounter dfval = (GlobalCounter)readVarint( src, pos);
+		if (dfval || m_sketchWidth)
+		{
+			shardterms[ shardIndex( type, value)][ Key( type, value)] = dfval;
+		}
+	}
+	std::vector<TermMap>::const_iterator ti = shardterms.begin(), te = shardterms.end();
+	for (int sidx=0; ti != te; ++ti,++sidx)
+	{
+		Snapshot next( m_compact);
+		if (m_compact)
+		{
+			strus::shared_ptr<CompactTermMap> cbase( new CompactTermMap());
+			TermMap::const_iterator mi = ti->begin(), me = ti->end();
+			for (; mi != me; ++mi)
+			{
+				cbase->append( mi->first.first, mi->first.second, mi->second);
+			}
+			next.cbase = cbase;
+		}
+		else
+		{
+			next.base.reset( new TermMap( *ti));
+		}
+		Shard* shard = m_shards[ sidx];
+		strus::scoped_lock wlock( shard->writeMutex);
+		strus::scoped_lock plock( shard->publishMutex);
+		shard->snapshot = next;
+	}
+	if (pos >= src.size()) throw strus::runtime_error(_TXT("corrupt statistics map serialization: %s"), _TXT("unexpected end of data"));
+	if (src[ pos++])
+	{
+		std::size_t nofShards = readVarint( src, pos);
+		if (!m_sketchWidth || nofShards != m_shards.size())
+		{
+			throw strus::runtime_error(_TXT("sketches of serialized statistics map do not match the configuration (%u shards with sketches)"), (unsigned int)nofShards);
+		}
+		std::vector<Shard*>::iterator si = m_shards.begin(), se = m_shards.end();
+		for (; si != se; ++si)
+		{
+			strus::scoped_lock wlock( (*si)->writeMutex);
+			(*si)->sketch->deserialize( src, pos);
+		}
+	}
+	m_nofDocuments.increment( nofdocs - m_nofDocuments.value());
+}
+
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_STATISTICS_SHARD_MAP_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_STATISTICS_SHARD_MAP_HPP_INCLUDED
+/// \brief Map of global statistics partitioned by term hash, serving reads from immutable snapshots
+#include "impl/value/compactTermMap.hpp"
+#include "impl/value/countMinSketch.hpp"
+#include "strus/storage/index.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include "strus/base/shared_ptr.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Map of global statistics partitioned by term hash, serving reads from immutable snapshots
+/// \note Writers of a shard are serialized and build the next version of the shard without blocking readers,
+///	readers only hold the lock of a shard for copying the reference to its current snapshot
+/// \note Optionally only terms with a df reaching a threshold are counted exactly, the df of the other terms is estimated
+///	with a count-min sketch per shard, updated in place by the writers of the shard and read without lock (atomic counters)
+/// \note A term once counted exactly stays counted exactly, also with a df of 0, because the sketch still holds the df it counted before
+class StatisticsShardMap
+{
+public:
+	/// \brief Change of the df of a term
+	struct DfChange
+	{
+		std::string type;
+		std::string value;
+		int increment;
+
+		DfChange( const std::string& type_, const std::string& value_, int increment_)
+			:type(type_),value(value_),increment(increment_){}
+		DfChange( const DfChange& o)
+			:type(o.type),value(o.value),increment(o.increment){}
+	};
+
+	enum {DefaultNofShards=16};
+
+	/// \brief Constructor
+	/// \param[in] nofShards_ number of partitions of the map
+	/// \param[in] compact_ true if the merged part of the shards is stored as compact term map (front coded values, varint packed df)
+	/// \param[in] sketchWidth_ total number of counters per row of the sketches estimating the df of terms not counted exactly, 0 if all terms are counted exactly
+	/// \param[in] sketchDepth_ number of rows of the sketches
+	/// \param[in] exactDfThreshold_ estimated df from which on a term is counted exactly
+	StatisticsShardMap( unsigned int nofShards_, bool compact_, unsigned int sketchWidth_=0, unsigned int sketchDepth_=0, GlobalCounter exactDfThreshold_=0);
+	/// \brief Destructor
+	virtual ~StatisticsShardMap();
+
+	/// \brief Apply a list of changes, as one update of each shard affected
+	/// \param[in] changes list of df changes
+	/// \param[in] nofDocumentsInsertedChange change of the number of documents in the collection
+	void update( const std::vector<DfChange>& changes, int nofDocumentsInsertedChange);
+
+	/// \brief Remove all terms and reset the number of documents to 0
+	/// \note Readers see the shards cleared one after the other
+	void clear();
+
+	/// \brief Get the total number of documents
+	GlobalCounter nofDocuments() const
+	{
+		return m_nofDocuments.value();
+	}
+
+	/// \brief Get the df of a term
+	GlobalCounter df( const std::string& type, const std::string& value) const;
+
+	/// \brief Get the df of a list of terms in one pass over the shards
+	/// \note The terms are grouped by shard and looked up in ascending order in one snapshot per shard, each distinct term once
+	/// \param[out] dest df of the terms, indexed like the terms passed, duplicates included
+	/// \param[in] terms list of terms as pairs (type,value)
+	void dfList( std::vector<GlobalCounter>& dest, const std::vector<std::pair<std::string,std::string> >& terms) const;
+
+	/// \brief Get the number of shards
+	unsigned int nofShards() const
+	{
+		return m_shards.size();
+	}
+
+	/// \brief Test if the merged part of the shards is stored as compact term map
+	bool compact() const
+	{
+		return m_compact;
+	}
+
+	/// \brief Get the number of counters per row of the sketch of a shard, 0 if all terms are counted exactly
+	unsigned int sketchWidth() const
+	{
+		return m_sketchWidth;
+	}
+	/// \brief Get the number of rows of the sketch of a shard
+	unsigned int sketchDepth() const
+	{
+		return m_sketchDepth;
+	}
+	/// \brief Get the estimated df from which on a term is counted exactly
+	GlobalCounter exactDfThreshold() const
+	{
+		return m_exactDfThreshold;
+	}
+
+	/// \brief Statistics of a shard for introspection
+	struct ShardInfo
+	{
+		std::size_t baseSize;		//< number of terms in the merged part of the snapshot
+		std::size_t deltaSize;		//< number of terms in the part of the snapshot with recent changes not merged yet
+		std::size_t memorySize;		//< number of bytes allocated by the snapshot and the sketch (estimated for std::map nodes)
+		GlobalCounter sketchErrorBound;	//< bound of the error of the df estimated by the sketch
+
+		ShardInfo()
+			:baseSize(0),deltaSize(0),memorySize(0),sketchErrorBound(0){}
+		ShardInfo( const ShardInfo& o)
+			:baseSize(o.baseSize),deltaSize(o.deltaSize),memorySize(o.memorySize),sketchErrorBound(o.sketchErrorBound){}
+	};
+	/// \brief Get the statistics of all shards
+	std::vector<ShardInfo> shardInfo() const;
+
+	/// \brief Append the number of documents and all terms with their df to a buffer
+	/// \note The shards are serialized one after the other, each one consistent in itself
+	/// \param[in,out] dest where to append the serialization to
+	void serialize( std::string& dest) const;
+
+	class Image;
+	/// \brief Get an image of the current state of the map for serializing it later without blocking the writers
+	/// \note Only copies the references to the current snapshots of the shards and the counters of the sketches
+	Image image() const;
+
+	/// \brief Load the content of a serialization created with 'serialize', the number of shards may differ
+	/// \note Replaces the content of the map, must not be called concurrently with updates
+	/// \param[in] src buffer with the serialization
+	/// \param[in,out] pos start position of the serialization, moved to its end
+	void deserialize( const std::string& src, std::size_t& pos);
+
+private:
+	typedef std::pair<std::string,std::string> Key;
+	typedef std::map<Key,GlobalCounter> TermMap;
+	typedef strus::shared_ptr<const TermMap> TermMapRef;
+	typedef strus::shared_ptr<const CompactTermMap> CompactTermMapRef;
+
+	typedef std::vector<TermMapRef> DeltaList;
+
+	/// \brief Immutable state of a shard, recent changes are kept in a list of small delta maps with absolute values that shadow the base map
+	/// \note The base is either a std::map (base) or a compact term map (cbase), the other one is null
+	/// \note The delta maps are ordered from the oldest to the newest, each one at least twice the size of its successor, so that an update
+	///	only copies the newest delta maps and every change is copied a logarithmic number of times until it is merged into the base
+	struct Snapshot
+	{
+		TermMapRef base;
+		CompactTermMapRef cbase;
+		DeltaList deltas;
+
+		explicit Snapshot( bool compact)
+			:base(compact ? 0 : new TermMap())
+			,cbase(compact ? new CompactTermMap() : 0)
+			,deltas(){}
+		Snapshot( const TermMapRef& base_, const CompactTermMapRef& cbase_, const DeltaList& deltas_)
+			:base(base_),cbase(cbase_),deltas(deltas_){}
+		Snapshot( const Snapshot& o)
+			:base(o.base),cbase(o.cbase),deltas(o.deltas){}
+
+		/// \brief Find a term counted exactly, also if its df is 0
+		/// \return true if the term has been found
+		bool find( const Key& key, GlobalCounter& df_) const;
+		/// \brief Find the df of a term in the delta maps, newest first
+		const GlobalCounter* deltaDf( const Key& key) const;
+		/// \brief Get all changes of the delta maps merged into one map
+		void mergeDeltas( TermMap& dest) const;
+		std::size_t baseSize() const
+		{
+			return cbase.get() ? cbase->size() : base->size();
+		}
+		std::size_t deltaSize() const;
+		std::size_t memorySize() const;
+	};
+
+	struct Shard
+	{
+		strus::mutex writeMutex;		//< serializes the writers of the shard
+		mutable strus::mutex publishMutex;	//< guards the reference to the current snapshot
+		Snapshot snapshot;			//< current snapshot
+		CountMinSketch* sketch;			//< sketch estimating the df of terms not counted exactly or NULL
+		GlobalCounter exactDfThreshold;		//< estimated df from which on a term is counted exactly
+
+		Shard( bool compact, CountMinSketch* sketch_, GlobalCounter exactDfThreshold_)
+			:writeMutex(),publishMutex(),snapshot(compact),sketch(sketch_),exactDfThreshold(exactDfThreshold_){}
+		~Shard();
+
+		Snapshot get() const;
+		void update( const std::vector<const DfChange*>& changes);
+	};
+
+	unsigned int shardIndex( const std::string& type, const std::string& value) const;
+
+private:
+	StatisticsShardMap( const StatisticsShardMap&) :m_shards(),m_nofDocuments(0),m_compact(false),m_sketchWidth(0),m_sketchDepth(0),m_exactDfThreshold(0){}	//... non copyable
+	void operator=( const StatisticsShardMap&){}		//... non copyable
+
+private:
+	std::vector<Shard*> m_shards;
+	strus::AtomicCounter<GlobalCounter> m_nofDocuments;
+	bool m_compact;
+	unsigned int m_sketchWidth;
+	unsigned int m_sketchDepth;
+	GlobalCounter m_exactDfThreshold;
+
+public:
+	/// \brief Immutable image of the state of the map (see 'StatisticsShardMap::image')
+	class Image
+	{
+	public:
+		Image()
+			:m_nofDocuments(0),m_shards(),m_sketches(),m_keepZeroDf(false){}
+		Image( const Image& o)
+			:m_nofDocuments(o.m_nofDocuments),m_shards(o.m_shards),m_sketches(o.m_sketches),m_keepZeroDf(o.m_keepZeroDf){}
+
+		/// \brief Append the number of documents and all terms with their df to a buffer, in the format of 'StatisticsShardMap::serialize'
+		/// \param[in,out] dest where to append the serialization to
+		void serialize( std::string& dest) const;
+
+	private:
+		friend class StatisticsShardMap;
+		GlobalCounter m_nofDocuments;
+		std::vector<Snapshot> m_shards;		//< snapshots of the shards
+		std::string m_sketches;			//< serialization of the sketches
+		bool m_keepZeroDf;			//< true if terms with a df of 0 are serialized too
+	};
+};
+
+}}//namespace
+#endif
+
@@ -6,6 +6,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "impl/value/termExpression.hpp"
+#include "impl/value/analyzerJobQueue.hpp"
 #include <cstring>
 
 using namespace strus;
@@ -103,6 +104,62 @@ void TermExpression::attachVariable( const std::string& name)
 	m_analyzer->groupElements( groupid, fieldnoList, how, true/*groupSingle*/);
 }
 
+void TermExpression::analyzeDeferred( AnalyzerJobQueue* queue)
+{
+	{
+		strus::unique_lock lock( m_state_mutex);
+		m_state = Pending;
+	}
+	try
+	{
+		queue->push( this);
+	}
+	catch (...)
+	{
+		strus::unique_lock lock( m_state_mutex);
+		m_state = Analyzed;
+		throw;
+	}
+}
 
+void TermExpression::runAnalyze()
+{
+	std::string errmsg;
+	try
+	{
+		m_expr = m_analyzer->analyze();
+		if (m_errorhnd->hasError())
+		{
+			errmsg = m_errorhnd->fetchError();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		errmsg = _TXT("out of memory");
+	}
+	catch (const std::runtime_error& err)
+	{
+		errmsg = err.what();
+	}
+	catch (...)
+	{
+		errmsg = _TXT("uncaught exception");
+	}
+	{
+		strus::unique_lock lock( m_state_mutex);
+		m_errmsg = errmsg;
+		m_state = Analyzed;
+		m_state_cond.notify_all();
+		//... notify while holding the lock, the waiting thread may delete this object as soon as it gets the lock
+	}
+}
 
+void TermExpression::waitAnalyzed() const
+{
+	strus::unique_lock lock( m_state_mutex);
+	while (m_state == Pending)
+	{
+		m_state_cond.wait( lock);
+	}
+}
 
@@ -13,12 +13,16 @@
 #include "strus/errorBufferInterface.hpp"
 #include "queryAnalyzerStruct.hpp"
 #include "private/internationalization.hpp"
+#include "strus/base/thread.hpp"
 #include <vector>
 #include <string>
 
 namespace strus {
 namespace bindings {
 
+/// \brief Forward declaration
+class AnalyzerJobQueue;
+
 /// \brief Analyzed term expression structure
 class TermExpression
 {
@@ -42,17 +46,22 @@ public:
 		:m_errorhnd(errorhnd_),m_analyzerStruct(analyzerStruct_),m_analyzer(analyzer_->createContext())
 		,m_singleUniqueResult(singleUniqueResult_),m_schemaTypedOutput(schemaTypedOutput_),m_fieldno_stack(),m_fieldar()
 		,m_expr(),m_operators(),m_variables()
+		,m_state(Analyzed),m_errmsg(),m_state_mutex(),m_state_cond()
 	{
 		if (!m_analyzer) throw strus::runtime_error(_TXT("failed to create analyzer context: %s"), m_errorhnd->fetchError());
 	}
 	~TermExpression()
 	{
+		waitAnalyzed();
 		delete m_analyzer;
 	}
 
 	/// \brief Reference to query structure
+	/// \note Waits for the completion of the analysis if it has been delegated to a job queue (see analyzeDeferred)
 	const analyzer::QueryTermExpression& expression() const
 	{
+		waitAnalyzed();
+		if (!m_errmsg.empty()) throw strus::runtime_error(_TXT("failed to analyze term expression: %s"), m_errmsg.c_str());
 		return m_expr;
 	}
 	static bool isVariable( unsigned int groupidx)
@@ -100,6 +109,14 @@ public:
 		if (m_errorhnd->hasError()) throw strus::runtime_error(_TXT("failed to analyze term expression: %s"), m_errorhnd->fetchError());
 	}
 
+	/// \brief Delegate the analysis to a job queue, the result is gathered on the first access of the expression
+	/// \param[in] queue job queue processing the analysis in a background thread
+	void analyzeDeferred( AnalyzerJobQueue* queue);
+
+	/// \brief Run the analysis delegated with analyzeDeferred, called by the job queue in a background thread
+	/// \note Does not throw, errors are reported on the access of the expression
+	void runAnalyze();
+
 	bool singleUniqueResult() const
 	{
 		return m_singleUniqueResult;
@@ -109,6 +126,9 @@ public:
 		return m_schemaTypedOutput;
 	}
 
+private:
+	void waitAnalyzed() const;
+
 private:
 	TermExpression( const TermExpression&){}		//... non copyable
 	void operator=( const TermExpression&){}		//... non copyable
@@ -124,6 +144,12 @@ private:
 	analyzer::QueryTermExpression m_expr;
 	std::vector<Operator> m_operators;
 	std::vector<std::string> m_variables;
+
+	enum State {Analyzed,Pending};
+	State m_state;					//< state of a deferred analysis
+	std::string m_errmsg;				//< error of a deferred analysis
+	mutable strus::mutex m_state_mutex;		//< mutex for the state of a deferred analysis
+	mutable strus::condition_variable m_state_cond;	//< signal for the completion of a deferred analysis
 };
 
 }}//namespace
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Compact summary (bloom filter) of the terms contained in a storage shard
+#include "impl/value/termSummary.hpp"
+#include "private/internationalization.hpp"
+#include "strus/base/base64.hpp"
+#include "strus/lib/error.hpp"
+#include <stdexcept>
+#include <cstring>
+
+using namespace strus;
+using namespace strus::bindings;
+
+#define HEADER_SIZE 12
+
+static void writeUInt32( unsigned char* dest, unsigned int val)
+{
+	dest[0] = (unsigned char)((val >> 24) & 0xff);
+	dest[1] = (unsigned char)((val >> 16) & 0xff);
+	dest[2] = (unsigned char)((val >>  8) & 0xff);
+	dest[3] = (unsigned char)((val      ) & 0xff);
+}
+
+static unsigned int readUInt32( const unsigned char* src)
+{
+	return ((unsigned int)src[0] << 24) | ((unsigned int)src[1] << 16) | ((unsigned int)src[2] << 8) | (unsigned int)src[3];
+}
+
+TermSummary::TermSummary( unsigned int nofBits_, unsigned int nofHashes_)
+	:m_nofBits(nofBits_),m_nofHashes(nofHashes_),m_nofTerms(0),m_ar()
+{
+	if (!m_nofBits || !m_nofHashes) throw strus::runtime_error(_TXT("size and number of hashes of a term summary must not be 0"));
+	m_ar.resize( (m_nofBits + 7) / 8, 0);
+}
+
+TermSummary::TermSummary( const std::string& blob)
+	:m_nofBits(0),m_nofHashes(0),m_nofTerms(0),m_ar()
+{
+	std::string buf( strus::base64DecodeLength( blob.c_str(), blob.size()), '\0');
+	ErrorCode errcode = (ErrorCode)0;
+	std::size_t len = strus::decodeBase64( const_cast<char*>( buf.c_str()), buf.size(), blob.c_str(), blob.size(), errcode);
+	if (errcode) throw strus::runtime_error(_TXT("error decoding base64 encoded term summary: %s"), errorCodeToString( errcode));
+	if (len < HEADER_SIZE) throw strus::runtime_error(_TXT("corrupt term summary: %s"), _TXT("header too small"));
+
+	const unsigned char* src = (const unsigned char*)buf.c_str();
+	m_nofBits = readUInt32( src);
+	m_nofHashes = readUInt32( src+4);
+	m_nofTerms = readUInt32( src+8);
+	if (!m_nofBits || !m_nofHashes || len != HEADER_SIZE + (m_nofBits + 7) / 8)
+	{
+		throw strus::runtime_error(_TXT("corrupt term summary: %s"), _TXT("size mismatch"));
+	}
+	m_ar.assign( src + HEADER_SIZE, src + len);
+}
+
+void TermSummary::getHash( unsigned int& h1, unsigned int& h2, const std::string& type, const std::string& value) const
+{
+	// ... FNV-1a 64 bit hash of type and value separated by a 0 byte, split into two 32 bit hashes for double hashing
+	unsigned long long hh = 14695981039346656037ULL;
+	std::string::const_iterator si = type.begin(), se = type.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 1099511628211ULL;
+	}
+	hh *= 1099511628211ULL;
+	si = value.begin(), se = value.end();
+	for (; si != se; ++si)
+	{
+		hh ^= (unsigned char)*si;
+		hh *= 1099511628211ULL;
+	}
+	h1 = (unsigned int)(hh & 0xffffFFFFULL);
+	h2 = (unsigned int)(hh >> 32) | 1;
+}
+
+void TermSummary::insert( const std::string& type, const std::string& value)
+{
+	unsigned int h1,h2;
+	getHash( h1, h2, type, value);
+	unsigned int hi = 0;
+	for (; hi < m_nofHashes; ++hi)
+	{
+		unsigned int bitidx = (h1 + hi * h2) % m_nofBits;
+		m_ar[ bitidx >> 3] |= (unsigned char)(1 << (bitidx & 7));
+	}
+	++m_nofTerms;
+}
+
+bool TermSummary::mayContain( const std::string& type, const std::string& value) const
+{
+	unsigned int h1,h2;
+	getHash( h1, h2, type, value);
+	unsigned int hi = 0;
+	for (; hi < m_nofHashes; ++hi)
+	{
+		unsigned int bitidx = (h1 + hi * h2) % m_nofBits;
+		if (0==(m_ar[ bitidx >> 3] & (unsigned char)(1 << (bitidx & 7)))) return false;
+	}
+	return true;
+}
+
+std::string TermSummary::tostring() const
+{
+	std::string buf( HEADER_SIZE, '\0');
+	unsigned char* hdr = (unsigned char*)const_cast<char*>( buf.c_str());
+	writeUInt32( hdr, m_nofBits);
+	writeUInt32( hdr+4, m_nofHashes);
+	writeUInt32( hdr+8, m_nofTerms);
+	buf.append( (const char*)&m_ar[0], m_ar.size());
+
+	std::string rt( strus::base64EncodeLength( buf.size()), '\0');
+	ErrorCode errcode = (ErrorCode)0;
+	rt.resize( strus::encodeBase64( const_cast<char*>( rt.c_str()), rt.size(), buf.c_str(), buf.size(), errcode));
+	if (errcode) throw strus::runtime_error(_TXT("error encoding term summary: %s"), errorCodeToString( errcode));
+	return rt;
+}
+
+bool TermSummaryCache::get( std::string& blob, const std::string& key, const TimeStamp& timestamp) const
+{
+	strus::scoped_lock lock( m_mutex);
+	if (m_blob.empty() || key != m_key || m_timestamp < timestamp || timestamp < m_timestamp) return false;
+	blob = m_blob;
+	return true;
+}
+
+void TermSummaryCache::set( const std::string& key, const TimeStamp& timestamp, const std::string& blob)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_key = key;
+	m_timestamp = timestamp;
+	m_blob = blob;
+}
+
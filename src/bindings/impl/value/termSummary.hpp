@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_TERM_SUMMARY_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_TERM_SUMMARY_HPP_INCLUDED
+/// \brief Compact summary (bloom filter) of the terms contained in a storage shard
+#include "strus/timeStamp.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Compact summary (bloom filter) of the terms contained in a storage shard
+/// \note A summary may report a term as contained that is not (false positive), but never the opposite
+class TermSummary
+{
+public:
+	enum {
+		DefaultNofBits=1048576,
+		DefaultNofHashes=4
+	};
+
+	/// \brief Constructor of an empty summary
+	/// \param[in] nofBits_ size of the filter in bits
+	/// \param[in] nofHashes_ number of hash functions used per term
+	TermSummary( unsigned int nofBits_, unsigned int nofHashes_);
+	/// \brief Constructor of a summary from its base64 encoded blob created with 'tostring()'
+	explicit TermSummary( const std::string& blob);
+	TermSummary( const TermSummary& o)
+		:m_nofBits(o.m_nofBits),m_nofHashes(o.m_nofHashes),m_nofTerms(o.m_nofTerms),m_ar(o.m_ar){}
+
+	/// \brief Insert a term into the summary
+	void insert( const std::string& type, const std::string& value);
+	/// \brief Test if a term is possibly contained in the summary
+	bool mayContain( const std::string& type, const std::string& value) const;
+
+	/// \brief Get the summary as base64 encoded blob
+	std::string tostring() const;
+
+	unsigned int nofBits() const		{return m_nofBits;}
+	unsigned int nofHashes() const		{return m_nofHashes;}
+	unsigned int nofTerms() const		{return m_nofTerms;}
+
+private:
+	void getHash( unsigned int& h1, unsigned int& h2, const std::string& type, const std::string& value) const;
+
+private:
+	unsigned int m_nofBits;
+	unsigned int m_nofHashes;
+	unsigned int m_nofTerms;
+	std::vector<unsigned char> m_ar;
+};
+
+/// \brief Term summary of a storage kept with the timestamp of the latest statistics change it was built for
+class TermSummaryCache
+{
+public:
+	TermSummaryCache()
+		:m_mutex(),m_key(),m_timestamp(),m_blob(){}
+
+	/// \brief Get the summary kept, if it was built with the same configuration for the same statistics change timestamp
+	/// \param[out] blob the summary as base64 encoded blob
+	/// \param[in] key string identifying the configuration of the summary
+	/// \param[in] timestamp timestamp of the latest statistics change of the storage
+	/// \return true if the summary kept is valid and returned, false if it has to be rebuilt
+	bool get( std::string& blob, const std::string& key, const TimeStamp& timestamp) const;
+	/// \brief Keep a summary built
+	/// \param[in] key string identifying the configuration of the summary
+	/// \param[in] timestamp timestamp of the latest statistics change of the storage taken before the summary was built
+	/// \param[in] blob the summary as base64 encoded blob
+	void set( const std::string& key, const TimeStamp& timestamp, const std::string& blob);
+
+private:
+	mutable strus::mutex m_mutex;
+	std::string m_key;
+	TimeStamp m_timestamp;
+	std::string m_blob;
+};
+
+}}//namespace
+#endif
+
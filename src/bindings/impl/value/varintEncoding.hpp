@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_VARINT_ENCODING_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_VARINT_ENCODING_HPP_INCLUDED
+/// \brief Variable length encoding of unsigned integers (7 bits per byte, high bit set if more bytes follow)
+#include "private/internationalization.hpp"
+#include "strus/lib/error.hpp"
+#include <string>
+#include <stdexcept>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Append an unsigned integer in variable length encoding
+static inline void appendVarint( std::string& dest, unsigned long long val)
+{
+	while (val >= 0x80)
+	{
+		dest.push_back( (char)(unsigned char)((val & 0x7f) | 0x80));
+		val >>= 7;
+	}
+	dest.push_back( (char)(unsigned char)val);
+}
+
+/// \brief Read an unsigned integer in variable length encoding
+/// \param[in] src source buffer
+/// \param[in,out] pos read position, moved to the position after the value read
+static inline unsigned long long readVarint( const std::string& src, std::size_t& pos)
+{
+	unsigned long long rt = 0;
+	unsigned int shift = 0;
+	for (;;)
+	{
+		if (pos >= src.size() || shift > 63) throw strus::runtime_error(_TXT("corrupt varint encoding: %s"), _TXT("unexpected end of data"));
+		unsigned char ch = (unsigned char)src[ pos++];
+		rt |= (unsigned long long)(ch & 0x7f) << shift;
+		if (!(ch & 0x80)) break;
+		shift += 7;
+	}
+	return rt;
+}
+
+/// \brief Append a string with its length in variable length encoding
+static inline void appendVarintString( std::string& dest, const std::string& val)
+{
+	appendVarint( dest, val.size());
+	dest.append( val);
+}
+
+/// \brief Read a string with its length in variable length encoding
+/// \param[in] src source buffer
+/// \param[in,out] pos read position, moved to the position after the string read
+static inline std::string readVarintString( const std::string& src, std::size_t& pos)
+{
+	std::size_t len = readVarint( src, pos);
+	if (len > src.size() - pos) throw strus::runtime_error(_TXT("corrupt varint encoding: %s"), _TXT("string out of range"));
+	std::string rt( src.c_str() + pos, len);
+	pos += len;
+	return rt;
+}
+
+}}//namespace
+#endif
+
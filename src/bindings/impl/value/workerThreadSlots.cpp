@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Bounded number of background worker threads shared by the parallel operations of a context
+#include "impl/value/workerThreadSlots.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+using namespace strus::bindings;
+
+unsigned int WorkerThreadSlots::tryAllocate( unsigned int nofSlots)
+{
+	strus::scoped_lock lock( m_mutex);
+	unsigned int rt = m_size - m_used;
+	if (rt > nofSlots) rt = nofSlots;
+	m_used += rt;
+	return rt;
+}
+
+void WorkerThreadSlots::release( unsigned int nofSlots)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_used = (m_used > nofSlots) ? (m_used - nofSlots) : 0;
+}
+
+WorkerThreadAllocation::WorkerThreadAllocation( const ObjectRef& slots_, unsigned int nofThreads_)
+	:m_slots_impl(slots_),m_nofThreads(0)
+{
+	WorkerThreadSlots* slots = m_slots_impl.getObject<WorkerThreadSlots>();
+	if (slots) m_nofThreads = slots->tryAllocate( nofThreads_);
+}
+
+WorkerThreadAllocation::~WorkerThreadAllocation()
+{
+	WorkerThreadSlots* slots = m_slots_impl.getObject<WorkerThreadSlots>();
+	if (slots && m_nofThreads) slots->release( m_nofThreads);
+}
+
+
+WorkerThreadPool::~WorkerThreadPool()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+	}
+	m_cond.notify_all();
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+}
+
+void WorkerThreadPool::push( WorkerThreadJob* job)
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_terminate) throw strus::runtime_error(_TXT("worker thread pool has been stopped"));
+		if (m_nofIdle <= m_queue.size() && m_threads.size() < m_maxNofThreads)
+		{
+			// ... with all threads started, the job is taken by the thread of a job completed, that did not yet get back to wait
+			m_threads.reserve( m_threads.size() + 1);
+			m_threads.push_back( new strus::thread( &WorkerThreadPool::run, this));
+		}
+		m_queue.push_back( job);
+	}
+	m_cond.notify_one();
+}
+
+void WorkerThreadPool::run()
+{
+	for (;;)
+	{
+		WorkerThreadJob* job = 0;
+		{
+			strus::unique_lock lock( m_mutex);
+			++m_nofIdle;
+			while (m_queue.empty() && !m_terminate)
+			{
+				m_cond.wait( lock);
+			}
+			--m_nofIdle;
+			if (m_queue.empty()) break;
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+		job->run();
+	}
+}
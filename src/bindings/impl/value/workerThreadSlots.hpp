@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_BINDING_IMPL_WORKER_THREAD_SLOTS_HPP_INCLUDED
+#define _STRUS_BINDING_IMPL_WORKER_THREAD_SLOTS_HPP_INCLUDED
+/// \brief Bounded number of background worker threads shared by the parallel operations of a context
+#include "impl/value/objectref.hpp"
+#include "strus/base/thread.hpp"
+#include <deque>
+#include <vector>
+
+namespace strus {
+namespace bindings {
+
+/// \brief Job run by a thread of a worker thread pool
+class WorkerThreadJob
+{
+public:
+	virtual ~WorkerThreadJob(){}
+
+	/// \brief Run the job
+	/// \note Must not throw, errors are reported by the job to its owner
+	virtual void run()=0;
+};
+
+/// \brief Background threads started on demand and kept for the jobs of later parallel operations, instead of starting new threads for every operation
+/// \note A job may only be pushed by an operation holding a worker thread slot for it (see WorkerThreadSlots), so a job waits at most for a thread getting back from a job already completed
+class WorkerThreadPool
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofThreads_ maximum number of background threads started
+	explicit WorkerThreadPool( unsigned int maxNofThreads_)
+		:m_mutex(),m_cond(),m_queue(),m_threads(),m_maxNofThreads(maxNofThreads_),m_nofIdle(0),m_terminate(false){}
+	/// \brief Destructor, processes all jobs left in the queue and joins the background threads
+	~WorkerThreadPool();
+
+	/// \brief Push a job to run by a background thread, starting a new thread if none is idle and not all have been started
+	/// \param[in] job job to run, must not be deleted before it has completed
+	void push( WorkerThreadJob* job);
+
+private:
+	void run();
+
+private:
+	WorkerThreadPool( const WorkerThreadPool&){}		//... non copyable
+	void operator=( const WorkerThreadPool&){}		//... non copyable
+
+private:
+	strus::mutex m_mutex;				//< mutex for the queue monitor
+	strus::condition_variable m_cond;		//< signal for jobs available or termination
+	std::deque<WorkerThreadJob*> m_queue;		//< jobs waiting to be processed
+	std::vector<strus::thread*> m_threads;		//< background threads started
+	unsigned int m_maxNofThreads;			//< maximum number of background threads started
+	unsigned int m_nofIdle;				//< number of background threads waiting for a job
+	bool m_terminate;				//< true, if the background threads should stop after the queue has been processed
+};
+
+/// \brief Bounded number of background worker threads shared by the parallel operations of a context
+/// \note Every background thread using the error buffer of the context needs a slot of its own in it,
+///	the context reserves one for every worker thread slot, parallel operations may only start as many threads as slots they got allocated
+class WorkerThreadSlots
+{
+public:
+	/// \brief Constructor
+	/// \param[in] size_ maximum number of worker threads running at the same time
+	explicit WorkerThreadSlots( unsigned int size_)
+		:m_mutex(),m_size(size_),m_used(0),m_pool(size_){}
+
+	/// \brief Get the maximum number of worker threads running at the same time
+	unsigned int size() const
+	{
+		return m_size;
+	}
+
+	/// \brief Allocate up to a number of slots without waiting
+	/// \param[in] nofSlots number of slots requested
+	/// \return the number of slots allocated, 0 if all are in use
+	unsigned int tryAllocate( unsigned int nofSlots);
+
+	/// \brief Release slots allocated with 'tryAllocate'
+	/// \param[in] nofSlots number of slots to release
+	void release( unsigned int nofSlots);
+
+	/// \brief Get the pool of background threads kept for the jobs of parallel operations holding slots
+	WorkerThreadPool* pool()
+	{
+		return &m_pool;
+	}
+
+private:
+	WorkerThreadSlots( const WorkerThreadSlots&):m_pool(0){}	//... non copyable
+	void operator=( const WorkerThreadSlots&){}		//... non copyable
+
+private:
+	strus::mutex m_mutex;			//< mutex for the counter of slots used
+	unsigned int m_size;			//< number of slots
+	unsigned int m_used;			//< number of slots allocated
+	WorkerThreadPool m_pool;		//< background threads kept for the jobs of parallel operations
+};
+
+/// \brief Worker thread slots allocated for one parallel operation, released on destruction
+class WorkerThreadAllocation
+{
+public:
+	/// \brief Constructor, allocating up to a number of slots without waiting
+	/// \param[in] slots_ reference to the worker thread slots of the context, no slots are allocated if it is undefined
+	/// \param[in] nofThreads_ number of worker threads requested
+	WorkerThreadAllocation( const ObjectRef& slots_, unsigned int nofThreads_);
+	/// \brief Destructor, releasing the slots allocated
+	~WorkerThreadAllocation();
+
+	/// \brief Get the number of worker threads the operation may start
+	unsigned int nofThreads() const
+	{
+		return m_nofThreads;
+	}
+
+private:
+	WorkerThreadAllocation( const WorkerThreadAllocation&){}	//... non copyable
+	void operator=( const WorkerThreadAllocation&){}		//... non copyable
+
+private:
+	ObjectRef m_slots_impl;
+	unsigned int m_nofThreads;
+};
+
+}}//namespace
+#endif
+
@@ -309,6 +309,12 @@ bool Serializer::serialize_nothrow( papuga_Serialization* result, const TermExpr
 		errcode = papuga_NoMemError;
 		return false;
 	}
+	catch (const std::runtime_error&)
+	{
+		// ... analysis delegated to a background thread failed
+		errcode = papuga_HostObjectError;
+		return false;
+	}
 }
 
 bool Serializer::serializeTermInExpression( papuga_Serialization* result, const SentenceTerm& term, papuga_ErrorCode& errcode, bool deep)
@@ -484,7 +484,7 @@ DfChangeDef::DfChangeDef( papuga_SerializationIter& seriter)
 }
 
 ContextDef::ContextDef( const ValueVariant& ctx)
-	:threads(0),rpc(),trace()
+	:threads(0),analyzerThreads(0),workerThreads(0),rpc(),trace()
 {
 	static const char* context = _TXT("context configuration");
 	if (!papuga_ValueVariant_defined( &ctx))
@@ -510,7 +510,7 @@ ContextDef::ContextDef( const ValueVariant& ctx)
 }
 
 ContextDef::ContextDef( papuga_SerializationIter& seriter)
-	:threads(0),rpc(),trace()
+	:threads(0),analyzerThreads(0),workerThreads(0),rpc(),trace()
 {
 	init( seriter);
 }
@@ -518,7 +518,7 @@ ContextDef::ContextDef( papuga_SerializationIter& seriter)
 void ContextDef::init( papuga_SerializationIter& seriter)
 {
 	static const char* context = _TXT("context configuration");
-	static const StructureNameMap namemap( "threads,rpc,trace", ',');
+	static const StructureNameMap namemap( "threads,rpc,trace,analyzerthreads,workerthreads", ',');
 
 	if (papuga_SerializationIter_tag( &seriter) == papuga_TagValue)
 	{
@@ -526,7 +526,7 @@ void ContextDef::init( papuga_SerializationIter& seriter)
 	}
 	else
 	{
-		unsigned char defined[3] = {0,0,0};
+		unsigned char defined[5] = {0,0,0,0,0};
 		while (papuga_SerializationIter_tag( &seriter) == papuga_TagName)
 		{
 			int idx = namemap.index( *papuga_SerializationIter_value( &seriter));
@@ -542,6 +542,12 @@ void ContextDef::init( papuga_SerializationIter& seriter)
 				case 2:	if (defined[2]++) throw strus::runtime_error(_TXT("duplicate definition of '%s' in %s"), namemap.name(idx), context);
 					trace = ConfigDef( seriter).cfgstring;
 					break;
+				case 3:	if (defined[3]++) throw strus::runtime_error(_TXT("duplicate definition of '%s' in %s"), namemap.name(idx), context);
+					analyzerThreads = Deserializer::getUint( seriter);
+					break;
+				case 4:	if (defined[4]++) throw strus::runtime_error(_TXT("duplicate definition of '%s' in %s"), namemap.name(idx), context);
+					workerThreads = Deserializer::getUint( seriter);
+					break;
 				default: throw strus::runtime_error(_TXT("unknown tag name in %s, one of {%s} expected"), context, namemap.names());
 			}
 		}
@@ -97,17 +97,19 @@ struct DfChangeDef
 struct ContextDef
 {
 	unsigned int threads;
+	unsigned int analyzerThreads;
+	unsigned int workerThreads;
 	std::string rpc;
 	std::string trace;
 
 	ContextDef()
-		:threads(0),rpc(),trace(){}
+		:threads(0),analyzerThreads(0),workerThreads(0),rpc(),trace(){}
 	explicit ContextDef( const std::string& connstr)
-		:threads(0),rpc(connstr),trace(){}
+		:threads(0),analyzerThreads(0),workerThreads(0),rpc(connstr),trace(){}
 	ContextDef( papuga_SerializationIter& seriter);
 	ContextDef( const papuga_ValueVariant& def);
 	ContextDef( const ContextDef& o)
-		:threads(o.threads),rpc(o.rpc),trace(o.trace){}
+		:threads(o.threads),analyzerThreads(o.analyzerThreads),workerThreads(o.workerThreads),rpc(o.rpc),trace(o.trace){}
 
 private:
 	void init( papuga_SerializationIter& seriter);
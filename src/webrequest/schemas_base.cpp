@@ -24,6 +24,8 @@ const char* AutomatonNameSpace::itemName( int itemid)
 		{WorkDir, "work directory"},
 		{ContextConfig, "context configuration"},
 		{ContextThreads, "context threads"},
+		{ContextAnalyzerThreads, "context analyzer threads"},
+		{ContextWorkerThreads, "context worker threads"},
 		{ContextRpc, "context rpc"},
 		{ContextDebug, "context debug"},
 		{ContextTrace, "context trace"},
@@ -35,8 +37,35 @@ const char* AutomatonNameSpace::itemName( int itemid)
 		{StatisticsMapConfig, "statistics map configuration"},
 		{StatisticsProc, "statistics proc"},
 		{StatisticsMapBlocks, "statistics map blocks"},
+		{StatisticsMapShards, "statistics map shards"},
+		{StatisticsMapDict, "statistics map dict"},
+		{StatisticsMapSnapshot, "statistics map snapshot"},
+		{StatisticsMapSnapshotPeriod, "statistics map snapshot period"},
+		{StatisticsMapEpoch, "statistics map version epoch"},
+		{StatisticsMapSketchWidth, "statistics map sketch width"},
+		{StatisticsMapSketchDepth, "statistics map sketch depth"},
+		{StatisticsMapExactDf, "statistics map exact df"},
 		{StatisticsStorageServer, "statistics storage server"},
 		{StatisticsBlob, "statistics blob"},
+		{StatisticsVersionRequest, "statistics version request"},
+		{StatisticsSource, "statistics source"},
+		{StatisticsTimeStampUnixTime, "statistics timestamp unix time"},
+		{StatisticsTimeStampCounter, "statistics timestamp counter"},
+		{StatisticsTimeStamp, "statistics timestamp"},
+		{StatisticsChangeMessage, "statistics change message"},
+		{StatisticsSnapshotMessage, "statistics snapshot message"},
+		{StatisticsWatermark, "statistics watermark"},
+		{StatisticsWatermarkTimeStamp, "statistics watermark timestamp"},
+		{StatisticsCacheConfig, "statistics cache configuration"},
+		{StatisticsCacheTimeToLive, "statistics cache time to live"},
+		{StatisticsCacheSize, "statistics cache size"},
+		{TermSummaryConfig, "term summary configuration"},
+		{TermSummaryBits, "term summary size in bits"},
+		{TermSummaryHashes, "term summary number of hash functions"},
+		{ShardSelectorConfig, "shard selector configuration"},
+		{ShardSelectFeatureSet, "shard selector selecting feature sets"},
+		{ShardSummaryServer, "shard summary server"},
+		{ShardSummaryBlob, "shard summary blob"},
 		{StorageConfig, "storage configuration"},
 		{DatabaseEngine, "database engine"},
 		{DatabasePath, "database path"},
@@ -163,7 +192,9 @@ const char* AutomatonNameSpace::itemName( int itemid)
 		{QueryEvalFormulaParameterName, "query evaluation formula parameter name"},
 		{QueryEvalFormulaParameterValue, "query evaluation formula parameter value"},
 		{QueryEvalFormulaParameter, "query evaluation formula parameter"},
+		{QueryEvalShard, "query evaluation shard identifier"},
 		{QueryResult, "query result"},
+		{QueryResultShard, "query result shard identifier"},
 		{QueryEvalPass, "query evaluation pass"},
 		{QueryNofRanked, "query number of ranked"},
 		{QueryNofVisited, "query number of visited"},
@@ -198,6 +229,7 @@ const char* AutomatonNameSpace::itemName( int itemid)
 		{DistQueryEvalStorageServer, "distributed query evaluation storage server"},
 		{DistQueryEvalStatisticsServer, "distributed query evaluation statistics server"},
 		{DistQueryEvalAnalyzeServer, "distributed query evaluation analyze server"},
+		{DistQueryEvalRankServer, "distributed query evaluation rank server"},
 		{ContentTermExpression, "content term expression"},
 		{AnalyzedTermExpression, "analyzed term expression"},
 		{NodeTerm, "node term"},
@@ -217,11 +249,15 @@ const char* AutomatonNameSpace::itemName( int itemid)
 		{TermStats, "term statistics"},
 		{TermDocumentFrequency, "term document frequency"},
 		{CollectionNofDocs, "collection number of documents"},
+		{CollectionStatisticsVersion, "collection statistics version"},
 		{GlobalStats, "global statistics"},
 		{Docno, "internal document number"},
+		{EvalShardName, "evaluation set shard identifier"},
+		{ShardIdRequest, "request shard identifier in result"},
 		{NumberOfResults, "number of results"},
 		{FirstResult, "first result"},
 		{MergeResult, "merge result"},
+		{NofPartitions, "number of partitions"},
 		{AccessRight, "access right"},
 		{VariableName, "variable name"},
 		{VariableValue, "variable value"},
@@ -31,10 +31,15 @@ public:
 	{
 		NullValue,
 
-		ModuleDir,ModuleName,ResourceDir,WorkDir,ContextConfig,ContextThreads,ContextRpc,ContextDebug,
+		ModuleDir,ModuleName,ResourceDir,WorkDir,ContextConfig,ContextThreads,ContextAnalyzerThreads,ContextWorkerThreads,ContextRpc,ContextDebug,
 		ContextTrace,TraceLogType,TraceLogFile,TraceGroupBy,TraceCall,TraceCount,
 
-		StatisticsMapConfig,StatisticsProc,StatisticsMapBlocks,StatisticsStorageServer,StatisticsBlob,
+		StatisticsMapConfig,StatisticsProc,StatisticsMapBlocks,StatisticsMapShards,StatisticsMapDict,StatisticsMapSnapshot,StatisticsMapSnapshotPeriod,StatisticsMapEpoch,StatisticsMapSketchWidth,StatisticsMapSketchDepth,StatisticsMapExactDf,StatisticsStorageServer,StatisticsBlob,StatisticsVersionRequest,
+		StatisticsSource,StatisticsTimeStampUnixTime,StatisticsTimeStampCounter,StatisticsTimeStamp,StatisticsChangeMessage,StatisticsSnapshotMessage,
+		StatisticsWatermark,StatisticsWatermarkTimeStamp,
+		StatisticsCacheConfig,StatisticsCacheTimeToLive,StatisticsCacheSize,
+		TermSummaryConfig,TermSummaryBits,TermSummaryHashes,
+		ShardSelectorConfig,ShardSelectFeatureSet,ShardSummaryServer,ShardSummaryBlob,
 
 		StorageConfig, DatabaseEngine, DatabasePath, StorageCachedTerms,
 		StorageMetadata, StorageMetadataName, StorageMetadataType,
@@ -78,8 +83,9 @@ public:
 		QueryEvalFunctionName, QueryEvalFormulaSource, QueryEvalSummaryId,
 		QueryEvalSummarizer, QueryEvalWeighting, 
 		QueryEvalFormulaParameterName, QueryEvalFormulaParameterValue, QueryEvalFormulaParameter,
+		QueryEvalShard,
 
-		QueryResult,QueryEvalPass,QueryNofRanked,QueryNofVisited,
+		QueryResult,QueryResultShard,QueryEvalPass,QueryNofRanked,QueryNofVisited,
 		QueryRank,QueryRankDocno,QueryRankWeight,QueryRankField,QueryRankFieldStart,QueryRankFieldEnd,QueryRankSummary,
 		QueryRankSummaryName,QueryRankSummaryValue,QueryRankSummaryWeight,QueryRankSummaryIndex,
 		QuerySummary,QuerySummaryName,QuerySummaryValue,QuerySummaryWeight,QuerySummaryIndex,
@@ -89,15 +95,15 @@ public:
 		QueryBuilderFeatureTypeRewriteDefName, QueryBuilderFeatureTypeRewriteDefValue,
 
 		DistQueryEvalCollectServer, DistQueryEvalStorageServer,
-		DistQueryEvalStatisticsServer, DistQueryEvalAnalyzeServer,
+		DistQueryEvalStatisticsServer, DistQueryEvalAnalyzeServer, DistQueryEvalRankServer,
 
 		ContentTermExpression, AnalyzedTermExpression,
 		NodeTerm, NodeExpression, ExpressionArg, ExpressionVariableName, TermType, TermValue, TermLen,
 		MetaDataCondition, MetaDataUnionCondition, MetaDataConditionOp, MetaDataConditionName, MetaDataConditionValue,
 		MetaDataRangeFrom, MetaDataRangeTo, 
 
-		TermStats, TermDocumentFrequency, CollectionNofDocs, GlobalStats,
-		Docno,NumberOfResults,FirstResult,MergeResult,AccessRight,
+		TermStats, TermDocumentFrequency, CollectionNofDocs, CollectionStatisticsVersion, GlobalStats,
+		Docno,EvalShardName,ShardIdRequest,NumberOfResults,FirstResult,MergeResult,NofPartitions,AccessRight,
 		VariableName,VariableValue,VariableDef,
 
 		IncludeContextName,
@@ -48,10 +48,14 @@ public:
 			{"/context/debug", "()", ContextDebug, papuga_TypeString, "sentence,query,analyze"},
 			{"/context/rpc", "()", ContextRpc, papuga_TypeString, "localhost:1313"},
 			{"/context/threads", "()", ContextThreads, papuga_TypeInt, "16"},
+			{"/context/analyzerthreads", "()", ContextAnalyzerThreads, papuga_TypeInt, "4"},
+			{"/context/workerthreads", "()", ContextWorkerThreads, papuga_TypeInt, "8"},
 			{"/context", ContextConfig, {
 					{"rpc", ContextRpc, '?'},
 					{"trace", ContextTrace, '?'},
-					{"threads", ContextThreads, '?'}
+					{"threads", ContextThreads, '?'},
+					{"analyzerthreads", ContextAnalyzerThreads, '?'},
+					{"workerthreads", ContextWorkerThreads, '?'}
 				}
 			},
 			{"/", "context", "", bindings::method::Context::constructor(), {{(int)ContextConfig, '?'}} },
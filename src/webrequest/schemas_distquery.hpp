@@ -38,7 +38,9 @@ public:
 			{"/distqryeval/qryeval", "()", DistQueryEvalStorageServer, papuga_TypeString, "example.com:7184/qryeval/test"},
 			{"/distqryeval", "", "qryeval", DistQueryEvalStorageServer, '*'},
 			{"/distqryeval/statserver", "()", DistQueryEvalStatisticsServer, papuga_TypeString, "example.com:7184/statserver/test"},
-			{"/distqryeval", "", "statserver", DistQueryEvalStatisticsServer, '!'}
+			{"/distqryeval", "", "statserver", DistQueryEvalStatisticsServer, '!'},
+			{SchemaQueryDeclPart::defineStatisticsCache( "/distqryeval")},
+			{SchemaQueryDeclPart::defineShardSelector( "/distqryeval")}
 		}
 	) {}
 };
@@ -59,15 +61,17 @@ public:
 			{"query", "SET~analysis", "GET", "qryanalyzer", "", {
 				{SchemaQueryDeclPart::resultQueryOrig("/query")}
 			}},
-			{"query", "SET~querystats", "GET", "statserver", "", {"_feature","_restriction"}, {
+			{"query", "SET~querystats", "GET", "statsel", "", {"_statfeature","_restriction"}, {
+				{{"/query","version", "y", '#'}}
 			}},
+			{"query", "END~querystats", {}},
 			{"query", "SET~collect", "GET", "collector", "", {"_feature","_termstats","_globalstats"}, {
 				{{"/query","mergeres", "y", '#'}}
 			}},
 			{"query", "CLOSE~collect", {}, {}},
 			{"query", "SET~analysis", "GET", "qryanalyzer", "", {"_collected"}, {
 			}},
-			{"query", "SET~ranklist", "GET", "qryeval", "", {"_feature","_restriction","_termstats","_globalstats"}, {
+			{"query", "SET~ranklist", "GET", "shardsel", "", {"_feature","_restriction","_termstats","_globalstats"}, {
 				{{"/query","mergeres", "y", '#'}}
 			}},
 			{"query", "END~ranklist", {}},
@@ -106,7 +110,10 @@ public:
 		{/*input*/
 			{SchemaQueryDeclPart::declareQuery( "/query")},
 			{SchemaQueryDeclPart::defineQueryAnalyzed( "/query")},
-			{SchemaQueryDeclPart::buildQuery( "/query")}
+			{SchemaQueryDeclPart::buildQuery( "/query")},
+			{SchemaQueryDeclPart::buildStatisticsQuery( "/query")},
+			{SchemaQueryDeclPart::selectStatisticsServers( "/query")},
+			{SchemaQueryDeclPart::selectShards( "/query", "qryeval")}
 		}
 	) {}
 };
@@ -120,9 +127,23 @@ public:
 		{/*result*/},
 		{/*inherit*/},
 		{/*input*/
-			{SchemaQueryDeclPart::declareStatistics("/statistics")},
-			{"/statistics", "termstats", "_termstats", TermStats, '*'},
-			{"/statistics", "globalstats", "_globalstats", GlobalStats, '!'}
+			{SchemaQueryDeclPart::declareCachedStatistics("/statistics")},
+			{SchemaQueryDeclPart::updateStatisticsCache("/statistics")},
+			{SchemaQueryDeclPart::updateShardSelector("/statistics")}
+		}
+	) {}
+};
+
+class Schema_DistQueryEval_END_querystats :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryEval_END_querystats() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::getCachedStatistics( "/query")}
 		}
 	) {}
 };
@@ -187,7 +208,173 @@ public:
 	) {}
 };
 
-}}//namespace
-#endif
+class Schema_Context_POST_DistQueryRank :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_Context_POST_DistQueryRank() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{"/distqryrank/analyzer", "()", DistQueryEvalAnalyzeServer, papuga_TypeString, "example.com:7191/qryanalyzer/test"},
+			{"/distqryrank", "", "qryanalyzer", DistQueryEvalAnalyzeServer, '!'},
+			{"/distqryrank/collector", "()", DistQueryEvalCollectServer, papuga_TypeString, "example.com:7184/qryeval/bm25"},
+			{"/distqryrank", "", "collector", DistQueryEvalCollectServer, '*'},
+			{"/distqryrank/ranker", "()", DistQueryEvalRankServer, papuga_TypeString, "example.com:7184/qryeval/rank"},
+			{"/distqryrank", "", "ranker", DistQueryEvalRankServer, '*'},
+			{"/distqryrank/qryeval", "()", DistQueryEvalStorageServer, papuga_TypeString, "example.com:7184/qryeval/test"},
+			{"/distqryrank", "", "qryeval", DistQueryEvalStorageServer, '*'},
+			{"/distqryrank/statserver", "()", DistQueryEvalStatisticsServer, papuga_TypeString, "example.com:7184/statserver/test"},
+			{"/distqryrank", "", "statserver", DistQueryEvalStatisticsServer, '!'},
+			{SchemaQueryDeclPart::defineStatisticsCache( "/distqryrank")},
+			{SchemaQueryDeclPart::defineShardSelector( "/distqryrank")}
+		}
+	) {}
+};
+
+class Schema_Context_PUT_DistQueryRank :public Schema_Context_POST_DistQueryRank
+{
+public:
+	Schema_Context_PUT_DistQueryRank() :Schema_Context_POST_DistQueryRank(){}
+};
+
+/// \brief Distributed query evaluation in two phases:
+///	The ranker servers (query evaluation without summarizers) return only the ranks of the shards.
+///	The summaries are calculated by the qryeval servers in a second phase only for the documents that survived the merge of the ranks.
+/// \note The ranker and the qryeval server of a shard must have the same shard identifier defined (/qryeval/shard)
+class Schema_DistQueryRank_GET :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_GET() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/
+			{"query", "SET~analysis", "GET", "qryanalyzer", "", {
+				{SchemaQueryDeclPart::resultQueryOrig("/query")}
+			}},
+			{"query", "SET~querystats", "GET", "statsel", "", {"_statfeature","_restriction"}, {
+				{{"/query","version", "y", '#'}}
+			}},
+			{"query", "END~querystats", {}},
+			{"query", "SET~collect", "GET", "collector", "", {"_feature","_termstats","_globalstats"}, {
+				{{"/query","mergeres", "y", '#'}}
+			}},
+			{"query", "CLOSE~collect", {}, {}},
+			{"query", "SET~analysis", "GET", "qryanalyzer", "", {"_collected"}, {
+			}},
+			{"query", "SET~ranklist", "GET", "shardsel", "", {"_feature","_restriction","_termstats","_globalstats"}, {
+				{{"/query","mergeres", "y", '#'}},
+				{{"/query","shard", "y", '#'}}
+			}},
+			{"query", "END~ranklist", {}},
+			{"query", "SET~summary", "GET", "qryeval", "", {"_feature","_restriction","_termstats","_globalstats","_evalshard"}, {
+				{{"/query","mergeres", "y", '#'}}
+			}},
+			{"query", "END~summary", {}},
+			{"queryresult", {"ranklist"}, {}}
+		},
+		{/*inherit*/
+			{"qryanalyzer","/query/include/analyzer()",false/*not required*/},
+			{"vstorage","/query/include/vstorage()",false/*not required*/}
+		},
+		{/*input*/
+			{"/query/server/ranker", "()", DistQueryEvalRankServer, papuga_TypeString, "example.com:7184/qryeval/rank"},
+			{"/query/server", "", "ranker", DistQueryEvalRankServer, '*'},
+			{"/query/server/qryeval", "()", DistQueryEvalStorageServer, papuga_TypeString, "example.com:7184/storage/test"},
+			{"/query/server", "", "qryeval", DistQueryEvalStorageServer, '*'},
+			{"/query/server/statserver", "()", DistQueryEvalStatisticsServer, papuga_TypeString, "example.com:7184/statserver/test"},
+			{"/query/server", "", "statserver", DistQueryEvalStatisticsServer, '!'},
+			{"/query/server/collector", "()", DistQueryEvalCollectServer, papuga_TypeString, "example.com:7184/qryeval/collector"},
+			{"/query/server", "", "collector", DistQueryEvalCollectServer, '!'},
+
+			{SchemaAnalyzerPart::defineQueryAnalyzer( "/query/analyzer")},	//... inherited or declared
+			{"/query/analyzer", '?'},
+
+			{SchemaQueryDeclPart::declareQuery( "/query")},
+			{SchemaQueryDeclPart::defineQueryBuilder( "/query", "config")},
+			{SchemaQueryDeclPart::defineResultMerger( "/query")},
+			{SchemaQueryDeclPart::defineSummaryMerger( "/query")}
+		}
+	) {}
+};
+
+class Schema_DistQueryRank_SET_analysis :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_SET_analysis() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::declareQuery( "/query")},
+			{SchemaQueryDeclPart::defineQueryAnalyzed( "/query")},
+			{SchemaQueryDeclPart::buildQuery( "/query")},
+			{SchemaQueryDeclPart::buildStatisticsQuery( "/query")},
+			{SchemaQueryDeclPart::selectStatisticsServers( "/query")},
+			{SchemaQueryDeclPart::selectShards( "/query", "ranker")}
+		}
+	) {}
+};
+
+class Schema_DistQueryRank_SET_ranklist :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_SET_ranklist() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::declareShardQueryResult( "/queryresult")},
+			{SchemaQueryDeclPart::addShardQueryResult( "/queryresult")},
+		}
+	) {}
+};
+
+class Schema_DistQueryRank_END_ranklist :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_END_ranklist() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::getShardEvaluationSets( "/query")}
+		}
+	) {}
+};
+
+class Schema_DistQueryRank_SET_summary :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_SET_summary() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::declareQueryResult( "/queryresult/ranklist")},
+			{SchemaQueryDeclPart::addSummaryQueryResult( "/queryresult/ranklist")},
+		}
+	) {}
+};
 
+class Schema_DistQueryRank_END_summary :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_DistQueryRank_END_summary() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{SchemaQueryDeclPart::mergeSummaryQueryResults( "/query")}
+		}
+	) {}
+};
 
+}}//namespace
+#endif
@@ -53,7 +53,10 @@ public:
 		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
 		{/*env*/},
 		{/*result*/
-			{"queryresult", { {"/query", "ranklist", "ranklist", '!'} }}
+			{"queryresult", {
+				{"/query", "shard", "shard", '?'},
+				{"/query", "ranklist", "ranklist", '!'}
+			}}
 		},
 		{/*inherit*/
 			{"storage","/qryeval/include/storage()",false/*not required*/},
@@ -73,6 +76,31 @@ public:
 	) {}
 };
 
+class Schema_QueryEval_POST_transaction :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_QueryEval_POST_transaction() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/
+			{"storage","/qryeval/include/storage()",false/*not required*/},
+			{"qryanalyzer","/qryeval/include/analyzer()",false/*not required*/}
+		},
+		{/*input*/
+			{SchemaQueryEvalDeclPart::defineQueryEval( "/query/eval")},	//... inherited or declared
+			{"/query/eval", '?'},
+			{SchemaAnalyzerPart::defineQueryAnalyzer( "/query/analyzer")},	//... inherited or declared
+			{"/query/analyzer", '?'},
+
+			{SchemaQueryDeclPart::declareQuery( "/query")},
+			{SchemaQueryDeclPart::analyzeQuery( "/query")},
+			{SchemaQueryDeclPart::defineQuery( "/query")},
+			{SchemaQueryDeclPart::createQueryResultCursor( "/query")}
+		}
+	) {}
+};
+
 }}//namespace
 #endif
 
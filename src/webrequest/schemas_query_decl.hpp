@@ -96,13 +96,111 @@ public:
 		}};
 	}
 
+	static papuga::RequestAutomaton_NodeList declareCachedStatistics( const char* rootexpr)
+	{
+		return {rootexpr, {
+			{"termstats/type", "()", TermType, papuga_TypeString, "word"},
+			{"termstats/value", "()", TermValue, papuga_TypeString, "country"},
+			{"termstats/df", "()", TermDocumentFrequency, papuga_TypeInt, "312367"},
+			{"globalstats/nofdocs", "()", CollectionNofDocs, papuga_TypeInt, "112739087"},
+			{"globalstats/version", "()", CollectionStatisticsVersion, papuga_TypeInt, "3321"}
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList defineStatisticsCache( const char* rootexpr)
+	{
+		typedef bindings::method::Context C;
+		return {rootexpr, {
+			{"statcache/ttl", "()", StatisticsCacheTimeToLive, papuga_TypeInt, "60"},
+			{"statcache/size", "()", StatisticsCacheSize, papuga_TypeInt, "1000000"},
+			{"statcache", StatisticsCacheConfig, {
+					{"ttl", StatisticsCacheTimeToLive, '?'},
+					{"size", StatisticsCacheSize, '?'}
+				}
+			},
+			{"", "statcache", "context", C::createStatisticsCache(), {{StatisticsCacheConfig, '?'}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList defineShardSelector( const char* rootexpr)
+	{
+		typedef bindings::method::Context C;
+		typedef bindings::method::ShardSelector SS;
+		return {rootexpr, {
+			{"shardselect/select", "()", ShardSelectFeatureSet, papuga_TypeString, "search;selfeat,search"},
+			{"shardselect", ShardSelectorConfig, {
+					{"select", ShardSelectFeatureSet, '?'}
+				}
+			},
+			{"", "shardselector", "context", C::createShardSelector(), {{ShardSelectorConfig, '?'}} },
+			{"shardselect/summary/server", "()", ShardSummaryServer, papuga_TypeString, "example.com:7184/qryeval/test"},
+			{"shardselect/summary/blob", "()", ShardSummaryBlob, papuga_TypeString, "AAAABwAKZ9h..."},
+			{"shardselect/summary", 0, "shardselector", SS::defineShardSummary(), {{ShardSummaryServer},{ShardSummaryBlob}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList selectShards( const char* rootexpr, const char* serversvar)
+	{
+		typedef bindings::method::QueryBuilder QB;
+		return {rootexpr, {
+			{"", "shardsel", "qrybuilder", QB::selectServers(), {{"shardselector"},{serversvar}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList updateStatisticsCache( const char* rootexpr)
+	{
+		typedef bindings::method::StatisticsCache SC;
+		return {rootexpr, {
+			{"termstats", 0, "statcache", SC::defineTermStatistics(), {{TermType},{TermValue},{TermDocumentFrequency}} },
+			{"globalstats", 0, "statcache", SC::defineGlobalStatistics(), {{CollectionNofDocs},{CollectionStatisticsVersion, '?'}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList updateShardSelector( const char* rootexpr)
+	{
+		typedef bindings::method::ShardSelector SS;
+		return {rootexpr, {
+			{"globalstats", 0, "shardselector", SS::defineStatisticsVersion(), {{CollectionStatisticsVersion, '?'}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList getCachedStatistics( const char* rootexpr)
+	{
+		typedef bindings::method::QueryBuilder QB;
+		typedef bindings::method::StatisticsCache SC;
+		return {rootexpr, {
+			{"", "_termstats", "qrybuilder", QB::getTermStatistics(), {{"statcache"}} },
+			{"", "_globalstats", "statcache", SC::getGlobalStatistics(), {} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList buildStatisticsQuery( const char* rootexpr)
+	{
+		typedef bindings::method::QueryBuilder QB;
+		return {rootexpr, {
+			{"", "_statfeature", "qrybuilder", QB::getFeaturesUncached(), {{"statcache"}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList selectStatisticsServers( const char* rootexpr)
+	{
+		typedef bindings::method::QueryBuilder QB;
+		return {rootexpr, {
+			{"", "statsel", "qrybuilder", QB::selectStatisticsServers(), {{"statcache"},{"statserver"}} }
+		}};
+	}
+
 	static papuga::RequestAutomaton_NodeList declareRankingParameter( const char* rootexpr)
 	{
 		return {rootexpr, {
 			{"evalset/docno", "()", Docno, papuga_TypeInt, "21345"},
+			{"evalshard/shard", "()", EvalShardName, papuga_TypeString, "shard01"},
+			{"evalshard/docno", "()", Docno, papuga_TypeInt, "21345"},
 			{"nofranks", "()", NumberOfResults, papuga_TypeInt, "5;10;20"},
 			{"minrank", "()", FirstResult, papuga_TypeInt, "0;10"},
 			{"mergeres", "()", MergeResult, papuga_TypeBool, "false;True;Y;n;1;0"},
+			{"partitions", "()", NofPartitions, papuga_TypeInt, "4;8"},
+			{"shard", "()", ShardIdRequest, papuga_TypeBool, "true;false"},
 			{"access", "()", AccessRight, papuga_TypeString, "customer"},
 		}};
 	}
@@ -194,9 +292,12 @@ public:
 			{"globalstats", 0, "query", Q::defineGlobalStatistics(), {{GlobalStats}} },
 			/// Ranking parameter:
 			{"evalset", 0, "query", Q::addDocumentEvaluationSet(), {{Docno, '*'}} },
+			{"evalshard", 0, "query", Q::addShardEvaluationSet(), {{EvalShardName}, {Docno, '*'}} },
 			{"nofranks", 0, "query", Q::setMaxNofRanks(), {{NumberOfResults}} },
 			{"minrank", 0, "query", Q::setMinRank(), {{FirstResult}} },
 			{"mergeres", 0, "query", Q::useMergeResult(), {{MergeResult}} },
+			{"partitions", 0, "query", Q::setNofPartitions(), {{NofPartitions}} },
+			{"shard", "shard", "query", Q::shardId(), {{ShardIdRequest}} },
 			{"access", 0, "query", Q::addAccess(), {{AccessRight, '*'}} },
 			{"", 0, "query", Q::setWeightingVariables(), {{VariableDef, '*'}} }
 		}};
@@ -227,6 +328,17 @@ public:
 		}};
 	}
 
+	static papuga::RequestAutomaton_NodeList defineSummaryMerger( const char* rootexpr)
+	{
+		typedef bindings::method::QueryResultMerger QM;
+		typedef bindings::method::Context C;
+		return {rootexpr, {
+			{"", "summerger", "context", C::createQueryResultMerger(), {}},
+			/// The summary phase gets only the documents of the result page, so we merge starting from the first rank:
+			{"nofranks", 0, "summerger", QM::setMaxNofRanks(), {{NumberOfResults}} }
+		}};
+	}
+
 	static papuga::RequestAutomaton_NodeList addQueryResult( const char* rootexpr)
 	{
 		typedef bindings::method::QueryResultMerger QM;
@@ -235,6 +347,46 @@ public:
 		}};
 	}
 
+	static papuga::RequestAutomaton_NodeList declareShardQueryResult( const char* rootexpr)
+	{
+		return {rootexpr, {
+			{"shard", "()", QueryResultShard, papuga_TypeString, "shard01"},
+			{declareQueryResult( "ranklist")}
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList addShardQueryResult( const char* rootexpr)
+	{
+		typedef bindings::method::QueryResultMerger QM;
+		return { rootexpr, {
+			{"", 0, "merger", QM::addShardQueryResult(), {{QueryResultShard},{QueryResult}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList addSummaryQueryResult( const char* rootexpr)
+	{
+		typedef bindings::method::QueryResultMerger QM;
+		return { rootexpr, {
+			{"", 0, "summerger", QM::addQueryResult(), {{QueryResult}} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList getShardEvaluationSets( const char* rootexpr)
+	{
+		typedef bindings::method::QueryResultMerger QM;
+		return { rootexpr, {
+			{"", "_evalshard", "merger", QM::getShardEvaluationSets(), {} }
+		}};
+	}
+
+	static papuga::RequestAutomaton_NodeList mergeSummaryQueryResults( const char* rootexpr)
+	{
+		typedef bindings::method::QueryResultMerger QM;
+		return { rootexpr, {
+			{"", "ranklist", "summerger", QM::evaluate(), {} }
+		}};
+	}
+
 	static papuga::RequestAutomaton_NodeList mergeQueryResults( const char* rootexpr)
 	{
 		typedef bindings::method::QueryResultMerger QM;
@@ -251,6 +403,14 @@ public:
 		}};
 	}
 
+	static papuga::RequestAutomaton_NodeList createQueryResultCursor( const char* rootexpr)
+	{
+		typedef bindings::method::Query Q;
+		return { rootexpr, {
+			{"", "transaction", "query", Q::createResultCursor(), {} }
+		}};
+	}
+
 	static papuga::RequestAutomaton_ResultElementDefList resultQuery( const char* rootexpr)
 	{
 		return papuga::RequestAutomaton_ResultElementDefList( rootexpr, {
@@ -259,6 +419,7 @@ public:
 			{"nofranks", "nofranks", NumberOfResults, '!'},
 			{"minrank", "minrank", FirstResult, '!'},
 			{"mergeres", "mergeres", MergeResult, '?'},
+			{"partitions", "partitions", NofPartitions, '?'},
 			{"access", "access", AccessRight, '*'},
 
 			{"include", "feature", true},
@@ -291,6 +452,7 @@ public:
 			{"nofranks", "nofranks", NumberOfResults, '!'},
 			{"minrank", "minrank", FirstResult, '!'},
 			{"mergeres", "mergeres", MergeResult, '?'},
+			{"partitions", "partitions", NofPartitions, '?'},
 			{"access", "access", AccessRight, '*'},
 
 			{"include", "feature", true},
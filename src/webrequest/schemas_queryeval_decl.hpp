@@ -29,6 +29,8 @@ public:
 		return { rootexpr,
 		{
 			{"", "qryeval", "context", C::createQueryEval(), {} },
+			{"shard", "()", QueryEvalShard, papuga_TypeString, "shard01"},
+			{"shard", 0, "qryeval", E::defineShard(), {{QueryEvalShard}} },
 			{"cterm/set", "()", FeatureSet, papuga_TypeString, "weighted"},
 			{"cterm/type", "()", TermType, papuga_TypeString, "word"},
 			{"cterm/name", "()", TermValue, papuga_TypeString, "town"},
@@ -27,7 +27,7 @@ public:
 	{
 		typedef bindings::method::StatisticsMap S;
 		return papuga::RequestAutomaton_NodeList( rootexpr,{
-			{"//term", "_termstats", "statserver", S::df(), {{TermType}, {TermValue}}},
+			{"", "_termstats", "statserver", S::dfList(), {{NodeTerm, '*'}}},
 		});
 	}
 
@@ -35,7 +35,16 @@ public:
 	{
 		typedef bindings::method::StatisticsMap S;
 		return papuga::RequestAutomaton_NodeList( rootexpr,{
-			{"", "_nofdocs", "statserver", S::nofDocuments(), {}}
+			{"", "_nofdocs", "statserver", S::nofDocuments(), {}},
+			{"version", "()", StatisticsVersionRequest, papuga_TypeBool, "true"},
+			{"version", "_version", "statserver", S::version(), {}}
+		});
+	}
+
+	static papuga::RequestAutomaton_ResultElementDefList resultTermStatistics( const char* rootexpr)
+	{
+		return papuga::RequestAutomaton_ResultElementDefList( rootexpr, {
+			{"~", "termstats", "_termstats", '*'}
 		});
 	}
 };
@@ -47,17 +56,33 @@ public:
 		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
 		{/*env*/},
 		{/*result*/
-			{0, "PUT~statistics", "GET", "storage", "statistics/snapshot", {}}
+			{0, "PUT~statchanges", "GET", "storage", "statchanges", {}}
 		},
 		{/*inherit*/},
 		{/*input*/
 			{"/statserver/storage", "()", StatisticsStorageServer, papuga_TypeString, "example.com:7184/storage/test"},
 			{"/statserver", "", "storage", StatisticsStorageServer, '*'},
 			{"/statserver/blocks", "()", StatisticsMapBlocks, papuga_TypeString, "100K"},
+			{"/statserver/shards", "()", StatisticsMapShards, papuga_TypeInt, "64"},
+			{"/statserver/dict", "()", StatisticsMapDict, papuga_TypeString, "compact"},
+			{"/statserver/snapshot", "()", StatisticsMapSnapshot, papuga_TypeString, "statserver.snapshot"},
+			{"/statserver/snapshotperiod", "()", StatisticsMapSnapshotPeriod, papuga_TypeInt, "600"},
+			{"/statserver/epoch", "()", StatisticsMapEpoch, papuga_TypeInt, "10"},
+			{"/statserver/sketchwidth", "()", StatisticsMapSketchWidth, papuga_TypeString, "16M"},
+			{"/statserver/sketchdepth", "()", StatisticsMapSketchDepth, papuga_TypeInt, "4"},
+			{"/statserver/exactdf", "()", StatisticsMapExactDf, papuga_TypeInt, "32"},
 			{"/statserver/proc", "()", StatisticsProc, papuga_TypeString, "std"},
 			{"/statserver", StatisticsMapConfig, {
 					{"proc", StatisticsProc, '?'},
 					{"blocks", StatisticsMapBlocks, '?'},
+					{"shards", StatisticsMapShards, '?'},
+					{"dict", StatisticsMapDict, '?'},
+					{"snapshot", StatisticsMapSnapshot, '?'},
+					{"snapshotperiod", StatisticsMapSnapshotPeriod, '?'},
+					{"epoch", StatisticsMapEpoch, '?'},
+					{"sketchwidth", StatisticsMapSketchWidth, '?'},
+					{"sketchdepth", StatisticsMapSketchDepth, '?'},
+					{"exactdf", StatisticsMapExactDf, '?'},
 				}
 			},
 			{"/", "statserver", "context", bindings::method::Context::createStatisticsMap(), {{StatisticsMapConfig}} }
@@ -80,6 +105,71 @@ public:
 	) {}
 };
 
+class Schema_StatisticsServer_POST_sync :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_StatisticsServer_POST_sync() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/
+			{0, "PUT~statchanges", "GET", "storage", "statchanges", {"_watermark"}}
+		},
+		{/*inherit*/},
+		{/*input*/
+			{"/", "_watermark", "statserver", bindings::method::StatisticsMap::watermarks(), {} }
+		}
+	) {}
+};
+
+class Schema_StatisticsServer_PUT_statchanges :public papuga::RequestAutomaton, public AutomatonNameSpace
+{
+public:
+	Schema_StatisticsServer_PUT_statchanges() :papuga::RequestAutomaton(
+		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
+		{/*env*/},
+		{/*result*/},
+		{/*inherit*/},
+		{/*input*/
+			{"/statchanges/changes/source", "()", StatisticsSource, papuga_TypeString, "node1/test"},
+			{"/statchanges/changes/watermark/unixtime", "()", StatisticsTimeStampUnixTime, papuga_TypeInt, "1577836800"},
+			{"/statchanges/changes/watermark/counter", "()", StatisticsTimeStampCounter, papuga_TypeInt, "12"},
+			{"/statchanges/changes/watermark", StatisticsWatermarkTimeStamp, {
+					{"unixtime", StatisticsTimeStampUnixTime, '!'},
+					{"counter", StatisticsTimeStampCounter, '?'}
+				}
+			},
+			{"/statchanges/changes/message/timestamp/unixtime", "()", StatisticsTimeStampUnixTime, papuga_TypeInt, "1577836800"},
+			{"/statchanges/changes/message/timestamp/counter", "()", StatisticsTimeStampCounter, papuga_TypeInt, "13"},
+			{"/statchanges/changes/message/timestamp", StatisticsTimeStamp, {
+					{"unixtime", StatisticsTimeStampUnixTime, '!'},
+					{"counter", StatisticsTimeStampCounter, '?'}
+				}
+			},
+			{"/statchanges/changes/message/blob", "()", StatisticsBlob, papuga_TypeString, "AAAABwAKZ9h..."},
+			{"/statchanges/changes/message", StatisticsChangeMessage, {
+					{"timestamp", StatisticsTimeStamp, '!'},
+					{"blob", StatisticsBlob, '!'}
+				}
+			},
+			{"/statchanges/changes/snapshot/timestamp/unixtime", "()", StatisticsTimeStampUnixTime, papuga_TypeInt, "1577836800"},
+			{"/statchanges/changes/snapshot/timestamp/counter", "()", StatisticsTimeStampCounter, papuga_TypeInt, "12"},
+			{"/statchanges/changes/snapshot/timestamp", StatisticsTimeStamp, {
+					{"unixtime", StatisticsTimeStampUnixTime, '!'},
+					{"counter", StatisticsTimeStampCounter, '?'}
+				}
+			},
+			{"/statchanges/changes/snapshot/blob", "()", StatisticsBlob, papuga_TypeString, "AAAABwAKZ9h..."},
+			{"/statchanges/changes/snapshot", StatisticsSnapshotMessage, {
+					{"timestamp", StatisticsTimeStamp, '!'},
+					{"blob", StatisticsBlob, '!'}
+				}
+			},
+			{"/statchanges/changes", 0/*result*/, "statserver", bindings::method::StatisticsMap::processStatisticsChanges(),
+					{{StatisticsSource},{StatisticsChangeMessage, '*'},{StatisticsWatermarkTimeStamp, '?'},{StatisticsSnapshotMessage, '*'}} }
+		}
+	) {}
+};
+
 class Schema_StatisticsServer_GET :public papuga::RequestAutomaton, public AutomatonNameSpace
 {
 public:
@@ -88,17 +178,16 @@ public:
 		{/*env*/},
 		{/*result*/
 		{"statistics", {
-			{"/query/feature/analyzed//term", "termstats", true},
-			{"/query/feature/analyzed//term/type", "type", TermType},
-			{"/query/feature/analyzed//term/value", "value", TermValue},
-			{"/query/feature/analyzed//term", "df", "_termstats", '!'},
+			{SchemaStatisticsPart::resultTermStatistics( "/query")},
 			{"/query~", "globalstats", false},
-			{"/query~", "nofdocs", "_nofdocs", '!'}
+			{"/query~", "nofdocs", "_nofdocs", '!'},
+			{"/query~", "version", "_version", '?'}
 		}}},
 		{/*inherit*/},
 		{/*input*/
 			{SchemaExpressionPart::declareTermExpression( "/query/feature/analyzed", AnalyzedTermExpression)},
-			{SchemaStatisticsPart::evaluateTermStatistics( "/query/feature/analyzed")},
+			{SchemaExpressionPart::declareTermExpression( "/query/statfeature/analyzed", AnalyzedTermExpression)},
+			{SchemaStatisticsPart::evaluateTermStatistics( "/query")},
 			{SchemaStatisticsPart::evaluateGlobalStatistics( "/query")}
 		}
 	) {}
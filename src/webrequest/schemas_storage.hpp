@@ -106,10 +106,12 @@ class Schema_Storage_GET :public papuga::RequestAutomaton, public AutomatonNameS
 public:
 	Schema_Storage_GET() :papuga::RequestAutomaton(
 		strus_getBindingsClassDefs(), getBindingsInterfaceDescription()->structs, itemName, true/*strict*/, false/*exclusive*/,
-		{/*env*/},
+		{/*env*/{"source", EnvFormat, "{id}/{name}"}},
 		{/*result*/
 			{"queryresult", { {"/query", "ranklist", "ranklist", '!'} }},
-			{"statistics", { {"/statistics", "_blob", "statistics", '!'} }}
+			{"statistics", { {"/statistics", "_blob", "statistics", '!'} }},
+			{"statchanges", { {"/statchanges", "changes", "_statchanges", '!'} }},
+			{"termsummary", { {"/termsummary", "blob", "_termsummary", '!'} }}
 		},
 		{/*inherit*/
 			{"qryeval","/storage/include/qryeval()",false/*not required*/},
@@ -124,7 +126,9 @@ public:
 			{SchemaQueryDeclPart::defineQuery( "/query")},
 			{SchemaQueryDeclPart::evaluateQuery( "/query")},
 
-			{SchemaStoragePart::defineStatisticsQuery( "/statistics")}
+			{SchemaStoragePart::defineStatisticsQuery( "/statistics")},
+			{SchemaStoragePart::defineStatisticsChangesQuery( "/statchanges")},
+			{SchemaStoragePart::defineTermSummaryQuery( "/termsummary")}
 		}
 	) {}
 };
@@ -77,6 +77,44 @@ public:
 		});
 	}
 
+	static papuga::RequestAutomaton_NodeList defineStatisticsChangesQuery( const char* rootexpr)
+	{
+		typedef bindings::method::StorageClient S;
+		return papuga::RequestAutomaton_NodeList( rootexpr,
+		{
+			{"watermark/source", "()", StatisticsSource, papuga_TypeString, "node1/test"},
+			{"watermark/timestamp/unixtime", "()", StatisticsTimeStampUnixTime, papuga_TypeInt, "1577836800"},
+			{"watermark/timestamp/counter", "()", StatisticsTimeStampCounter, papuga_TypeInt, "12"},
+			{"watermark/timestamp", StatisticsTimeStamp, {
+					{"unixtime", StatisticsTimeStampUnixTime, '!'},
+					{"counter", StatisticsTimeStampCounter, '?'}
+				}
+			},
+			{"watermark", StatisticsWatermark, {
+					{"source", StatisticsSource, '!'},
+					{"timestamp", StatisticsTimeStamp, '!'}
+				}
+			},
+			{"", "_statchanges", "storage", S::getStatisticsChanges(), {{"source"},{StatisticsWatermark, '*'}}}
+		});
+	}
+
+	static papuga::RequestAutomaton_NodeList defineTermSummaryQuery( const char* rootexpr)
+	{
+		typedef bindings::method::StorageClient S;
+		return papuga::RequestAutomaton_NodeList( rootexpr,
+		{
+			{"bits", "()", TermSummaryBits, papuga_TypeInt, "1048576"},
+			{"hashes", "()", TermSummaryHashes, papuga_TypeInt, "4"},
+			{"", TermSummaryConfig, {
+					{"bits", TermSummaryBits, '?'},
+					{"hashes", TermSummaryHashes, '?'}
+				}
+			},
+			{"", "_termsummary", "storage", S::termSummary(), {{TermSummaryConfig, '?'}}}
+		});
+	}
+
 	static papuga::RequestAutomaton_NodeList defineMetaDataTableCommand( const char* rootexpr)
 	{
 		return papuga::RequestAutomaton_NodeList( rootexpr,
@@ -362,10 +362,28 @@ bool WebRequestContext::executeObjectRequest( const WebRequestContent& content)
 	{
 		if (m_obj->valuetype == papuga_TypeHostObject)
 		{
-			if (m_methodId == Method_POST && isEqual( m_path.rest(),"transaction"))
+			if (m_methodId == Method_POST && m_transactionRef.get() && isEqual( m_path.rest(),"commit"))
 			{
-				// [3.A] Call POST transaction (a method), e.g. create a new transaction
-				return executePostTransaction();
+				if (content.empty())
+				{
+					// [3.A.0] POST commit of a transaction without content, asynchronous commit polled with GET:
+					return executeCommitTransactionAsync();
+				}
+				setAnswer( ErrorCodeInvalidRequest);
+				return false;
+			}
+			else if (m_methodId == Method_POST && isEqual( m_path.rest(),"transaction"))
+			{
+				if (content.empty())
+				{
+					// [3.A.1] Call POST transaction (a method), e.g. create a new transaction
+					return executePostTransaction();
+				}
+				else
+				{
+					// [3.A.2] Execute POST transaction schema with content, e.g. create a query result cursor
+					return executePostTransactionSchema( content);
+				}
 			}
 			else
 			{
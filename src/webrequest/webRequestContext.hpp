@@ -167,8 +167,12 @@ private:
 		bool initResultContentType();
 	/// \brief Execute a request creating a transaction (POST)
 	bool executePostTransaction();
+	/// \brief Execute a request creating a transaction (POST) with a schema defining the transaction object from the content, e.g. a query result cursor
+	bool executePostTransactionSchema( const WebRequestContent& content);
 	/// \brief Execute a request doing the commit (PUT) of a transaction
 	bool executeCommitTransaction();
+	/// \brief Execute a request starting an asynchronous commit (POST without content on the path "commit" of a transaction), answered with a link to the transaction for polling its state
+	bool executeCommitTransactionAsync();
 
 	// Implemented in webRequestContext_method:
 	/// \brief Call a method and put the result to the answer of the request
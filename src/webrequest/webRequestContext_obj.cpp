@@ -367,6 +367,69 @@ bool WebRequestContext::executePostTransaction()
 	return setAnswerLink( "transaction", tid, 3/*link level*/);
 }
 
+bool WebRequestContext::executePostTransactionSchema( const WebRequestContent& content)
+{
+	if (0!=(m_logMask & WebRequestLoggerInterface::LogRequests))
+	{
+		m_logger->logRequestType( "transaction", "post schema", m_contextType, m_contextName);
+	}
+	if (!initContentSchemaAutomaton( SchemaId( m_contextType, "POST/transaction"))) return false;
+	if (!executeContentSchemaAutomaton( content)) return false;
+	if (!papuga_RequestContext_get_variable( m_context.get(), "transaction"))
+	{
+		setAnswer( ErrorCodeRequestResolveError, _TXT("transaction object not defined by schema"));
+		return false;
+	}
+	std::string transaction_typenam = strus::string_format( "transaction/%s", m_contextType);
+	std::string tid = m_transactionPool->createTransaction( transaction_typenam, m_context, m_handler->maxIdleTime());
+	if (tid.empty())
+	{
+		setAnswer( ErrorCodeOutOfMem);
+		return false;
+	}
+	m_answer.setHttpStatus( 201/*created*/);
+	return setAnswerLink( "transaction", tid, 3/*link level*/);
+}
+
+bool WebRequestContext::executeCommitTransactionAsync()
+{
+	if (0!=(m_logMask & WebRequestLoggerInterface::LogRequests))
+	{
+		m_logger->logRequestType( "transaction", "commit async", m_contextType, m_contextName);
+	}
+	if (m_obj && m_obj->valuetype == papuga_TypeHostObject)
+	{
+		int classid = m_obj->value.hostObject->classid;
+		void* self = m_obj->value.hostObject->data;
+
+		const papuga_RequestMethodDescription* methoddescr
+			= papuga_RequestHandler_get_method(
+				m_handler->impl(), classid, "POST/transaction/commit"/*method*/, false/*has content*/);
+		if (methoddescr)
+		{
+			WebRequestContent content;
+			if (!callHostObjMethodToAnswer( self, methoddescr, ""/*path*/, content))
+			{
+				m_transactionRef.reset();
+				return false;
+			}
+			//... the transaction is returned to the pool, the state of the commit is polled with GET on the link returned
+			m_answer.setHttpStatus( 202/*accepted*/);
+			return setAnswerLink( "transaction", m_contextName, 3/*link level*/);
+		}
+		else
+		{
+			setAnswer( ErrorCodeRequestResolveError);
+			return false;
+		}
+	}
+	else
+	{
+		setAnswer( ErrorCodeRequestResolveError);
+		return false;
+	}
+}
+
 bool WebRequestContext::executeCommitTransaction()
 {
 	if (0!=(m_logMask & WebRequestLoggerInterface::LogRequests))
@@ -118,6 +118,12 @@ struct CommitTransactionMethodDescription
 	CommitTransactionMethodDescription( const papuga_RequestMethodId& id)
 		:MethodDescription( "PUT/transaction", id, 204/*no content*/, NULL, "commit", 0/*no list*/, false/*has content*/, 0){}
 };
+struct CommitAsyncTransactionMethodDescription
+	:public MethodDescription
+{
+	CommitAsyncTransactionMethodDescription( const papuga_RequestMethodId& id)
+		:MethodDescription( "POST/transaction/commit", id, 202/*accepted*/, NULL, "commit", 0/*no list*/, false/*has content*/, 0){}
+};
 struct PostTransactionMethodDescription
 	:public MethodDescription
 {
@@ -166,7 +172,7 @@ public:
 	DefineUpdateConfigSchema( const char* contextType) :DefineSchema<SCHEMA>( contextType){}
 };
 
-static const char* g_context_typenames[] = {"contentstats","statserver","storage","vstorage","docanalyzer","qryanalyzer","qryeval","distqryeval","inserter",0};
+static const char* g_context_typenames[] = {"contentstats","statserver","storage","vstorage","docanalyzer","qryanalyzer","qryeval","distqryeval","distqryrank","inserter",0};
 
 static void tickerFunction( void* THIS)
 {
@@ -248,6 +254,10 @@ WebRequestHandler::WebRequestHandler(
 		schema_Context_PUT_StatisticsServer.addToHandler( m_impl, "POST/statserver");
 		static const DefineSchema<Schema_StatisticsServer_PUT_statistics> schema_StatisticsServer_PUT_statistics_statistics("statserver");
 		schema_StatisticsServer_PUT_statistics_statistics.addToHandler( m_impl, "PUT~statistics");
+		static const DefineSchema<Schema_StatisticsServer_PUT_statchanges> schema_StatisticsServer_PUT_statchanges("statserver");
+		schema_StatisticsServer_PUT_statchanges.addToHandler( m_impl, "PUT~statchanges");
+		static const DefineSchema<Schema_StatisticsServer_POST_sync> schema_StatisticsServer_POST_sync("statserver");
+		schema_StatisticsServer_POST_sync.addToHandler( m_impl, "POST");
 
 		static const DefineConfigSchema<Schema_Context_PUT_Inserter> schema_Context_PUT_Inserter;
 		schema_Context_PUT_Inserter.addToHandler( m_impl, "PUT/inserter");
@@ -268,6 +278,8 @@ WebRequestHandler::WebRequestHandler(
 		schema_DistQueryEval_SET_analysis.addToHandler( m_impl, "SET~analysis");
 		static const DefineSchema<Schema_DistQueryEval_SET_querystats> schema_DistQueryEval_SET_querystats("distqryeval");
 		schema_DistQueryEval_SET_querystats.addToHandler( m_impl, "SET~querystats");
+		static const DefineSchema<Schema_DistQueryEval_END_querystats> schema_DistQueryEval_END_querystats("distqryeval");
+		schema_DistQueryEval_END_querystats.addToHandler( m_impl, "END~querystats");
 		static const DefineSchema<Schema_DistQueryEval_SET_collect> schema_DistQueryEval_SET_collect("distqryeval");
 		schema_DistQueryEval_SET_collect.addToHandler( m_impl, "SET~collect");
 		static const DefineSchema<Schema_DistQueryEval_CLOSE_collect> schema_DistQueryEval_CLOSE_collect("distqryeval");
@@ -277,6 +289,32 @@ WebRequestHandler::WebRequestHandler(
 		static const DefineSchema<Schema_DistQueryEval_END_ranklist> schema_DistQueryEval_END_ranklist("distqryeval");
 		schema_DistQueryEval_END_ranklist.addToHandler( m_impl, "END~ranklist");
 
+		static const DefineConfigSchema<Schema_Context_POST_DistQueryRank> schema_Context_POST_DistQueryRank;
+		schema_Context_POST_DistQueryRank.addToHandler( m_impl, "POST/distqryrank");
+		static const DefineConfigSchema<Schema_Context_PUT_DistQueryRank> schema_Context_PUT_DistQueryRank;
+		schema_Context_PUT_DistQueryRank.addToHandler( m_impl, "PUT/distqryrank");
+
+		static const DefineSchema<Schema_DistQueryRank_GET> schema_DistQueryRank_GET("distqryrank");
+		schema_DistQueryRank_GET.addToHandler( m_impl, "GET");
+		static const DefineSchema<Schema_DistQueryRank_SET_analysis> schema_DistQueryRank_SET_analysis("distqryrank");
+		schema_DistQueryRank_SET_analysis.addToHandler( m_impl, "SET~analysis");
+		static const DefineSchema<Schema_DistQueryEval_SET_querystats> schema_DistQueryRank_SET_querystats("distqryrank");
+		schema_DistQueryRank_SET_querystats.addToHandler( m_impl, "SET~querystats");
+		static const DefineSchema<Schema_DistQueryEval_END_querystats> schema_DistQueryRank_END_querystats("distqryrank");
+		schema_DistQueryRank_END_querystats.addToHandler( m_impl, "END~querystats");
+		static const DefineSchema<Schema_DistQueryEval_SET_collect> schema_DistQueryRank_SET_collect("distqryrank");
+		schema_DistQueryRank_SET_collect.addToHandler( m_impl, "SET~collect");
+		static const DefineSchema<Schema_DistQueryEval_CLOSE_collect> schema_DistQueryRank_CLOSE_collect("distqryrank");
+		schema_DistQueryRank_CLOSE_collect.addToHandler( m_impl, "CLOSE~collect");
+		static const DefineSchema<Schema_DistQueryRank_SET_ranklist> schema_DistQueryRank_SET_ranklist("distqryrank");
+		schema_DistQueryRank_SET_ranklist.addToHandler( m_impl, "SET~ranklist");
+		static const DefineSchema<Schema_DistQueryRank_END_ranklist> schema_DistQueryRank_END_ranklist("distqryrank");
+		schema_DistQueryRank_END_ranklist.addToHandler( m_impl, "END~ranklist");
+		static const DefineSchema<Schema_DistQueryRank_SET_summary> schema_DistQueryRank_SET_summary("distqryrank");
+		schema_DistQueryRank_SET_summary.addToHandler( m_impl, "SET~summary");
+		static const DefineSchema<Schema_DistQueryRank_END_summary> schema_DistQueryRank_END_summary("distqryrank");
+		schema_DistQueryRank_END_summary.addToHandler( m_impl, "END~summary");
+
 		static const DefineSchema<Schema_Storage_GET> schema_Storage_GET("storage");
 		schema_Storage_GET.addToHandler( m_impl, "GET");
 		static const DefineSchema<Schema_StatisticsServer_GET> schema_StatisticsServer_GET("statserver");
@@ -285,6 +323,8 @@ WebRequestHandler::WebRequestHandler(
 		schema_QueryAnalyzer_GET.addToHandler( m_impl, "GET");
 		static const DefineSchema<Schema_QueryEval_GET> schema_QueryEval_GET("qryeval");
 		schema_QueryEval_GET.addToHandler( m_impl, "GET");
+		static const DefineSchema<Schema_QueryEval_POST_transaction> schema_QueryEval_POST_transaction("qryeval");
+		schema_QueryEval_POST_transaction.addToHandler( m_impl, "POST/transaction");
 
 		// [2] Add methods
 		static const IntrospectionMethodDescription mt_Context_GET( mt::Context::introspection(), "config");
@@ -302,6 +342,9 @@ WebRequestHandler::WebRequestHandler(
 		static const IntrospectionMethodDescription mt_QueryEval_GET( mt::QueryEval::introspection(), "qryeval");
 		mt_QueryEval_GET.addToHandler( m_impl);
 
+		static const DumpMethodDescription mt_QueryResultCursor_GET( mt::QueryResultCursor::nextPage(), "ranklist");
+		mt_QueryResultCursor_GET.addToHandler( m_impl);
+
 		static const IntrospectionMethodDescription mt_StatisticsServer_GET( mt::StatisticsMap::introspection(), "statserver");
 		mt_StatisticsServer_GET.addToHandler( m_impl);
 
@@ -311,6 +354,10 @@ WebRequestHandler::WebRequestHandler(
 		mt_StorageClient_POST_transaction.addToHandler( m_impl);
 		static const CommitTransactionMethodDescription mt_StorageTransaction_COMMIT( mt::StorageTransaction::commit());
 		mt_StorageTransaction_COMMIT.addToHandler( m_impl);
+		static const CommitAsyncTransactionMethodDescription mt_StorageTransaction_COMMIT_async( mt::StorageTransaction::commitAsync());
+		mt_StorageTransaction_COMMIT_async.addToHandler( m_impl);
+		static const DumpMethodDescription mt_StorageTransaction_GET( mt::StorageTransaction::commitState(), "commit");
+		mt_StorageTransaction_GET.addToHandler( m_impl);
 
 		static const IntrospectionMethodDescription mt_VectorStorageClient_GET( mt::VectorStorageClient::introspection(), "vstorage");
 		mt_VectorStorageClient_GET.addToHandler( m_impl);
@@ -0,0 +1,106 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc10.xml"}
+
+local ctx = strus_Context.new( {workerthreads=4})
+local analyzer = createDocumentAnalyzer_mdprim( ctx)
+createCollection( ctx, storagedir, metadata_mdprim(), analyzer, true, datadir, docfiles, nil, false)
+
+-- The group commit window of 300 milliseconds keeps an asynchronous commit running long enough to observe it:
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M;statsproc=std;groupcommit=300", storagedir))
+
+local docs = {}
+for doc in analyzer:analyzeMultiPart( readFile( datadir .. '/' .. docfiles[1])) do
+	table.insert( docs, doc)
+end
+
+-- Poll the state of a commit until it is not running anymore, return the final state and the number of polls with state running:
+function pollCommit( transaction)
+	local polls = 0
+	local state = transaction:commitState()
+	while state.state == "running" do
+		polls = polls + 1
+		state = transaction:commitState()
+	end
+	return state, polls
+end
+
+-- Classify the error of a call:
+function callResult( func, expectedError)
+	local ok,err = pcall( func)
+	if ok then
+		return "ok"
+	elseif string.find( tostring(err), expectedError, 1, true) then
+		return "rejected"
+	else
+		return "unexpected error: " .. tostring(err)
+	end
+end
+
+local output = {}
+
+-- [1] Commit succeeding, other calls are rejected while it is running:
+local transaction = storage:createTransaction()
+local doc = docs[ 1]
+doc.attribute.docid = "X1"
+transaction:insertDocument( "X1", doc)
+output[ "1 state before"] = transaction:commitState().state
+transaction:commitAsync()
+output[ "1 state started"] = transaction:commitState().state
+output[ "1 insert while running"] = callResult( function() transaction:insertDocument( "X2", docs[ 2]) end, "asynchronous commit is running")
+output[ "1 commit while running"] = callResult( function() transaction:commitAsync() end, "asynchronous commit")
+local state,polls = pollCommit( transaction)
+output[ "1 state finished"] = state.state
+output[ "1 polled"] = tostring( polls > 0)
+output[ "1 wait"] = callResult( function() transaction:waitCommit() end, "")
+output[ "1 state after wait"] = transaction:commitState().state
+output[ "1 inserted"] = tostring( storage:documentNumber( "X1") > 0)
+
+-- [2] Commit failing, the error is reported by the state and thrown by the wait:
+transaction = storage:createTransaction()
+doc = docs[ 2]
+doc.attribute.docid = "X2"
+transaction:updateDocument( "X2", doc, {})
+transaction:commitAsync()
+state = pollCommit( transaction)
+output[ "2 state finished"] = state.state
+output[ "2 error"] = tostring( string.find( state.error or "", "undefined id", 1, true) ~= nil)
+output[ "2 wait"] = callResult( function() transaction:waitCommit() end, "undefined id")
+output[ "2 state after wait"] = transaction:commitState().state
+output[ "2 inserted"] = tostring( storage:documentNumber( "X2") > 0)
+
+-- [3] Waiting without any commit started returns immediately:
+transaction = storage:createTransaction()
+output[ "3 wait"] = callResult( function() transaction:waitCommit() end, "")
+output[ "3 state"] = transaction:commitState().state
+output[ "nofdocs"] = storage:nofDocumentsInserted()
+storage:close()
+
+local result = "asynchronous commit:" .. dumpTree( output) .. "\n"
+local expected = [[
+asynchronous commit:
+string 1 commit while running: "rejected"
+string 1 insert while running: "rejected"
+string 1 inserted: "true"
+string 1 polled: "true"
+string 1 state after wait: "idle"
+string 1 state before: "idle"
+string 1 state finished: "done"
+string 1 state started: "running"
+string 1 wait: "ok"
+string 2 error: "true"
+string 2 inserted: "false"
+string 2 state after wait: "idle"
+string 2 state finished: "failed"
+string 2 wait: "rejected"
+string 3 state: "idle"
+string 3 wait: "ok"
+string nofdocs: 11
+]]
+verifyTestOutput( outputdir, result, expected)
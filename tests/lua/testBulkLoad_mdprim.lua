@@ -0,0 +1,117 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local docfiles = {"doc1000.xml"}
+
+local ctx = strus_Context.new( {workerthreads=4})
+local analyzer = createDocumentAnalyzer_mdprim( ctx)
+
+-- The collection inserted sequentially as reference:
+local referencedir = outputdir .. "/storage"
+createCollection( ctx, referencedir, metadata_mdprim(), analyzer, true, datadir, docfiles, nil, false)
+local reference = ctx:createStorageClient( string.format( "path='%s';cache=512M", referencedir))
+
+function createStorage( context, name)
+	local config = {path=outputdir .. "/" .. name, cache='512M', statsproc='std'}
+	if context:storageExists( config) then
+		context:destroyStorage( config)
+	end
+	context:createStorage( config)
+	local storage = context:createStorageClient( config)
+	local transaction = storage:createTransaction()
+	transaction:defineMetaDataTable( metadata_mdprim())
+	transaction:commit()
+	return storage
+end
+
+-- Compare the content of a storage loaded with the reference, the document numbers may differ:
+function compare( storage)
+	local differences = 0
+	if storage:nofDocumentsInserted() ~= reference:nofDocumentsInserted() then
+		differences = differences + 1
+	end
+	for value=1,1000 do
+		if storage:documentFrequency( "word", tostring( value)) ~= reference:documentFrequency( "word", tostring( value)) then
+			differences = differences + 1
+		end
+	end
+	local what = {"docid", "cross", "factors", "lo", "hi", "doclen", "docidx"}
+	local rows = {}
+	for row in reference:select( what, nil, nil, 0) do
+		rows[ row.docid] = row
+	end
+	for row in storage:select( what, nil, nil, 0) do
+		local refrow = rows[ row.docid]
+		for _,name in ipairs( what) do
+			if not refrow or refrow[ name] ~= row[ name] then
+				differences = differences + 1
+			end
+		end
+	end
+	return differences
+end
+
+-- Properties of the result of a load that do not depend on the timing:
+function loadResult( result, storage)
+	return {
+		files = result.files,
+		documents = result.documents,
+		commits = result.commits,
+		threads = result.analyzer.threads,
+		differences = compare( storage)
+	}
+end
+
+local output = {}
+
+-- [1] Load of a file with multipart documents:
+local storage = createStorage( ctx, "bulkload_file")
+local inserter = ctx:createInserter( storage, analyzer)
+output[ "1 file"] = loadResult( inserter:load( datadir .. "/doc1000.xml", "threads=2; queue=16; commit=100"), storage)
+storage:close()
+
+-- [2] Load of a directory with documents contained in more than one file, inserted with a transaction per document, so that the last one inserted replaces the ones before:
+storage = createStorage( ctx, "bulkload_dir")
+inserter = ctx:createInserter( storage, analyzer)
+output[ "2 directory"] = loadResult( inserter:load( {datadir}, {threads=3, commit=1, ext=".xml"}), storage)
+storage:close()
+
+-- [3] A load without worker threads available for the analyzer threads fails:
+local singlectx = strus_Context.new()
+storage = createStorage( singlectx, "bulkload_nothreads")
+inserter = singlectx:createInserter( storage, createDocumentAnalyzer_mdprim( singlectx))
+local ok,err = pcall( function() inserter:load( datadir .. "/doc10.xml") end)
+if ok then
+	output[ "3 no threads"] = "loaded"
+elseif string.find( tostring(err), "no worker threads available", 1, true) then
+	output[ "3 no threads"] = "rejected"
+else
+	output[ "3 no threads"] = "unexpected error: " .. tostring(err)
+end
+output[ "3 nofdocs"] = storage:nofDocumentsInserted()
+storage:close()
+reference:close()
+
+local result = "bulk load:" .. dumpTree( output) .. "\n"
+local expected = [[
+bulk load:
+string 1 file:
+  string commits: 10
+  string differences: 0
+  string documents: 1000
+  string files: 1
+  string threads: 2
+string 2 directory:
+  string commits: 1110
+  string differences: 0
+  string documents: 1110
+  string files: 3
+  string threads: 3
+string 3 no threads: "rejected"
+string 3 nofdocs: 0
+]]
+verifyTestOutput( outputdir, result, expected)
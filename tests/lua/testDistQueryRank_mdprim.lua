@@ -0,0 +1,174 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local docfiles = {"doc1000.xml"}
+local nofranks = 10
+
+local ctx = strus_Context.new()
+local analyzer = createDocumentAnalyzer_mdprim( ctx)
+local content = readFile( datadir .. '/' .. docfiles[1])
+
+-- The whole collection as reference:
+local storagedir = outputdir .. "/storage"
+createCollection( ctx, storagedir, metadata_mdprim(), analyzer, true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Two shards with the documents with odd and even document identifiers:
+function createShard( name, select)
+	local config = {path=outputdir .. "/" .. name, cache='512M', statsproc='std'}
+	if ctx:storageExists( config) then
+		ctx:destroyStorage( config)
+	end
+	ctx:createStorage( config)
+	local shard = ctx:createStorageClient( config)
+	local transaction = shard:createTransaction()
+	transaction:defineMetaDataTable( metadata_mdprim())
+	for doc in analyzer:analyzeMultiPart( content) do
+		if select( tonumber( doc.attribute.docid)) then
+			transaction:insertDocument( doc.attribute.docid, doc)
+		end
+	end
+	transaction:commit()
+	return shard
+end
+local shards = {
+	odd = createShard( "shard_odd", function( id) return id % 2 == 1 end),
+	even = createShard( "shard_even", function( id) return id % 2 == 0 end)
+}
+local shardnames = {"even","odd"}
+
+-- Query evaluation of the first phase, ranks without summaries:
+function createRankerEval( shardname)
+	local queryEval = ctx:createQueryEval()
+	queryEval:addSelectionFeature( "select")
+	queryEval:addWeightingFunction( "frequency", {}, {match="seek"})
+	queryEval:addWeightingFunction( "metadata", {name="doclen"})
+	queryEval:addWeightingFunction( "metadata", {name="docidx"})
+	queryEval:defineWeightingFormula( "(_0 / _1) + ((1000 - _2) / 1000000)" )
+	queryEval:defineShard( shardname)
+	return queryEval
+end
+
+-- Query evaluation of the second phase, summaries of the documents surviving the merge of the ranks:
+function createSummaryEval( shardname)
+	local queryEval = createQueryEval_mdprim( ctx)
+	queryEval:defineShard( shardname)
+	return queryEval
+end
+
+function defineQuery( query, maxNofRanks)
+	query:addFeature( "seek", {"word","2"})
+	query:addFeature( "select", {"contains", 0, 1, {"word","2"}, {"word","3"}})
+	query:setMaxNofRanks( maxNofRanks)
+	query:setMinRank( 0)
+end
+
+-- Map the ranks of a result to a list of document identifiers with weights, the document numbers differ between the shards and the collection:
+function rankList( result)
+	local rt = {}
+	for _,rank in ipairs( result.ranks) do
+		local docid = "?"
+		for _,si in ipairs( rank.summary) do
+			if si.name == "docid" then
+				docid = si.value
+			end
+		end
+		table.insert( rt, string.format( "%s %.6f", docid, rank.weight))
+	end
+	return rt
+end
+
+-- Evaluate the summaries of a list of shard evaluation sets, return the merged result:
+function evaluateSummaries( evalsets, maxNofRanks)
+	local summerger = ctx:createQueryResultMerger()
+	summerger:setMaxNofRanks( maxNofRanks)
+	summerger:setMinRank( 0)
+	local nofEvaluated = 0
+	for _,shardname in ipairs( shardnames) do
+		local query = createSummaryEval( shardname):createQuery( shards[ shardname])
+		defineQuery( query, maxNofRanks)
+		query:useMergeResult( true)
+		for _,evalset in ipairs( evalsets) do
+			query:addShardEvaluationSet( evalset.shard, evalset.docno or {})
+		end
+		local result = query:evaluate()
+		nofEvaluated = nofEvaluated + #result.ranks
+		summerger:addQueryResult( result)
+	end
+	return summerger:evaluate(), nofEvaluated
+end
+
+-- Two phase evaluation of the query:
+function evaluateDistributed( maxNofRanks)
+	local merger = ctx:createQueryResultMerger()
+	merger:setMaxNofRanks( maxNofRanks)
+	merger:setMinRank( 0)
+	for _,shardname in ipairs( shardnames) do
+		local query = createRankerEval( shardname):createQuery( shards[ shardname])
+		defineQuery( query, maxNofRanks)
+		query:useMergeResult( true)
+		merger:addShardQueryResult( shardname, query:evaluate())
+	end
+	local evalsets = merger:getShardEvaluationSets()
+	local result,nofEvaluated = evaluateSummaries( evalsets, maxNofRanks)
+	return result, evalsets, nofEvaluated
+end
+
+local output = {}
+
+-- The ranks of the two phase evaluation must be the ones of the evaluation on the whole collection:
+local reference = createQueryEval_mdprim( ctx):createQuery( storage)
+defineQuery( reference, nofranks)
+local referenceRanks = rankList( reference:evaluate())
+local distributedResult,_,nofEvaluated = evaluateDistributed( nofranks)
+local distributedRanks = rankList( distributedResult)
+local differences = 0
+for ri=1,math.max( #referenceRanks, #distributedRanks) do
+	if referenceRanks[ ri] ~= distributedRanks[ ri] then
+		differences = differences + 1
+	end
+end
+output[ "ranks"] = #distributedRanks
+output[ "differences"] = differences
+output[ "summaries"] = nofEvaluated
+
+-- With one rank only one shard has a document surviving the merge, the other one must get an empty evaluation set and evaluate nothing:
+local _,evalsets,nofEvaluated = evaluateDistributed( 1)
+local evalsetSizes = {}
+for _,evalset in ipairs( evalsets) do
+	evalsetSizes[ evalset.shard] = #(evalset.docno or {})
+end
+output[ "single rank"] = {evalsets=evalsetSizes, summaries=nofEvaluated}
+
+-- Without any shard result the list of evaluation sets is not empty, so that no shard evaluates all documents:
+local emptyMerger = ctx:createQueryResultMerger()
+local emptyEvalsets = emptyMerger:getShardEvaluationSets()
+local _,nofEvaluated = evaluateSummaries( emptyEvalsets, nofranks)
+output[ "no result"] = {evalsets=#emptyEvalsets, summaries=nofEvaluated}
+
+storage:close()
+for _,shardname in ipairs( shardnames) do
+	shards[ shardname]:close()
+end
+
+local result = "distributed query rank:" .. dumpTree( output) .. "\n"
+local expected = [[
+distributed query rank:
+string differences: 0
+string no result:
+  string evalsets: 1
+  string summaries: 0
+string ranks: 10
+string single rank:
+  string evalsets:
+    string even: 1
+    string odd: 0
+  string summaries: 1
+string summaries: 10
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,77 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc100.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Identifiers in descending order, with duplicates and unknown identifiers:
+local docids = {"99", "7", "unknown", "42", "7", "1", "", "100"}
+local docnos = storage:documentNumbers( docids)
+
+-- The lookup of a list must return the same as the single lookups, in the order of the input:
+local numberDifferences = 0
+for di,docid in ipairs( docids) do
+	if docnos[ di] ~= storage:documentNumber( docid) then
+		numberDifferences = numberDifferences + 1
+	end
+end
+
+-- The document numbers returned mapped back to identifiers, with unknown and out of range document numbers added:
+local docnolist = {}
+for _,docno in ipairs( docnos) do
+	table.insert( docnolist, docno)
+end
+local maxdocno = storage:maxDocumentNumber()
+table.insert( docnolist, maxdocno + 1)
+table.insert( docnolist, docnos[ 1])
+local ids = storage:documentIds( docnolist)
+local idDifferences = 0
+for di,docno in ipairs( docnolist) do
+	if (ids[ di] or "") ~= ((docno > 0 and docno <= maxdocno) and storage:docid( docno) or "") then
+		idDifferences = idDifferences + 1
+	end
+end
+
+local output = {}
+output[ "docnos"] = {size = #docnos, differences = numberDifferences, unknown = {docnos[ 3], docnos[ 7]}, duplicate = tostring( docnos[ 2] == docnos[ 5])}
+output[ "docids"] = {size = #ids, differences = idDifferences, roundtrip = {ids[ 1], ids[ 2], ids[ 4], ids[ 5], ids[ 6], ids[ 8], ids[ 10]}, unknown = {ids[ 3], ids[ 9]}}
+output[ "empty"] = {docnos = #(storage:documentNumbers( {}) or {}), docids = #(storage:documentIds( {}) or {})}
+storage:close()
+
+local result = "document numbers:" .. dumpTree( output) .. "\n"
+local expected = [[
+document numbers:
+string docids:
+  string differences: 0
+  string roundtrip:
+    number 1: "99"
+    number 2: "7"
+    number 3: "42"
+    number 4: "7"
+    number 5: "1"
+    number 6: "100"
+    number 7: "99"
+  string size: 10
+  string unknown:
+    number 1: ""
+    number 2: ""
+string docnos:
+  string differences: 0
+  string duplicate: "true"
+  string size: 8
+  string unknown:
+    number 1: 0
+    number 2: 0
+string empty:
+  string docids: 0
+  string docnos: 0
+]]
+verifyTestOutput( outputdir, result, expected)
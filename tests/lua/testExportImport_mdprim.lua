@@ -0,0 +1,85 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+require "dumpCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local importdir = outputdir .. "/import"
+local exportfile = outputdir .. "/export.bin"
+local corruptfile = outputdir .. "/corrupt.bin"
+local docfiles = {"doc10.xml"}
+
+local ctx = strus_Context.new()
+local aclmap = {["1"]='A',["2"]='A',["3"]='A',["4"]='A',["5"]='A',["6"]='B',["7"]='B',["8"]='B',["9"]='B',["10"]='B'}
+
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, aclmap, false)
+
+-- Create an empty storage with the meta data table of the collection exported:
+function createImportStorage()
+	local config = {
+		path = importdir,
+		cache = '512M',
+		statsproc = 'std',
+		acl = true
+	}
+	if ctx:storageExists( config) then
+		ctx:destroyStorage( config)
+	end
+	ctx:createStorage( config)
+	local storage = ctx:createStorageClient( config)
+	local transaction = storage:createTransaction()
+	transaction:defineMetaDataTable( metadata_mdprim())
+	transaction:commit()
+	return storage
+end
+
+-- Import a file expecting an error containing a pattern:
+function importFailure( path, pattern)
+	local storage = createImportStorage()
+	local ok,err = pcall( function() return storage:importDocuments( path) end)
+	storage:close()
+	if ok then
+		return "no error"
+	elseif string.find( tostring(err), pattern, 1, true) then
+		return "rejected"
+	else
+		return "unexpected error: " .. tostring(err)
+	end
+end
+
+local output = {}
+local storage = ctx:createStorageClient( {path=storagedir, cache='512M', statsproc='std'})
+output[ "export"] = storage:exportDocuments( exportfile).documents
+storage:close()
+
+-- Round trip, the collection imported must be equal to the one exported (except for the path):
+local importstorage = createImportStorage()
+output[ "import"] = importstorage:importDocuments( exportfile).documents
+importstorage:close()
+local dumpExported = dumpTreeWithFilter( dumpCollection( ctx, storagedir), {'config'})
+local dumpImported = dumpTreeWithFilter( dumpCollection( ctx, importdir), {'config'})
+output[ "equal"] = tostring( dumpExported == dumpImported)
+
+-- A file with a byte changed in the last document record must be rejected:
+local content = readFile( exportfile)
+local pos = #content - 10
+writeFile( corruptfile, string.sub( content, 1, pos-1) .. string.char( (string.byte( content, pos) + 1) % 256) .. string.sub( content, pos+1))
+output[ "checksum"] = importFailure( corruptfile, "checksum mismatch")
+
+-- A file cut in the middle of the last document record must be rejected:
+writeFile( corruptfile, string.sub( content, 1, #content - 20))
+output[ "truncated"] = importFailure( corruptfile, "truncated")
+
+local result = "export import:" .. dumpTree( output) .. "\n"
+local expected = [[
+export import:
+string checksum: "rejected"
+string equal: "true"
+string export: 10
+string import: 10
+string truncated: "rejected"
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,63 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc100.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Documents in any order with a duplicate, the document "1" has no terms:
+local docnos = storage:documentNumbers( {"96", "7", "1", "60", "7"})
+local columns = storage:documentsForwardIndexTerms( docnos, {"word"})
+
+-- The terms of a document in the columns must be the ones of the forward index iterator of the document:
+local differences = 0
+local ascending = "true"
+local column = columns.type[ 1]
+for di,docno in ipairs( columns.docno) do
+	if di > 1 and columns.docno[ di-1] >= docno then
+		ascending = "false"
+	end
+	local terms = {}
+	for ti=column.offset[ di]+1,column.offset[ di+1] do
+		table.insert( terms, string.format( "%s:%d", column.value[ ti], column.pos[ ti]))
+	end
+	local reference = {}
+	for value,pos in storage:documentForwardIndexTerms( docno, "word") do
+		table.insert( reference, string.format( "%s:%d", value, pos))
+	end
+	if table.concat( terms, " ") ~= table.concat( reference, " ") then
+		differences = differences + 1
+	end
+end
+
+local output = {}
+output[ "documents"] = #columns.docno
+output[ "ascending"] = ascending
+output[ "differences"] = differences
+output[ "type"] = column.name
+output[ "offsets"] = #column.offset
+output[ "terms"] = {values = #column.value, positions = #column.pos, last = column.offset[ #column.offset]}
+storage:close()
+
+local result = "forward index columns:" .. dumpTree( output) .. "\n"
+local expected = [[
+forward index columns:
+string ascending: "true"
+string differences: 0
+string documents: 4
+string offsets: 5
+string terms:
+  string last: 11
+  string positions: 11
+  string values: 11
+string type: "word"
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,81 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc10.xml"}
+
+local ctx = strus_Context.new( {workerthreads=4})
+local analyzer = createDocumentAnalyzer_mdprim( ctx)
+createCollection( ctx, storagedir, metadata_mdprim(), analyzer, true, datadir, docfiles, nil, false)
+
+-- Commits of transactions arriving within 20 milliseconds are merged into one physical commit:
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M;statsproc=std;groupcommit=20", storagedir))
+
+local docs = {}
+for doc in analyzer:analyzeMultiPart( readFile( datadir .. '/' .. docfiles[1])) do
+	table.insert( docs, doc)
+end
+
+-- Three transactions committed concurrently, the second one fails when its operations are applied,
+-- because the document to update does not exist. The failure must not affect the other members of the group:
+local transactions = {}
+for ti,docid in ipairs( {"X1","X2","X3"}) do
+	local transaction = storage:createTransaction()
+	local doc = docs[ ti]
+	doc.attribute.docid = docid
+	if docid == "X2" then
+		transaction:updateDocument( docid, doc, {})
+	else
+		transaction:insertDocument( docid, doc)
+	end
+	table.insert( transactions, transaction)
+end
+for _,transaction in ipairs( transactions) do
+	transaction:commitAsync()
+end
+local output = {}
+local commits = {}
+for ti,transaction in ipairs( transactions) do
+	local ok,err = pcall( function() transaction:waitCommit() end)
+	if ok then
+		commits[ ti] = "ok"
+	elseif string.find( tostring(err), "undefined id", 1, true) then
+		commits[ ti] = "rejected"
+	else
+		commits[ ti] = "unexpected error: " .. tostring(err)
+	end
+end
+output[ "commit"] = commits
+
+local inserted = {}
+for _,docid in ipairs( {"X1","X2","X3"}) do
+	inserted[ docid] = tostring( storage:documentNumber( docid) > 0)
+end
+output[ "inserted"] = inserted
+output[ "nofdocs"] = storage:nofDocumentsInserted()
+
+local statistics = storage:groupCommitStatistics()
+output[ "members"] = statistics.members
+output[ "failures"] = statistics.failures
+storage:close()
+
+local result = "group commit:" .. dumpTree( output) .. "\n"
+local expected = [[
+group commit:
+string commit:
+  number 1: "ok"
+  number 2: "rejected"
+  number 3: "ok"
+string failures: 1
+string inserted:
+  string X1: "true"
+  string X2: "false"
+  string X3: "true"
+string members: 3
+string nofdocs: 12
+]]
+verifyTestOutput( outputdir, result, expected)
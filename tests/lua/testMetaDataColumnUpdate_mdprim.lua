@@ -0,0 +1,95 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc100.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Values of the meta data element 'lo' of all documents, indexed by document identifier:
+function readColumn()
+	local rt = {}
+	for row in storage:select( {"docno", "lo"}, nil, nil, 0) do
+		rt[ storage:docid( row.docno)] = row.lo
+	end
+	return rt
+end
+
+-- Identifiers of the documents with a value differing from the reference, sorted:
+function changedDocuments( reference, column)
+	local rt = {}
+	for docid,value in pairs( column) do
+		if reference[ docid] ~= value then
+			table.insert( rt, docid)
+		end
+	end
+	table.sort( rt, function( a, b) return tonumber( a) < tonumber( b) end)
+	return rt
+end
+
+-- Classify the error of a call:
+function callResult( func, expectedError)
+	local ok,err = pcall( func)
+	if ok then
+		return "ok"
+	elseif string.find( tostring(err), expectedError, 1, true) then
+		return "rejected"
+	else
+		return "unexpected error: " .. tostring(err)
+	end
+end
+
+local output = {}
+local reference = readColumn()
+
+-- [1] Document numbers not in ascending order, the last value of a duplicate document number wins:
+local transaction = storage:createTransaction()
+local docnos = storage:documentNumbers( {"90", "3", "50", "3", "17"})
+transaction:updateMetaDataColumn( "lo", docnos, {900, 31, 500, 32, 170})
+transaction:commit()
+local column = readColumn()
+output[ "update"] = {
+	changed = changedDocuments( reference, column),
+	values = {column[ "3"], column[ "17"], column[ "50"], column[ "90"]}
+}
+
+-- [2] Invalid updates are rejected without changing anything, also not the valid entries of the same call:
+reference = column
+transaction = storage:createTransaction()
+local maxdocno = storage:maxDocumentNumber()
+local docno60 = storage:documentNumber( "60")
+output[ "unknown element"] = callResult( function() transaction:updateMetaDataColumn( "unknown", {docno60}, {1}) end, "unknown meta data element")
+output[ "out of range"] = callResult( function() transaction:updateMetaDataColumn( "lo", {docno60, maxdocno + 1}, {600, 1}) end, "exceeds the maximum document number")
+output[ "zero docno"] = callResult( function() transaction:updateMetaDataColumn( "lo", {docno60, 0}, {600, 1}) end, "invalid document number")
+output[ "size mismatch"] = callResult( function() transaction:updateMetaDataColumn( "lo", {docno60}, {600, 1}) end, "do not match")
+transaction:commit()
+output[ "rejected changed"] = #changedDocuments( reference, readColumn())
+storage:close()
+
+local result = "meta data column update:" .. dumpTree( output) .. "\n"
+local expected = [[
+meta data column update:
+string out of range: "rejected"
+string rejected changed: 0
+string size mismatch: "rejected"
+string unknown element: "rejected"
+string update:
+  string changed:
+    number 1: "3"
+    number 2: "17"
+    number 3: "50"
+    number 4: "90"
+  string values:
+    number 1: 32
+    number 2: 170
+    number 3: 500
+    number 4: 900
+string zero docno: "rejected"
+]]
+verifyTestOutput( outputdir, result, expected)
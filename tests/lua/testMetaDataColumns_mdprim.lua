@@ -0,0 +1,106 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+local columns = {"docidx", "cross", "doclen"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Meta data of all documents selected row by row as reference, indexed by document number:
+local reference = {}
+local what = {"docno"}
+for _,name in ipairs( columns) do
+	table.insert( what, name)
+end
+for row in storage:select( what, nil, nil, 0) do
+	reference[ row.docno] = row
+end
+
+-- Decode the base64 encoded packed values of a column, 8 byte little endian integers (only non negative values used here):
+local base64chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+function decodePacked( packed)
+	local bytes = {}
+	local acc = 0
+	local nofbits = 0
+	for ci=1,#packed do
+		local digit = string.find( base64chars, string.sub( packed, ci, ci), 1, true)
+		if digit then
+			acc = acc * 64 + (digit - 1)
+			nofbits = nofbits + 6
+			if nofbits >= 8 then
+				nofbits = nofbits - 8
+				local divisor = 2 ^ nofbits
+				table.insert( bytes, math.floor( acc / divisor))
+				acc = acc % divisor
+			end
+		end
+	end
+	local rt = {}
+	for bi=1,#bytes - 7,8 do
+		local value = 0
+		for ofs=7,0,-1 do
+			value = value * 256 + bytes[ bi + ofs]
+		end
+		table.insert( rt, value)
+	end
+	return rt
+end
+
+-- Export the columns of a range in chunks, compare the values with the reference, return the properties of the chunks:
+function export( start_docno, end_docno, chunksize, packed)
+	local chunks = {}
+	local differences = 0
+	local nofdocs = 0
+	for chunk in storage:metadataColumns( columns, start_docno, end_docno, chunksize, packed) do
+		table.insert( chunks, string.format( "%d+%d", chunk.start, chunk.count))
+		for ci,column in ipairs( chunk.column) do
+			if column.name ~= columns[ ci] or column.type ~= "int64" then
+				differences = differences + 1
+			end
+			local values = packed and decodePacked( column.packed) or column.values
+			if #values ~= chunk.count then
+				differences = differences + 1
+			end
+			for vi,value in ipairs( values) do
+				local row = reference[ chunk.start + vi - 1]
+				if not row or tonumber( row[ column.name] or 0) ~= value then
+					differences = differences + 1
+				end
+			end
+		end
+		nofdocs = nofdocs + chunk.count
+	end
+	return {chunks = table.concat( chunks, " "), differences = differences, nofdocs = nofdocs}
+end
+
+local output = {}
+output[ "range"] = export( 101, 301, 64, false)
+output[ "packed"] = export( 101, 301, 64, true)
+output[ "all"] = export( 0, 0, 0, false)
+storage:close()
+
+local result = "metadata columns:" .. dumpTree( output) .. "\n"
+local expected = [[
+metadata columns:
+string all:
+  string chunks: "1+1000"
+  string differences: 0
+  string nofdocs: 1000
+string packed:
+  string chunks: "101+64 165+64 229+64 293+8"
+  string differences: 0
+  string nofdocs: 200
+string range:
+  string chunks: "101+64 165+64 229+64 293+8"
+  string differences: 0
+  string nofdocs: 200
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,148 @@
+require "string"
+require "utils"
+require "math"
+
+local outputdir = arg[1] or '.'
+local nofdocs = 4096
+local ctx = strus_Context.new()
+
+function createStorage( name)
+	local config = {path=outputdir .. "/" .. name, cache='512M', statsproc='std'}
+	if ctx:storageExists( config) then
+		ctx:destroyStorage( config)
+	end
+	ctx:createStorage( config)
+	local storage = ctx:createStorageClient( config)
+	local transaction = storage:createTransaction()
+	transaction:defineMetaDataTable( {{"year","UINT16"},{"idx","UINT32"}})
+	transaction:commit()
+	return storage
+end
+
+-- Insert documents with an index and a year, the years of the documents of a block of 1024 documents do not overlap with the ones of other blocks:
+function insertDocuments( storage, docs)
+	local transaction = storage:createTransaction()
+	for _,doc in ipairs( docs) do
+		transaction:insertDocument( doc.docid, {
+			attribute = {{name="docid", value=doc.docid}},
+			metadata = {{name="year", value=doc.year}, {name="idx", value=doc.idx}},
+			searchindex = {{type="word", value="w" .. (doc.idx % 3), pos=1}}
+		})
+	end
+	transaction:commit()
+end
+
+local storage = createStorage( "zonemap")
+local docs = {}
+for idx=1,nofdocs do
+	table.insert( docs, {docid = "d" .. idx, idx = idx, year = 1990 + math.floor( (idx-1) / 1024) * 5 + (idx % 5)})
+end
+insertDocuments( storage, docs)
+
+local restriction = {{">=", "year", 2000}, {"<=", "year", 2004}}
+
+-- Document numbers of the documents matching the restriction, the scan skips the blocks summarized that cannot match:
+function selectRestricted( expression)
+	local rt = {}
+	for row in storage:select( {"docno"}, expression, restriction, 0) do
+		table.insert( rt, row.docno)
+	end
+	return rt
+end
+
+-- Document numbers of the documents matching the restriction, evaluated on the values of all documents read without restriction:
+function selectReference( expression)
+	local rt = {}
+	for row in storage:select( {"docno", "year"}, expression, nil, 0) do
+		if row.year >= 2000 and row.year <= 2004 then
+			table.insert( rt, row.docno)
+		end
+	end
+	return rt
+end
+
+function compareExpression( expression)
+	local restricted = selectRestricted( expression)
+	local reference = selectReference( expression)
+	local differences = 0
+	for ri=1,math.max( #restricted, #reference) do
+		if restricted[ ri] ~= reference[ ri] then
+			differences = differences + 1
+		end
+	end
+	return {size = #reference, differences = differences}
+end
+
+-- Compare the restricted scan with the reference, with the browse postings of the restriction and with term postings driving the scan:
+function compare()
+	return {all = compareExpression( nil), postings = compareExpression( {"word", "w1"})}
+end
+
+local output = {}
+
+-- [1] The first scan builds the summaries of the blocks, the second one skips the blocks that cannot match:
+output[ "1 first scan"] = compare()
+output[ "1 second scan"] = compare()
+
+-- [2] Documents of a block skipped before get a value matching with a column update:
+local transaction = storage:createTransaction()
+transaction:updateMetaDataColumn( "year", storage:documentNumbers( {"d10", "d20", "d30"}), {2001, 2002, 2003})
+transaction:commit()
+output[ "2 column update"] = compare()
+
+-- [3] Documents get a value matching or not matching anymore with an import of documents replacing them:
+local source = createStorage( "zonemap_import")
+insertDocuments( source, {{docid = "d100", idx = 100, year = 2004}, {docid = "d3000", idx = 3000, year = 1990}})
+local exportfile = outputdir .. "/zonemap.export"
+source:exportDocuments( exportfile)
+source:close()
+storage:importDocuments( exportfile)
+output[ "3 import"] = compare()
+
+-- [4] The values of the column restricted change with a change of the meta data table, the index becomes the year:
+transaction = storage:createTransaction()
+transaction:updateMetaDataTable( {{op="replace", name="yearold", oldname="year", type="UINT16"}, {op="replace", name="year", oldname="idx", type="UINT32"}})
+transaction:commit()
+output[ "4 table update"] = compare()
+storage:close()
+
+local result = "metadata zone map:" .. dumpTree( output) .. "\n"
+local expected = [[
+metadata zone map:
+string 1 first scan:
+  string all:
+    string differences: 0
+    string size: 1024
+  string postings:
+    string differences: 0
+    string size: 341
+string 1 second scan:
+  string all:
+    string differences: 0
+    string size: 1024
+  string postings:
+    string differences: 0
+    string size: 341
+string 2 column update:
+  string all:
+    string differences: 0
+    string size: 1027
+  string postings:
+    string differences: 0
+    string size: 342
+string 3 import:
+  string all:
+    string differences: 0
+    string size: 1027
+  string postings:
+    string differences: 0
+    string size: 343
+string 4 table update:
+  string all:
+    string differences: 0
+    string size: 5
+  string postings:
+    string differences: 0
+    string size: 1
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,117 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+-- Decode a base64 encoded string to a list of byte values:
+local base64chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+function decodeBase64( encoded)
+	local rt = {}
+	local acc = 0
+	local nofbits = 0
+	for ci=1,#encoded do
+		local digit = string.find( base64chars, string.sub( encoded, ci, ci), 1, true)
+		if digit then
+			acc = acc * 64 + (digit - 1)
+			nofbits = nofbits + 6
+			if nofbits >= 8 then
+				nofbits = nofbits - 8
+				local divisor = 2 ^ nofbits
+				table.insert( rt, math.floor( acc / divisor))
+				acc = acc % divisor
+			end
+		end
+	end
+	return rt
+end
+
+-- Decode the packed positions, varint encoded deltas of the positions:
+function decodePacked( packed)
+	local rt = {}
+	local pos = 0
+	local value = 0
+	local factor = 1
+	for _,byte in ipairs( decodeBase64( packed)) do
+		value = value + (byte % 128) * factor
+		if byte >= 128 then
+			factor = factor * 128
+		else
+			pos = pos + value
+			table.insert( rt, pos)
+			value = 0
+			factor = 1
+		end
+	end
+	return rt
+end
+
+-- Postings with the positions as reference:
+function postings( expression, output)
+	local rt = {}
+	for docno,value in storage:postings( expression, nil, 0, output) do
+		table.insert( rt, {docno = docno, value = value})
+	end
+	return rt
+end
+
+function compare( expression)
+	local reference = postings( expression, "positions")
+	local modes = {docno = postings( expression, "docno"), ff = postings( expression, "ff"), packed = postings( expression, "packed")}
+	local rt = {postings = #reference}
+	for mode,list in pairs( modes) do
+		local differences = 0
+		for pi=1,math.max( #reference, #list) do
+			local ref = reference[ pi]
+			local elem = list[ pi]
+			if not ref or not elem or ref.docno ~= elem.docno then
+				differences = differences + 1
+			elseif mode == "docno" and elem.value ~= nil then
+				differences = differences + 1
+			elseif mode == "ff" and elem.value ~= #ref.value then
+				differences = differences + 1
+			elseif mode == "packed" and table.concat( decodePacked( elem.value), " ") ~= table.concat( ref.value, " ") then
+				differences = differences + 1
+			end
+		end
+		rt[ mode] = differences
+	end
+	local ff = 0
+	for _,elem in ipairs( modes.ff) do
+		ff = ff + elem.value
+	end
+	rt.frequency = ff
+	return rt
+end
+
+local output = {}
+output[ "term"] = compare( {"word", "2"})
+output[ "sequence"] = compare( {"sequence", 1, {"word", "2"}, {"word", "3"}})
+storage:close()
+
+local result = "postings output:" .. dumpTree( output) .. "\n"
+local expected = [[
+postings output:
+string sequence:
+  string docno: 0
+  string ff: 0
+  string frequency: 166
+  string packed: 0
+  string postings: 166
+string term:
+  string docno: 0
+  string ff: 0
+  string frequency: 994
+  string packed: 0
+  string postings: 500
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,64 @@
+require "string"
+require "utils"
+require "config_mdprim"
+
+local outputdir = arg[1] or '.'
+
+-- Query analyzers analyzing in the calling thread and delegating the analysis to background threads:
+local syncAnalyzer = createQueryAnalyzer_mdprim( strus_Context.new())
+local deferredAnalyzer = createQueryAnalyzer_mdprim( strus_Context.new( {analyzerthreads=2}))
+
+-- Analyze a list of term expressions, return their serialization or the string "error" for a failed analysis:
+function analyze( analyzer, expressions)
+	local rt = {}
+	for ei,expr in ipairs( expressions) do
+		local ok,result = pcall( function() return dumpTree( analyzer:analyzeTermExpression( expr)) end)
+		if ok then
+			rt[ ei] = result
+		else
+			rt[ ei] = "error"
+		end
+	end
+	return rt
+end
+
+-- Compare the results of the analysis in the calling thread and in background threads, return the number of differences:
+function compare( expressions)
+	local syncResult = analyze( syncAnalyzer, expressions)
+	local deferredResult = analyze( deferredAnalyzer, expressions)
+	local differences = 0
+	for ei=1,#expressions do
+		if syncResult[ ei] ~= deferredResult[ ei] then
+			differences = differences + 1
+		end
+	end
+	return differences, deferredResult
+end
+
+local output = {}
+
+-- Features of a query analyzed concurrently are returned in their original order:
+local expressions = {
+	{"word","2"},
+	{"sequence", 10, {"word","2"}, {"word","3"}},
+	{"lo","17"},
+	{"union", {"word","5"}, {"word","7"}}
+}
+output[ "valid"] = compare( expressions)
+
+-- The failure of an analysis in a background thread is reported as error, when the result is accessed,
+-- the thread stays available for the following expressions:
+local differences,failedResult = compare( {{"undefinedfieldtype","2"}})
+output[ "failed"] = failedResult[1]
+output[ "failed differences"] = differences
+output[ "after failure"] = compare( expressions)
+
+local result = "query analyzer threads:" .. dumpTree( output) .. "\n"
+local expected = [[
+query analyzer threads:
+string after failure: 0
+string failed: "error"
+string failed differences: 0
+string valid: 0
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,84 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+
+local ctx = strus_Context.new( {workerthreads=4})
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+local queryEval = createQueryEval_mdprim( ctx)
+
+-- Evaluate a query with the documents split into a number of partitions and return its ranks with their summaries:
+function evaluate( nofPartitions, minRank, evalset)
+	local query = queryEval:createQuery( storage)
+	query:addFeature( "seek", {"word","2"})
+	query:addFeature( "select", {"contains", 0, 1, {"word","2"}, {"word","3"}})
+	if evalset then
+		query:addDocumentEvaluationSet( evalset)
+	end
+	query:setMaxNofRanks( 30)
+	query:setMinRank( minRank)
+	query:setNofPartitions( nofPartitions)
+	local rt = {}
+	for _,rank in ipairs( query:evaluate().ranks) do
+		local summary = {}
+		for _,si in ipairs( rank.summary) do
+			table.insert( summary, string.format( "%s=%s", si.name, si.value))
+		end
+		table.insert( rt, string.format( "%d %.6f %s", rank.docno, rank.weight, table.concat( summary, " ")))
+	end
+	return rt
+end
+
+-- Compare the ranks of a sequential and of a partitioned evaluation, return the number of ranks differing:
+function compare( minRank, evalset)
+	local sequential = evaluate( 1, minRank, evalset)
+	local partitioned = evaluate( 4, minRank, evalset)
+	if #sequential == 0 then
+		return "empty"
+	end
+	local differences = 0
+	for ri=1,math.max( #sequential, #partitioned) do
+		if sequential[ ri] ~= partitioned[ ri] then
+			differences = differences + 1
+		end
+	end
+	return differences
+end
+
+local evalset = {}
+for docno=1,1000,3 do
+	table.insert( evalset, docno)
+end
+
+local output = {}
+output[ "range first"] = compare( 0)
+output[ "range scroll"] = compare( 20)
+output[ "set first"] = compare( 0, evalset)
+output[ "set scroll"] = compare( 20, evalset)
+
+-- Evaluations repeated with the threads of the worker thread pool reused:
+local repeatedDifferences = 0
+for ri=1,5 do
+	repeatedDifferences = repeatedDifferences + compare( ri * 10)
+end
+output[ "repeated"] = repeatedDifferences
+storage:close()
+
+local result = "query partitions:" .. dumpTree( output) .. "\n"
+local expected = [[
+query partitions:
+string range first: 0
+string range scroll: 0
+string repeated: 0
+string set first: 0
+string set scroll: 0
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,88 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+local pagesize = 7
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+local queryEval = createQueryEval_mdprim( ctx)
+
+function createQuery( nofranks)
+	local query = queryEval:createQuery( storage)
+	query:addFeature( "seek", {"word","2"})
+	query:addFeature( "select", {"contains", 0, 1, {"word","2"}, {"word","3"}})
+	query:setMaxNofRanks( nofranks or pagesize)
+	query:setMinRank( 0)
+	return query
+end
+
+-- Append the ranks of a page to a list, return the number of ranks of the page:
+function appendRanks( list, result)
+	local nofranks = 0
+	for _,rank in ipairs( result.ranks) do
+		table.insert( list, string.format( "%d %.6f", rank.docno, rank.weight))
+		nofranks = nofranks + 1
+	end
+	return nofranks
+end
+
+-- Pages fetched with a cursor:
+local cursorRanks = {}
+local cursorPages = 0
+local cursor = createQuery():createResultCursor()
+while appendRanks( cursorRanks, cursor:nextPage()) > 0 do
+	cursorPages = cursorPages + 1
+end
+
+-- Pages fetched with a query evaluation per page:
+local sequentialRanks = {}
+local sequentialPages = 0
+local query = createQuery()
+while appendRanks( sequentialRanks, query:evaluate()) > 0 do
+	sequentialPages = sequentialPages + 1
+	query:setMinRank( sequentialPages * pagesize)
+end
+
+local differences = 0
+for ri=1,math.max( #cursorRanks, #sequentialRanks) do
+	if cursorRanks[ ri] ~= sequentialRanks[ ri] then
+		differences = differences + 1
+	end
+end
+
+-- Pages of a single rank fetched with a cursor, the window grows past the size of many pages:
+local singleRanks = {}
+cursor = createQuery( 1):createResultCursor()
+while appendRanks( singleRanks, cursor:nextPage()) > 0 do end
+local singleDifferences = 0
+for ri=1,math.max( #singleRanks, #sequentialRanks) do
+	if singleRanks[ ri] ~= sequentialRanks[ ri] then
+		singleDifferences = singleDifferences + 1
+	end
+end
+
+local output = {}
+output[ "single rank differences"] = singleDifferences
+output[ "pages"] = tostring( cursorPages == sequentialPages and cursorPages > 1)
+output[ "ranks"] = tostring( #cursorRanks == #sequentialRanks and #cursorRanks > pagesize)
+output[ "differences"] = differences
+storage:close()
+
+local result = "result cursor:" .. dumpTree( output) .. "\n"
+local expected = [[
+result cursor:
+string differences: 0
+string pages: "true"
+string ranks: "true"
+string single rank differences: 0
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,112 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+
+-- Access rights of the documents: multiples of 3 for A, multiples of 5 for B, multiples of 7 for C, the other documents without access rights:
+local aclmap = {}
+for docid=1,1000 do
+	local access = {}
+	if docid % 3 == 0 then table.insert( access, "A") end
+	if docid % 5 == 0 then table.insert( access, "B") end
+	if docid % 7 == 0 then table.insert( access, "C") end
+	if #access > 0 then
+		aclmap[ tostring( docid)] = access
+	end
+end
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, aclmap, false)
+local storage = ctx:createStorageClient( {path = storagedir, cache = '512M', acl = true})
+
+-- Document numbers selected with an access restriction driving the scan, as leapfrog between the postings and the access iterators:
+function selectAccessible( expression, accesslist)
+	local rt = {}
+	for row in storage:select( {"docno"}, expression, nil, 0, accesslist) do
+		table.insert( rt, row.docno)
+	end
+	return rt
+end
+
+-- Document numbers selected without access restriction and filtered document by document with the access list read, as the check of every document did before:
+function selectChecked( expression, accesslist)
+	local rt = {}
+	for row in storage:select( {"docno", "ACL"}, expression, nil, 0) do
+		local granted = false
+		for _,user in ipairs( row.ACL or {}) do
+			for _,access in ipairs( accesslist) do
+				if user == access then
+					granted = true
+				end
+			end
+		end
+		if granted then
+			table.insert( rt, row.docno)
+		end
+	end
+	return rt
+end
+
+function compare( expression, accesslist)
+	local leapfrog = selectAccessible( expression, accesslist)
+	local checked = selectChecked( expression, accesslist)
+	local differences = 0
+	for ri=1,math.max( #leapfrog, #checked) do
+		if leapfrog[ ri] ~= checked[ ri] then
+			differences = differences + 1
+		end
+	end
+	return {size = #leapfrog, differences = differences}
+end
+
+local output = {}
+output[ "access A"] = compare( nil, {"A"})
+output[ "access B,C"] = compare( nil, {"B", "C"})
+output[ "access unknown"] = compare( nil, {"X"})
+output[ "postings A"] = compare( {"word", "2"}, {"A"})
+output[ "postings B,C"] = compare( {"word", "3"}, {"B", "C"})
+
+-- Without postings and access restriction only the documents inserted are selected, also after a deletion:
+local transaction = storage:createTransaction()
+transaction:deleteDocument( "500")
+transaction:commit()
+local all = 0
+local undefined = 0
+for row in storage:select( {"docno", "docid"}, nil, nil, 0) do
+	all = all + 1
+	if not row.docid then
+		undefined = undefined + 1
+	end
+end
+output[ "all"] = {size = all, undefined = undefined}
+storage:close()
+
+local result = "select access:" .. dumpTree( output) .. "\n"
+local expected = [[
+select access:
+string access A:
+  string differences: 0
+  string size: 333
+string access B,C:
+  string differences: 0
+  string size: 314
+string access unknown:
+  string differences: 0
+  string size: 0
+string all:
+  string size: 999
+  string undefined: 0
+string postings A:
+  string differences: 0
+  string size: 166
+string postings B,C:
+  string differences: 0
+  string size: 104
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,119 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+local batchsize = 10
+
+local ctx = strus_Context.new( {workerthreads=4})
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M", storagedir))
+
+local what = {"docno", "docid", "doclen", "position"}
+local expression = {"word", "7"}
+local restriction = {"<", "cross", 10}
+
+function valueString( value)
+	if type( value) == "table" then
+		return table.concat( value, " ")
+	end
+	return tostring( value)
+end
+
+-- Rows selected one by one as structures with the names of the items selected:
+function selectRows( restr)
+	local rt = {}
+	for row in storage:select( what, expression, restr, 0) do
+		local values = {}
+		for _,name in ipairs( what) do
+			table.insert( values, valueString( row[ name]))
+		end
+		table.insert( rt, table.concat( values, "|"))
+	end
+	return rt
+end
+
+-- Rows selected in batches with a header, return the rows and the properties of the batches:
+function selectBatches( iterator)
+	local rt = {}
+	local batches = 0
+	local oversized = 0
+	local header = "true"
+	for batch in iterator do
+		batches = batches + 1
+		if table.concat( batch.header, " ") ~= table.concat( what, " ") then
+			header = "false"
+		end
+		if #batch.rows > batchsize then
+			oversized = oversized + 1
+		end
+		for _,row in ipairs( batch.rows) do
+			local values = {}
+			for ci,_ in ipairs( batch.header) do
+				table.insert( values, valueString( row[ ci]))
+			end
+			table.insert( rt, table.concat( values, "|"))
+		end
+	end
+	return rt, {batches=batches, oversized=oversized, header=header}
+end
+
+function differences( list1, list2)
+	local rt = 0
+	for ri=1,math.max( #list1, #list2) do
+		if list1[ ri] ~= list2[ ri] then
+			rt = rt + 1
+		end
+	end
+	return rt
+end
+
+local output = {}
+
+-- The rows of the batches must be the ones selected one by one, in the same order:
+local rows = selectRows()
+local batchRows,batchProps = selectBatches( storage:select( what, expression, nil, 0, nil, batchsize))
+batchProps.rows = #batchRows
+batchProps.differences = differences( rows, batchRows)
+output[ "batch"] = batchProps
+
+-- The same with a meta data restriction:
+local restrictedRows = selectRows( restriction)
+local restrictedBatchRows,restrictedProps = selectBatches( storage:select( what, expression, restriction, 0, nil, batchsize))
+restrictedProps.batches = nil
+restrictedProps.rows = tostring( #restrictedBatchRows > 0 and #restrictedBatchRows < #rows)
+restrictedProps.differences = differences( restrictedRows, restrictedBatchRows)
+output[ "restricted"] = restrictedProps
+
+-- The batches of a partitioned select in ascending order of document numbers must have the same rows:
+local partitionedRows,partitionedProps = selectBatches( storage:selectPartitioned( what, expression, nil, 0, nil, batchsize, 4, true))
+partitionedProps.batches = nil
+partitionedProps.differences = differences( rows, partitionedRows)
+output[ "partitioned"] = partitionedProps
+storage:close()
+
+local result = "select batch:" .. dumpTree( output) .. "\n"
+local expected = [[
+select batch:
+string batch:
+  string batches: 15
+  string differences: 0
+  string header: "true"
+  string oversized: 0
+  string rows: 142
+string partitioned:
+  string differences: 0
+  string header: "true"
+  string oversized: 0
+string restricted:
+  string differences: 0
+  string header: "true"
+  string oversized: 0
+  string rows: "true"
+]]
+verifyTestOutput( outputdir, result, expected)
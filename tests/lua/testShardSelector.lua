@@ -0,0 +1,69 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local ctx = strus_Context.new()
+local server = "example.com:7184/qryeval/shard"
+
+-- Storage shard with statistics change timestamps the summary of its terms is built for:
+local config = {path=outputdir .. "/shard", statsproc='std'}
+if ctx:storageExists( config) then
+	ctx:destroyStorage( config)
+end
+ctx:createStorage( config)
+local storage = ctx:createStorageClient( config)
+
+function insertDocument( docid, words)
+	local searchindex = {}
+	for pos,word in ipairs( words) do
+		table.insert( searchindex, {type="word", value=word, pos=pos})
+	end
+	local transaction = storage:createTransaction()
+	transaction:insertDocument( docid, {searchindex=searchindex})
+	transaction:commit()
+end
+
+-- Number of servers selected for a query with a single feature searching a word:
+local selector = ctx:createShardSelector()
+function nofServersSelected( word)
+	local builder = ctx:createQueryBuilder()
+	builder:addFeature( "seek", {"word",word})
+	return #(builder:selectServers( selector, {server}) or {})
+end
+
+local output = {}
+
+-- [1] The shard is pruned for a term not contained in it:
+insertDocument( "A", {"hello","world"})
+local summary = storage:termSummary()
+selector:defineStatisticsVersion( 1)
+selector:defineShardSummary( server, summary)
+output[ "1 contained"] = nofServersSelected( "hello")
+output[ "1 not contained"] = nofServersSelected( "new")
+output[ "1 summary kept"] = tostring( storage:termSummary() == summary)
+
+-- [2] After an insert, the statistics version changes and the outdated summary is not used anymore:
+insertDocument( "B", {"new"})
+selector:defineStatisticsVersion( 2)
+output[ "2 outdated"] = nofServersSelected( "new")
+
+-- [3] The summary is rebuilt after the insert and contains the term inserted:
+local rebuiltSummary = storage:termSummary()
+output[ "3 summary rebuilt"] = tostring( rebuiltSummary ~= summary)
+selector:defineShardSummary( server, rebuiltSummary)
+output[ "3 inserted"] = nofServersSelected( "new")
+output[ "3 not contained"] = nofServersSelected( "other")
+storage:close()
+
+local result = "shard selector:" .. dumpTree( output) .. "\n"
+local expected = [[
+shard selector:
+string 1 contained: 1
+string 1 not contained: 0
+string 1 summary kept: "true"
+string 2 outdated: 1
+string 3 inserted: 1
+string 3 not contained: 0
+string 3 summary rebuilt: "true"
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,114 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local ctx = strus_Context.new()
+local statserver = "example.com:7184/statserver/test"
+
+-- Cache of the coordinator of a distributed query evaluation:
+local cache = ctx:createStatisticsCache( "ttl=3600; size=1000")
+
+-- Query builder of a query with features referencing some terms:
+function createQueryBuilder( terms)
+	local builder = ctx:createQueryBuilder()
+	for _,term in ipairs( terms) do
+		builder:addFeature( "seek", {"word",term})
+	end
+	return builder
+end
+
+-- Number of statistics servers asked for the statistics of a query, 0 if the request is skipped:
+function nofServersAsked( builder)
+	return #(builder:selectStatisticsServers( cache, statserver) or {})
+end
+
+-- Statistics server response with the term statistics defined before the global statistics:
+function response( termstats, nofdocs, version)
+	for _,ts in ipairs( termstats) do
+		cache:defineTermStatistics( "word", ts[1], ts[2])
+	end
+	cache:defineGlobalStatistics( nofdocs, version)
+end
+
+local output = {}
+
+-- [1] Empty cache, the statistics server is asked:
+local builder = createQueryBuilder( {"hello","world"})
+output[ "1 empty"] = nofServersAsked( builder)
+response( {{"hello",12},{"world",7}}, 100, 1)
+output[ "1 termstats"] = builder:getTermStatistics( cache)
+
+-- [2] All terms cached, the request is skipped:
+builder = createQueryBuilder( {"hello","world"})
+output[ "2 cached"] = nofServersAsked( builder)
+output[ "2 termstats"] = builder:getTermStatistics( cache)
+
+-- [3] A term not cached, the statistics server is asked:
+builder = createQueryBuilder( {"hello","new"})
+output[ "3 uncached"] = nofServersAsked( builder)
+response( {{"new",3}}, 110, 2)
+output[ "3 termstats"] = builder:getTermStatistics( cache)
+
+-- [4] The version change of the response in [3] outdates the entries defined before, but not the ones defined with it:
+builder = createQueryBuilder( {"new"})
+output[ "4 same response"] = nofServersAsked( builder)
+builder = createQueryBuilder( {"hello","world"})
+output[ "4 outdated"] = nofServersAsked( builder)
+response( {{"hello",13},{"world",8}}, 110, 2)
+output[ "4 termstats"] = builder:getTermStatistics( cache)
+
+-- [5] A response with the same version does not outdate any entry:
+response( {{"other",1}}, 111, 2)
+builder = createQueryBuilder( {"hello","world","new"})
+output[ "5 same version"] = nofServersAsked( builder)
+output[ "5 globalstats"] = cache:getGlobalStatistics()
+
+local result = "statistics cache:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics cache:
+string 1 empty: 1
+string 1 termstats:
+  number 1:
+    string df: 12
+    string type: "word"
+    string value: "hello"
+  number 2:
+    string df: 7
+    string type: "word"
+    string value: "world"
+string 2 cached: 0
+string 2 termstats:
+  number 1:
+    string df: 12
+    string type: "word"
+    string value: "hello"
+  number 2:
+    string df: 7
+    string type: "word"
+    string value: "world"
+string 3 termstats:
+  number 1:
+    string df: 12
+    string type: "word"
+    string value: "hello"
+  number 2:
+    string df: 3
+    string type: "word"
+    string value: "new"
+string 3 uncached: 1
+string 4 outdated: 1
+string 4 same response: 0
+string 4 termstats:
+  number 1:
+    string df: 13
+    string type: "word"
+    string value: "hello"
+  number 2:
+    string df: 8
+    string type: "word"
+    string value: "world"
+string 5 globalstats:
+  string nofdocs: 111
+string 5 same version: 0
+]]
+verifyTestOutput( outputdir, result, expected)
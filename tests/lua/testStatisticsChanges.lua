@@ -0,0 +1,144 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local ctx = strus_Context.new()
+
+-- Two storages as sources of statistics changes:
+function createStorage( name)
+	local config = {path=outputdir .. "/" .. name, statsproc='std'}
+	if ctx:storageExists( config) then
+		ctx:destroyStorage( config)
+	end
+	ctx:createStorage( config)
+	return ctx:createStorageClient( config)
+end
+local storages = {A = createStorage( "statchanges_A"), B = createStorage( "statchanges_B")}
+local statmap = ctx:createStatisticsMap( "proc=std; shards=4")
+
+function insertDocument( source, docid, words)
+	local searchindex = {}
+	for pos,word in ipairs( words) do
+		table.insert( searchindex, {type="word", value=word, pos=pos})
+	end
+	local transaction = storages[ source]:createTransaction()
+	transaction:insertDocument( docid, {searchindex=searchindex})
+	transaction:commit()
+end
+
+-- Propagate changes to the statistics map as a source, return what the changes contain:
+function process( source, changes)
+	statmap:processStatisticsChanges( source, changes.message, changes.watermark, changes.snapshot)
+	if changes.watermark then
+		return "snapshot"
+	else
+		return "messages"
+	end
+end
+
+-- Synchronize the statistics map with a storage:
+function sync( source, watermarks)
+	return process( source, storages[ source]:getStatisticsChanges( source, watermarks or statmap:watermarks()))
+end
+
+-- State of the statistics map:
+function state()
+	local sources = {}
+	for _,wm in ipairs( statmap:watermarks() or {}) do
+		table.insert( sources, wm.source)
+	end
+	table.sort( sources)
+	return {
+		nofdocs = statmap:nofDocuments(),
+		df = {a = statmap:df( "word", "a"), b = statmap:df( "word", "b"), c = statmap:df( "word", "c")},
+		sources = table.concat( sources, ",")
+	}
+end
+
+local output = {}
+
+-- [1] The first synchronization of a source delivers a snapshot:
+insertDocument( "A", "A1", {"a","b"})
+insertDocument( "B", "B1", {"a"})
+output[ "1 sync"] = {A = sync( "A"), B = sync( "B")}
+output[ "1 state"] = state()
+
+-- [2] The following synchronizations deliver the messages since the watermark:
+local watermarks = statmap:watermarks()
+insertDocument( "A", "A2", {"b","c"})
+output[ "2 sync"] = sync( "A")
+output[ "2 state"] = state()
+
+-- [3] Changes delivered twice are applied once:
+output[ "3 sync"] = sync( "A", watermarks)
+output[ "3 state"] = state()
+
+-- [4] Messages of a source without watermark are ignored, its statistics are accepted first with a snapshot:
+output[ "4 process"] = process( "C", storages.A:getStatisticsChanges( "A", watermarks))
+output[ "4 state"] = state()
+
+-- [5] If the changes kept by the storage do not reach back to the watermark, a snapshot is delivered.
+-- It cannot be separated from the statistics contributed before, all statistics are dropped and the sources are accepted again with a snapshot:
+output[ "5 sync"] = sync( "A", {{source="A", timestamp={unixtime=1, counter=0}}})
+output[ "5 state"] = state()
+output[ "5 resync"] = sync( "B")
+output[ "5 resync state"] = state()
+
+storages.A:close()
+storages.B:close()
+
+local result = "statistics changes:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics changes:
+string 1 state:
+  string df:
+    string a: 2
+    string b: 1
+    string c: 0
+  string nofdocs: 2
+  string sources: "A,B"
+string 1 sync:
+  string A: "snapshot"
+  string B: "snapshot"
+string 2 state:
+  string df:
+    string a: 2
+    string b: 2
+    string c: 1
+  string nofdocs: 3
+  string sources: "A,B"
+string 2 sync: "messages"
+string 3 state:
+  string df:
+    string a: 2
+    string b: 2
+    string c: 1
+  string nofdocs: 3
+  string sources: "A,B"
+string 3 sync: "messages"
+string 4 process: "messages"
+string 4 state:
+  string df:
+    string a: 2
+    string b: 2
+    string c: 1
+  string nofdocs: 3
+  string sources: "A,B"
+string 5 resync: "snapshot"
+string 5 resync state:
+  string df:
+    string a: 2
+    string b: 2
+    string c: 1
+  string nofdocs: 3
+  string sources: "A,B"
+string 5 state:
+  string df:
+    string a: 1
+    string b: 2
+    string c: 1
+  string nofdocs: 2
+  string sources: "A"
+string 5 sync: "snapshot"
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,80 @@
+require "string"
+require "utils"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local snapshotfile = outputdir .. "/statcompact.snapshot"
+local docfiles = {"doc1000.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M;statsproc=std", storagedir))
+
+-- Fill a map with the statistics of the storage and store them as snapshot:
+os.remove( snapshotfile)
+local source = ctx:createStatisticsMap( string.format( "proc=std; shards=8; dict=map; snapshot='%s'", snapshotfile))
+for blob in storage:getAllStatistics() do
+	source:processStatisticsMessage( blob)
+end
+storage:close()
+source:storeSnapshot()
+
+-- Maps with both term dictionaries loaded from the snapshot, so that all terms are in the merged part of the shards:
+local map = ctx:createStatisticsMap( string.format( "proc=std; shards=8; dict=map; snapshot='%s'", snapshotfile))
+local compact = ctx:createStatisticsMap( string.format( "proc=std; shards=8; dict=compact; snapshot='%s'", snapshotfile))
+
+function compare()
+	local differences = 0
+	for value=1,1000 do
+		if compact:df( "word", tostring( value)) ~= map:df( "word", tostring( value)) then
+			differences = differences + 1
+		end
+	end
+	return differences
+end
+
+-- Number of terms in the part of the shards with the recent changes:
+function deltaSize( statmap)
+	local rt = 0
+	for _,shard in ipairs( statmap:introspection( "shard")) do
+		rt = rt + shard.delta
+	end
+	return rt
+end
+
+local output = {}
+output[ "loaded"] = {differences = compare(), delta = deltaSize( compact), nofdocs = compact:nofDocuments()}
+output[ "dict"] = {map = map:introspection( "dict"), compact = compact:introspection( "dict")}
+output[ "smaller"] = tostring( compact:introspection( "bytesperterm") < map:introspection( "bytesperterm"))
+
+-- Changes of existing and of new terms are kept in the overlay of the recent changes:
+for _,statmap in ipairs( {map, compact}) do
+	statmap:addDfChange( "word", "2", 1)
+	statmap:addDfChange( "word", "3", -1)
+	statmap:addDfChange( "word", "1009", 1)
+end
+output[ "changed"] = {differences = compare(), delta = deltaSize( compact), df = compact:dfArray( {{"word","2"},{"word","3"},{"word","1009"}})}
+
+local result = "statistics compact:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics compact:
+string changed:
+  string delta: 3
+  string df:
+    number 1: 501
+    number 2: 332
+    number 3: 1
+  string differences: 0
+string dict:
+  string compact: "compact"
+  string map: "map"
+string loaded:
+  string delta: 0
+  string differences: 0
+  string nofdocs: 1000
+string smaller: "true"
+]]
+verifyTestOutput( outputdir, result, expected)
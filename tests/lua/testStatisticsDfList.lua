@@ -0,0 +1,72 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local ctx = strus_Context.new()
+
+-- The df of a list of terms must be the one of the single lookups, for every position of the list:
+function compare( statmap, terms)
+	local dfar = statmap:dfArray( terms)
+	local differences = 0
+	for ti,term in ipairs( terms) do
+		if dfar[ ti] ~= statmap:df( term[1], term[2]) then
+			differences = differences + 1
+		end
+	end
+	return {size=#dfar, differences=differences}
+end
+
+function fill( statmap)
+	for ti=1,100 do
+		statmap:addDfChange( "word", "t" .. ti, ti % 7 + 1)
+	end
+	statmap:addDfChange( "word", "country", 12)
+	statmap:addDfChange( "word", "city", 5)
+end
+
+-- List with duplicates, unknown terms and terms of another type, spread over all shards:
+local terms = {{"word","country"},{"word","city"},{"word","country"},{"word","unknown"},{"other","city"}}
+for ti=1,100,3 do
+	table.insert( terms, {"word", "t" .. ti})
+	table.insert( terms, {"word", "t" .. (ti % 11 + 1)})
+end
+
+local output = {}
+local exact = ctx:createStatisticsMap( "proc=std; shards=4")
+fill( exact)
+output[ "exact"] = exact:dfArray( {{"word","country"},{"word","city"},{"word","country"},{"word","unknown"},{"other","city"}})
+output[ "exact termstats"] = exact:dfList( {{"word","country"},{"word","city"},{"word","country"}})
+output[ "exact compare"] = compare( exact, terms)
+
+local sketch = ctx:createStatisticsMap( "proc=std; shards=4; sketchwidth=65536; sketchdepth=4; exactdf=3")
+fill( sketch)
+output[ "sketch compare"] = compare( sketch, terms)
+output[ "empty"] = #(exact:dfArray( {}) or {})
+
+local result = "statistics df list:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics df list:
+string empty: 0
+string exact:
+  number 1: 12
+  number 2: 5
+  number 3: 12
+  number 4: 0
+  number 5: 0
+string exact compare:
+  string differences: 0
+  string size: 73
+string exact termstats:
+  number 1:
+    string df: 12
+    string type: "word"
+    string value: "country"
+  number 2:
+    string df: 5
+    string type: "word"
+    string value: "city"
+string sketch compare:
+  string differences: 0
+  string size: 73
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,76 @@
+require "string"
+require "utils"
+require "math"
+require "config_mdprim"
+require "createCollection"
+
+local datadir = arg[1] or "../data/mdprim/"
+local outputdir = arg[2] or '.'
+local storagedir = outputdir .. "/storage"
+local docfiles = {"doc1000.xml"}
+
+local ctx = strus_Context.new()
+createCollection( ctx, storagedir, metadata_mdprim(), createDocumentAnalyzer_mdprim( ctx), true, datadir, docfiles, nil, false)
+local storage = ctx:createStorageClient( string.format( "path='%s';cache=512M;statsproc=std", storagedir))
+
+-- The map of the statistics processor as reference and a map partitioned by term hash:
+local reference = ctx:createStatisticsMap( "proc=std")
+local statmap = ctx:createStatisticsMap( "proc=std; shards=8")
+
+-- Feed the statistics of the storage to both maps, the partitioned map is read between the messages,
+-- as only documents are inserted, the df read must never decrease:
+local decreasing = 0
+local lastdf = 0
+for blob in storage:getAllStatistics() do
+	reference:processStatisticsMessage( blob)
+	statmap:processStatisticsMessage( blob)
+	local df = statmap:df( "word", "2")
+	if df < lastdf then
+		decreasing = decreasing + 1
+	end
+	lastdf = df
+end
+storage:close()
+
+-- The terms of the collection are the prime numbers below 1000, the other numbers are unknown terms:
+local terms = {}
+for value=1,1000 do
+	table.insert( terms, {"word", tostring( value)})
+end
+local differences = 0
+local known = 0
+for _,term in ipairs( terms) do
+	local df = statmap:df( term[1], term[2])
+	if df ~= reference:df( term[1], term[2]) then
+		differences = differences + 1
+	end
+	if df > 0 then
+		known = known + 1
+	end
+end
+
+local output = {}
+output[ "decreasing"] = decreasing
+output[ "differences"] = differences
+output[ "known"] = known
+output[ "nofdocs"] = {reference = reference:nofDocuments(), shards = statmap:nofDocuments()}
+output[ "df"] = statmap:dfArray( {{"word","2"},{"word","3"},{"word","997"},{"word","4"}})
+output[ "shards"] = #statmap:introspection( "shard")
+
+local result = "statistics shards:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics shards:
+string decreasing: 0
+string df:
+  number 1: 500
+  number 2: 333
+  number 3: 1
+  number 4: 0
+string differences: 0
+string known: 168
+string nofdocs:
+  string reference: 1000
+  string shards: 1000
+string shards: 8
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,52 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local ctx = strus_Context.new()
+
+-- Terms are counted in a count-min sketch until their estimated df reaches the threshold 'exactdf',
+-- then they are counted exactly. Terms counted exactly stay exact also if their df drops to 0:
+local statmap = ctx:createStatisticsMap( "proc=std; shards=4; sketchwidth=65536; sketchdepth=4; exactdf=3")
+
+local steps = {}
+function change( type, value, increment)
+	statmap:addDfChange( type, value, increment)
+	table.insert( steps, string.format( "%s %s %+d: %d", type, value, increment, statmap:df( type, value)))
+end
+
+-- promotion of a term to an exact count when its estimate reaches the threshold:
+change( "word", "a", 1)
+change( "word", "a", 1)
+change( "word", "a", 1)
+change( "word", "a", 2)
+-- demotion of a term counted exactly to 0, the estimate of the sketch must not be used for it anymore:
+change( "word", "a", -5)
+change( "word", "a", 1)
+-- term counted in the sketch only:
+change( "word", "b", 1)
+change( "word", "b", -1)
+-- term promoted with the first change:
+change( "word", "c", 4)
+change( "word", "c", -1)
+
+local output = {}
+output[ "df"] = steps
+output[ "unknown"] = statmap:df( "word", "d")
+
+local result = "statistics sketch:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics sketch:
+string df:
+  number 1: "word a +1: 1"
+  number 2: "word a +1: 2"
+  number 3: "word a +1: 3"
+  number 4: "word a +2: 5"
+  number 5: "word a -5: 0"
+  number 6: "word a +1: 1"
+  number 7: "word b +1: 1"
+  number 8: "word b -1: 0"
+  number 9: "word c +4: 4"
+  number 10: "word c -1: 3"
+string unknown: 0
+]]
+verifyTestOutput( outputdir, result, expected)
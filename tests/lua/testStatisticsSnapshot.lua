@@ -0,0 +1,100 @@
+require "string"
+require "utils"
+
+local outputdir = arg[1] or '.'
+local snapshotfile = outputdir .. "/statserver.snapshot"
+local ctx = strus_Context.new()
+
+-- Two storages as sources of statistics changes:
+function createStorage( name)
+	local config = {path=outputdir .. "/" .. name, statsproc='std'}
+	if ctx:storageExists( config) then
+		ctx:destroyStorage( config)
+	end
+	ctx:createStorage( config)
+	return ctx:createStorageClient( config)
+end
+local storages = {A = createStorage( "statsnapshot_A"), B = createStorage( "statsnapshot_B")}
+
+function createStatisticsMap()
+	return ctx:createStatisticsMap( string.format( "proc=std; shards=4; snapshot='%s'", snapshotfile))
+end
+
+function insertDocument( source, docid, words)
+	local searchindex = {}
+	for pos,word in ipairs( words) do
+		table.insert( searchindex, {type="word", value=word, pos=pos})
+	end
+	local transaction = storages[ source]:createTransaction()
+	transaction:insertDocument( docid, {searchindex=searchindex})
+	transaction:commit()
+end
+
+-- Synchronize a statistics map with a storage, return what the changes contained:
+function sync( statmap, source)
+	local changes = storages[ source]:getStatisticsChanges( source, statmap:watermarks())
+	statmap:processStatisticsChanges( source, changes.message, changes.watermark, changes.snapshot)
+	if changes.watermark then
+		return "snapshot"
+	else
+		return "messages"
+	end
+end
+
+-- State of a statistics map:
+function state( statmap)
+	local watermarks = {}
+	for _,wm in ipairs( statmap:watermarks() or {}) do
+		watermarks[ wm.source] = string.format( "%d.%d", wm.timestamp.unixtime, wm.timestamp.counter)
+	end
+	return {
+		nofdocs = statmap:nofDocuments(),
+		df = statmap:dfArray( {{"word","a"},{"word","b"},{"word","c"}}),
+		watermarks = watermarks
+	}
+end
+
+local output = {}
+
+-- [1] A server started without snapshot gets the complete statistics of the sources and stores them as snapshot:
+os.remove( snapshotfile)
+insertDocument( "A", "A1", {"a","b"})
+insertDocument( "B", "B1", {"a"})
+local statmap = createStatisticsMap()
+output[ "1 sync"] = {A = sync( statmap, "A"), B = sync( statmap, "B")}
+statmap:storeSnapshot()
+local stored = state( statmap)
+
+-- [2] A server restarted has the state of the snapshot immediately, before any synchronization:
+insertDocument( "A", "A2", {"b","c"})
+local restarted = createStatisticsMap()
+local loaded = state( restarted)
+output[ "2 equal"] = tostring( dumpTree( loaded) == dumpTree( stored))
+output[ "2 nofdocs"] = loaded.nofdocs
+
+-- [3] The restarted server only gets the changes since the watermarks of the snapshot:
+output[ "3 sync"] = {A = sync( restarted, "A"), B = sync( restarted, "B")}
+output[ "3 state"] = {nofdocs = restarted:nofDocuments(), df = restarted:dfArray( {{"word","a"},{"word","b"},{"word","c"}})}
+
+storages.A:close()
+storages.B:close()
+
+local result = "statistics snapshot:" .. dumpTree( output) .. "\n"
+local expected = [[
+statistics snapshot:
+string 1 sync:
+  string A: "snapshot"
+  string B: "snapshot"
+string 2 equal: "true"
+string 2 nofdocs: 2
+string 3 state:
+  string df:
+    number 1: 2
+    number 2: 2
+    number 3: 1
+  string nofdocs: 3
+string 3 sync:
+  string A: "messages"
+  string B: "messages"
+]]
+verifyTestOutput( outputdir, result, expected)
@@ -0,0 +1,60 @@
+require "config"
+require "testUtils"
+require "io"
+require "os"
+
+storageConfig = {
+	storage = {
+		database = "leveldb",
+		statsproc = "std",
+		cache_size = "500M",
+		max_open_files = 512,
+		write_buffer_size = "8K",
+		block_size = "4K"
+	}
+}
+metadataConfig = {
+	storage = {
+		metadata = {
+			{op="add", name="doclen", type="UINT16"}
+		}
+	}
+}
+resultBuffer = ""
+
+function report( title, value)
+	if verbose then io.stderr:write( string.format("- %s: %s\n", title, tostring(value))) end
+	resultBuffer = resultBuffer .. string.format("%s: %s\n", title, tostring(value))
+end
+
+def_test_server( "isrv", ISERVER1)
+call_server_checked( "POST", ISERVER1 .. "/storage/test", storageConfig)
+local transaction = from_json( call_server_checked( "POST", ISERVER1 .. "/storage/test/transaction" )).transaction.link
+call_server_checked( "PUT", transaction, metadataConfig)
+
+-- A POST without content on the transaction itself does not commit, the asynchronous commit has to be addressed explicitly:
+local _,status = call_server( "POST", transaction)
+report( "POST TRANSACTION REJECTED", status >= 400)
+
+-- Start the asynchronous commit, answered with 202 and a link to the transaction:
+local result,status = call_server( "POST", transaction .. "/commit")
+exitOnBadHttpStatus( status)
+report( "POST COMMIT STATUS", status)
+local link = from_json( result).transaction.link
+report( "POST COMMIT LINK", link == transaction)
+
+-- Poll the state of the commit until it is finished:
+local state = from_json( call_server_checked( "GET", link)).commit.state
+while state == "running" do
+	state = from_json( call_server_checked( "GET", link)).commit.state
+end
+report( "COMMIT STATE", state)
+
+-- Content on the commit path is not accepted:
+local _,status = call_server( "POST", transaction .. "/commit", metadataConfig)
+report( "POST COMMIT WITH CONTENT REJECTED", status >= 400)
+
+local _,status = call_server( "DELETE", transaction)
+report( "DELETE TRANSACTION STATUS", status)
+
+checkExpected( resultBuffer, "@asyncCommit.exp", "asyncCommit.res" )
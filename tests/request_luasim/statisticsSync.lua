@@ -0,0 +1,111 @@
+require "config"
+require "testUtils"
+require "io"
+require "os"
+
+SCRIPTPATH = script_path()
+
+storageConfig = {
+	storage = {
+		database = "leveldb",
+		statsproc = "std",
+		cache_size = "500M",
+		max_open_files = 512,
+		write_buffer_size = "8K",
+		block_size = "4K"
+	}
+}
+metadataConfig = {
+	storage = {
+		metadata = {
+			{op="add", name="doclen", type="UINT16"}
+		}
+	}
+}
+inserterConfig = {
+	inserter = {
+		include = {
+			analyzer = "test",
+			storage  = "test"
+		}
+	}
+}
+statserverConfig = {
+	statserver = {
+		proc = "std",
+		shards = 4,
+		storage = { ISERVER1 .. "/storage/test" }
+	}
+}
+query_analyzed = {
+	query = {
+		feature = {
+			{
+				analyzed = {
+					{
+						term = { type = "word", value = "pop"}
+					}
+				},
+				set = "search"
+			}
+		}
+	}
+}
+resultBuffer = ""
+
+function insertDocuments( documents)
+	local transaction = from_json( call_server_checked( "POST", ISERVER1 .. "/inserter/test/transaction" )).transaction.link
+	for _,path in ipairs( documents) do
+		call_server_checked( "PUT", transaction, "@doc/xml/" .. path)
+	end
+	call_server_checked( "PUT", transaction)
+	if verbose then io.stderr:write( string.format("- Inserted %d documents\n", #documents)) end
+end
+
+-- Check the number of documents of the statistics server against the number of documents inserted:
+function checkStatistics( title, nofdocs)
+	local statistics = from_json( call_server_checked( "GET", ISERVER1 .. "/statserver/test", query_analyzed)).statistics
+	if verbose then io.stderr:write( string.format("- Statistics server nofdocs %s: %d\n", title, statistics.nofdocs)) end
+	resultBuffer = resultBuffer .. string.format("NOFDOCS %s: %s\n", title, tostring( statistics.nofdocs == nofdocs))
+end
+
+-- Let the statistics server pull the changes of the storages since its watermarks:
+function sync()
+	call_server_checked( "POST", ISERVER1 .. "/statserver/test/statserver", "{}")
+end
+
+def_test_server( "isrv", ISERVER1)
+call_server_checked( "POST", ISERVER1 .. "/storage/test", storageConfig)
+local transaction = from_json( call_server_checked( "POST", ISERVER1 .. "/storage/test/transaction" )).transaction.link
+call_server_checked( "PUT", transaction, metadataConfig)
+call_server_checked( "PUT", transaction)
+call_server_checked( "PUT", ISERVER1 .. "/docanalyzer/test", "@docanalyzer.json")
+call_server_checked( "PUT", ISERVER1 .. "/inserter/test", inserterConfig)
+
+local documents = getDirectoryFiles( SCRIPTPATH .. "/doc/xml", ".xml")
+local firstHalf = {}
+local secondHalf = {}
+for di,path in ipairs( documents) do
+	if di <= #documents / 2 then
+		table.insert( firstHalf, path)
+	else
+		table.insert( secondHalf, path)
+	end
+end
+
+-- The statistics server gets a snapshot of the storage with its configuration:
+insertDocuments( firstHalf)
+call_server_checked( "PUT", ISERVER1 .. "/statserver/test", statserverConfig)
+checkStatistics( "snapshot", #firstHalf)
+
+-- Changes are pulled with a synchronization request:
+insertDocuments( secondHalf)
+checkStatistics( "before sync", #firstHalf)
+sync()
+checkStatistics( "after sync", #documents)
+
+-- Changes already propagated are not applied again:
+sync()
+checkStatistics( "after repeated sync", #documents)
+
+checkExpected( resultBuffer, "@statisticsSync.exp", "statisticsSync.res" )